@@ -8,12 +8,251 @@
 #define NTL__CPU
 #pragma once
 
+/// SSE2 is a part of x64 and is enabled by /arch:SSE2 on x86
+#if defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2) || defined(__SSE2__)
+# define NTL_CPU_SSE2
+#endif
+
+/// AVX2 code is built without /arch:AVX2 and selected at run time by ntl::cpu::has().
+/// Kernel mode code does not get it: the YMM state is not saved there without KeSaveExtendedProcessorState.
+#if defined(NTL_CPU_SSE2) && !defined(NTL_SUBSYSTEM_KM) && ((defined(_MSC_VER) && _MSC_VER >= 1700) || defined(__GNUC__) || defined(__clang__))
+# define NTL_CPU_AVX2
+#endif
+
+/// SHA extensions code (with SSSE3 and SSE4.1) is selected at run time by ntl::cpu::has(cpu::sha)
+#if defined(NTL_CPU_SSE2) && ((defined(_MSC_VER) && _MSC_VER >= 1900) || defined(__GNUC__) || defined(__clang__))
+# define NTL_CPU_SHA
+#endif
+
+/// Marks the function compiled for the given instruction set (GNU compilers require it for the intrinsics)
+#if defined(__GNUC__) || defined(__clang__)
+# define NTL_CPU_TARGET(isa) __attribute__((target(isa)))
+#else
+# define NTL_CPU_TARGET(isa)
+#endif
+
+#if defined(__GNUC__) || defined(__clang__)
+# if defined(__i386__) || defined(__x86_64__)
+#  include <cpuid.h>
+# endif
+#endif
+
+#ifdef NTL_CPU_SSE2
+# if defined(__GNUC__) || defined(__clang__)
+#  include <immintrin.h>
+# elif !defined(_INCLUDED_EMM)
+/** 128-bit integer vector type (declared as in the compiler's emmintrin.h) */
+typedef union __declspec(intrin_type) __declspec(align(16)) __m128i {
+  char              m128i_i8[16];
+  short             m128i_i16[8];
+  int               m128i_i32[4];
+  __int64           m128i_i64[2];
+  unsigned char     m128i_u8[16];
+  unsigned short    m128i_u16[8];
+  unsigned int      m128i_u32[4];
+  unsigned __int64  m128i_u64[2];
+} __m128i;
+# endif
+# if defined(NTL_CPU_AVX2) && !defined(__GNUC__) && !defined(__clang__) && !defined(_INCLUDED_IMM)
+/** 256-bit integer vector type (declared as in the compiler's immintrin.h) */
+typedef union __declspec(intrin_type) __declspec(align(32)) __m256i {
+  char              m256i_i8[32];
+  short             m256i_i16[16];
+  int               m256i_i32[8];
+  __int64           m256i_i64[4];
+  unsigned char     m256i_u8[32];
+  unsigned short    m256i_u16[16];
+  unsigned int      m256i_u32[8];
+  unsigned __int64  m256i_u64[4];
+} __m256i;
+# endif
+#endif // NTL_CPU_SSE2
+
 namespace ntl {
 
   /// Compiler intrinsics \internal
   namespace intrinsic {
     extern "C" void __cdecl _mm_pause();
     #pragma intrinsic(_mm_pause)
+
+#if defined(_MSC_VER) && !defined(__clang__)
+    extern "C" {
+    void __cdecl __cpuid(int cpuInfo[4], int function_id);
+    void __cdecl __cpuidex(int cpuInfo[4], int function_id, int subfunction_id);
+    unsigned __int64 __cdecl _xgetbv(unsigned int xcr);
+    }
+    #pragma intrinsic(__cpuid, __cpuidex)
+#endif
+
+#ifdef NTL_CPU_SSE2
+# if defined(__GNUC__) || defined(__clang__)
+    using ::_mm_loadu_si128;
+    using ::_mm_load_si128;
+    using ::_mm_set1_epi8;
+    using ::_mm_set1_epi16;
+    using ::_mm_set1_epi32;
+    using ::_mm_setzero_si128;
+    using ::_mm_cmpeq_epi8;
+    using ::_mm_cmpeq_epi16;
+    using ::_mm_cmpeq_epi32;
+    using ::_mm_cmpgt_epi8;
+    using ::_mm_and_si128;
+    using ::_mm_or_si128;
+    using ::_mm_movemask_epi8;
+    using ::_mm_storeu_si128;
+    using ::_mm_add_epi32;
+    using ::_mm_xor_si128;
+    using ::_mm_shuffle_epi32;
+    using ::_mm_cvtsi32_si128;
+    using ::_mm_cvtsi128_si32;
+    using ::_mm_slli_epi32;
+    using ::_mm_srli_epi32;
+    using ::_mm_unpacklo_epi32;
+    using ::_mm_unpackhi_epi32;
+    using ::_mm_unpacklo_epi64;
+    using ::_mm_unpackhi_epi64;
+# else
+    extern "C" {
+    __m128i __cdecl _mm_loadu_si128(const __m128i* p);
+    __m128i __cdecl _mm_load_si128(const __m128i* p);
+    __m128i __cdecl _mm_set1_epi8(char b);
+    __m128i __cdecl _mm_set1_epi16(short w);
+    __m128i __cdecl _mm_set1_epi32(int i);
+    __m128i __cdecl _mm_setzero_si128();
+    __m128i __cdecl _mm_cmpeq_epi8(__m128i a, __m128i b);
+    __m128i __cdecl _mm_cmpeq_epi16(__m128i a, __m128i b);
+    __m128i __cdecl _mm_cmpeq_epi32(__m128i a, __m128i b);
+    __m128i __cdecl _mm_cmpgt_epi8(__m128i a, __m128i b);
+    __m128i __cdecl _mm_and_si128(__m128i a, __m128i b);
+    __m128i __cdecl _mm_or_si128(__m128i a, __m128i b);
+    int     __cdecl _mm_movemask_epi8(__m128i a);
+    void    __cdecl _mm_storeu_si128(__m128i* p, __m128i a);
+    __m128i __cdecl _mm_add_epi32(__m128i a, __m128i b);
+    __m128i __cdecl _mm_xor_si128(__m128i a, __m128i b);
+    __m128i __cdecl _mm_shuffle_epi32(__m128i a, int imm);
+    __m128i __cdecl _mm_cvtsi32_si128(int a);
+    int     __cdecl _mm_cvtsi128_si32(__m128i a);
+    __m128i __cdecl _mm_slli_epi32(__m128i a, int count);
+    __m128i __cdecl _mm_srli_epi32(__m128i a, int count);
+    __m128i __cdecl _mm_unpacklo_epi32(__m128i a, __m128i b);
+    __m128i __cdecl _mm_unpackhi_epi32(__m128i a, __m128i b);
+    __m128i __cdecl _mm_unpacklo_epi64(__m128i a, __m128i b);
+    __m128i __cdecl _mm_unpackhi_epi64(__m128i a, __m128i b);
+    }
+    #pragma intrinsic(_mm_loadu_si128, _mm_load_si128, _mm_set1_epi8, _mm_set1_epi16, _mm_set1_epi32, _mm_setzero_si128)
+    #pragma intrinsic(_mm_cmpeq_epi8, _mm_cmpeq_epi16, _mm_cmpeq_epi32, _mm_cmpgt_epi8)
+    #pragma intrinsic(_mm_and_si128, _mm_or_si128, _mm_movemask_epi8)
+    #pragma intrinsic(_mm_storeu_si128, _mm_add_epi32, _mm_xor_si128, _mm_shuffle_epi32, _mm_cvtsi32_si128, _mm_cvtsi128_si32)
+    #pragma intrinsic(_mm_slli_epi32, _mm_srli_epi32, _mm_unpacklo_epi32, _mm_unpackhi_epi32, _mm_unpacklo_epi64, _mm_unpackhi_epi64)
+# endif
+#endif // NTL_CPU_SSE2
+
+#ifdef NTL_CPU_SSE2
+    // SSE4.2 CRC32, selected at run time by ntl::cpu::has(cpu::sse42)
+# if defined(__GNUC__) || defined(__clang__)
+    using ::_mm_crc32_u8;
+    using ::_mm_crc32_u32;
+#  ifdef __x86_64__
+    using ::_mm_crc32_u64;
+#  endif
+# else
+    extern "C" {
+    unsigned int __cdecl _mm_crc32_u8(unsigned int crc, unsigned char v);
+    unsigned int __cdecl _mm_crc32_u32(unsigned int crc, unsigned int v);
+#  ifdef _M_X64
+    unsigned __int64 __cdecl _mm_crc32_u64(unsigned __int64 crc, unsigned __int64 v);
+#  endif
+    }
+    #pragma intrinsic(_mm_crc32_u8, _mm_crc32_u32)
+#  ifdef _M_X64
+    #pragma intrinsic(_mm_crc32_u64)
+#  endif
+# endif
+#endif // NTL_CPU_SSE2
+
+#ifdef NTL_CPU_SHA
+# if defined(__GNUC__) || defined(__clang__)
+    using ::_mm_shuffle_epi8;
+    using ::_mm_alignr_epi8;
+    using ::_mm_blend_epi16;
+    using ::_mm_sha1rnds4_epu32;
+    using ::_mm_sha1nexte_epu32;
+    using ::_mm_sha1msg1_epu32;
+    using ::_mm_sha1msg2_epu32;
+    using ::_mm_sha256rnds2_epu32;
+    using ::_mm_sha256msg1_epu32;
+    using ::_mm_sha256msg2_epu32;
+# else
+    extern "C" {
+    __m128i __cdecl _mm_shuffle_epi8(__m128i a, __m128i b);
+    __m128i __cdecl _mm_alignr_epi8(__m128i a, __m128i b, int n);
+    __m128i __cdecl _mm_blend_epi16(__m128i a, __m128i b, const int mask);
+    __m128i __cdecl _mm_sha1rnds4_epu32(__m128i a, __m128i b, const int func);
+    __m128i __cdecl _mm_sha1nexte_epu32(__m128i a, __m128i b);
+    __m128i __cdecl _mm_sha1msg1_epu32(__m128i a, __m128i b);
+    __m128i __cdecl _mm_sha1msg2_epu32(__m128i a, __m128i b);
+    __m128i __cdecl _mm_sha256rnds2_epu32(__m128i a, __m128i b, __m128i k);
+    __m128i __cdecl _mm_sha256msg1_epu32(__m128i a, __m128i b);
+    __m128i __cdecl _mm_sha256msg2_epu32(__m128i a, __m128i b);
+    }
+# endif
+#endif // NTL_CPU_SHA
+
+#ifdef NTL_CPU_AVX2
+# if defined(__GNUC__) || defined(__clang__)
+    using ::_mm256_loadu_si256;
+    using ::_mm256_load_si256;
+    using ::_mm256_set1_epi8;
+    using ::_mm256_set1_epi16;
+    using ::_mm256_set1_epi32;
+    using ::_mm256_cmpeq_epi8;
+    using ::_mm256_cmpeq_epi16;
+    using ::_mm256_cmpeq_epi32;
+    using ::_mm256_movemask_epi8;
+    using ::_mm256_zeroupper;
+    using ::_mm256_storeu_si256;
+    using ::_mm256_add_epi32;
+    using ::_mm256_xor_si256;
+    using ::_mm256_and_si256;
+    using ::_mm256_andnot_si256;
+    using ::_mm256_or_si256;
+    using ::_mm256_slli_epi32;
+    using ::_mm256_srli_epi32;
+    using ::_mm256_shuffle_epi8;
+    using ::_mm256_unpacklo_epi32;
+    using ::_mm256_unpackhi_epi32;
+    using ::_mm256_unpacklo_epi64;
+    using ::_mm256_unpackhi_epi64;
+    using ::_mm256_permute2x128_si256;
+# else
+    extern "C" {
+    __m256i __cdecl _mm256_loadu_si256(const __m256i* p);
+    __m256i __cdecl _mm256_load_si256(const __m256i* p);
+    __m256i __cdecl _mm256_set1_epi8(char b);
+    __m256i __cdecl _mm256_set1_epi16(short w);
+    __m256i __cdecl _mm256_set1_epi32(int i);
+    __m256i __cdecl _mm256_cmpeq_epi8(__m256i a, __m256i b);
+    __m256i __cdecl _mm256_cmpeq_epi16(__m256i a, __m256i b);
+    __m256i __cdecl _mm256_cmpeq_epi32(__m256i a, __m256i b);
+    int     __cdecl _mm256_movemask_epi8(__m256i a);
+    void    __cdecl _mm256_zeroupper();
+    void    __cdecl _mm256_storeu_si256(__m256i* p, __m256i a);
+    __m256i __cdecl _mm256_add_epi32(__m256i a, __m256i b);
+    __m256i __cdecl _mm256_xor_si256(__m256i a, __m256i b);
+    __m256i __cdecl _mm256_and_si256(__m256i a, __m256i b);
+    __m256i __cdecl _mm256_andnot_si256(__m256i a, __m256i b);
+    __m256i __cdecl _mm256_or_si256(__m256i a, __m256i b);
+    __m256i __cdecl _mm256_slli_epi32(__m256i a, int count);
+    __m256i __cdecl _mm256_srli_epi32(__m256i a, int count);
+    __m256i __cdecl _mm256_shuffle_epi8(__m256i a, __m256i b);
+    __m256i __cdecl _mm256_unpacklo_epi32(__m256i a, __m256i b);
+    __m256i __cdecl _mm256_unpackhi_epi32(__m256i a, __m256i b);
+    __m256i __cdecl _mm256_unpacklo_epi64(__m256i a, __m256i b);
+    __m256i __cdecl _mm256_unpackhi_epi64(__m256i a, __m256i b);
+    __m256i __cdecl _mm256_permute2x128_si256(__m256i a, __m256i b, const int control);
+    }
+# endif
+#endif // NTL_CPU_AVX2
   }
 
   /// CPU functions
@@ -32,6 +271,102 @@ namespace ntl {
 #ifdef NTL__NT_BASEDEF
     static inline void yield() { ntl::nt::ZwYieldExecution(); }
 #endif
+
+    /** Instruction set extensions which the code may select at run time */
+    enum feature
+    {
+      sse2    = 1 << 0,
+      ssse3   = 1 << 1,
+      sse41   = 1 << 2,
+      sse42   = 1 << 3,
+      popcnt  = 1 << 4,
+      avx     = 1 << 5,
+      avx2    = 1 << 6,
+      bmi2    = 1 << 7,
+      sha     = 1 << 8
+    };
+
+    namespace __
+    {
+      static inline void cpuid(int r[4], int leaf, int subleaf)
+      {
+#if defined(_MSC_VER) && !defined(__clang__)
+        intrinsic::__cpuidex(r, leaf, subleaf);
+#elif defined(__i386__) || defined(__x86_64__)
+        unsigned a, b, c, d;
+        __cpuid_count(leaf, subleaf, a, b, c, d);
+        r[0] = a, r[1] = b, r[2] = c, r[3] = d;
+#else
+        (void)leaf, (void)subleaf;
+        r[0] = r[1] = r[2] = r[3] = 0;
+#endif
+      }
+
+      /** Checks that the OS saves the XMM and YMM state on the context switch */
+      static inline bool os_saves_ymm()
+      {
+#if defined(_MSC_VER) && !defined(__clang__)
+        return (intrinsic::_xgetbv(0) & 6) == 6;
+#elif defined(__i386__) || defined(__x86_64__)
+        unsigned lo, hi;
+        __asm__ ("xgetbv" : "=a"(lo), "=d"(hi) : "c"(0));
+        return (lo & 6) == 6;
+#else
+        return false;
+#endif
+      }
+
+      static inline unsigned detect_features()
+      {
+        // eax, ebx, ecx, edx
+        int r[4];
+        cpuid(r, 0, 0);
+        const int max_leaf = r[0];
+        if(max_leaf < 1)
+          return 0;
+
+        unsigned f = 0;
+        cpuid(r, 1, 0);
+        if(r[3] & (1 << 26)) f |= sse2;
+        if(r[2] & (1 << 9))  f |= ssse3;
+        if(r[2] & (1 << 19)) f |= sse41;
+        if(r[2] & (1 << 20)) f |= sse42;
+        if(r[2] & (1 << 23)) f |= popcnt;
+        // avx needs both the cpu (bit 28) and the os support (osxsave, bit 27);
+        // the kernel mode code does not save the YMM state, so it never selects avx
+#ifdef NTL_SUBSYSTEM_KM
+        const bool ymm = false;
+#else
+        const bool ymm = (r[2] & (1 << 27)) && (r[2] & (1 << 28)) && os_saves_ymm();
+#endif
+        if(ymm) f |= avx;
+
+        if(max_leaf >= 7){
+          cpuid(r, 7, 0);
+          if(ymm && (r[1] & (1 << 5))) f |= avx2;
+          if(r[1] & (1 << 8))  f |= bmi2;
+          if(r[1] & (1 << 29)) f |= sha;
+        }
+        return f;
+      }
+    }
+
+    /** Returns the set of the supported \c feature flags. The processor is queried once. */
+    inline unsigned features()
+    {
+      // the high bit marks the cache as filled; concurrent callers store the same value
+      static volatile unsigned cache = 0;
+      unsigned f = cache;
+      if(!f)
+        cache = f = __::detect_features() | 0x80000000u;
+      return f;
+    }
+
+    /** Checks if the processor (and the OS) supports the feature \p f */
+    inline bool has(feature f)
+    {
+      return (features() & f) != 0;
+    }
   } // cpu
 } // ntl
 #endif // NTL__CPU
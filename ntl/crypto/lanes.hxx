@@ -0,0 +1,85 @@
+/**\file*********************************************************************
+ *                                                                     \brief
+ *  SIMD helpers for hashing the independent messages in the vector lanes
+ *
+ ****************************************************************************
+ */
+#ifndef NTL__CRYPTO_LANES
+#define NTL__CRYPTO_LANES
+#pragma once
+
+#include "../cpu.hxx"
+
+namespace ntl { namespace crypto { namespace __
+{
+
+#ifdef NTL_CPU_SSE2
+
+  template<int N>
+  static inline __m128i rotl4x(__m128i x)
+  {
+    using namespace intrinsic;
+    return _mm_or_si128(_mm_slli_epi32(x, N), _mm_srli_epi32(x, 32 - N));
+  }
+
+  /// transposes the 4x4 matrix of the 32-bit words
+  static inline void transpose4x4(__m128i r[4])
+  {
+    using namespace intrinsic;
+    const __m128i t0 = _mm_unpacklo_epi32(r[0], r[1]), t1 = _mm_unpackhi_epi32(r[0], r[1]),
+                  t2 = _mm_unpacklo_epi32(r[2], r[3]), t3 = _mm_unpackhi_epi32(r[2], r[3]);
+    r[0] = _mm_unpacklo_epi64(t0, t2);
+    r[1] = _mm_unpackhi_epi64(t0, t2);
+    r[2] = _mm_unpacklo_epi64(t1, t3);
+    r[3] = _mm_unpackhi_epi64(t1, t3);
+  }
+
+#endif // NTL_CPU_SSE2
+
+#ifdef NTL_CPU_AVX2
+
+  template<int N>
+  NTL_CPU_TARGET("avx2")
+  static inline __m256i rotr8x(__m256i x)
+  {
+    using namespace intrinsic;
+    return _mm256_or_si256(_mm256_srli_epi32(x, N), _mm256_slli_epi32(x, 32 - N));
+  }
+
+  template<int N>
+  NTL_CPU_TARGET("avx2")
+  static inline __m256i rotl8x(__m256i x)
+  {
+    return rotr8x<32 - N>(x);
+  }
+
+  /// transposes the 8x8 matrix of the 32-bit words
+  NTL_CPU_TARGET("avx2")
+  static inline void transpose8x8(__m256i r[8])
+  {
+    using namespace intrinsic;
+    __m256i t[8], u[8];
+    for ( unsigned i = 0; i < 8; i += 2 )
+    {
+      t[i]     = _mm256_unpacklo_epi32(r[i], r[i + 1]);
+      t[i + 1] = _mm256_unpackhi_epi32(r[i], r[i + 1]);
+    }
+    for ( unsigned i = 0; i < 8; i += 4 )
+    {
+      u[i]     = _mm256_unpacklo_epi64(t[i], t[i + 2]);
+      u[i + 1] = _mm256_unpackhi_epi64(t[i], t[i + 2]);
+      u[i + 2] = _mm256_unpacklo_epi64(t[i + 1], t[i + 3]);
+      u[i + 3] = _mm256_unpackhi_epi64(t[i + 1], t[i + 3]);
+    }
+    for ( unsigned i = 0; i < 4; ++i )
+    {
+      r[i]     = _mm256_permute2x128_si256(u[i], u[i + 4], 0x20);
+      r[i + 4] = _mm256_permute2x128_si256(u[i], u[i + 4], 0x31);
+    }
+  }
+
+#endif // NTL_CPU_AVX2
+
+}}}//namespace ntl.crypto.__
+
+#endif//#ifndef NTL__CRYPTO_LANES
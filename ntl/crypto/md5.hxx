@@ -1,9 +1,21 @@
+/**\file*********************************************************************
+ *                                                                     \brief
+ *  MD5 Message-Digest Algorithm as declared in RFC 1321
+ *
+ *  md5::hash_many() hashes the independent messages in the SSE2 (4 lanes)
+ *  or AVX2 (8 lanes) registers, a lane takes the next message as soon as
+ *  its current one is done.
+ *
+ ****************************************************************************
+ */
 #ifndef NTL__CRYPTO_MD5
 #define NTL__CRYPTO_MD5
 #pragma once
 
-#include <nt/peb.hxx>
-#include <pe/image.hxx>
+#include <stdint.h>
+#include <stdlib.hxx>
+#include "lanes.hxx"
+#include "../stlx/cstring.hxx"
 #include "../stlx/ostream.hxx"
 #include "../stlx/vector.hxx"
 #include "../stlx/array.hxx"
@@ -14,51 +26,300 @@ namespace ntl
   {
     struct md5_ctx
     {
-      uint32_t  i[2];
-      uint32_t  buf[4];
+      uint32_t  i[2];     // message length in bits, low and high parts
+      uint32_t  buf[4];   // A, B, C, D
       uint8_t   in[64];
       std::array<uint8_t, 16> hash;
     };
 
-    class md5: md5_ctx
+    namespace __
     {
-      typedef void __stdcall MD5Init_t(md5_ctx* context);
-      typedef void __stdcall MD5Final_t(md5_ctx* context);
-      typedef void __stdcall MD5Update_t(md5_ctx* context, const void* input, uint32_t size);
+      static const uint32_t md5_k[64] = {
+        0xD76AA478, 0xE8C7B756, 0x242070DB, 0xC1BDCEEE, 0xF57C0FAF, 0x4787C62A, 0xA8304613, 0xFD469501,
+        0x698098D8, 0x8B44F7AF, 0xFFFF5BB1, 0x895CD7BE, 0x6B901122, 0xFD987193, 0xA679438E, 0x49B40821,
+        0xF61E2562, 0xC040B340, 0x265E5A51, 0xE9B6C7AA, 0xD62F105D, 0x02441453, 0xD8A1E681, 0xE7D3FBC8,
+        0x21E1CDE6, 0xC33707D6, 0xF4D50D87, 0x455A14ED, 0xA9E3E905, 0xFCEFA3F8, 0x676F02D9, 0x8D2A4C8A,
+        0xFFFA3942, 0x8771F681, 0x6D9D6122, 0xFDE5380C, 0xA4BEEA44, 0x4BDECFA9, 0xF6BB4B60, 0xBEBFBC70,
+        0x289B7EC6, 0xEAA127FA, 0xD4EF3085, 0x04881D05, 0xD9D4D039, 0xE6DB99E5, 0x1FA27CF8, 0xC4AC5665,
+        0xF4292244, 0x432AFF97, 0xAB9423A7, 0xFC93A039, 0x655B59C3, 0x8F0CCC92, 0xFFEFF47D, 0x85845DD1,
+        0x6FA87E4F, 0xFE2CE6E0, 0xA3014314, 0x4E0811A1, 0xF7537E82, 0xBD3AF235, 0x2AD7D2BB, 0xEB86D391
+      };
+
+      static const uint32_t md5_iv[4] = { 0x67452301, 0xEFCDAB89, 0x98BADCFE, 0x10325476 };
+
+      /// the message word used by the step \p t
+      static inline unsigned md5_word(unsigned t)
+      {
+        return t < 16 ? t : t < 32 ? (5 * t + 1) & 15 : t < 48 ? (3 * t + 5) & 15 : (7 * t) & 15;
+      }
+
+      /// the little endian word of the message, which is not aligned
+      static inline uint32_t load_le32(const uint8_t* p)
+      {
+        uint32_t v;
+        std::memcpy(&v, p, sizeof(v));
+        return v;
+      }
+
+      template<int S>
+      static inline uint32_t md5_step(uint32_t a, uint32_t b, uint32_t f, uint32_t w, unsigned t)
+      {
+        return b + rotl(a + f + w + md5_k[t], S);
+      }
+
+      /// the portable compression function, \p state is A, B, C, D
+      static inline void md5_compress(uint32_t state[4], const uint8_t* p, size_t count)
+      {
+        for(; count; --count, p += 64){
+          uint32_t w[16];
+          for(unsigned t = 0; t < 16; t++)
+            w[t] = load_le32(p + t * 4);
+          uint32_t a = state[0], b = state[1], c = state[2], d = state[3];
+          for(unsigned t = 0; t < 16; t += 4){
+            a = md5_step< 7>(a, b, d ^ (b & (c ^ d)), w[md5_word(t)], t);
+            d = md5_step<12>(d, a, c ^ (a & (b ^ c)), w[md5_word(t+1)], t+1);
+            c = md5_step<17>(c, d, b ^ (d & (a ^ b)), w[md5_word(t+2)], t+2);
+            b = md5_step<22>(b, c, a ^ (c & (d ^ a)), w[md5_word(t+3)], t+3);
+          }
+          for(unsigned t = 16; t < 32; t += 4){
+            a = md5_step< 5>(a, b, c ^ (d & (b ^ c)), w[md5_word(t)], t);
+            d = md5_step< 9>(d, a, b ^ (c & (a ^ b)), w[md5_word(t+1)], t+1);
+            c = md5_step<14>(c, d, a ^ (b & (d ^ a)), w[md5_word(t+2)], t+2);
+            b = md5_step<20>(b, c, d ^ (a & (c ^ d)), w[md5_word(t+3)], t+3);
+          }
+          for(unsigned t = 32; t < 48; t += 4){
+            a = md5_step< 4>(a, b, b ^ c ^ d, w[md5_word(t)], t);
+            d = md5_step<11>(d, a, a ^ b ^ c, w[md5_word(t+1)], t+1);
+            c = md5_step<16>(c, d, d ^ a ^ b, w[md5_word(t+2)], t+2);
+            b = md5_step<23>(b, c, c ^ d ^ a, w[md5_word(t+3)], t+3);
+          }
+          for(unsigned t = 48; t < 64; t += 4){
+            a = md5_step< 6>(a, b, c ^ (b | ~d), w[md5_word(t)], t);
+            d = md5_step<10>(d, a, b ^ (a | ~c), w[md5_word(t+1)], t+1);
+            c = md5_step<15>(c, d, a ^ (d | ~b), w[md5_word(t+2)], t+2);
+            b = md5_step<21>(b, c, d ^ (c | ~a), w[md5_word(t+3)], t+3);
+          }
+          state[0] += a, state[1] += b, state[2] += c, state[3] += d;
+        }
+      }
+
+#ifdef NTL_CPU_SSE2
+      template<int S>
+      static inline __m128i md5_step4x(__m128i a, __m128i b, __m128i f, __m128i w, unsigned t)
+      {
+        using namespace intrinsic;
+        a = _mm_add_epi32(_mm_add_epi32(a, f), _mm_add_epi32(w, _mm_set1_epi32(static_cast<int>(md5_k[t]))));
+        return _mm_add_epi32(b, rotl4x<S>(a));
+      }
+
+      /// compresses one block of four messages, \p state is the A, B, C, D words of the lanes
+      static inline void md5_compress4x(uint32_t state[4][4], const uint8_t* const blocks[4])
+      {
+        using namespace intrinsic;
+        __m128i w[16];
+        for(unsigned i = 0; i < 16; i += 4){
+          for(unsigned j = 0; j < 4; j++)
+            w[i + j] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(blocks[j] + i * 4));
+          transpose4x4(w + i);
+        }
+        const __m128i ones = _mm_set1_epi32(-1);
+        const __m128i a0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(state[0])),
+                      b0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(state[1])),
+                      c0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(state[2])),
+                      d0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(state[3]));
+        __m128i a = a0, b = b0, c = c0, d = d0;
+        for(unsigned t = 0; t < 16; t += 4){
+          a = md5_step4x< 7>(a, b, _mm_xor_si128(d, _mm_and_si128(b, _mm_xor_si128(c, d))), w[md5_word(t)], t);
+          d = md5_step4x<12>(d, a, _mm_xor_si128(c, _mm_and_si128(a, _mm_xor_si128(b, c))), w[md5_word(t+1)], t+1);
+          c = md5_step4x<17>(c, d, _mm_xor_si128(b, _mm_and_si128(d, _mm_xor_si128(a, b))), w[md5_word(t+2)], t+2);
+          b = md5_step4x<22>(b, c, _mm_xor_si128(a, _mm_and_si128(c, _mm_xor_si128(d, a))), w[md5_word(t+3)], t+3);
+        }
+        for(unsigned t = 16; t < 32; t += 4){
+          a = md5_step4x< 5>(a, b, _mm_xor_si128(c, _mm_and_si128(d, _mm_xor_si128(b, c))), w[md5_word(t)], t);
+          d = md5_step4x< 9>(d, a, _mm_xor_si128(b, _mm_and_si128(c, _mm_xor_si128(a, b))), w[md5_word(t+1)], t+1);
+          c = md5_step4x<14>(c, d, _mm_xor_si128(a, _mm_and_si128(b, _mm_xor_si128(d, a))), w[md5_word(t+2)], t+2);
+          b = md5_step4x<20>(b, c, _mm_xor_si128(d, _mm_and_si128(a, _mm_xor_si128(c, d))), w[md5_word(t+3)], t+3);
+        }
+        for(unsigned t = 32; t < 48; t += 4){
+          a = md5_step4x< 4>(a, b, _mm_xor_si128(_mm_xor_si128(b, c), d), w[md5_word(t)], t);
+          d = md5_step4x<11>(d, a, _mm_xor_si128(_mm_xor_si128(a, b), c), w[md5_word(t+1)], t+1);
+          c = md5_step4x<16>(c, d, _mm_xor_si128(_mm_xor_si128(d, a), b), w[md5_word(t+2)], t+2);
+          b = md5_step4x<23>(b, c, _mm_xor_si128(_mm_xor_si128(c, d), a), w[md5_word(t+3)], t+3);
+        }
+        for(unsigned t = 48; t < 64; t += 4){
+          a = md5_step4x< 6>(a, b, _mm_xor_si128(c, _mm_or_si128(b, _mm_xor_si128(d, ones))), w[md5_word(t)], t);
+          d = md5_step4x<10>(d, a, _mm_xor_si128(b, _mm_or_si128(a, _mm_xor_si128(c, ones))), w[md5_word(t+1)], t+1);
+          c = md5_step4x<15>(c, d, _mm_xor_si128(a, _mm_or_si128(d, _mm_xor_si128(b, ones))), w[md5_word(t+2)], t+2);
+          b = md5_step4x<21>(b, c, _mm_xor_si128(d, _mm_or_si128(c, _mm_xor_si128(a, ones))), w[md5_word(t+3)], t+3);
+        }
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(state[0]), _mm_add_epi32(a, a0));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(state[1]), _mm_add_epi32(b, b0));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(state[2]), _mm_add_epi32(c, c0));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(state[3]), _mm_add_epi32(d, d0));
+      }
+#endif // NTL_CPU_SSE2
+
+#ifdef NTL_CPU_AVX2
+      template<int S>
+      NTL_CPU_TARGET("avx2")
+      static inline __m256i md5_step8x(__m256i a, __m256i b, __m256i f, __m256i w, unsigned t)
+      {
+        using namespace intrinsic;
+        a = _mm256_add_epi32(_mm256_add_epi32(a, f), _mm256_add_epi32(w, _mm256_set1_epi32(static_cast<int>(md5_k[t]))));
+        return _mm256_add_epi32(b, rotl8x<S>(a));
+      }
 
-      struct runtime
+      /// compresses one block of eight messages, \p state is the A, B, C, D words of the lanes
+      NTL_CPU_TARGET("avx2")
+      static inline void md5_compress8x(uint32_t state[4][8], const uint8_t* const blocks[8])
       {
-        MD5Init_t* init;
-        MD5Update_t* update;
-        MD5Final_t* final;
+        using namespace intrinsic;
+        __m256i w[16];
+        for(unsigned i = 0; i < 16; i += 8){
+          for(unsigned j = 0; j < 8; j++)
+            w[i + j] = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(blocks[j] + i * 4));
+          transpose8x8(w + i);
+        }
+        const __m256i ones = _mm256_set1_epi32(-1);
+        const __m256i a0 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(state[0])),
+                      b0 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(state[1])),
+                      c0 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(state[2])),
+                      d0 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(state[3]));
+        __m256i a = a0, b = b0, c = c0, d = d0;
+        for(unsigned t = 0; t < 16; t += 4){
+          a = md5_step8x< 7>(a, b, _mm256_xor_si256(d, _mm256_and_si256(b, _mm256_xor_si256(c, d))), w[md5_word(t)], t);
+          d = md5_step8x<12>(d, a, _mm256_xor_si256(c, _mm256_and_si256(a, _mm256_xor_si256(b, c))), w[md5_word(t+1)], t+1);
+          c = md5_step8x<17>(c, d, _mm256_xor_si256(b, _mm256_and_si256(d, _mm256_xor_si256(a, b))), w[md5_word(t+2)], t+2);
+          b = md5_step8x<22>(b, c, _mm256_xor_si256(a, _mm256_and_si256(c, _mm256_xor_si256(d, a))), w[md5_word(t+3)], t+3);
+        }
+        for(unsigned t = 16; t < 32; t += 4){
+          a = md5_step8x< 5>(a, b, _mm256_xor_si256(c, _mm256_and_si256(d, _mm256_xor_si256(b, c))), w[md5_word(t)], t);
+          d = md5_step8x< 9>(d, a, _mm256_xor_si256(b, _mm256_and_si256(c, _mm256_xor_si256(a, b))), w[md5_word(t+1)], t+1);
+          c = md5_step8x<14>(c, d, _mm256_xor_si256(a, _mm256_and_si256(b, _mm256_xor_si256(d, a))), w[md5_word(t+2)], t+2);
+          b = md5_step8x<20>(b, c, _mm256_xor_si256(d, _mm256_and_si256(a, _mm256_xor_si256(c, d))), w[md5_word(t+3)], t+3);
+        }
+        for(unsigned t = 32; t < 48; t += 4){
+          a = md5_step8x< 4>(a, b, _mm256_xor_si256(_mm256_xor_si256(b, c), d), w[md5_word(t)], t);
+          d = md5_step8x<11>(d, a, _mm256_xor_si256(_mm256_xor_si256(a, b), c), w[md5_word(t+1)], t+1);
+          c = md5_step8x<16>(c, d, _mm256_xor_si256(_mm256_xor_si256(d, a), b), w[md5_word(t+2)], t+2);
+          b = md5_step8x<23>(b, c, _mm256_xor_si256(_mm256_xor_si256(c, d), a), w[md5_word(t+3)], t+3);
+        }
+        for(unsigned t = 48; t < 64; t += 4){
+          a = md5_step8x< 6>(a, b, _mm256_xor_si256(c, _mm256_or_si256(b, _mm256_xor_si256(d, ones))), w[md5_word(t)], t);
+          d = md5_step8x<10>(d, a, _mm256_xor_si256(b, _mm256_or_si256(a, _mm256_xor_si256(c, ones))), w[md5_word(t+1)], t+1);
+          c = md5_step8x<15>(c, d, _mm256_xor_si256(a, _mm256_or_si256(d, _mm256_xor_si256(b, ones))), w[md5_word(t+2)], t+2);
+          b = md5_step8x<21>(b, c, _mm256_xor_si256(d, _mm256_or_si256(c, _mm256_xor_si256(a, ones))), w[md5_word(t+3)], t+3);
+        }
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(state[0]), _mm256_add_epi32(a, a0));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(state[1]), _mm256_add_epi32(b, b0));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(state[2]), _mm256_add_epi32(c, c0));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(state[3]), _mm256_add_epi32(d, d0));
+        _mm256_zeroupper();
+      }
+#endif // NTL_CPU_AVX2
+
+      /// pads the last \p tail bytes of the \p size bytes message, returns the number of the padded blocks
+      static inline unsigned md5_pad(uint8_t block[128], const uint8_t* tail, uint64_t size)
+      {
+        const unsigned n = static_cast<unsigned>(size % 64);
+        const unsigned blocks = n < 56 ? 1 : 2;
+        std::memcpy(block, tail, n);
+        block[n] = 0x80;
+        std::memset(block + n + 1, 0, blocks * 64 - 8 - n - 1);
+        for(unsigned i = 0; i < 8; i++)
+          block[blocks * 64 - 8 + i] = static_cast<uint8_t>((size << 3) >> (i * 8));
+        return blocks;
+      }
 
-        runtime()
+      /**
+       *  Hashes the messages in \c Lanes lanes of \p compress.
+       *  Every lane runs through the complete blocks of its message and then through the padded tail,
+       *  a finished lane takes the next message. When the messages are over, the lanes left are
+       *  finished one by one.
+       **/
+      template<unsigned Lanes>
+      static inline void md5_hash_lanes(void (*compress)(uint32_t state[4][Lanes], const uint8_t* const blocks[Lanes]),
+        const void* const messages[], const size_t sizes[], std::array<uint8_t, 16> out[], size_t count)
+      {
+        struct lane
         {
-          init = nullptr,
-            update = nullptr,
-            final = nullptr;
-
-          using namespace ntl::nt;
-          peb::find_dll f(&peb::instance());
-          const ntl::pe::image* ntdll = f("ntdll.dll");
-          if(!ntdll)
-            return;
-          init = ntdll->find_export<MD5Init_t*>("MD5Init");
-          update = ntdll->find_export<MD5Update_t*>("MD5Update");
-          final = ntdll->find_export<MD5Final_t*>("MD5Final");
-          if(!init){
-            // for xp x86
-            ntdll = f("advapi32.dll");
-            if(!ntdll)
-              return;
-            init = ntdll->find_export<MD5Init_t*>("MD5Init");
-            update = ntdll->find_export<MD5Update_t*>("MD5Update");
-            final = ntdll->find_export<MD5Final_t*>("MD5Final");
+          const uint8_t* p;
+          size_t blocks;        // complete blocks left
+          unsigned tail_blocks; // padded blocks left
+          unsigned tail_pos;
+          size_t index;
+          uint8_t tail[128];
+        } lanes[Lanes];
+
+        uint32_t state[4][Lanes];
+        const uint8_t* blocks[Lanes];
+        size_t next = 0;
+
+        for(unsigned j = 0; j < Lanes; j++)
+          lanes[j].index = count;
+
+        for(;;){
+          // feed the idle lanes
+          unsigned active = 0;
+          for(unsigned j = 0; j < Lanes; j++){
+            lane& l = lanes[j];
+            if(l.index == count && next != count){
+              l.index = next++;
+              l.p = reinterpret_cast<const uint8_t*>(messages[l.index]);
+              l.blocks = sizes[l.index] / 64;
+              l.tail_blocks = md5_pad(l.tail, l.p + l.blocks * 64, sizes[l.index]);
+              l.tail_pos = 0;
+              for(unsigned i = 0; i < 4; i++)
+                state[i][j] = md5_iv[i];
+            }
+            if(l.index != count)
+              ++active;
+          }
+          if(active == 0)
+            break;
+          if(next == count && active < Lanes){
+            // no more messages to fill the lanes
+            for(unsigned j = 0; j < Lanes; j++){
+              lane& l = lanes[j];
+              if(l.index == count)
+                continue;
+              uint32_t s[4] = { state[0][j], state[1][j], state[2][j], state[3][j] };
+              md5_compress(s, l.p, l.blocks);
+              md5_compress(s, l.tail + l.tail_pos * 64, l.tail_blocks - l.tail_pos);
+              std::memcpy(out[l.index].data(), s, sizeof(s));
+            }
+            break;
+          }
+
+          for(unsigned j = 0; j < Lanes; j++){
+            lane& l = lanes[j];
+            if(l.index == count)
+              blocks[j] = l.tail;   // idle, the result is dropped
+            else if(l.blocks)
+              blocks[j] = l.p;
+            else
+              blocks[j] = l.tail + l.tail_pos * 64;
+          }
+          compress(state, blocks);
+
+          for(unsigned j = 0; j < Lanes; j++){
+            lane& l = lanes[j];
+            if(l.index == count)
+              continue;
+            if(l.blocks){
+              l.p += 64, --l.blocks;
+            }else if(++l.tail_pos == l.tail_blocks){
+              const uint32_t s[4] = { state[0][j], state[1][j], state[2][j], state[3][j] };
+              std::memcpy(out[l.index].data(), s, sizeof(s));
+              l.index = count;
+            }
           }
         }
-      };
+      }
+    }
 
-      runtime* funcs;
+    class md5: md5_ctx
+    {
       bool finalized;
     public:
       enum { digest_size = 16 };
@@ -66,16 +327,27 @@ namespace ntl
       typedef std::array<uint8_t, digest_size> digest;
 
       md5()
-        :finalized(false)
       {
-        funcs = ntl::static_storage<runtime>::get_object();
-        funcs->init(this);
+        reset();
       }
 
       md5& operator()(const void* input, size_t size)
       {
         finalized = false;
-        funcs->update(this, input, static_cast<uint32_t>(size));
+        const uint8_t* p = reinterpret_cast<const uint8_t*>(input);
+        const unsigned used = (i[0] >> 3) & 63;
+        const uint64_t bits = (static_cast<uint64_t>(i[1]) << 32 | i[0]) + (static_cast<uint64_t>(size) << 3);
+        i[0] = static_cast<uint32_t>(bits), i[1] = static_cast<uint32_t>(bits >> 32);
+        if(used){
+          const size_t n = size < 64 - used ? size : 64 - used;
+          std::memcpy(in + used, p, n);
+          if(used + n < 64)
+            return *this;
+          __::md5_compress(buf, in, 1);
+          p += n, size -= n;
+        }
+        __::md5_compress(buf, p, size / 64);
+        std::memcpy(in, p + (size & ~size_t(63)), size % 64);
         return *this;
       }
 
@@ -87,7 +359,10 @@ namespace ntl
       const digest& final()
       {
         if(!finalized){
-          funcs->final(this);
+          uint8_t block[128];
+          const uint64_t size = (static_cast<uint64_t>(i[1]) << 32 | i[0]) >> 3;
+          __::md5_compress(buf, block, __::md5_pad(block, in, size));
+          std::memcpy(hash.data(), buf, sizeof(buf));
           finalized = true;
         }
         return hash;
@@ -95,9 +370,74 @@ namespace ntl
 
       md5& reset()
       {
-        funcs->init(this);
+        i[0] = i[1] = 0;
+        std::memcpy(buf, __::md5_iv, sizeof(buf));
+        finalized = false;
         return *this;
       }
+
+      /**
+       *  Hashes \p count independent messages into \p out.
+       *  The messages go through the SIMD lanes, which pays off for a lot of small messages.
+       **/
+      static void hash_many(const void* const messages[], const size_t sizes[], digest out[], size_t count)
+      {
+#ifdef NTL_CPU_AVX2
+        if(cpu::has(cpu::avx2))
+          return __::md5_hash_lanes<8>(__::md5_compress8x, messages, sizes, out, count);
+#endif
+#ifdef NTL_CPU_SSE2
+        __::md5_hash_lanes<4>(__::md5_compress4x, messages, sizes, out, count);
+#else
+        for(size_t n = 0; n < count; n++){
+          md5 m;
+          out[n] = m(messages[n], sizes[n]).final();
+        }
+#endif
+      }
+
+#ifdef NTL_TEST
+      /// @return 0 - Ok;
+      static inline const char* test__implementation()
+      {
+        // A.5 Test suite of RFC 1321
+        static const char* const msgs[] = {
+          "", "a", "abc", "message digest", "abcdefghijklmnopqrstuvwxyz",
+          "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789",
+          "12345678901234567890123456789012345678901234567890123456789012345678901234567890"
+        };
+        static const uint8_t etalons[][digest_size] = {
+          { 0xd4, 0x1d, 0x8c, 0xd9, 0x8f, 0x00, 0xb2, 0x04, 0xe9, 0x80, 0x09, 0x98, 0xec, 0xf8, 0x42, 0x7e },
+          { 0x0c, 0xc1, 0x75, 0xb9, 0xc0, 0xf1, 0xb6, 0xa8, 0x31, 0xc3, 0x99, 0xe2, 0x69, 0x77, 0x26, 0x61 },
+          { 0x90, 0x01, 0x50, 0x98, 0x3c, 0xd2, 0x4f, 0xb0, 0xd6, 0x96, 0x3f, 0x7d, 0x28, 0xe1, 0x7f, 0x72 },
+          { 0xf9, 0x6b, 0x69, 0x7d, 0x7c, 0xb7, 0x93, 0x8d, 0x52, 0x5a, 0x2f, 0x31, 0xaa, 0xf1, 0x61, 0xd0 },
+          { 0xc3, 0xfc, 0xd3, 0xd7, 0x61, 0x92, 0xe4, 0x00, 0x7d, 0xfb, 0x49, 0x6c, 0xca, 0x67, 0xe1, 0x3b },
+          { 0xd1, 0x74, 0xab, 0x98, 0xd2, 0x77, 0xd9, 0xf5, 0xa5, 0x61, 0x1c, 0x2c, 0x9f, 0x41, 0x9d, 0x9f },
+          { 0x57, 0xed, 0xf4, 0xa2, 0x2b, 0xe3, 0xc9, 0x55, 0xac, 0x49, 0xda, 0x2e, 0x21, 0x07, 0xb6, 0x7a }
+        };
+        const size_t count = sizeof(msgs) / sizeof(*msgs);
+        const void* messages[count];
+        size_t sizes[count];
+        digest many[count];
+        for(size_t n = 0; n < count; n++){
+          md5 m;
+          messages[n] = msgs[n], sizes[n] = std::strlen(msgs[n]);
+          if(std::memcmp(m(msgs[n], sizes[n]).final().data(), etalons[n], digest_size) != 0)
+            return "A.5 MD5 test suite";
+          // the same message by one byte
+          m.reset();
+          for(size_t k = 0; k < sizes[n]; k++)
+            m(msgs[n] + k, 1);
+          if(std::memcmp(m.final().data(), etalons[n], digest_size) != 0)
+            return "A.5 MD5 test suite, streamed";
+        }
+        hash_many(messages, sizes, many, count);
+        for(size_t n = 0; n < count; n++)
+          if(std::memcmp(many[n].data(), etalons[n], digest_size) != 0)
+            return "A.5 MD5 test suite, hash_many";
+        return 0;
+      }
+#endif
     };
 
     template<typename T>
@@ -109,7 +449,7 @@ namespace ntl
     {
       return m(str, std::strlen(str));
     }
-    
+
     inline md5& operator>>(md5& m, md5::digest& digest)
     {
       std::memcpy(&digest, &m.final(), m.digest_size);
@@ -3,7 +3,10 @@
  *  Secure Hash Algorithm as declared in FIPS PUB 180-2
  *  http://csrc.nist.gov/publications/fips/fips180-2/fips180-2.pdf
  *
- *  @note at the moment only SHA1 is implemented.
+ *  SHA-1, SHA-256 and SHA-512 with the streaming update()/finalize()
+ *  interface. SHA-1 and SHA-256 blocks are compressed by the SHA extensions
+ *  when ntl::cpu reports them; sha256::hash_many() hashes up to eight
+ *  independent messages at once in the AVX2 lanes.
  *
  ****************************************************************************
  */
@@ -13,6 +16,8 @@
 
 #include <stdint.h>
 #include <stdlib.hxx>
+#include "lanes.hxx"
+#include "../stlx/cstring.hxx"
 
 namespace ntl { namespace crypto
 {
@@ -22,7 +27,345 @@ namespace ntl { namespace crypto
 #pragma warning(disable:4710) // operator()(const block & m) & hash_tail not inlined
 #endif
 
-class sha1
+namespace __
+{
+  typedef uint8_t octet;
+
+  /// The message digest of \c Bits length, as the sequence of octets.
+  template<size_t Bits>
+  struct sha_digest
+  {
+      enum { size = Bits };
+
+      sha_digest() {}
+      explicit sha_digest(const octet (&d)[Bits/8]) { std::memcpy(_, d, sizeof(_)); }
+
+      const octet & operator [](int pos) const { return _[pos]; }
+
+    friend
+      bool operator ==(const sha_digest & d, const sha_digest & d2)
+        { return binary_equal(d, d2); }
+
+    friend
+      bool operator !=(const sha_digest & d, const sha_digest & d2)
+        { return ! (d == d2); }
+
+    private:
+      octet _[size/8];
+  };
+
+  /**
+   *  Message buffering and padding common to the SHA engines.
+   *
+   *  The \c Engine provides compress(blocks, count), which hashes the complete
+   *  blocks into its state, and the digest conversion of that state.
+   *  The message length is kept in bytes; \c LengthBytes is the size of
+   *  the bit length field in the last block (8 for SHA-1/256, 16 for SHA-512).
+   **/
+  template<class Engine, size_t BlockBytes, size_t LengthBytes>
+  class sha_stream
+  {
+    public:
+
+      /// hash the next part of the message
+      /// @note the size is in bytes, not bits.
+      void update(const void * const data, size_t bytes)
+      {
+        const octet * p = reinterpret_cast<const octet*>(data);
+        const size_t used = static_cast<size_t>(length % BlockBytes);
+        length += bytes;
+        if ( used )
+        {
+          const size_t n = bytes < BlockBytes - used ? bytes : BlockBytes - used;
+          std::memcpy(buffer + used, p, n);
+          if ( used + n < BlockBytes )
+            return;
+          engine().compress(buffer, 1);
+          p += n; bytes -= n;
+        }
+        if ( bytes >= BlockBytes )
+        {
+          engine().compress(p, bytes / BlockBytes);
+          p += bytes - bytes % BlockBytes;
+          bytes %= BlockBytes;
+        }
+        std::memcpy(buffer, p, bytes);
+      }
+
+      /// pad the message and hash the last blocks
+      /// @note call reset() before hashing the next message.
+      void pad()
+      {
+        size_t j = static_cast<size_t>(length % BlockBytes);
+        // add `1' bit and fill with `0'.
+        buffer[j++] = 0x80;
+        if ( j > BlockBytes - LengthBytes )
+        {
+          std::memset(buffer + j, 0, BlockBytes - j);
+          engine().compress(buffer, 1);
+          j = 0;
+        }
+        std::memset(buffer + j, 0, BlockBytes - sizeof(uint64_t) - j);
+        // add the bit length, its high part is only nonzero for SHA-512
+        if ( LengthBytes > sizeof(uint64_t) )
+          store(BlockBytes - 2 * sizeof(uint64_t), length >> 61);
+        store(BlockBytes - sizeof(uint64_t), length << 3);
+        engine().compress(buffer, 1);
+      }
+
+    protected:
+
+      uint64_t  length;
+      octet     buffer[BlockBytes];
+
+      sha_stream() : length(0) {}
+
+    private:
+
+      Engine & engine() { return *static_cast<Engine*>(this); }
+
+      void store(size_t pos, uint64_t v)
+      {
+        const uint64_t be = big_endian(v);
+        std::memcpy(buffer + pos, &be, sizeof(be));
+      }
+  };
+
+  /// the big endian word of the message, which is not aligned
+  template<typename T>
+  static inline T load_be(const octet * p)
+  {
+    T v;
+    std::memcpy(&v, p, sizeof(v));
+    return big_endian(v);
+  }
+
+  static const uint32_t sha256_k[64] = {
+    0x428A2F98, 0x71374491, 0xB5C0FBCF, 0xE9B5DBA5, 0x3956C25B, 0x59F111F1, 0x923F82A4, 0xAB1C5ED5,
+    0xD807AA98, 0x12835B01, 0x243185BE, 0x550C7DC3, 0x72BE5D74, 0x80DEB1FE, 0x9BDC06A7, 0xC19BF174,
+    0xE49B69C1, 0xEFBE4786, 0x0FC19DC6, 0x240CA1CC, 0x2DE92C6F, 0x4A7484AA, 0x5CB0A9DC, 0x76F988DA,
+    0x983E5152, 0xA831C66D, 0xB00327C8, 0xBF597FC7, 0xC6E00BF3, 0xD5A79147, 0x06CA6351, 0x14292967,
+    0x27B70A85, 0x2E1B2138, 0x4D2C6DFC, 0x53380D13, 0x650A7354, 0x766A0ABB, 0x81C2C92E, 0x92722C85,
+    0xA2BFE8A1, 0xA81A664B, 0xC24B8B70, 0xC76C51A3, 0xD192E819, 0xD6990624, 0xF40E3585, 0x106AA070,
+    0x19A4C116, 0x1E376C08, 0x2748774C, 0x34B0BCB5, 0x391C0CB3, 0x4ED8AA4A, 0x5B9CCA4F, 0x682E6FF3,
+    0x748F82EE, 0x78A5636F, 0x84C87814, 0x8CC70208, 0x90BEFFFA, 0xA4506CEB, 0xBEF9A3F7, 0xC67178F2
+  };
+
+  static const uint64_t sha512_k[80] = {
+    0x428A2F98D728AE22ULL, 0x7137449123EF65CDULL, 0xB5C0FBCFEC4D3B2FULL, 0xE9B5DBA58189DBBCULL,
+    0x3956C25BF348B538ULL, 0x59F111F1B605D019ULL, 0x923F82A4AF194F9BULL, 0xAB1C5ED5DA6D8118ULL,
+    0xD807AA98A3030242ULL, 0x12835B0145706FBEULL, 0x243185BE4EE4B28CULL, 0x550C7DC3D5FFB4E2ULL,
+    0x72BE5D74F27B896FULL, 0x80DEB1FE3B1696B1ULL, 0x9BDC06A725C71235ULL, 0xC19BF174CF692694ULL,
+    0xE49B69C19EF14AD2ULL, 0xEFBE4786384F25E3ULL, 0x0FC19DC68B8CD5B5ULL, 0x240CA1CC77AC9C65ULL,
+    0x2DE92C6F592B0275ULL, 0x4A7484AA6EA6E483ULL, 0x5CB0A9DCBD41FBD4ULL, 0x76F988DA831153B5ULL,
+    0x983E5152EE66DFABULL, 0xA831C66D2DB43210ULL, 0xB00327C898FB213FULL, 0xBF597FC7BEEF0EE4ULL,
+    0xC6E00BF33DA88FC2ULL, 0xD5A79147930AA725ULL, 0x06CA6351E003826FULL, 0x142929670A0E6E70ULL,
+    0x27B70A8546D22FFCULL, 0x2E1B21385C26C926ULL, 0x4D2C6DFC5AC42AEDULL, 0x53380D139D95B3DFULL,
+    0x650A73548BAF63DEULL, 0x766A0ABB3C77B2A8ULL, 0x81C2C92E47EDAEE6ULL, 0x92722C851482353BULL,
+    0xA2BFE8A14CF10364ULL, 0xA81A664BBC423001ULL, 0xC24B8B70D0F89791ULL, 0xC76C51A30654BE30ULL,
+    0xD192E819D6EF5218ULL, 0xD69906245565A910ULL, 0xF40E35855771202AULL, 0x106AA07032BBD1B8ULL,
+    0x19A4C116B8D2D0C8ULL, 0x1E376C085141AB53ULL, 0x2748774CDF8EEB99ULL, 0x34B0BCB5E19B48A8ULL,
+    0x391C0CB3C5C95A63ULL, 0x4ED8AA4AE3418ACBULL, 0x5B9CCA4F7763E373ULL, 0x682E6FF3D6B2B8A3ULL,
+    0x748F82EE5DEFB2FCULL, 0x78A5636F43172F60ULL, 0x84C87814A1F0AB72ULL, 0x8CC702081A6439ECULL,
+    0x90BEFFFA23631E28ULL, 0xA4506CEBDE82BDE9ULL, 0xBEF9A3F7B2C67915ULL, 0xC67178F2E372532BULL,
+    0xCA273ECEEA26619CULL, 0xD186B8C721C0C207ULL, 0xEADA7DD6CDE0EB1EULL, 0xF57D4F7FEE6ED178ULL,
+    0x06F067AA72176FBAULL, 0x0A637DC5A2C898A6ULL, 0x113F9804BEF90DAEULL, 0x1B710B35131C471BULL,
+    0x28DB77F523047D84ULL, 0x32CAAB7B40C72493ULL, 0x3C9EBE0A15C9BEBCULL, 0x431D67C49C100D4CULL,
+    0x4CC5D4BECB3E42B6ULL, 0x597F299CFC657E2AULL, 0x5FCB6FAB3AD6FAECULL, 0x6C44198C4A475817ULL
+  };
+
+#ifdef NTL_CPU_SHA
+
+  /// the SHA extensions are used together with SSSE3 and SSE4.1
+  static inline bool has_sha_extensions()
+  {
+    const unsigned required = cpu::sha | cpu::ssse3 | cpu::sse41;
+    return (cpu::features() & required) == required;
+  }
+
+  NTL_CPU_TARGET("sha,sse4.1,ssse3")
+  static inline __m128i load_be(const octet * p, __m128i mask)
+  {
+    using namespace intrinsic;
+    return _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p)), mask);
+  }
+
+  template<int F>
+  NTL_CPU_TARGET("sha,sse4.1,ssse3")
+  static inline void sha1_quad(__m128i & abcd, __m128i & prev, __m128i w)
+  {
+    using namespace intrinsic;
+    const __m128i e = _mm_sha1nexte_epu32(prev, w);
+    prev = abcd;
+    abcd = _mm_sha1rnds4_epu32(abcd, e, F);
+  }
+
+  /// the next four words of the SHA-1 message schedule
+  NTL_CPU_TARGET("sha,sse4.1,ssse3")
+  static inline __m128i sha1_schedule(__m128i w[4], unsigned g)
+  {
+    using namespace intrinsic;
+    const __m128i next = _mm_sha1msg2_epu32(_mm_xor_si128(_mm_sha1msg1_epu32(w[g & 3], w[(g + 1) & 3]),
+                                                          w[(g + 2) & 3]), w[(g + 3) & 3]);
+    w[g & 3] = next;
+    return next;
+  }
+
+  NTL_CPU_TARGET("sha,sse4.1,ssse3")
+  static inline void sha1_compress_ni(uint32_t state[5], const octet * p, size_t blocks)
+  {
+    using namespace intrinsic;
+    static const uint64_t bswap[2] = { 0x08090a0b0c0d0e0fULL, 0x0001020304050607ULL };
+    const __m128i mask = _mm_loadu_si128(reinterpret_cast<const __m128i*>(bswap));
+    // lanes hold D C B A and the E in the highest lane
+    __m128i abcd = _mm_shuffle_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(state)), 0x1B);
+    __m128i e0 = _mm_shuffle_epi32(_mm_cvtsi32_si128(static_cast<int>(state[4])), 0x3F);
+    for ( ; blocks; --blocks, p += 64 )
+    {
+      const __m128i abcd_save = abcd, e0_save = e0;
+      __m128i w[4];
+      for ( unsigned i = 0; i < 4; ++i )
+        w[i] = load_be(p + i * 16, mask);
+
+      __m128i prev = abcd;
+      abcd = _mm_sha1rnds4_epu32(abcd, _mm_add_epi32(e0, w[0]), 0);
+      sha1_quad<0>(abcd, prev, w[1]);
+      sha1_quad<0>(abcd, prev, w[2]);
+      sha1_quad<0>(abcd, prev, w[3]);
+      sha1_quad<0>(abcd, prev, sha1_schedule(w, 4));
+      for ( unsigned g = 5; g < 10; ++g )
+        sha1_quad<1>(abcd, prev, sha1_schedule(w, g));
+      for ( unsigned g = 10; g < 15; ++g )
+        sha1_quad<2>(abcd, prev, sha1_schedule(w, g));
+      for ( unsigned g = 15; g < 20; ++g )
+        sha1_quad<3>(abcd, prev, sha1_schedule(w, g));
+
+      e0 = _mm_sha1nexte_epu32(prev, e0_save);
+      abcd = _mm_add_epi32(abcd, abcd_save);
+    }
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(state), _mm_shuffle_epi32(abcd, 0x1B));
+    state[4] = static_cast<uint32_t>(_mm_cvtsi128_si32(_mm_shuffle_epi32(e0, 0x03)));
+  }
+
+  /// four rounds of SHA-256 on the message words \p w
+  NTL_CPU_TARGET("sha,sse4.1,ssse3")
+  static inline void sha256_quad(__m128i & abef, __m128i & cdgh, __m128i w, const uint32_t * k)
+  {
+    using namespace intrinsic;
+    const __m128i m = _mm_add_epi32(w, _mm_loadu_si128(reinterpret_cast<const __m128i*>(k)));
+    cdgh = _mm_sha256rnds2_epu32(cdgh, abef, m);
+    abef = _mm_sha256rnds2_epu32(abef, cdgh, _mm_shuffle_epi32(m, 0x0E));
+  }
+
+  NTL_CPU_TARGET("sha,sse4.1,ssse3")
+  static inline void sha256_compress_ni(uint32_t state[8], const octet * p, size_t blocks)
+  {
+    using namespace intrinsic;
+    static const uint64_t bswap[2] = { 0x0405060700010203ULL, 0x0c0d0e0f08090a0bULL };
+    const __m128i mask = _mm_loadu_si128(reinterpret_cast<const __m128i*>(bswap));
+    // the rounds instruction takes the state as ABEF and CDGH
+    const __m128i cdab = _mm_shuffle_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(state)), 0xB1);
+    const __m128i efgh = _mm_shuffle_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(state + 4)), 0x1B);
+    __m128i abef = _mm_alignr_epi8(cdab, efgh, 8);
+    __m128i cdgh = _mm_blend_epi16(efgh, cdab, 0xF0);
+    for ( ; blocks; --blocks, p += 64 )
+    {
+      const __m128i abef_save = abef, cdgh_save = cdgh;
+      __m128i w0 = load_be(p, mask), w1 = load_be(p + 16, mask),
+              w2 = load_be(p + 32, mask), w3 = load_be(p + 48, mask);
+      for ( unsigned i = 0; i < 64; i += 16 )
+      {
+        if ( i )
+        {
+          w0 = _mm_sha256msg2_epu32(_mm_add_epi32(_mm_sha256msg1_epu32(w0, w1), _mm_alignr_epi8(w3, w2, 4)), w3);
+          w1 = _mm_sha256msg2_epu32(_mm_add_epi32(_mm_sha256msg1_epu32(w1, w2), _mm_alignr_epi8(w0, w3, 4)), w0);
+          w2 = _mm_sha256msg2_epu32(_mm_add_epi32(_mm_sha256msg1_epu32(w2, w3), _mm_alignr_epi8(w1, w0, 4)), w1);
+          w3 = _mm_sha256msg2_epu32(_mm_add_epi32(_mm_sha256msg1_epu32(w3, w0), _mm_alignr_epi8(w2, w1, 4)), w2);
+        }
+        sha256_quad(abef, cdgh, w0, sha256_k + i);
+        sha256_quad(abef, cdgh, w1, sha256_k + i + 4);
+        sha256_quad(abef, cdgh, w2, sha256_k + i + 8);
+        sha256_quad(abef, cdgh, w3, sha256_k + i + 12);
+      }
+      abef = _mm_add_epi32(abef, abef_save);
+      cdgh = _mm_add_epi32(cdgh, cdgh_save);
+    }
+    const __m128i feba = _mm_shuffle_epi32(abef, 0x1B);
+    const __m128i dchg = _mm_shuffle_epi32(cdgh, 0xB1);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(state), _mm_blend_epi16(feba, dchg, 0xF0));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(state + 4), _mm_alignr_epi8(dchg, feba, 8));
+  }
+
+#endif // NTL_CPU_SHA
+
+#ifdef NTL_CPU_AVX2
+
+  /**
+   *  Compresses \p blocks of eight messages at once, lane \c i holds the message \c i.
+   *  The \p state is the eight big endian SHA-256 states and it is updated in place.
+   **/
+  NTL_CPU_TARGET("avx2")
+  static inline void sha256_compress_x8(uint32_t state[8][8], const octet * const messages[8], size_t blocks)
+  {
+    using namespace intrinsic;
+    static const uint64_t bswap[4] = { 0x0405060700010203ULL, 0x0c0d0e0f08090a0bULL,
+                                       0x0405060700010203ULL, 0x0c0d0e0f08090a0bULL };
+    const __m256i mask = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(bswap));
+    __m256i s[8];
+    for ( unsigned i = 0; i < 8; ++i )
+      s[i] = _mm256_shuffle_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(state[i])), mask);
+    transpose8x8(s);
+
+    for ( size_t b = 0; b < blocks; ++b )
+    {
+      __m256i w[16];
+      for ( unsigned half = 0; half < 16; half += 8 )
+      {
+        for ( unsigned i = 0; i < 8; ++i )
+          w[half + i] = _mm256_shuffle_epi8(
+            _mm256_loadu_si256(reinterpret_cast<const __m256i*>(messages[i] + b * 64 + half * 4)), mask);
+        transpose8x8(w + half);
+      }
+      __m256i a = s[0], bb = s[1], c = s[2], d = s[3], e = s[4], f = s[5], g = s[6], h = s[7];
+      for ( unsigned t = 0; t < 64; ++t )
+      {
+        __m256i wt;
+        if ( t < 16 )
+          wt = w[t];
+        else
+        {
+          const __m256i w15 = w[(t - 15) & 15], w2 = w[(t - 2) & 15];
+          const __m256i s0 = _mm256_xor_si256(_mm256_xor_si256(rotr8x<7>(w15), rotr8x<18>(w15)), _mm256_srli_epi32(w15, 3));
+          const __m256i s1 = _mm256_xor_si256(_mm256_xor_si256(rotr8x<17>(w2), rotr8x<19>(w2)), _mm256_srli_epi32(w2, 10));
+          wt = w[t & 15] = _mm256_add_epi32(_mm256_add_epi32(w[t & 15], s0), _mm256_add_epi32(w[(t - 7) & 15], s1));
+        }
+        const __m256i sum1 = _mm256_xor_si256(_mm256_xor_si256(rotr8x<6>(e), rotr8x<11>(e)), rotr8x<25>(e));
+        const __m256i ch = _mm256_xor_si256(_mm256_and_si256(e, f), _mm256_andnot_si256(e, g));
+        const __m256i t1 = _mm256_add_epi32(_mm256_add_epi32(_mm256_add_epi32(h, sum1), _mm256_add_epi32(ch, wt)),
+                                            _mm256_set1_epi32(static_cast<int>(sha256_k[t])));
+        const __m256i sum0 = _mm256_xor_si256(_mm256_xor_si256(rotr8x<2>(a), rotr8x<13>(a)), rotr8x<22>(a));
+        const __m256i maj = _mm256_or_si256(_mm256_and_si256(a, bb), _mm256_and_si256(c, _mm256_or_si256(a, bb)));
+        h = g; g = f; f = e; e = _mm256_add_epi32(d, t1);
+        d = c; c = bb; bb = a; a = _mm256_add_epi32(t1, _mm256_add_epi32(sum0, maj));
+      }
+      s[0] = _mm256_add_epi32(s[0], a);  s[1] = _mm256_add_epi32(s[1], bb);
+      s[2] = _mm256_add_epi32(s[2], c);  s[3] = _mm256_add_epi32(s[3], d);
+      s[4] = _mm256_add_epi32(s[4], e);  s[5] = _mm256_add_epi32(s[5], f);
+      s[6] = _mm256_add_epi32(s[6], g);  s[7] = _mm256_add_epi32(s[7], h);
+    }
+
+    transpose8x8(s);
+    for ( unsigned i = 0; i < 8; ++i )
+      _mm256_storeu_si256(reinterpret_cast<__m256i*>(state[i]), _mm256_shuffle_epi8(s[i], mask));
+    _mm256_zeroupper();
+  }
+
+#endif // NTL_CPU_AVX2
+
+}//namespace __
+
+class sha1:
+  public __::sha_stream<sha1, 64, sizeof(uint64_t)>
 {
   ///////////////////////////////////////////////////////////////////////////
   public:
@@ -73,70 +416,55 @@ class sha1
     /// @note the size is in bytes, not bits.
     const digest & operator()(const void * const message, const size_t bytes)
     {
-      hash_complete_blocks(message, bytes);
-      return hash_tail(message, bytes);
+      length = 0;
+      update(message, bytes);
+      return finalize();
     }
 
     /// hash one block
     const digest & operator()(const block & m)
     {
-      const uint32_t * w0 = reinterpret_cast<const uint32_t*>(&m[0]);
-      uint32_t w[80];
-      uint32_t a = big_endian(h[0]);  uint32_t b = big_endian(h[1]);
-      uint32_t c = big_endian(h[2]);  uint32_t d = big_endian(h[3]);
-      uint32_t e = big_endian(h[4]);  unsigned t = 0;
-      do
-      {
-        w[t] = big_endian(w0[t]);
-        // it's Ok to use 0 instead of t in f() and k() because t < 20 here
-        const uint32_t temp = rotl(a, 5) + f(0, b, c, d) + e + w[t] - k(0);
-        e = d;  d = c;  c = rotr(b, 2); b = a;  a = temp;
-      }
-      while ( ++t < 16 );
-      do
-      {
-        w[t] = rotl(w[t-3] ^ w[t-8] ^ w[t-14] ^ w[t-16], 1);
-        const uint32_t temp = rotl(a, 5) + f(t, b, c, d) + e + w[t] - k(t);
-        e = d;  d = c;  c = rotr(b, 2); b = a;  a = temp;
-      }
-      while ( ++t < 80 );
-      h[0] = big_endian(big_endian(h[0]) + a);
-      h[1] = big_endian(big_endian(h[1]) + b);
-      h[2] = big_endian(big_endian(h[2]) + c);
-      h[3] = big_endian(big_endian(h[3]) + d);
-      h[4] = big_endian(big_endian(h[4]) + e);
+      compress(m, 1);
       return *this;
     }
 
     void hash_complete_blocks(const void * const message, size_t bytes)
     {
-      const block * pm = reinterpret_cast<const block*>(message);
-      const size_t ready_blocks = bytes / block_bytes;
-      for ( size_t i = 0; i < ready_blocks; ++i )
-        operator()(*pm++);
+      compress(message, bytes / block_bytes);
     }
 
     const digest & hash_tail(const void * const message, const size_t bytes)
     {
-      const block * const pm = reinterpret_cast<const block*>(message);
-      // copy the message tail
-      const octet * tail = reinterpret_cast<const octet*>(&pm[bytes/block_bytes]);
-      block _b[2]; octet * pad = reinterpret_cast<octet*>(_b);
-      unsigned j = 0;
-      for ( ; j < bytes % block_bytes; ++j )
-        pad[j] = tail[j];
-      // add `1' bit and fill with `0'.
-      pad[j++] = 0x80;
-      while ( (j % block_bytes) != block_bytes - sizeof(uint64_t) )
-        pad[j++] = 0x00;
-      // add 64 bit size and do hash
-      *reinterpret_cast<uint64_t*>(&pad[j]) =
-                                  big_endian(static_cast<uint64_t>(bytes) * 8);
-      operator()(_b[0]);
-      if ( j > block_bytes )  operator()(_b[1]);
+      const size_t tail = bytes % block_bytes;
+      length = bytes - tail;
+      update(reinterpret_cast<const octet*>(message) + length, tail);
+      return finalize();
+    }
+
+    /// pad the message passed to update() and return its digest
+    const digest & finalize()
+    {
+      pad();
       return *this;
     }
 
+    /// hash the complete blocks of the message
+    void compress(const void * const blocks, size_t count)
+    {
+      uint32_t state[5];
+      for ( unsigned i = 0; i < 5; ++i )
+        state[i] = big_endian(h[i]);
+      const octet * const p = reinterpret_cast<const octet*>(blocks);
+#ifdef NTL_CPU_SHA
+      if ( __::has_sha_extensions() )
+        __::sha1_compress_ni(state, p, count);
+      else
+#endif
+        compress_blocks(state, p, count);
+      for ( unsigned i = 0; i < 5; ++i )
+        h[i] = big_endian(state[i]);
+    }
+
     void inline reset()
     {
       //set_state(digest());
@@ -145,6 +473,7 @@ class sha1
                           0x98, 0xBA, 0xDC, 0xFE,   //h2 = 0x98BADCFE;
                           0x10, 0x32, 0x54, 0x76,   //h3 = 0x10325476;
                           0xC3, 0xD2, 0xE1, 0xF0 ); //h4 = 0xC3D2E1F0;
+      length = 0;
     }
 
     void inline set_state(const digest & state)
@@ -152,6 +481,35 @@ class sha1
       new (&h[0]) digest(state);
     }
 
+    /// the portable compression function
+    static void compress_blocks(uint32_t state[5], const octet * p, size_t count)
+    {
+      for ( ; count; --count, p += block_bytes )
+      {
+        uint32_t w[80];
+        uint32_t a = state[0];  uint32_t b = state[1];
+        uint32_t c = state[2];  uint32_t d = state[3];
+        uint32_t e = state[4];  unsigned t = 0;
+        do
+        {
+          w[t] = __::load_be<uint32_t>(p + t * 4);
+          // it's Ok to use 0 instead of t in f() and k() because t < 20 here
+          const uint32_t temp = rotl(a, 5) + f(0, b, c, d) + e + w[t] - k(0);
+          e = d;  d = c;  c = rotr(b, 2); b = a;  a = temp;
+        }
+        while ( ++t < 16 );
+        do
+        {
+          w[t] = rotl(w[t-3] ^ w[t-8] ^ w[t-14] ^ w[t-16], 1);
+          const uint32_t temp = rotl(a, 5) + f(t, b, c, d) + e + w[t] - k(t);
+          e = d;  d = c;  c = rotr(b, 2); b = a;  a = temp;
+        }
+        while ( ++t < 80 );
+        state[0] += a;  state[1] += b;  state[2] += c;
+        state[3] += d;  state[4] += e;
+      }
+    }
+
 #ifdef NTL_TEST
     /// @return 0 - Ok;
     static inline
@@ -177,6 +535,12 @@ class sha1
         sha1 hash;
         if ( hash(msg, 448 / 8) != etalon )
           return "A.2 SHA-1 Example (Multi-Block Message)";
+        // the same message in the parts of different size
+        hash.reset();
+        for ( unsigned i = 0, n = 1; i < 448 / 8; i += n, ++n )
+          hash.update(msg + i, i + n < 448 / 8 ? n : 448 / 8 - i);
+        if ( hash.finalize() != etalon )
+          return "A.2 SHA-1 Example (Multi-Block Message, streamed)";
       }
       //  A.3 SHA-1 Example (Long Message)
       {
@@ -190,6 +554,15 @@ class sha1
         sha1 hash;
         if ( hash(msg, sizeof(msg)) != etalon )
           return "A.3 SHA-1 Example (Long Message)";
+
+        // the portable code against the dispatched one
+        uint32_t state[5] = { 0x67452301, 0xEFCDAB89, 0x98BADCFE, 0x10325476, 0xC3D2E1F0 };
+        compress_blocks(state, reinterpret_cast<const octet*>(msg), sizeof(msg) / block_bytes);
+        hash.reset();
+        hash.hash_complete_blocks(msg, sizeof(msg));
+        for ( unsigned i = 0; i < 5; ++i )
+          if ( big_endian(state[i]) != hash.h[i] )
+            return "SHA-1 compression functions mismatch";
       }
       return 0;
     }
@@ -221,6 +594,384 @@ class sha1
 
 };// class sha1
 
+
+class sha256:
+  public __::sha_stream<sha256, 64, sizeof(uint64_t)>
+{
+  ///////////////////////////////////////////////////////////////////////////
+  public:
+
+    typedef uint8_t  octet;
+
+    enum { block_size = 512, block_bytes = block_size/8 };
+    typedef octet block[block_bytes];
+
+    typedef __::sha_digest<256> digest;
+
+    sha256() { reset(); }
+
+    operator const digest&() const { return *reinterpret_cast<const digest*>(&h[0]); }
+
+    /// hash message
+    /// @note the size is in bytes, not bits.
+    const digest & operator()(const void * const message, const size_t bytes)
+    {
+      length = 0;
+      update(message, bytes);
+      return finalize();
+    }
+
+    /// pad the message passed to update() and return its digest
+    const digest & finalize()
+    {
+      pad();
+      return *this;
+    }
+
+    /// hash the complete blocks of the message
+    void compress(const void * const blocks, size_t count)
+    {
+      uint32_t state[8];
+      for ( unsigned i = 0; i < 8; ++i )
+        state[i] = big_endian(h[i]);
+      const octet * const p = reinterpret_cast<const octet*>(blocks);
+#ifdef NTL_CPU_SHA
+      if ( __::has_sha_extensions() )
+        __::sha256_compress_ni(state, p, count);
+      else
+#endif
+        compress_blocks(state, p, count);
+      for ( unsigned i = 0; i < 8; ++i )
+        h[i] = big_endian(state[i]);
+    }
+
+    void reset()
+    {
+      static const uint32_t initial[8] = {
+        0x6A09E667, 0xBB67AE85, 0x3C6EF372, 0xA54FF53A, 0x510E527F, 0x9B05688C, 0x1F83D9AB, 0x5BE0CD19
+      };
+      for ( unsigned i = 0; i < 8; ++i )
+        h[i] = big_endian(initial[i]);
+      length = 0;
+    }
+
+    void set_state(const digest & state)
+    {
+      std::memcpy(h, &state, sizeof(h));
+    }
+
+    /**
+     *  Hashes \p count independent messages.
+     *  Without the SHA extensions the common complete blocks of every eight
+     *  messages are compressed together in the AVX2 lanes.
+     **/
+    static void hash_many(const void * const messages[], const size_t sizes[], digest out[], size_t count)
+    {
+      size_t i = 0;
+#ifdef NTL_CPU_AVX2
+      if ( use_lanes() )
+      {
+        for ( ; count - i >= 8; i += 8 )
+        {
+          size_t blocks = sizes[i] / block_bytes;
+          for ( unsigned j = 1; j < 8; ++j )
+            if ( sizes[i + j] / block_bytes < blocks )
+              blocks = sizes[i + j] / block_bytes;
+          sha256 lane[8];
+          if ( blocks )
+          {
+            uint32_t state[8][8];
+            for ( unsigned j = 0; j < 8; ++j )
+              std::memcpy(state[j], lane[j].h, sizeof(state[j]));
+            __::sha256_compress_x8(state, reinterpret_cast<const octet* const*>(messages + i), blocks);
+            for ( unsigned j = 0; j < 8; ++j )
+              std::memcpy(lane[j].h, state[j], sizeof(state[j]));
+          }
+          // the tails are finished one by one
+          const size_t done = blocks * block_bytes;
+          for ( unsigned j = 0; j < 8; ++j )
+          {
+            lane[j].length = done;
+            lane[j].update(reinterpret_cast<const octet*>(messages[i + j]) + done, sizes[i + j] - done);
+            out[i + j] = lane[j].finalize();
+          }
+        }
+      }
+#endif
+      for ( ; i < count; ++i )
+      {
+        sha256 hash;
+        out[i] = hash(messages[i], sizes[i]);
+      }
+    }
+
+    /// the portable compression function
+    static void compress_blocks(uint32_t state[8], const octet * p, size_t count)
+    {
+      for ( ; count; --count, p += block_bytes )
+      {
+        uint32_t w[64];
+        for ( unsigned t = 0; t < 16; ++t )
+          w[t] = __::load_be<uint32_t>(p + t * 4);
+        for ( unsigned t = 16; t < 64; ++t )
+          w[t] = sigma1(w[t-2]) + w[t-7] + sigma0(w[t-15]) + w[t-16];
+        uint32_t a = state[0], b = state[1], c = state[2], d = state[3],
+                 e = state[4], f = state[5], g = state[6], hh = state[7];
+        for ( unsigned t = 0; t < 64; ++t )
+        {
+          const uint32_t t1 = hh + (rotr(e, 6) ^ rotr(e, 11) ^ rotr(e, 25)) + ((e & f) ^ (~e & g)) + __::sha256_k[t] + w[t];
+          const uint32_t t2 = (rotr(a, 2) ^ rotr(a, 13) ^ rotr(a, 22)) + ((a & b) | (c & (a | b)));
+          hh = g; g = f; f = e; e = d + t1;
+          d = c; c = b; b = a; a = t1 + t2;
+        }
+        state[0] += a;  state[1] += b;  state[2] += c;  state[3] += d;
+        state[4] += e;  state[5] += f;  state[6] += g;  state[7] += hh;
+      }
+    }
+
+#ifdef NTL_TEST
+    /// @return 0 - Ok;
+    static inline
+    const char * test__implementation()
+    {
+      //  B.1 SHA-256 Example (One-Block Message)
+      {
+        static char msg[3] = { 'a', 'b', 'c' };
+        static const octet etalon[32] = {
+          0xba, 0x78, 0x16, 0xbf, 0x8f, 0x01, 0xcf, 0xea, 0x41, 0x41, 0x40, 0xde, 0x5d, 0xae, 0x22, 0x23,
+          0xb0, 0x03, 0x61, 0xa3, 0x96, 0x17, 0x7a, 0x9c, 0xb4, 0x10, 0xff, 0x61, 0xf2, 0x00, 0x15, 0xad };
+        sha256 hash;
+        if ( digest(etalon) != hash(msg, sizeof(msg)) )
+          return "B.1 SHA-256 Example (One-Block Message)";
+      }
+      //  B.2 SHA-256 Example (Multi-Block Message)
+      {
+        static char msg[] = "abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq";
+        static const octet etalon[32] = {
+          0x24, 0x8d, 0x6a, 0x61, 0xd2, 0x06, 0x38, 0xb8, 0xe5, 0xc0, 0x26, 0x93, 0x0c, 0x3e, 0x60, 0x39,
+          0xa3, 0x3c, 0xe4, 0x59, 0x64, 0xff, 0x21, 0x67, 0xf6, 0xec, 0xed, 0xd4, 0x19, 0xdb, 0x06, 0xc1 };
+        sha256 hash;
+        if ( hash(msg, 448 / 8) != digest(etalon) )
+          return "B.2 SHA-256 Example (Multi-Block Message)";
+        hash.reset();
+        for ( unsigned i = 0, n = 1; i < 448 / 8; i += n, ++n )
+          hash.update(msg + i, i + n < 448 / 8 ? n : 448 / 8 - i);
+        if ( hash.finalize() != digest(etalon) )
+          return "B.2 SHA-256 Example (Multi-Block Message, streamed)";
+      }
+      //  B.3 SHA-256 Example (Long Message)
+      {
+        static char msg[1000000];
+        for ( unsigned i = 0; i < sizeof(msg); ++i )
+          msg[i] = 'a';
+        static const octet etalon[32] = {
+          0xcd, 0xc7, 0x6e, 0x5c, 0x99, 0x14, 0xfb, 0x92, 0x81, 0xa1, 0xc7, 0xe2, 0x84, 0xd7, 0x3e, 0x67,
+          0xf1, 0x80, 0x9a, 0x48, 0xa4, 0x97, 0x20, 0x0e, 0x04, 0x6d, 0x39, 0xcc, 0xc7, 0x11, 0x2c, 0xd0 };
+        sha256 hash;
+        if ( hash(msg, sizeof(msg)) != digest(etalon) )
+          return "B.3 SHA-256 Example (Long Message)";
+
+        // the portable code against the dispatched one
+        uint32_t state[8];
+        hash.reset();
+        for ( unsigned i = 0; i < 8; ++i )
+          state[i] = big_endian(hash.h[i]);
+        compress_blocks(state, reinterpret_cast<const octet*>(msg), 100);
+        hash.compress(msg, 100);
+        for ( unsigned i = 0; i < 8; ++i )
+          if ( big_endian(state[i]) != hash.h[i] )
+            return "SHA-256 compression functions mismatch";
+
+        // the messages of different length hashed together
+        const void * messages[19];
+        size_t sizes[19];
+        digest many[19];
+        for ( unsigned i = 0; i < 19; ++i )
+        {
+          messages[i] = msg + i;
+          sizes[i] = i * 97 + (i & 1) * 1000;
+        }
+        hash_many(messages, sizes, many, 19);
+        for ( unsigned i = 0; i < 19; ++i )
+        {
+          sha256 one;
+          if ( many[i] != one(messages[i], sizes[i]) )
+            return "SHA-256 hash_many";
+        }
+      }
+      return 0;
+    }
+#endif//#ifdef NTL_TEST
+
+  ///////////////////////////////////////////////////////////////////////////
+  private:
+
+    uint32_t h[8];
+
+    static inline uint32_t sigma0(uint32_t x) { return rotr(x, 7) ^ rotr(x, 18) ^ (x >> 3); }
+    static inline uint32_t sigma1(uint32_t x) { return rotr(x, 17) ^ rotr(x, 19) ^ (x >> 10); }
+
+    /// the lanes are only faster than the portable code
+    static bool use_lanes()
+    {
+#ifdef NTL_CPU_SHA
+      if ( __::has_sha_extensions() )
+        return false;
+#endif
+      return cpu::has(cpu::avx2);
+    }
+
+};// class sha256
+
+
+class sha512:
+  public __::sha_stream<sha512, 128, 2 * sizeof(uint64_t)>
+{
+  ///////////////////////////////////////////////////////////////////////////
+  public:
+
+    typedef uint8_t  octet;
+
+    enum { block_size = 1024, block_bytes = block_size/8 };
+    typedef octet block[block_bytes];
+
+    typedef __::sha_digest<512> digest;
+
+    sha512() { reset(); }
+
+    operator const digest&() const { return *reinterpret_cast<const digest*>(&h[0]); }
+
+    /// hash message
+    /// @note the size is in bytes, not bits.
+    const digest & operator()(const void * const message, const size_t bytes)
+    {
+      length = 0;
+      update(message, bytes);
+      return finalize();
+    }
+
+    /// pad the message passed to update() and return its digest
+    const digest & finalize()
+    {
+      pad();
+      return *this;
+    }
+
+    /// hash the complete blocks of the message
+    void compress(const void * const blocks, size_t count)
+    {
+      uint64_t state[8];
+      for ( unsigned i = 0; i < 8; ++i )
+        state[i] = big_endian(h[i]);
+      compress_blocks(state, reinterpret_cast<const octet*>(blocks), count);
+      for ( unsigned i = 0; i < 8; ++i )
+        h[i] = big_endian(state[i]);
+    }
+
+    void reset()
+    {
+      static const uint64_t initial[8] = {
+        0x6A09E667F3BCC908ULL, 0xBB67AE8584CAA73BULL, 0x3C6EF372FE94F82BULL, 0xA54FF53A5F1D36F1ULL,
+        0x510E527FADE682D1ULL, 0x9B05688C2B3E6C1FULL, 0x1F83D9ABFB41BD6BULL, 0x5BE0CD19137E2179ULL
+      };
+      for ( unsigned i = 0; i < 8; ++i )
+        h[i] = big_endian(initial[i]);
+      length = 0;
+    }
+
+    void set_state(const digest & state)
+    {
+      std::memcpy(h, &state, sizeof(h));
+    }
+
+    /// the portable compression function
+    static void compress_blocks(uint64_t state[8], const octet * p, size_t count)
+    {
+      for ( ; count; --count, p += block_bytes )
+      {
+        uint64_t w[80];
+        for ( unsigned t = 0; t < 16; ++t )
+          w[t] = __::load_be<uint64_t>(p + t * 8);
+        for ( unsigned t = 16; t < 80; ++t )
+          w[t] = sigma1(w[t-2]) + w[t-7] + sigma0(w[t-15]) + w[t-16];
+        uint64_t a = state[0], b = state[1], c = state[2], d = state[3],
+                 e = state[4], f = state[5], g = state[6], hh = state[7];
+        for ( unsigned t = 0; t < 80; ++t )
+        {
+          const uint64_t t1 = hh + (rotr(e, 14) ^ rotr(e, 18) ^ rotr(e, 41)) + ((e & f) ^ (~e & g)) + __::sha512_k[t] + w[t];
+          const uint64_t t2 = (rotr(a, 28) ^ rotr(a, 34) ^ rotr(a, 39)) + ((a & b) | (c & (a | b)));
+          hh = g; g = f; f = e; e = d + t1;
+          d = c; c = b; b = a; a = t1 + t2;
+        }
+        state[0] += a;  state[1] += b;  state[2] += c;  state[3] += d;
+        state[4] += e;  state[5] += f;  state[6] += g;  state[7] += hh;
+      }
+    }
+
+#ifdef NTL_TEST
+    /// @return 0 - Ok;
+    static inline
+    const char * test__implementation()
+    {
+      //  C.1 SHA-512 Example (One-Block Message)
+      {
+        static char msg[3] = { 'a', 'b', 'c' };
+        static const octet etalon[64] = {
+          0xdd, 0xaf, 0x35, 0xa1, 0x93, 0x61, 0x7a, 0xba, 0xcc, 0x41, 0x73, 0x49, 0xae, 0x20, 0x41, 0x31,
+          0x12, 0xe6, 0xfa, 0x4e, 0x89, 0xa9, 0x7e, 0xa2, 0x0a, 0x9e, 0xee, 0xe6, 0x4b, 0x55, 0xd3, 0x9a,
+          0x21, 0x92, 0x99, 0x2a, 0x27, 0x4f, 0xc1, 0xa8, 0x36, 0xba, 0x3c, 0x23, 0xa3, 0xfe, 0xeb, 0xbd,
+          0x45, 0x4d, 0x44, 0x23, 0x64, 0x3c, 0xe8, 0x0e, 0x2a, 0x9a, 0xc9, 0x4f, 0xa5, 0x4c, 0xa4, 0x9f };
+        sha512 hash;
+        if ( digest(etalon) != hash(msg, sizeof(msg)) )
+          return "C.1 SHA-512 Example (One-Block Message)";
+      }
+      //  C.2 SHA-512 Example (Multi-Block Message)
+      {
+        static char msg[] = "abcdefghbcdefghicdefghijdefghijkefghijklfghijklmghijklmnhijklmno"
+                            "ijklmnopjklmnopqklmnopqrlmnopqrsmnopqrstnopqrstu";
+        STATIC_ASSERT(896 / 8 == sizeof(msg) - 1);
+        static const octet etalon[64] = {
+          0x8e, 0x95, 0x9b, 0x75, 0xda, 0xe3, 0x13, 0xda, 0x8c, 0xf4, 0xf7, 0x28, 0x14, 0xfc, 0x14, 0x3f,
+          0x8f, 0x77, 0x79, 0xc6, 0xeb, 0x9f, 0x7f, 0xa1, 0x72, 0x99, 0xae, 0xad, 0xb6, 0x88, 0x90, 0x18,
+          0x50, 0x1d, 0x28, 0x9e, 0x49, 0x00, 0xf7, 0xe4, 0x33, 0x1b, 0x99, 0xde, 0xc4, 0xb5, 0x43, 0x3a,
+          0xc7, 0xd3, 0x29, 0xee, 0xb6, 0xdd, 0x26, 0x54, 0x5e, 0x96, 0xe5, 0x5b, 0x87, 0x4b, 0xe9, 0x09 };
+        sha512 hash;
+        if ( hash(msg, 896 / 8) != digest(etalon) )
+          return "C.2 SHA-512 Example (Multi-Block Message)";
+        hash.reset();
+        for ( unsigned i = 0, n = 1; i < 896 / 8; i += n, ++n )
+          hash.update(msg + i, i + n < 896 / 8 ? n : 896 / 8 - i);
+        if ( hash.finalize() != digest(etalon) )
+          return "C.2 SHA-512 Example (Multi-Block Message, streamed)";
+      }
+      //  C.3 SHA-512 Example (Long Message)
+      {
+        static char msg[1000000];
+        for ( unsigned i = 0; i < sizeof(msg); ++i )
+          msg[i] = 'a';
+        static const octet etalon[64] = {
+          0xe7, 0x18, 0x48, 0x3d, 0x0c, 0xe7, 0x69, 0x64, 0x4e, 0x2e, 0x42, 0xc7, 0xbc, 0x15, 0xb4, 0x63,
+          0x8e, 0x1f, 0x98, 0xb1, 0x3b, 0x20, 0x44, 0x28, 0x56, 0x32, 0xa8, 0x03, 0xaf, 0xa9, 0x73, 0xeb,
+          0xde, 0x0f, 0xf2, 0x44, 0x87, 0x7e, 0xa6, 0x0a, 0x4c, 0xb0, 0x43, 0x2c, 0xe5, 0x77, 0xc3, 0x1b,
+          0xeb, 0x00, 0x9c, 0x5c, 0x2c, 0x49, 0xaa, 0x2e, 0x4e, 0xad, 0xb2, 0x17, 0xad, 0x8c, 0xc0, 0x9b };
+        sha512 hash;
+        if ( hash(msg, sizeof(msg)) != digest(etalon) )
+          return "C.3 SHA-512 Example (Long Message)";
+      }
+      return 0;
+    }
+#endif//#ifdef NTL_TEST
+
+  ///////////////////////////////////////////////////////////////////////////
+  private:
+
+    uint64_t h[8];
+
+    static inline uint64_t sigma0(uint64_t x) { return rotr(x, 1) ^ rotr(x, 8) ^ (x >> 7); }
+    static inline uint64_t sigma1(uint64_t x) { return rotr(x, 19) ^ rotr(x, 61) ^ (x >> 6); }
+
+};// class sha512
+
 #ifdef _MSC_VER
 #pragma warning(pop)
 #endif
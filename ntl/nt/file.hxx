@@ -808,6 +808,19 @@ public:
     return success(last_status_);
   }
 
+  /** Leaves the view mapped after the section is closed, it must be unmapped by munmap(void*) */
+  void* detach()
+  {
+    void* base = base_;
+    base_ = NULL;
+    return base;
+  }
+
+  static bool munmap(void* base)
+  {
+    return success(NtUnmapViewOfSection(current_process(), base));
+  }
+
   bool flush()
   {
     void* base = base_;
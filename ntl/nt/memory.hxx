@@ -0,0 +1,72 @@
+/**\file*********************************************************************
+*                                                                     \brief
+*  user-mode allocator
+*
+****************************************************************************
+*/
+#ifndef NTL__NT_MEMORY
+#define NTL__NT_MEMORY
+#pragma once
+
+#include "heap.hxx"
+#include "../stlx/memory.hxx"
+
+namespace ntl {
+  namespace nt {
+
+    /**
+     *	process heap allocator
+     *  grows the blocks in place when the heap has room after them,
+     *  so the containers reallocate without moving their elements
+     **/
+    template<class T>
+    class heap_allocator: public std::allocator<T>
+    {
+    public:
+      typedef typename std::allocator<T>::pointer   pointer;
+      typedef typename std::allocator<T>::size_type size_type;
+
+      template<class U> struct rebind { typedef heap_allocator<U> other; };
+
+      heap_allocator() __ntl_nothrow {}
+      template<class U> heap_allocator(const heap_allocator<U>&) __ntl_nothrow {}
+
+      __noalias __forceinline
+        pointer allocate(size_type n, std::allocator<void>::const_pointer = 0)
+        __ntl_throws(std::bad_alloc)
+      {
+        const pointer p = reinterpret_cast<T*>(heap::alloc(process_heap(), sizeof(T) * n));
+        if(!p)
+          __ntl_throw(std::bad_alloc());
+        return p;
+      }
+
+      __noalias __forceinline
+        void deallocate(pointer p, size_type /* n */)
+      {
+        heap::free(process_heap(), p);
+      }
+
+      /** Resizes the block \p p to \p m objects without moving it, fails if the heap can't */
+      bool expand(pointer p, size_type /* n */, size_type m)
+      {
+        return m <= this->max_size()
+          && RtlReAllocateHeap(process_heap(), heap::realloc_in_place_only, p, sizeof(T) * m) != 0;
+      }
+
+    };//class heap_allocator
+
+  } // namespace nt
+
+} // namespace ntl
+
+namespace std
+{
+  namespace ext
+  {
+    template<class T>
+    struct is_trivially_relocatable<ntl::nt::heap_allocator<T> >: true_type {};
+  }
+}
+
+#endif // #ifndef NTL__NT_MEMORY
@@ -9,19 +9,18 @@
 namespace
 {
   // CRT stubs
-  vfv_t *imp_strtod, *imp_vsnprintf, *imp_vsnwprintf, *imp_acos, *imp_atan, *imp_tan, *imp_strtok, *imp_modf;
+  vfv_t *imp_vsnprintf, *imp_vsnwprintf, *imp_acos, *imp_atan, *imp_tan, *imp_strtok, *imp_modf;
 }
 
-// CRT forwards
+// native conversions
 double NTL_CRTCALL strtod(const char * __restrict nptr, char ** __restrict endptr)
 {
-  typedef double __cdecl f_t(const char*, char**);
-  return reinterpret_cast<f_t*>(imp_strtod)(nptr, endptr);
+  return ntl::numeric::strtod(nptr, (const char**)endptr);
 }
 
 float NTL_CRTCALL strtof(const char * __restrict nptr, char ** __restrict endptr)
 {
-  return (float)strtod(nptr, endptr);
+  return ntl::numeric::strtof(nptr, (const char**)endptr);
 }
 
 long double NTL_CRTCALL strtold(const char * __restrict nptr, char ** __restrict endptr)
@@ -31,10 +30,10 @@ long double NTL_CRTCALL strtold(const char * __restrict nptr, char ** __restrict
 
 double NTL_CRTCALL atof(const char *nptr)
 {
-  char* end;
-  return strtod(nptr, &end);
+  return ntl::numeric::strtod(nptr);
 }
 
+// CRT forwards
 double NTL_CRTCALL std::modf(double value, double* iptr)
 {
   typedef double __cdecl f_t(double, double*);
@@ -140,7 +139,6 @@ namespace
 #define NTL_IMP(func) imp_ ## func = msvcrt->find_export<vfv_t*>(#func)
 #define NTL_IMP2(func,name) imp_ ## func = msvcrt->find_export<vfv_t*>(name)
 
-    NTL_IMP(strtod);
     NTL_IMP(strtok);
     NTL_IMP(vsnprintf);
     NTL_IMP2(vsnwprintf, "vsnwprintf");
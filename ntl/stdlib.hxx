@@ -40,10 +40,22 @@ extern "C" uint64_t _rotr64(uint64_t value, uint8_t shift);
 extern "C" uint16_t _byteswap_ushort (uint16_t value);
 extern "C" uint32_t _byteswap_ulong (uint32_t value);
 extern "C" uint64_t _byteswap_uint64(uint64_t value);
+
+extern "C" unsigned char _BitScanForward(unsigned long* index, unsigned long mask);
+extern "C" unsigned char _BitScanReverse(unsigned long* index, unsigned long mask);
+#ifdef _M_X64
+extern "C" unsigned char _BitScanForward64(unsigned long* index, uint64_t mask);
+extern "C" unsigned char _BitScanReverse64(unsigned long* index, uint64_t mask);
+extern "C" uint64_t _umul128(uint64_t a, uint64_t b, uint64_t* high);
+#endif
 #ifndef __ICL
 #pragma intrinsic(_rotr8, _rotr16, _lrotr, _rotr64)
 #pragma intrinsic(_rotl8, _rotl16, _lrotl, _rotl64)
 #pragma intrinsic(_byteswap_ushort, _byteswap_ulong, _byteswap_uint64)
+#pragma intrinsic(_BitScanForward, _BitScanReverse)
+#ifdef _M_X64
+#pragma intrinsic(_BitScanForward64, _BitScanReverse64, _umul128)
+#endif
 #endif
 
 }//namespace intrinsic
@@ -164,8 +176,51 @@ type
   return value;
 }
 
+
+///\name  Bit scan
+
+/// index of the least significant set bit of the nonzero \p mask
+static inline unsigned bsf(uint32_t mask)
+{
+  unsigned long index;
+  intrinsic::_BitScanForward(&index, mask);
+  return index;
+}
+
+/// index of the most significant set bit of the nonzero \p mask
+static inline unsigned bsr(uint32_t mask)
+{
+  unsigned long index;
+  intrinsic::_BitScanReverse(&index, mask);
+  return index;
+}
+
+#ifdef _M_X64
+static inline unsigned bsf(uint64_t mask)
+{
+  unsigned long index;
+  intrinsic::_BitScanForward64(&index, mask);
+  return index;
+}
+
+static inline unsigned bsr(uint64_t mask)
+{
+  unsigned long index;
+  intrinsic::_BitScanReverse64(&index, mask);
+  return index;
+}
+#endif
+
 #else
 
+#if defined(__GNUC__) || defined(__clang__)
+///\name  Bit scan
+static inline unsigned bsf(uint32_t mask) { return __builtin_ctz(mask); }
+static inline unsigned bsr(uint32_t mask) { return 31 - __builtin_clz(mask); }
+static inline unsigned bsf(uint64_t mask) { return __builtin_ctzll(mask); }
+static inline unsigned bsr(uint64_t mask) { return 63 - __builtin_clzll(mask); }
+#endif
+
 #endif  //_MSC_VER
 
 
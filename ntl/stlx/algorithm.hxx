@@ -18,8 +18,13 @@
 #include "initializer_list.hxx"
 #endif
 
+#ifndef NTL__STLX_MEMORY
+#include "memory.hxx" // for get_temporary_buffer
+#endif
+
 #include "cstring.hxx"
 #include "functional.hxx"
+#include "ext/simd_chars.hxx"
 
 namespace std
 {
@@ -250,28 +255,65 @@ bool equal(InputIterator1 first1, InputIterator1 last1, InputIterator2 first2, I
   return true;
 }
 
-template<class ForwardIterator1, class ForwardIterator2>
-__forceinline
-ForwardIterator1
-  search(ForwardIterator1 first1, ForwardIterator1 last1,
-         ForwardIterator2 first2, ForwardIterator2 last2)
+namespace __
 {
-  // iterators are of forward category, so do a brute force search
-  // @todo: specializations for other iterator categories?
-  for ( ; ; )
+  /** Character types handled by the vectorized string search */
+  template<class T>
+  struct is_simd_char:
+    integral_constant<bool, is_integral<T>::value && !is_same<T, bool>::value && (sizeof(T) == 1 || sizeof(T) == 2 || sizeof(T) == 4)>
+  {};
+
+  template<class I1, class I2>
+  struct is_simd_searchable_check
   {
-    ForwardIterator1 i1 = first1;
-    ForwardIterator2 i2 = first2;
+    typedef typename remove_cv<typename iterator_traits<I1>::value_type>::type type1;
+    typedef typename remove_cv<typename iterator_traits<I2>::value_type>::type type2;
+
+    static const bool value = is_pointer<I1>::value && is_pointer<I2>::value && is_same<type1, type2>::value && is_simd_char<type1>::value;
+  };
+
+  template<class I1, class I2>
+  struct is_simd_searchable:
+    integral_constant<bool, is_simd_searchable_check<I1,I2>::value>
+  {};
+
+  template<class ForwardIterator1, class ForwardIterator2>
+  inline ForwardIterator1 search(ForwardIterator1 first1, ForwardIterator1 last1, ForwardIterator2 first2, ForwardIterator2 last2, false_type)
+  {
+    // iterators are of forward category, so do a brute force search
     for ( ; ; )
     {
-      if ( i1 == last1 ) return first1; // not found, first1 == last1
-      if ( i2 == last2 ) return first1; // found
-      if ( *i1 != *i2 ) break;
-      ++i1;
-      ++i2;
+      ForwardIterator1 i1 = first1;
+      ForwardIterator2 i2 = first2;
+      for ( ; ; )
+      {
+        if ( i1 == last1 ) return first1; // not found, first1 == last1
+        if ( i2 == last2 ) return first1; // found
+        if ( *i1 != *i2 ) break;
+        ++i1;
+        ++i2;
+      }
+      ++first1;
     }
-    ++first1;
   }
+
+  // contiguous character ranges are searched without the quadratic worst case
+  template<class Pointer1, class Pointer2>
+  inline Pointer1 search(Pointer1 first1, Pointer1 last1, Pointer2 first2, Pointer2 last2, true_type)
+  {
+    typedef typename is_simd_searchable_check<Pointer1, Pointer2>::type1 char_type;
+    const char_type* const p = ext::simd::search<char_type>(first1, static_cast<size_t>(last1 - first1), first2, static_cast<size_t>(last2 - first2));
+    return p ? first1 + (p - first1) : last1;
+  }
+}
+
+template<class ForwardIterator1, class ForwardIterator2>
+__forceinline
+ForwardIterator1
+  search(ForwardIterator1 first1, ForwardIterator1 last1,
+         ForwardIterator2 first2, ForwardIterator2 last2)
+{
+  return __::search(first1, last1, first2, last2, __::is_simd_searchable<ForwardIterator1, ForwardIterator2>());
 }
 
 
@@ -290,7 +332,7 @@ ForwardIterator1
     {
       if ( i1 == last1 ) return first1; // not found, first1 == last1
       if ( i2 == last2 ) return first1; // found
-      if ( pred(*i1, *i2) != false ) break;
+      if ( pred(*i1, *i2) == false ) break;
       ++i1;
       ++i2;
     }
@@ -866,54 +908,632 @@ ForwardIterator partition_point(ForwardIterator first,
                                 Predicate pred);
 
 ///\name 25.3, sorting and related operations:
+
+// used by the sorting algorithms and defined below
+template<class ForwardIterator, class T, class Compare>
+inline
+ForwardIterator
+  lower_bound(ForwardIterator first, ForwardIterator last,
+              const T& value, Compare comp);
+
+template<class ForwardIterator, class T, class Compare>
+inline
+ForwardIterator
+  upper_bound(ForwardIterator first, ForwardIterator last, const T& value, Compare comp);
+
+template<class RandomAccessIterator, class Compare>
+inline void make_heap(RandomAccessIterator first, RandomAccessIterator last, Compare comp);
+
+template<class RandomAccessIterator, class Compare>
+inline void sort_heap(RandomAccessIterator first, RandomAccessIterator last, Compare comp);
+
+namespace __
+{
+  template<class Compare, class RandomAccessIterator>
+  inline void push_heap_front(RandomAccessIterator first, RandomAccessIterator last, Compare comp, typename iterator_traits<RandomAccessIterator>::difference_type count);
+}
+
 ///\name 25.3.1, sorting:
+
+namespace __
+{
+  /** Ranges shorter than this are sorted by insertion */
+  static const ptrdiff_t insertion_sort_threshold = 24;
+  /** Ranges longer than this use the pseudomedian of nine as the pivot */
+  static const ptrdiff_t ninther_threshold = 128;
+  /** Number of the element moves after which partial_insertion_sort() gives up */
+  static const size_t partial_insertion_sort_limit = 8;
+  /** Number of the elements classified at once by the branchless partitioning */
+  static const size_t partition_block_size = 64;
+
+  /** The arithmetic values compared by the standard function objects are partitioned without branches */
+  template<class T, class Compare>
+  struct is_branchless_sortable: false_type {};
+  template<class T>
+  struct is_branchless_sortable<T, less<T> >: integral_constant<bool, is_arithmetic<T>::value> {};
+  template<class T>
+  struct is_branchless_sortable<T, greater<T> >: integral_constant<bool, is_arithmetic<T>::value> {};
+  template<class T>
+  struct is_branchless_sortable<T, less<void> >: integral_constant<bool, is_arithmetic<T>::value> {};
+  template<class T>
+  struct is_branchless_sortable<T, greater<void> >: integral_constant<bool, is_arithmetic<T>::value> {};
+
+  template<class Size>
+  inline int sort_log2(Size n)
+  {
+    int log = 0;
+    while(n >>= 1)
+      ++log;
+    return log;
+  }
+
+  template<class RandomAccessIterator, class Compare>
+  inline void insertion_sort(RandomAccessIterator first, RandomAccessIterator last, Compare comp)
+  {
+    typedef typename iterator_traits<RandomAccessIterator>::value_type value_type;
+    if(first == last)
+      return;
+    for(RandomAccessIterator cur = first + 1; cur != last; ++cur){
+      RandomAccessIterator sift = cur, sift_1 = cur - 1;
+      if(comp(*sift, *sift_1)){
+        value_type tmp = std::move(*sift);
+        do {
+          *sift-- = std::move(*sift_1);
+        } while(sift != first && comp(tmp, *--sift_1));
+        *sift = std::move(tmp);
+      }
+    }
+  }
+
+  /** Insertion sort which relies on the element before \p first being not greater than any element of the range */
+  template<class RandomAccessIterator, class Compare>
+  inline void unguarded_insertion_sort(RandomAccessIterator first, RandomAccessIterator last, Compare comp)
+  {
+    typedef typename iterator_traits<RandomAccessIterator>::value_type value_type;
+    if(first == last)
+      return;
+    for(RandomAccessIterator cur = first + 1; cur != last; ++cur){
+      RandomAccessIterator sift = cur, sift_1 = cur - 1;
+      if(comp(*sift, *sift_1)){
+        value_type tmp = std::move(*sift);
+        do {
+          *sift-- = std::move(*sift_1);
+        } while(comp(tmp, *--sift_1));
+        *sift = std::move(tmp);
+      }
+    }
+  }
+
+  /** Insertion sort which gives up after a few moves: returns \c false if the range was not nearly sorted */
+  template<class RandomAccessIterator, class Compare>
+  inline bool partial_insertion_sort(RandomAccessIterator first, RandomAccessIterator last, Compare comp)
+  {
+    typedef typename iterator_traits<RandomAccessIterator>::value_type value_type;
+    if(first == last)
+      return true;
+    size_t moves = 0;
+    for(RandomAccessIterator cur = first + 1; cur != last; ++cur){
+      RandomAccessIterator sift = cur, sift_1 = cur - 1;
+      if(comp(*sift, *sift_1)){
+        value_type tmp = std::move(*sift);
+        do {
+          *sift-- = std::move(*sift_1);
+        } while(sift != first && comp(tmp, *--sift_1));
+        *sift = std::move(tmp);
+        moves += cur - sift;
+        if(moves > partial_insertion_sort_limit)
+          return false;
+      }
+    }
+    return true;
+  }
+
+  template<class RandomAccessIterator, class Compare>
+  inline void sort2(RandomAccessIterator a, RandomAccessIterator b, Compare comp)
+  {
+    if(comp(*b, *a))
+      iter_swap(a, b);
+  }
+
+  template<class RandomAccessIterator, class Compare>
+  inline void sort3(RandomAccessIterator a, RandomAccessIterator b, RandomAccessIterator c, Compare comp)
+  {
+    sort2(a, b, comp);
+    sort2(b, c, comp);
+    sort2(a, b, comp);
+  }
+
+  /** Moves the median of three (or the pseudomedian of nine for the long ranges) to \p first */
+  template<class RandomAccessIterator, class Compare>
+  inline void choose_pivot(RandomAccessIterator first, RandomAccessIterator last, Compare comp)
+  {
+    const ptrdiff_t size = last - first, half = size / 2;
+    if(size > ninther_threshold){
+      sort3(first, first + half, last - 1, comp);
+      sort3(first + 1, first + (half - 1), last - 2, comp);
+      sort3(first + 2, first + (half + 1), last - 3, comp);
+      sort3(first + (half - 1), first + half, first + (half + 1), comp);
+      iter_swap(first, first + half);
+    }else{
+      sort3(first + half, first, last - 1, comp);
+    }
+  }
+
+  /**
+   *	Partitions [first, last) around the pivot *first: the elements less than the pivot go left, the rest go right.
+   *  Returns the final pivot position and whether the range was already partitioned.
+   *  Requires the median-of-three pivot: the range must contain an element not less than the pivot.
+   **/
+  template<class RandomAccessIterator, class Compare>
+  inline pair<RandomAccessIterator, bool> partition_right(RandomAccessIterator first, RandomAccessIterator last, Compare comp, false_type)
+  {
+    typedef typename iterator_traits<RandomAccessIterator>::value_type value_type;
+    const RandomAccessIterator begin = first;
+    value_type pivot = std::move(*first);
+
+    while(comp(*++first, pivot));
+    if(first - 1 == begin)
+      while(first < last && !comp(*--last, pivot));
+    else
+      while(!comp(*--last, pivot));
+
+    const bool already_partitioned = first >= last;
+    while(first < last){
+      iter_swap(first, last);
+      while(comp(*++first, pivot));
+      while(!comp(*--last, pivot));
+    }
+
+    const RandomAccessIterator pivot_pos = first - 1;
+    *begin = std::move(*pivot_pos);
+    *pivot_pos = std::move(pivot);
+    return make_pair(pivot_pos, already_partitioned);
+  }
+
+  /** Swaps the elements at the offsets of the left and of the right block */
+  template<class RandomAccessIterator>
+  inline void swap_offsets(RandomAccessIterator first, RandomAccessIterator last, const unsigned char* offsets_l, const unsigned char* offsets_r, size_t n, bool use_swaps)
+  {
+    typedef typename iterator_traits<RandomAccessIterator>::value_type value_type;
+    if(use_swaps){
+      // the counts were equal, a cyclic permutation would break the partitioning
+      for(size_t i = 0; i < n; ++i)
+        iter_swap(first + offsets_l[i], last - offsets_r[i]);
+    }else if(n){
+      RandomAccessIterator l = first + offsets_l[0], r = last - offsets_r[0];
+      value_type tmp = std::move(*l);
+      *l = std::move(*r);
+      for(size_t i = 1; i < n; ++i){
+        l = first + offsets_l[i];
+        *r = std::move(*l);
+        r = last - offsets_r[i];
+        *l = std::move(*r);
+      }
+      *r = std::move(tmp);
+    }
+  }
+
+  /**
+   *	partition_right() for the cheap comparisons: the blocks of elements are classified first, storing
+   *  the offsets of the misplaced ones without branching on the comparison result, then swapped
+   *  (BlockQuicksort, Edelkamp & Weiss).
+   **/
+  template<class RandomAccessIterator, class Compare>
+  inline pair<RandomAccessIterator, bool> partition_right(RandomAccessIterator first, RandomAccessIterator last, Compare comp, true_type)
+  {
+    typedef typename iterator_traits<RandomAccessIterator>::value_type value_type;
+    const RandomAccessIterator begin = first;
+    value_type pivot = std::move(*first);
+
+    while(comp(*++first, pivot));
+    if(first - 1 == begin)
+      while(first < last && !comp(*--last, pivot));
+    else
+      while(!comp(*--last, pivot));
+
+    const bool already_partitioned = first >= last;
+    if(!already_partitioned){
+      iter_swap(first, last);
+      ++first;
+
+      unsigned char offsets_l[partition_block_size], offsets_r[partition_block_size];
+      RandomAccessIterator offsets_l_base = first, offsets_r_base = last;
+      size_t num_l = 0, num_r = 0, start_l = 0, start_r = 0;
+
+      while(first < last){
+        // fill the empty blocks, splitting the rest of the range between them when it is short
+        const size_t num_unknown = static_cast<size_t>(last - first);
+        const size_t left_split = num_l == 0 ? (num_r == 0 ? num_unknown / 2 : num_unknown) : 0;
+        const size_t right_split = num_r == 0 ? num_unknown - left_split : 0;
+
+        const size_t left_count = left_split < partition_block_size ? left_split : partition_block_size;
+        for(size_t i = 0; i < left_count; ++i){
+          offsets_l[num_l] = static_cast<unsigned char>(i);
+          num_l += !comp(*first, pivot);
+          ++first;
+        }
+        const size_t right_count = right_split < partition_block_size ? right_split : partition_block_size;
+        for(size_t i = 0; i < right_count; ){
+          offsets_r[num_r] = static_cast<unsigned char>(++i);
+          num_r += comp(*--last, pivot);
+        }
+
+        const size_t n = num_l < num_r ? num_l : num_r;
+        swap_offsets(offsets_l_base, offsets_r_base, offsets_l + start_l, offsets_r + start_r, n, num_l == num_r);
+        num_l -= n; num_r -= n;
+        start_l += n; start_r += n;
+        if(num_l == 0){
+          start_l = 0;
+          offsets_l_base = first;
+        }
+        if(num_r == 0){
+          start_r = 0;
+          offsets_r_base = last;
+        }
+      }
+
+      // at most one block has misplaced elements left, move them next to the boundary
+      if(num_l){
+        while(num_l--)
+          iter_swap(offsets_l_base + offsets_l[start_l + num_l], --last);
+        first = last;
+      }
+      if(num_r){
+        while(num_r--){
+          iter_swap(offsets_r_base - offsets_r[start_r + num_r], first);
+          ++first;
+        }
+        last = first;
+      }
+    }
+
+    const RandomAccessIterator pivot_pos = first - 1;
+    *begin = std::move(*pivot_pos);
+    *pivot_pos = std::move(pivot);
+    return make_pair(pivot_pos, already_partitioned);
+  }
+
+  /**
+   *	Partitions [first, last) around the pivot *first putting the elements equal to the pivot left.
+   *  Used when the pivot equals the element before the range, so all of them are already in place.
+   **/
+  template<class RandomAccessIterator, class Compare>
+  inline RandomAccessIterator partition_left(RandomAccessIterator first, RandomAccessIterator last, Compare comp)
+  {
+    typedef typename iterator_traits<RandomAccessIterator>::value_type value_type;
+    const RandomAccessIterator begin = first, end = last;
+    value_type pivot = std::move(*first);
+
+    while(comp(pivot, *--last));
+    if(last + 1 == end)
+      while(first < last && !comp(pivot, *++first));
+    else
+      while(!comp(pivot, *++first));
+
+    while(first < last){
+      iter_swap(first, last);
+      while(comp(pivot, *--last));
+      while(!comp(pivot, *++first));
+    }
+
+    const RandomAccessIterator pivot_pos = last;
+    *begin = std::move(*pivot_pos);
+    *pivot_pos = std::move(pivot);
+    return pivot_pos;
+  }
+
+  /** Shuffles a few elements of the part after a bad partition to break the input pattern */
+  template<class RandomAccessIterator>
+  inline void break_patterns(RandomAccessIterator first, RandomAccessIterator last)
+  {
+    const ptrdiff_t size = last - first;
+    if(size < insertion_sort_threshold)
+      return;
+    const ptrdiff_t q = size / 4;
+    iter_swap(first, first + q);
+    iter_swap(last - 1, last - q);
+    if(size > ninther_threshold){
+      iter_swap(first + 1, first + (q + 1));
+      iter_swap(first + 2, first + (q + 2));
+      iter_swap(last - 2, last - (q + 1));
+      iter_swap(last - 3, last - (q + 2));
+    }
+  }
+
+  /**
+   *	Pattern-defeating quicksort (Orson Peters).
+   *
+   *  Introsort with the pseudomedian pivot and insertion sort for the short ranges, which in addition:
+   *  - finishes a range in linear time if the partitioning did not move anything and it is nearly sorted;
+   *  - partitions the runs of equal elements once, by putting them left of the pivot;
+   *  - shuffles the elements after an unbalanced partitioning and falls back to heapsort after
+   *    log(n) of them, so the worst case is O(n log n).
+   **/
+  template<class RandomAccessIterator, class Compare, class Branchless>
+  inline void pdqsort_loop(RandomAccessIterator first, RandomAccessIterator last, Compare comp, int bad_allowed, bool leftmost, Branchless branchless)
+  {
+    for(;;){
+      const ptrdiff_t size = last - first;
+      if(size < insertion_sort_threshold){
+        if(leftmost)
+          insertion_sort(first, last, comp);
+        else
+          unguarded_insertion_sort(first, last, comp);
+        return;
+      }
+
+      choose_pivot(first, last, comp);
+
+      // the pivot equals the element before the range: the equal elements need no further sorting
+      if(!leftmost && !comp(*(first - 1), *first)){
+        first = partition_left(first, last, comp) + 1;
+        continue;
+      }
+
+      const pair<RandomAccessIterator, bool> part = partition_right(first, last, comp, branchless);
+      const RandomAccessIterator pivot_pos = part.first;
+      const ptrdiff_t l_size = pivot_pos - first, r_size = last - (pivot_pos + 1);
+
+      if(l_size < size / 8 || r_size < size / 8){
+        if(--bad_allowed == 0){
+          make_heap(first, last, comp);
+          sort_heap(first, last, comp);
+          return;
+        }
+        break_patterns(first, pivot_pos);
+        break_patterns(pivot_pos + 1, last);
+      }else if(part.second && partial_insertion_sort(first, pivot_pos, comp) && partial_insertion_sort(pivot_pos + 1, last, comp)){
+        return;
+      }
+
+      // sort the left part recursively and the right one in the loop
+      pdqsort_loop(first, pivot_pos, comp, bad_allowed, leftmost, branchless);
+      first = pivot_pos + 1;
+      leftmost = false;
+    }
+  }
+
+  /**
+   *	Checks for an ascending or a descending range in a single pass and sorts it.
+   *  The descending range is reversed if it is strictly descending or if \p stable is \c false.
+   *  The pass stops at the first element breaking the order.
+   **/
+  template<class RandomAccessIterator, class Compare>
+  inline bool sort_monotonic(RandomAccessIterator first, RandomAccessIterator last, Compare comp, bool stable)
+  {
+    if(last - first < 2)
+      return true;
+    RandomAccessIterator i = first + 1;
+    if(comp(*i, *first)){
+      if(stable)
+        while(++i != last && comp(*i, *(i - 1)));
+      else
+        while(++i != last && !comp(*(i - 1), *i));
+      if(i != last)
+        return false;
+      reverse(first, last);
+      return true;
+    }
+    while(++i != last && !comp(*i, *(i - 1)));
+    return i == last;
+  }
+
+  template<class RandomAccessIterator, class Compare>
+  inline void pdqsort(RandomAccessIterator first, RandomAccessIterator last, Compare comp)
+  {
+    typedef typename iterator_traits<RandomAccessIterator>::value_type value_type;
+    if(sort_monotonic(first, last, comp, false))
+      return;
+    pdqsort_loop(first, last, comp, sort_log2(last - first), true, is_branchless_sortable<value_type, Compare>());
+  }
+}
+
+template<class RandomAccessIterator, class Compare>
+inline void sort(RandomAccessIterator first, RandomAccessIterator last, Compare comp)
+{
+  __::pdqsort(first, last, comp);
+}
+
 template<class RandomAccessIterator>
 inline void sort(RandomAccessIterator first, RandomAccessIterator last)
 {
   typedef typename iterator_traits<RandomAccessIterator>::value_type value_type;
-  sort (first, last, less<value_type>());
+  sort(first, last, less<value_type>());
 }
 
-template<class RandomAccessIterator, class Compare>
-inline void sort(RandomAccessIterator first, RandomAccessIterator last, Compare /*comp*/)
+namespace __
 {
-  typedef typename iterator_traits<RandomAccessIterator>::value_type value_type;
-  typedef const value_type* const_pointer;
+  /** Runs of this length are sorted by insertion before merging */
+  static const ptrdiff_t stable_sort_run = 32;
 
-  struct proxy
+  /** Merges [first, middle) and [middle, last) moving the first run into the uninitialized \p buf */
+  template<class RandomAccessIterator, class T, class Compare>
+  inline void merge_with_buffer(RandomAccessIterator first, RandomAccessIterator middle, RandomAccessIterator last, T* buf, Compare comp)
   {
-    static int NTL_CRTIMP qsort(const void* a, const void* b)
-    {
-      const_pointer x = reinterpret_cast<const_pointer>(a), y = reinterpret_cast<const_pointer>(b);
-      Compare comp;
-      return comp(*x, *y) ? -1 : (comp(*y,*x) ? 1 : 0);
+    T* bend = buf;
+    for(RandomAccessIterator i = first; i != middle; ++i, ++bend)
+      new (static_cast<void*>(bend)) T(std::move(*i));
+
+    T* b = buf;
+    RandomAccessIterator out = first;
+    while(b != bend && middle != last){
+      if(comp(*middle, *b))
+        *out++ = std::move(*middle++);
+      else
+        *out++ = std::move(*b++);
     }
-  };
-  qsort(first, distance(first, last), sizeof(value_type), &proxy::qsort);
-}
+    while(b != bend)
+      *out++ = std::move(*b++);
 
-template<class RandomAccessIterator>
-inline
-void
-  stable_sort(RandomAccessIterator first, RandomAccessIterator last);
+    for(b = buf; b != bend; ++b)
+      b->~T();
+  }
 
+  /** Merges the adjacent runs in place by the rotations, O(n log n) */
+  template<class RandomAccessIterator, class Compare>
+  inline void merge_without_buffer(RandomAccessIterator first, RandomAccessIterator middle, RandomAccessIterator last, ptrdiff_t len1, ptrdiff_t len2, Compare comp)
+  {
+    if(len1 == 0 || len2 == 0)
+      return;
+    if(len1 + len2 == 2){
+      if(comp(*middle, *first))
+        iter_swap(first, middle);
+      return;
+    }
+    RandomAccessIterator first_cut, second_cut;
+    ptrdiff_t len11, len22;
+    if(len1 > len2){
+      len11 = len1 / 2;
+      first_cut = first + len11;
+      second_cut = lower_bound(middle, last, *first_cut, comp);
+      len22 = second_cut - middle;
+    }else{
+      len22 = len2 / 2;
+      second_cut = middle + len22;
+      first_cut = upper_bound(first, middle, *second_cut, comp);
+      len11 = first_cut - first;
+    }
+    rotate(first_cut, middle, second_cut);
+    const RandomAccessIterator new_middle = first_cut + len22;
+    merge_without_buffer(first, first_cut, new_middle, len11, len22, comp);
+    merge_without_buffer(new_middle, second_cut, last, len1 - len11, len2 - len22, comp);
+  }
+
+  template<class RandomAccessIterator, class T, class Compare>
+  inline void stable_sort(RandomAccessIterator first, RandomAccessIterator last, T* buf, ptrdiff_t buf_size, Compare comp)
+  {
+    const ptrdiff_t len = last - first;
+    if(len <= stable_sort_run){
+      insertion_sort(first, last, comp);
+      return;
+    }
+    const RandomAccessIterator middle = first + len / 2;
+    stable_sort(first, middle, buf, buf_size, comp);
+    stable_sort(middle, last, buf, buf_size, comp);
+    if(!comp(*middle, *(middle - 1)))
+      return; // the runs are already in order
+    if(middle - first <= buf_size)
+      merge_with_buffer(first, middle, last, buf, comp);
+    else
+      merge_without_buffer(first, middle, last, middle - first, last - middle, comp);
+  }
+}
+
+/**
+ *	Sorts the range preserving the order of the equivalent elements.
+ *  Merge sort with a temporary buffer of the half range size, O(n log n); without the buffer
+ *  the runs are merged in place in O(n log^2 n).
+ **/
 template<class RandomAccessIterator, class Compare>
-inline
-void
-  stable_sort(RandomAccessIterator first, RandomAccessIterator last,
-              Compare comp);
+inline void stable_sort(RandomAccessIterator first, RandomAccessIterator last, Compare comp)
+{
+  typedef typename iterator_traits<RandomAccessIterator>::value_type value_type;
+  if(__::sort_monotonic(first, last, comp, true))
+    return;
+  const ptrdiff_t len = last - first;
+  pair<value_type*, ptrdiff_t> buf;
+  if(len > __::stable_sort_run)
+    buf = get_temporary_buffer<value_type>((len + 1) / 2);
+  __::stable_sort(first, last, buf.first, buf.second, comp);
+  if(buf.first)
+    return_temporary_buffer(buf.first);
+}
 
 template<class RandomAccessIterator>
-inline
-void
-  partial_sort(RandomAccessIterator first, RandomAccessIterator middle,
-               RandomAccessIterator last);
+inline void stable_sort(RandomAccessIterator first, RandomAccessIterator last)
+{
+  typedef typename iterator_traits<RandomAccessIterator>::value_type value_type;
+  stable_sort(first, last, less<value_type>());
+}
+
+namespace __
+{
+  /** Selects the smallest elements by a heap of [first, middle) and sorts them, O(n log k) */
+  template<class RandomAccessIterator, class Compare>
+  inline void heap_partial_sort(RandomAccessIterator first, RandomAccessIterator middle, RandomAccessIterator last, Compare comp)
+  {
+    if(first == middle)
+      return;
+    make_heap(first, middle, comp);
+    const ptrdiff_t k = middle - first;
+    for(RandomAccessIterator i = middle; i != last; ++i){
+      if(comp(*i, *first)){
+        iter_swap(i, first);
+        push_heap_front<Compare>(first, middle, comp, k);
+      }
+    }
+    sort_heap(first, middle, comp);
+  }
 
+  /** Quickselect with the pdqsort partitioning, falls back to the heap selection after log(n) bad partitions */
+  template<class RandomAccessIterator, class Compare, class Branchless>
+  inline void nth_element(RandomAccessIterator first, RandomAccessIterator nth, RandomAccessIterator last, Compare comp, Branchless branchless)
+  {
+    int bad_allowed = sort_log2(last - first);
+    bool leftmost = true;
+    while(last - first >= insertion_sort_threshold){
+      const ptrdiff_t size = last - first;
+      choose_pivot(first, last, comp);
+
+      if(!leftmost && !comp(*(first - 1), *first)){
+        // all elements up to the pivot position are equal to the pivot
+        const RandomAccessIterator pivot_pos = partition_left(first, last, comp);
+        if(nth <= pivot_pos)
+          return;
+        first = pivot_pos + 1;
+        continue;
+      }
+
+      const RandomAccessIterator pivot_pos = partition_right(first, last, comp, branchless).first;
+      if(pivot_pos == nth)
+        return;
+
+      const ptrdiff_t l_size = pivot_pos - first, r_size = last - (pivot_pos + 1);
+      if(l_size < size / 8 || r_size < size / 8){
+        if(--bad_allowed == 0){
+          heap_partial_sort(first, nth + 1, last, comp);
+          return;
+        }
+        break_patterns(first, pivot_pos);
+        break_patterns(pivot_pos + 1, last);
+      }
+
+      if(nth < pivot_pos){
+        last = pivot_pos;
+      }else{
+        first = pivot_pos + 1;
+        leftmost = false;
+      }
+    }
+    insertion_sort(first, last, comp);
+  }
+}
+
+/**
+ *	Places the \p middle - \p first smallest elements sorted into [first, middle).
+ *  A few elements are selected by a heap, a large part is selected by nth_element() and then sorted.
+ **/
 template<class RandomAccessIterator, class Compare>
-inline
-void
-  partial_sort(RandomAccessIterator first, RandomAccessIterator middle,
-               RandomAccessIterator last, Compare comp);
+inline void partial_sort(RandomAccessIterator first, RandomAccessIterator middle, RandomAccessIterator last, Compare comp)
+{
+  typedef typename iterator_traits<RandomAccessIterator>::value_type value_type;
+  const ptrdiff_t k = middle - first, n = last - first;
+  if(k == 0)
+    return;
+  if(k < n && k > n / 8){
+    __::nth_element(first, middle - 1, last, comp, __::is_branchless_sortable<value_type, Compare>());
+    __::pdqsort(first, middle - 1, comp);
+  }else{
+    __::heap_partial_sort(first, middle, last, comp);
+  }
+}
+
+template<class RandomAccessIterator>
+inline void partial_sort(RandomAccessIterator first, RandomAccessIterator middle, RandomAccessIterator last)
+{
+  typedef typename iterator_traits<RandomAccessIterator>::value_type value_type;
+  partial_sort(first, middle, last, less<value_type>());
+}
 
 template<class InputIterator, class RandomAccessIterator>
 inline
@@ -941,17 +1561,26 @@ template<class ForwardIterator, class Compare>
 ForwardIterator is_sorted_until(ForwardIterator first, ForwardIterator last,
                                 Compare comp);
 
-template<class RandomAccessIterator>
+template<class RandomAccessIterator, class Compare>
 inline
 void
   nth_element(RandomAccessIterator first, RandomAccessIterator nth,
-              RandomAccessIterator last);
+              RandomAccessIterator last, Compare comp)
+{
+  typedef typename iterator_traits<RandomAccessIterator>::value_type value_type;
+  if(nth != last)
+    __::nth_element(first, nth, last, comp, __::is_branchless_sortable<value_type, Compare>());
+}
 
-template<class RandomAccessIterator, class Compare>
+template<class RandomAccessIterator>
 inline
 void
   nth_element(RandomAccessIterator first, RandomAccessIterator nth,
-              RandomAccessIterator last, Compare comp);
+              RandomAccessIterator last)
+{
+  typedef typename iterator_traits<RandomAccessIterator>::value_type value_type;
+  nth_element(first, nth, last, less<value_type>());
+}
 
 ///\name 25.3.3, binary search:
 
@@ -0,0 +1,1266 @@
+/**\file*********************************************************************
+ *                                                                     \brief
+ *  Primitive numeric conversions [utility.to.chars]
+ *
+ ****************************************************************************
+ */
+#ifndef NTL__STLX_CHARCONV
+#define NTL__STLX_CHARCONV
+#pragma once
+
+#ifndef NTL__STLX_CSTDINT
+#include "cstdint.hxx"
+#endif
+#ifndef NTL__STLX_CSTRING
+#include "cstring.hxx"
+#endif
+#ifndef NTL__STLX_SYSTEM_ERROR
+#include "system_error.hxx"
+#endif
+#ifndef NTL__STLX_LIMITS
+#include "limits.hxx"
+#endif
+#ifndef NTL__EXT_INTEGER_CHARS
+#include "ext/integer_chars.hxx"
+#endif
+#ifndef NTL__EXT_FLOAT_PARSE
+#include "ext/float_parse.hxx"
+#endif
+
+namespace std
+{
+  /**
+   *	@addtogroup utilities
+   *  @{
+   *	@defgroup charconv Primitive numeric conversions [utility.to.chars]
+   *  The locale independent conversions which never allocate and never throw.
+   *  @{
+   **/
+
+#if defined(NTL_CXX_ENUM) || defined(NTL_DOC)
+  /// Floating point formatting style
+  enum class chars_format {
+    /** As by printf %e */
+    scientific  = 0x1,
+    /** As by printf %f */
+    fixed       = 0x2,
+    /** As by printf %a without the leading 0x */
+    hex         = 0x4,
+    /** As by printf %g */
+    general     = fixed | scientific
+  };
+#else
+  __class_enum(chars_format) {
+    scientific  = 0x1,
+    fixed       = 0x2,
+    hex         = 0x4,
+    general     = fixed | scientific
+  };};
+#endif
+
+  /** Result of to_chars(): the end of the characters written, or \c last and errc::value_too_large */
+  struct to_chars_result
+  {
+    char* ptr;
+    errc ec;
+  };
+
+  /** Result of from_chars(): the end of the number, or \c first and errc::invalid_argument */
+  struct from_chars_result
+  {
+    const char* ptr;
+    errc ec;
+  };
+
+  namespace __
+  {
+    /**
+     *	Floating point formatting engine.
+     *
+     *  The shortest round trip digits are generated by Grisu3 and the fixed count of digits by the counted Grisu,
+     *  both are checked and fall back to the exact big integer digit generation (Dragon4) in the rare cases
+     *  where the 64-bit approximation can't decide.
+     **/
+    namespace fp
+    {
+      /** The floating point value as its significand and binary exponent */
+      template<class T>
+      struct ieee_value
+      {
+        typedef ieee<T> traits;
+        typedef typename traits::bits_type bits_type;
+
+        explicit ieee_value(T v)
+        {
+          memcpy(&bits, &v, sizeof(bits));
+        }
+
+        bool negative() const { return (bits >> (sizeof(bits_type) * 8 - 1)) != 0; }
+        int biased_exponent() const { return static_cast<int>(bits >> traits::mantissa_bits) & traits::exponent_mask; }
+        uint64_t fraction() const { return bits & ((bits_type(1) << traits::mantissa_bits) - 1); }
+
+        bool special() const { return biased_exponent() == traits::exponent_mask; }
+        bool nan() const { return special() && fraction() != 0; }
+        bool zero() const { return (bits << 1) == 0; }
+
+        /** The value is significand() * 2^exponent() */
+        uint64_t significand() const
+        {
+          return biased_exponent() ? fraction() | (uint64_t(1) << traits::mantissa_bits) : fraction();
+        }
+        int exponent() const
+        {
+          const int e = biased_exponent();
+          return (e ? e : 1) - traits::exponent_bias - traits::mantissa_bits;
+        }
+        /** The lower neighbour is nearer than the upper one */
+        bool lower_closer() const
+        {
+          return fraction() == 0 && biased_exponent() > 1;
+        }
+
+        bits_type bits;
+      };
+
+      ///\name 64-bit floating point approximation
+      struct diy_fp
+      {
+        uint64_t f;
+        int e;
+      };
+
+      /** The upper 64 bits of the product, rounded */
+      inline diy_fp multiply(const diy_fp& x, const diy_fp& y)
+      {
+        const uint64_t mask = 0xFFFFFFFF;
+        const uint64_t a = x.f >> 32, b = x.f & mask, c = y.f >> 32, d = y.f & mask;
+        const uint64_t ac = a * c, bc = b * c, ad = a * d, bd = b * d;
+        const uint64_t middle = (bd >> 32) + (ad & mask) + (bc & mask) + (uint64_t(1) << 31);
+        const diy_fp r = { ac + (ad >> 32) + (bc >> 32) + (middle >> 32), x.e + y.e + 64 };
+        return r;
+      }
+
+      inline diy_fp normalize(diy_fp x)
+      {
+        while(!(x.f & 0xFFC0000000000000ULL))
+          x.f <<= 10, x.e -= 10;
+        while(!(x.f & 0x8000000000000000ULL))
+          x.f <<= 1, x.e--;
+        return x;
+      }
+
+      /** The normalized halfway points to the neighbours of the value, at the same exponent */
+      template<class T>
+      inline void boundaries(const ieee_value<T>& v, diy_fp& minus, diy_fp& plus)
+      {
+        const uint64_t f = v.significand();
+        const int e = v.exponent();
+        const diy_fp p = { (f << 1) + 1, e - 1 };
+        plus = normalize(p);
+        if(v.lower_closer())
+          minus.f = (f << 2) - 1, minus.e = e - 2;
+        else
+          minus.f = (f << 1) - 1, minus.e = e - 1;
+        minus.f <<= minus.e - plus.e;
+        minus.e = plus.e;
+      }
+
+      /** Powers of ten 10^k as the 64-bit significand f and the binary exponent e */
+      struct cached_power
+      {
+        uint64_t f;
+        int16_t e, k;
+      };
+
+      static const cached_power cached_powers[] =
+      {
+        { 0xFA8FD5A0081C0288ULL, -1220, -348 },
+        { 0xBAAEE17FA23EBF76ULL, -1193, -340 },
+        { 0x8B16FB203055AC76ULL, -1166, -332 },
+        { 0xCF42894A5DCE35EAULL, -1140, -324 },
+        { 0x9A6BB0AA55653B2DULL, -1113, -316 },
+        { 0xE61ACF033D1A45DFULL, -1087, -308 },
+        { 0xAB70FE17C79AC6CAULL, -1060, -300 },
+        { 0xFF77B1FCBEBCDC4FULL, -1034, -292 },
+        { 0xBE5691EF416BD60CULL, -1007, -284 },
+        { 0x8DD01FAD907FFC3CULL,  -980, -276 },
+        { 0xD3515C2831559A83ULL,  -954, -268 },
+        { 0x9D71AC8FADA6C9B5ULL,  -927, -260 },
+        { 0xEA9C227723EE8BCBULL,  -901, -252 },
+        { 0xAECC49914078536DULL,  -874, -244 },
+        { 0x823C12795DB6CE57ULL,  -847, -236 },
+        { 0xC21094364DFB5637ULL,  -821, -228 },
+        { 0x9096EA6F3848984FULL,  -794, -220 },
+        { 0xD77485CB25823AC7ULL,  -768, -212 },
+        { 0xA086CFCD97BF97F4ULL,  -741, -204 },
+        { 0xEF340A98172AACE5ULL,  -715, -196 },
+        { 0xB23867FB2A35B28EULL,  -688, -188 },
+        { 0x84C8D4DFD2C63F3BULL,  -661, -180 },
+        { 0xC5DD44271AD3CDBAULL,  -635, -172 },
+        { 0x936B9FCEBB25C996ULL,  -608, -164 },
+        { 0xDBAC6C247D62A584ULL,  -582, -156 },
+        { 0xA3AB66580D5FDAF6ULL,  -555, -148 },
+        { 0xF3E2F893DEC3F126ULL,  -529, -140 },
+        { 0xB5B5ADA8AAFF80B8ULL,  -502, -132 },
+        { 0x87625F056C7C4A8BULL,  -475, -124 },
+        { 0xC9BCFF6034C13053ULL,  -449, -116 },
+        { 0x964E858C91BA2655ULL,  -422, -108 },
+        { 0xDFF9772470297EBDULL,  -396, -100 },
+        { 0xA6DFBD9FB8E5B88FULL,  -369,  -92 },
+        { 0xF8A95FCF88747D94ULL,  -343,  -84 },
+        { 0xB94470938FA89BCFULL,  -316,  -76 },
+        { 0x8A08F0F8BF0F156BULL,  -289,  -68 },
+        { 0xCDB02555653131B6ULL,  -263,  -60 },
+        { 0x993FE2C6D07B7FACULL,  -236,  -52 },
+        { 0xE45C10C42A2B3B06ULL,  -210,  -44 },
+        { 0xAA242499697392D3ULL,  -183,  -36 },
+        { 0xFD87B5F28300CA0EULL,  -157,  -28 },
+        { 0xBCE5086492111AEBULL,  -130,  -20 },
+        { 0x8CBCCC096F5088CCULL,  -103,  -12 },
+        { 0xD1B71758E219652CULL,   -77,   -4 },
+        { 0x9C40000000000000ULL,   -50,    4 },
+        { 0xE8D4A51000000000ULL,   -24,   12 },
+        { 0xAD78EBC5AC620000ULL,     3,   20 },
+        { 0x813F3978F8940984ULL,    30,   28 },
+        { 0xC097CE7BC90715B3ULL,    56,   36 },
+        { 0x8F7E32CE7BEA5C70ULL,    83,   44 },
+        { 0xD5D238A4ABE98068ULL,   109,   52 },
+        { 0x9F4F2726179A2245ULL,   136,   60 },
+        { 0xED63A231D4C4FB27ULL,   162,   68 },
+        { 0xB0DE65388CC8ADA8ULL,   189,   76 },
+        { 0x83C7088E1AAB65DBULL,   216,   84 },
+        { 0xC45D1DF942711D9AULL,   242,   92 },
+        { 0x924D692CA61BE758ULL,   269,  100 },
+        { 0xDA01EE641A708DEAULL,   295,  108 },
+        { 0xA26DA3999AEF774AULL,   322,  116 },
+        { 0xF209787BB47D6B85ULL,   348,  124 },
+        { 0xB454E4A179DD1877ULL,   375,  132 },
+        { 0x865B86925B9BC5C2ULL,   402,  140 },
+        { 0xC83553C5C8965D3DULL,   428,  148 },
+        { 0x952AB45CFA97A0B3ULL,   455,  156 },
+        { 0xDE469FBD99A05FE3ULL,   481,  164 },
+        { 0xA59BC234DB398C25ULL,   508,  172 },
+        { 0xF6C69A72A3989F5CULL,   534,  180 },
+        { 0xB7DCBF5354E9BECEULL,   561,  188 },
+        { 0x88FCF317F22241E2ULL,   588,  196 },
+        { 0xCC20CE9BD35C78A5ULL,   614,  204 },
+        { 0x98165AF37B2153DFULL,   641,  212 },
+        { 0xE2A0B5DC971F303AULL,   667,  220 },
+        { 0xA8D9D1535CE3B396ULL,   694,  228 },
+        { 0xFB9B7CD9A4A7443CULL,   720,  236 },
+        { 0xBB764C4CA7A44410ULL,   747,  244 },
+        { 0x8BAB8EEFB6409C1AULL,   774,  252 },
+        { 0xD01FEF10A657842CULL,   800,  260 },
+        { 0x9B10A4E5E9913129ULL,   827,  268 },
+        { 0xE7109BFBA19C0C9DULL,   853,  276 },
+        { 0xAC2820D9623BF429ULL,   880,  284 },
+        { 0x80444B5E7AA7CF85ULL,   907,  292 },
+        { 0xBF21E44003ACDD2DULL,   933,  300 },
+        { 0x8E679C2F5E44FF8FULL,   960,  308 },
+        { 0xD433179D9C8CB841ULL,   986,  316 },
+        { 0x9E19DB92B4E31BA9ULL,  1013,  324 },
+        { 0xEB96BF6EBADF77D9ULL,  1039,  332 },
+        { 0xAF87023B9BF0EE6BULL,  1066,  340 }
+      };
+
+      static const int cached_powers_offset = 348, cached_powers_step = 8;
+
+      /** The scaled value has the exponent in this range, so its integral part fits 32 bits */
+      static const int min_target_exponent = -60, max_target_exponent = -32;
+
+      static const uint32_t small_powers_of_ten[] =
+      {
+        0, 1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000, 1000000000
+      };
+
+      /** floor(e * log10(2)) */
+      inline int floor_log10_pow2(int e)
+      {
+        return (e * 78913) >> 18;
+      }
+
+      /** The cached power of ten which scales the normalized value with the exponent \p e into the target range, and its decimal exponent */
+      inline diy_fp cached_power_for(int e, int& k)
+      {
+        const int x = min_target_exponent - (e + 64) + 63;
+        const int dk = floor_log10_pow2(x) + (x != 0);
+        const cached_power& c = cached_powers[(cached_powers_offset + dk - 1) / cached_powers_step + 1];
+        k = c.k;
+        const diy_fp p = { c.f, c.e };
+        return p;
+      }
+
+      /** The largest power of ten not above \p number and its exponent plus one */
+      inline uint32_t biggest_power_of_ten(uint32_t number, int number_bits, int& exponent_plus_one)
+      {
+        int guess = ((number_bits + 1) * 1233 >> 12) + 1;
+        if(number < small_powers_of_ten[guess])
+          guess--;
+        exponent_plus_one = guess;
+        return small_powers_of_ten[guess];
+      }
+
+      ///\name Grisu3
+
+      /** Moves the last digit down towards \p w while it stays in the safe interval, fails if the result is ambiguous */
+      inline bool round_weed(char* buffer, int length, uint64_t distance_too_high_w, uint64_t unsafe_interval, uint64_t rest, uint64_t ten_kappa, uint64_t unit)
+      {
+        const uint64_t small_distance = distance_too_high_w - unit, big_distance = distance_too_high_w + unit;
+        while(rest < small_distance && unsafe_interval - rest >= ten_kappa
+          && (rest + ten_kappa < small_distance || small_distance - rest >= rest + ten_kappa - small_distance)){
+          buffer[length - 1]--;
+          rest += ten_kappa;
+        }
+        if(rest < big_distance && unsafe_interval - rest >= ten_kappa
+          && (rest + ten_kappa < big_distance || big_distance - rest > rest + ten_kappa - big_distance))
+          return false;
+        return 2 * unit <= rest && rest <= unsafe_interval - 4 * unit;
+      }
+
+      inline bool digit_gen(const diy_fp& low, const diy_fp& w, const diy_fp& high, char* buffer, int& length, int& kappa)
+      {
+        uint64_t unit = 1;
+        const diy_fp too_low = { low.f - unit, low.e }, too_high = { high.f + unit, high.e };
+        uint64_t unsafe_interval = too_high.f - too_low.f;
+        const unsigned shift = static_cast<unsigned>(-w.e);
+        const uint64_t one = uint64_t(1) << shift;
+        uint32_t integrals = static_cast<uint32_t>(too_high.f >> shift);
+        uint64_t fractionals = too_high.f & (one - 1);
+        uint32_t divisor = biggest_power_of_ten(integrals, 64 - shift, kappa);
+        length = 0;
+
+        while(kappa > 0){
+          buffer[length++] = static_cast<char>('0' + integrals / divisor);
+          integrals %= divisor;
+          kappa--;
+          const uint64_t rest = (static_cast<uint64_t>(integrals) << shift) + fractionals;
+          if(rest < unsafe_interval)
+            return round_weed(buffer, length, too_high.f - w.f, unsafe_interval, rest, static_cast<uint64_t>(divisor) << shift, unit);
+          divisor /= 10;
+        }
+        for(;;){
+          fractionals *= 10;
+          unit *= 10;
+          unsafe_interval *= 10;
+          buffer[length++] = static_cast<char>('0' + (fractionals >> shift));
+          fractionals &= one - 1;
+          kappa--;
+          if(fractionals < unsafe_interval)
+            return round_weed(buffer, length, (too_high.f - w.f) * unit, unsafe_interval, fractionals, one, unit);
+        }
+      }
+
+      /** The shortest digits which read back as \p v: v = digits * 10^exponent, or false if the approximation is not precise enough */
+      template<class T>
+      inline bool grisu_shortest(const ieee_value<T>& v, char* buffer, int& length, int& exponent)
+      {
+        const diy_fp x = { v.significand(), v.exponent() };
+        const diy_fp w = normalize(x);
+        diy_fp minus, plus;
+        boundaries(v, minus, plus);
+        int mk, kappa;
+        const diy_fp ten_mk = cached_power_for(w.e, mk);
+        const bool ok = digit_gen(multiply(minus, ten_mk), multiply(w, ten_mk), multiply(plus, ten_mk), buffer, length, kappa);
+        exponent = kappa - mk;
+        return ok;
+      }
+
+      /** Rounds the last digit by the rest, fails if the error makes the rounding direction unknown */
+      inline bool round_weed_counted(char* buffer, int length, uint64_t rest, uint64_t ten_kappa, uint64_t unit, int& kappa)
+      {
+        if(unit >= ten_kappa || ten_kappa - unit <= unit)
+          return false;
+        if(ten_kappa - rest > rest && ten_kappa - 2 * rest >= 2 * unit)
+          return true;
+        if(rest > unit && ten_kappa - (rest - unit) <= rest - unit){
+          buffer[length - 1]++;
+          for(int i = length - 1; i > 0 && buffer[i] == '0' + 10; i--){
+            buffer[i] = '0';
+            buffer[i - 1]++;
+          }
+          if(buffer[0] == '0' + 10){
+            buffer[0] = '1';
+            kappa++;
+          }
+          return true;
+        }
+        return false;
+      }
+
+      inline bool digit_gen_counted(const diy_fp& w, int count, char* buffer, int& length, int& kappa)
+      {
+        uint64_t error = 1;
+        const unsigned shift = static_cast<unsigned>(-w.e);
+        const uint64_t one = uint64_t(1) << shift;
+        uint32_t integrals = static_cast<uint32_t>(w.f >> shift);
+        uint64_t fractionals = w.f & (one - 1);
+        uint32_t divisor = biggest_power_of_ten(integrals, 64 - shift, kappa);
+        length = 0;
+
+        while(kappa > 0){
+          buffer[length++] = static_cast<char>('0' + integrals / divisor);
+          integrals %= divisor;
+          kappa--;
+          if(--count == 0)
+            break;
+          divisor /= 10;
+        }
+        if(count == 0)
+          return round_weed_counted(buffer, length, (static_cast<uint64_t>(integrals) << shift) + fractionals, static_cast<uint64_t>(divisor) << shift, error, kappa);
+
+        while(count > 0 && fractionals > error){
+          fractionals *= 10;
+          error *= 10;
+          buffer[length++] = static_cast<char>('0' + (fractionals >> shift));
+          fractionals &= one - 1;
+          kappa--;
+          count--;
+        }
+        return count == 0 && round_weed_counted(buffer, length, fractionals, one, error, kappa);
+      }
+
+      /** The \p count correctly rounded digits of \p v: v ~ digits * 10^exponent, or false if the approximation is not precise enough */
+      template<class T>
+      inline bool grisu_counted(const ieee_value<T>& v, int count, char* buffer, int& length, int& exponent)
+      {
+        const diy_fp x = { v.significand(), v.exponent() };
+        const diy_fp w = normalize(x);
+        int mk, kappa;
+        const diy_fp ten_mk = cached_power_for(w.e, mk);
+        const bool ok = digit_gen_counted(multiply(w, ten_mk), count, buffer, length, kappa);
+        exponent = kappa - mk;
+        return ok;
+      }
+
+      ///\name Exact digit generation
+
+      /** Unsigned integer large enough to scale any double by a power of ten */
+      class bignum
+      {
+        static const int capacity = 40;
+      public:
+        explicit bignum(uint64_t v = 0)
+        {
+          assign(v);
+        }
+
+        void assign(uint64_t v)
+        {
+          size = 0;
+          for(; v; v >>= 32)
+            limbs[size++] = static_cast<uint32_t>(v);
+        }
+
+        void multiply(uint32_t m)
+        {
+          uint64_t carry = 0;
+          for(int i = 0; i < size; i++){
+            carry += static_cast<uint64_t>(limbs[i]) * m;
+            limbs[i] = static_cast<uint32_t>(carry);
+            carry >>= 32;
+          }
+          if(carry)
+            limbs[size++] = static_cast<uint32_t>(carry);
+        }
+
+        void multiply_pow10(int k)
+        {
+          for(; k >= 9; k -= 9)
+            multiply(1000000000);
+          if(k)
+            multiply(small_powers_of_ten[k + 1]);
+        }
+
+        void shift_left(int bits)
+        {
+          if(!size || !bits)
+            return;
+          const int words = bits / 32, rest = bits % 32;
+          if(rest){
+            uint32_t carry = 0;
+            for(int i = 0; i < size; i++){
+              const uint32_t l = limbs[i];
+              limbs[i] = (l << rest) | carry;
+              carry = l >> (32 - rest);
+            }
+            if(carry)
+              limbs[size++] = carry;
+          }
+          if(words){
+            for(int i = size - 1; i >= 0; i--)
+              limbs[i + words] = limbs[i];
+            for(int i = 0; i < words; i++)
+              limbs[i] = 0;
+            size += words;
+          }
+        }
+
+        void add(const bignum& b)
+        {
+          uint64_t carry = 0;
+          int i = 0;
+          for(; i < b.size || (carry && i < size); i++){
+            carry += static_cast<uint64_t>(i < size ? limbs[i] : 0) + (i < b.size ? b.limbs[i] : 0);
+            limbs[i] = static_cast<uint32_t>(carry);
+            carry >>= 32;
+          }
+          if(i > size)
+            size = i;
+          if(carry)
+            limbs[size++] = static_cast<uint32_t>(carry);
+        }
+
+        /** this -= b, b is not greater */
+        void subtract(const bignum& b)
+        {
+          int64_t borrow = 0;
+          for(int i = 0; i < size; i++){
+            borrow += static_cast<int64_t>(limbs[i]) - (i < b.size ? b.limbs[i] : 0);
+            limbs[i] = static_cast<uint32_t>(borrow);
+            borrow >>= 32;
+          }
+          while(size && !limbs[size - 1])
+            size--;
+        }
+
+        friend int compare(const bignum& a, const bignum& b)
+        {
+          if(a.size != b.size)
+            return a.size < b.size ? -1 : 1;
+          for(int i = a.size - 1; i >= 0; i--)
+            if(a.limbs[i] != b.limbs[i])
+              return a.limbs[i] < b.limbs[i] ? -1 : 1;
+          return 0;
+        }
+
+        /** Compares a + b with c */
+        friend int plus_compare(const bignum& a, const bignum& b, const bignum& c)
+        {
+          bignum sum(a);
+          sum.add(b);
+          return compare(sum, c);
+        }
+
+        /** Divides by \p s when the quotient is a single digit and leaves the remainder */
+        unsigned divide_digit(const bignum& s)
+        {
+          unsigned q = 0;
+          while(compare(*this, s) >= 0){
+            subtract(s);
+            q++;
+          }
+          return q;
+        }
+
+        bool empty() const { return size == 0; }
+
+      private:
+        uint32_t limbs[capacity];
+        int size;
+      };
+
+      /** Bit length of the nonzero value */
+      inline int bit_length(uint64_t f)
+      {
+        int n = 0;
+        for(; f; f >>= 1)
+          n++;
+        return n;
+      }
+
+      /** Upper digits of \p v, the ones past this count are zeros */
+      static const int max_exact_digits = 120;
+
+      /** Propagates the increment of the last digit, returns true if all of them were nines */
+      inline bool round_up(char* buffer, int length)
+      {
+        for(int i = length - 1; i >= 0; i--){
+          if(buffer[i] != '9'){
+            buffer[i]++;
+            return false;
+          }
+          buffer[i] = '0';
+        }
+        buffer[0] = '1';
+        return true;
+      }
+
+      /** The shortest digits which read back as \p v, the exact way; returns the decimal point position: v = 0.digits * 10^point */
+      template<class T>
+      inline int dragon_shortest(const ieee_value<T>& v, char* buffer, int& length)
+      {
+        const uint64_t f = v.significand();
+        const int e = v.exponent();
+        const bool even = (f & 1) == 0, closer = v.lower_closer();
+        const int scale = closer ? 2 : 1;
+
+        // v = r / s, the margins to the neighbours are mp / s and mm / s
+        bignum r(f), s(1), mp(1), mm(1);
+        if(e >= 0){
+          r.shift_left(e + scale);
+          s.shift_left(scale);
+          mp.shift_left(e + scale - 1);
+          mm.shift_left(e);
+        }else{
+          r.shift_left(scale);
+          s.shift_left(scale - e);
+          mp.shift_left(scale - 1);
+        }
+
+        int k = floor_log10_pow2(e + bit_length(f) - 1) + 1;
+        if(k >= 0){
+          s.multiply_pow10(k);
+        }else{
+          r.multiply_pow10(-k);
+          mp.multiply_pow10(-k);
+          mm.multiply_pow10(-k);
+        }
+        while(plus_compare(r, mp, s) >= (even ? 0 : 1)){
+          s.multiply(10);
+          k++;
+        }
+
+        length = 0;
+        for(;;){
+          r.multiply(10);
+          mp.multiply(10);
+          mm.multiply(10);
+          unsigned digit = r.divide_digit(s);
+          const bool low = compare(r, mm) < (even ? 1 : 0), high = plus_compare(r, mp, s) >= (even ? 0 : 1);
+          if(!low && !high){
+            buffer[length++] = static_cast<char>('0' + digit);
+            continue;
+          }
+          if(low && high){
+            const int c = plus_compare(r, r, s);
+            if(c > 0 || (c == 0 && (digit & 1)))
+              digit++;
+          }else if(high){
+            digit++;
+          }
+          if(digit == 10){
+            buffer[length++] = '9';
+            if(round_up(buffer, length))
+              k++;
+          }else{
+            buffer[length++] = static_cast<char>('0' + digit);
+          }
+          break;
+        }
+        return k;
+      }
+
+      /**
+       *	The correctly rounded digits of \p v, the exact way; returns the decimal point position: v ~ 0.digits * 10^point.
+       *  \p count is the number of the significant digits or of the digits after the decimal point if \p fixed.
+       *  The ties are rounded to even. No digits are generated if the value rounds to zero.
+       **/
+      template<class T>
+      inline int dragon_counted(const ieee_value<T>& v, bool fixed, int count, char* buffer, int& length)
+      {
+        const uint64_t f = v.significand();
+        const int e = v.exponent();
+        bignum r(f), s(1);
+        if(e >= 0)
+          r.shift_left(e);
+        else
+          s.shift_left(-e);
+
+        int k = floor_log10_pow2(e + bit_length(f) - 1) + 1;
+        if(k >= 0)
+          s.multiply_pow10(k);
+        else
+          r.multiply_pow10(-k);
+        while(compare(r, s) >= 0){
+          s.multiply(10);
+          k++;
+        }
+
+        length = 0;
+        const int n = fixed ? k + count : count;
+        if(n < 0)
+          return k;
+        if(n == 0){
+          // rounds either to zero or to the unit of the last place
+          if(plus_compare(r, r, s) > 0){
+            buffer[length++] = '1';
+            k++;
+          }
+          return k;
+        }
+
+        const int digits = n < max_exact_digits ? n : max_exact_digits;
+        unsigned digit = 0;
+        while(length < digits){
+          r.multiply(10);
+          digit = r.divide_digit(s);
+          buffer[length++] = static_cast<char>('0' + digit);
+        }
+        const int c = plus_compare(r, r, s);
+        if((c > 0 || (c == 0 && (digit & 1))) && round_up(buffer, length))
+          k++;
+        return k;
+      }
+
+      /** The shortest digits which read back as nonzero finite \p v; returns the decimal point position */
+      template<class T>
+      inline int shortest(const ieee_value<T>& v, char* buffer, int& length)
+      {
+        int exponent;
+        if(grisu_shortest(v, buffer, length, exponent))
+          return length + exponent;
+        return dragon_shortest(v, buffer, length);
+      }
+
+      /** The correctly rounded digits of finite \p v as by dragon_counted(); returns the decimal point position */
+      template<class T>
+      inline int counted(const ieee_value<T>& v, bool fixed, int count, char* buffer, int& length)
+      {
+        if(v.zero()){
+          length = 0;
+          return 1;
+        }
+        int exponent, n = count;
+        if(fixed){
+          // the decimal point is either k or k + 1, try for the latter
+          const int k = floor_log10_pow2(v.exponent() + bit_length(v.significand()) - 1) + 1;
+          n = k + 1 + count;
+          if(n > 0 && n <= ieee<T>::max_digits10 && grisu_counted(v, n, buffer, length, exponent)){
+            if(length + exponent != k)
+              return length + exponent;
+            // one digit too much
+            if(--n > 0 && grisu_counted(v, n, buffer, length, exponent))
+              return length + exponent;
+          }
+        }else if(n <= ieee<T>::max_digits10 && grisu_counted(v, n, buffer, length, exponent)){
+          return length + exponent;
+        }
+        return dragon_counted(v, fixed, count, buffer, length);
+      }
+
+      ///\name Character layout
+
+      /** Formatting request flags */
+      enum format_flags
+      {
+        showpos   = 0x01,
+        showpoint = 0x02,
+        uppercase = 0x04,
+        hexprefix = 0x08
+      };
+
+      /** Formatting style, same as chars_format; the shortest style is the shorter of the fixed and scientific ones */
+      enum style
+      {
+        shortest_style    = 0,
+        scientific_style  = 1,
+        fixed_style       = 2,
+        general_style     = 3,
+        hex_style         = 4
+      };
+
+      /**
+       *	@brief Characters of the formatted value: [sign][prefix]integral[.fraction][exponent]
+       *
+       *  The integral and fraction digits are taken in turn from \c digits, which are padded with zeros.
+       **/
+      struct layout
+      {
+        char digits[max_exact_digits + 8];
+        int length;
+        /** count of the integral digits, none stands for a single zero */
+        int integral;
+        /** zeros after the decimal point and the digits after them */
+        int fraction_zeros, fraction;
+        bool point, grouped;
+        char sign;
+        const char* prefix;
+        char exponent[8];
+        int exponent_length;
+
+        char digit(int i) const { return i < length ? digits[i] : '0'; }
+      };
+
+      inline void set_exponent(layout& l, char marker, int x, int min_digits)
+      {
+        char* p = l.exponent;
+        *p++ = marker;
+        *p++ = x < 0 ? '-' : '+';
+        const unsigned u = static_cast<unsigned>(x < 0 ? -x : x);
+        const int digits = u >= 1000 ? 4 : u >= 100 ? 3 : u >= 10 ? 2 : 1;
+        for(int i = (digits > min_digits ? digits : min_digits) - 1, v = u; i >= 0; i--, v /= 10)
+          p[i] = static_cast<char>('0' + v % 10);
+        l.exponent_length = 2 + (digits > min_digits ? digits : min_digits);
+      }
+
+      /** The digits with the decimal point at \p point and \p precision digits after it */
+      inline void fixed_layout(layout& l, int point, int precision, bool showpoint)
+      {
+        l.integral = point > 0 ? point : 0;
+        l.fraction_zeros = point < 0 ? (-point < precision ? -point : precision) : 0;
+        l.fraction = precision - l.fraction_zeros;
+        l.point = precision > 0 || showpoint;
+        l.grouped = true;
+      }
+
+      /** One digit before the decimal point, \p precision digits after it and the decimal exponent \p x */
+      inline void scientific_layout(layout& l, int x, int precision, bool showpoint, bool upper)
+      {
+        l.integral = 1;
+        l.fraction = precision;
+        l.point = precision > 0 || showpoint;
+        set_exponent(l, upper ? 'E' : 'e', x, 2);
+      }
+
+      inline int fixed_size(int length, int point)
+      {
+        const int fraction = length > point ? length - point : 0;
+        return (point > 0 ? point : 1) + (fraction ? fraction + 1 : 0);
+      }
+
+      inline int scientific_size(int length, int point)
+      {
+        const int x = point - 1;
+        return length + (length > 1) + ((x < 0 ? -x : x) >= 100 ? 5 : 4);
+      }
+
+      /** As by printf %a: the hexadecimal significand, rounded to \p precision digits if not negative, and the binary exponent */
+      template<class T>
+      inline void hex_layout(layout& l, const ieee_value<T>& v, int precision, unsigned flags)
+      {
+        typedef ieee<T> traits;
+        static const int hex_digits = (traits::mantissa_bits + 3) / 4;
+        const char* const xdigits = (flags & uppercase) ? "0123456789ABCDEF" : "0123456789abcdef";
+
+        // the leading digit and the fraction digits
+        uint64_t m = v.significand() << (hex_digits * 4 - traits::mantissa_bits);
+        const int x = v.zero() ? 0 : v.exponent() + traits::mantissa_bits;
+
+        int digits = hex_digits;
+        if(precision >= 0 && precision < hex_digits){
+          const int drop = (hex_digits - precision) * 4;
+          const uint64_t rest = m & ((uint64_t(1) << drop) - 1), half = uint64_t(1) << (drop - 1);
+          m >>= drop;
+          if(rest > half || (rest == half && (m & 1)))
+            m++;
+          digits = precision;
+        }else if(precision < 0){
+          while(digits && !(m & 0xF))
+            m >>= 4, digits--;
+        }
+        l.digits[0] = xdigits[m >> (digits * 4)];
+        for(int i = digits; i > 0; i--, m >>= 4)
+          l.digits[i] = xdigits[m & 0xF];
+        l.length = digits + 1;
+        l.integral = 1;
+        l.fraction = precision > digits ? precision : digits;
+        l.point = l.fraction > 0 || (flags & showpoint);
+        if(flags & hexprefix)
+          l.prefix = (flags & uppercase) ? "0X" : "0x";
+        set_exponent(l, (flags & uppercase) ? 'P' : 'p', x, 1);
+      }
+
+      /**
+       *	Lays out \p v in the \p style with the \p precision as printf does, or the shortest digits to read it back if \p precision is negative.
+       *  The general style with a precision strips the trailing zeros unless the \c showpoint flag is given.
+       **/
+      template<class T>
+      inline void format(layout& l, T value, style kind, int precision, unsigned flags)
+      {
+        const ieee_value<T> v(value);
+        const bool upper = (flags & uppercase) != 0, showpoint = (flags & fp::showpoint) != 0;
+        l.sign = v.negative() ? '-' : (flags & showpos) ? '+' : 0;
+        l.prefix = "";
+        l.fraction_zeros = l.fraction = l.exponent_length = 0;
+        l.point = l.grouped = false;
+
+        if(v.special()){
+          memcpy(l.digits, v.nan() ? (upper ? "NAN" : "nan") : (upper ? "INF" : "inf"), 3);
+          l.length = l.integral = 3;
+          return;
+        }
+        if(kind == hex_style){
+          hex_layout(l, v, precision, flags);
+          return;
+        }
+
+        if(precision < 0){
+          int point = 1;
+          if(v.zero())
+            l.digits[0] = '0', l.length = 1;
+          else
+            point = shortest(v, l.digits, l.length);
+          if(kind == scientific_style || (kind != fixed_style
+            && (fixed_size(l.length, point) > scientific_size(l.length, point) || (kind == general_style && point <= -4)))){
+            scientific_layout(l, point - 1, l.length - 1, showpoint, upper);
+            return;
+          }
+          const int fraction = l.length > point ? l.length - point : 0;
+          // the integral value is exact rather than padded with zeros
+          if(point > l.length)
+            point = counted(v, true, 0, l.digits, l.length);
+          fixed_layout(l, point, fraction, showpoint);
+          return;
+        }
+
+        if(kind == fixed_style){
+          fixed_layout(l, counted(v, true, precision, l.digits, l.length), precision, showpoint);
+        }else if(kind == scientific_style){
+          scientific_layout(l, counted(v, false, precision + 1, l.digits, l.length) - 1, precision, showpoint, upper);
+        }else{
+          const int p = precision ? precision : 1;
+          const int point = counted(v, false, p, l.digits, l.length), x = point - 1;
+          int significant = l.length;
+          while(significant > 0 && l.digits[significant - 1] == '0')
+            significant--;
+          if(x < p && x >= -4){
+            const int fraction = showpoint ? p - point : significant > point ? significant - point : 0;
+            fixed_layout(l, point, fraction, showpoint);
+          }else{
+            scientific_layout(l, x, showpoint ? p - 1 : significant > 1 ? significant - 1 : 0, showpoint, upper);
+          }
+        }
+      }
+
+      /** A group separator follows the integral digit with \p right digits after it */
+      inline bool group_boundary(const char* grouping, size_t groups, int right)
+      {
+        int pos = 0;
+        for(size_t i = 0; i < groups; i++){
+          const int g = grouping[i];
+          if(g <= 0 || g == CHAR_MAX)
+            return false;
+          pos += g;
+          if(pos >= right)
+            return pos == right;
+          if(i + 1 == groups)
+            return (right - pos) % g == 0;
+        }
+        return false;
+      }
+
+      inline size_t separators(const layout& l, const char* grouping, size_t groups)
+      {
+        size_t n = 0;
+        if(l.grouped && groups)
+          for(int right = 1; right < l.integral; right++)
+            n += group_boundary(grouping, groups, right);
+        return n;
+      }
+
+      /** The sign and the prefix length */
+      inline size_t prefix_size(const layout& l)
+      {
+        return (l.sign != 0) + strlen(l.prefix);
+      }
+
+      /** Count of the characters laid out, including the group separators */
+      inline size_t size(const layout& l, const char* grouping = nullptr, size_t groups = 0)
+      {
+        return prefix_size(l) + (l.integral ? l.integral : 1) + separators(l, grouping, groups)
+          + l.point + l.fraction_zeros + l.fraction + l.exponent_length;
+      }
+
+      template<class charT, class OutputIterator>
+      inline OutputIterator put_prefix(const layout& l, OutputIterator out)
+      {
+        if(l.sign)
+          *out = static_cast<charT>(l.sign), ++out;
+        for(const char* p = l.prefix; *p; ++p)
+          *out = static_cast<charT>(*p), ++out;
+        return out;
+      }
+
+      /** Writes the digits, the decimal point and the exponent */
+      template<class charT, class OutputIterator>
+      inline OutputIterator put_number(const layout& l, OutputIterator out, charT decimal_point, charT thousands_sep = charT(), const char* grouping = nullptr, size_t groups = 0)
+      {
+        if(!l.integral){
+          *out = static_cast<charT>('0'), ++out;
+        }else{
+          const bool grouped = l.grouped && groups;
+          for(int i = 0; i < l.integral; i++){
+            *out = static_cast<charT>(l.digit(i)), ++out;
+            if(grouped && i + 1 < l.integral && group_boundary(grouping, groups, l.integral - 1 - i))
+              *out = thousands_sep, ++out;
+          }
+        }
+        if(l.point)
+          *out = decimal_point, ++out;
+        for(int i = 0; i < l.fraction_zeros; i++)
+          *out = static_cast<charT>('0'), ++out;
+        for(int i = 0; i < l.fraction; i++)
+          *out = static_cast<charT>(l.digit(l.integral + i)), ++out;
+        for(int i = 0; i < l.exponent_length; i++)
+          *out = static_cast<charT>(l.exponent[i]), ++out;
+        return out;
+      }
+
+      template<class T>
+      inline to_chars_result to_chars(char* first, char* last, T value, style kind, int precision)
+      {
+        layout l;
+        format(l, value, kind, precision, 0);
+        to_chars_result r;
+        if(static_cast<size_t>(last - first) < size(l)){
+          r.ptr = last;
+          r.ec = errc::value_too_large;
+        }else{
+          r.ptr = put_number(l, put_prefix<char>(l, first), '.');
+          r.ec = errc();
+        }
+        return r;
+      }
+    }
+  }
+
+  ///\name Integer output
+  namespace __
+  {
+    namespace intconv
+    {
+      template<class T>
+      inline to_chars_result to_chars(char* first, char* last, T value, int base)
+      {
+        to_chars_result r;
+        bool negative;
+        const typename magnitude<T>::type u = absolute(value, negative);
+        const size_t n = negative + length(u, static_cast<unsigned>(base));
+        if(static_cast<size_t>(last - first) < n){
+          r.ptr = last;
+          r.ec = errc::value_too_large;
+        }else{
+          if(negative)
+            *first = '-';
+          r.ptr = first + n;
+          put_digits(r.ptr, u, static_cast<unsigned>(base));
+          r.ec = errc();
+        }
+        return r;
+      }
+
+      template<class T>
+      inline from_chars_result from_chars(const char* first, const char* last, T& value, int base)
+      {
+        typedef typename magnitude<T>::type U;
+        from_chars_result r = { first, errc::invalid_argument };
+        const bool negative = is_signed_type<T>() && first != last && *first == '-';
+        const char* const digits = first + negative;
+        U u;
+        bool overflow;
+        const char* const end = parse(digits, last, u, static_cast<unsigned>(base), overflow);
+        if(end == digits)
+          return r;
+        r.ptr = end;
+        const U limit = static_cast<U>(numeric_limits<T>::__max) + negative;
+        if(overflow || u > limit){
+          r.ec = errc::result_out_of_range;
+        }else{
+          value = static_cast<T>(negative ? U(0) - u : u);
+          r.ec = errc();
+        }
+        return r;
+      }
+    }
+  }
+
+  /** The digits of \p value in \p base (2 to 36) with the lowercase letters, preceded by '-' for the negative values */
+  inline to_chars_result to_chars(char* first, char* last, char value, int base = 10)
+  {
+    return __::intconv::to_chars(first, last, value, base);
+  }
+  inline to_chars_result to_chars(char* first, char* last, signed char value, int base = 10)
+  {
+    return __::intconv::to_chars(first, last, value, base);
+  }
+  inline to_chars_result to_chars(char* first, char* last, unsigned char value, int base = 10)
+  {
+    return __::intconv::to_chars(first, last, value, base);
+  }
+  inline to_chars_result to_chars(char* first, char* last, short value, int base = 10)
+  {
+    return __::intconv::to_chars(first, last, value, base);
+  }
+  inline to_chars_result to_chars(char* first, char* last, unsigned short value, int base = 10)
+  {
+    return __::intconv::to_chars(first, last, value, base);
+  }
+  inline to_chars_result to_chars(char* first, char* last, int value, int base = 10)
+  {
+    return __::intconv::to_chars(first, last, value, base);
+  }
+  inline to_chars_result to_chars(char* first, char* last, unsigned int value, int base = 10)
+  {
+    return __::intconv::to_chars(first, last, value, base);
+  }
+  inline to_chars_result to_chars(char* first, char* last, long value, int base = 10)
+  {
+    return __::intconv::to_chars(first, last, value, base);
+  }
+  inline to_chars_result to_chars(char* first, char* last, unsigned long value, int base = 10)
+  {
+    return __::intconv::to_chars(first, last, value, base);
+  }
+  inline to_chars_result to_chars(char* first, char* last, long long value, int base = 10)
+  {
+    return __::intconv::to_chars(first, last, value, base);
+  }
+  inline to_chars_result to_chars(char* first, char* last, unsigned long long value, int base = 10)
+  {
+    return __::intconv::to_chars(first, last, value, base);
+  }
+  to_chars_result to_chars(char* first, char* last, bool value, int base = 10) __deleted;
+  ///\}
+
+  ///\name Integer input
+
+  /**
+   *	Parses the integer in \p base (2 to 36), the letters are the digits from 10 in either case.
+   *  The only sign accepted is '-' and only for the signed types, there is no base prefix and no leading whitespace.
+   *  The \p value is left unchanged when there are no digits or the number is out of its range.
+   **/
+  inline from_chars_result from_chars(const char* first, const char* last, char& value, int base = 10)
+  {
+    return __::intconv::from_chars(first, last, value, base);
+  }
+  inline from_chars_result from_chars(const char* first, const char* last, signed char& value, int base = 10)
+  {
+    return __::intconv::from_chars(first, last, value, base);
+  }
+  inline from_chars_result from_chars(const char* first, const char* last, unsigned char& value, int base = 10)
+  {
+    return __::intconv::from_chars(first, last, value, base);
+  }
+  inline from_chars_result from_chars(const char* first, const char* last, short& value, int base = 10)
+  {
+    return __::intconv::from_chars(first, last, value, base);
+  }
+  inline from_chars_result from_chars(const char* first, const char* last, unsigned short& value, int base = 10)
+  {
+    return __::intconv::from_chars(first, last, value, base);
+  }
+  inline from_chars_result from_chars(const char* first, const char* last, int& value, int base = 10)
+  {
+    return __::intconv::from_chars(first, last, value, base);
+  }
+  inline from_chars_result from_chars(const char* first, const char* last, unsigned int& value, int base = 10)
+  {
+    return __::intconv::from_chars(first, last, value, base);
+  }
+  inline from_chars_result from_chars(const char* first, const char* last, long& value, int base = 10)
+  {
+    return __::intconv::from_chars(first, last, value, base);
+  }
+  inline from_chars_result from_chars(const char* first, const char* last, unsigned long& value, int base = 10)
+  {
+    return __::intconv::from_chars(first, last, value, base);
+  }
+  inline from_chars_result from_chars(const char* first, const char* last, long long& value, int base = 10)
+  {
+    return __::intconv::from_chars(first, last, value, base);
+  }
+  inline from_chars_result from_chars(const char* first, const char* last, unsigned long long& value, int base = 10)
+  {
+    return __::intconv::from_chars(first, last, value, base);
+  }
+  ///\}
+
+  ///\name Floating point output
+
+  /** The shortest characters which read back as \p value, in the fixed or the scientific style, whichever is shorter */
+  inline to_chars_result to_chars(char* first, char* last, float value)
+  {
+    return __::fp::to_chars(first, last, value, __::fp::shortest_style, -1);
+  }
+  inline to_chars_result to_chars(char* first, char* last, double value)
+  {
+    return __::fp::to_chars(first, last, value, __::fp::shortest_style, -1);
+  }
+  inline to_chars_result to_chars(char* first, char* last, long double value)
+  {
+    return __::fp::to_chars(first, last, static_cast<double>(value), __::fp::shortest_style, -1);
+  }
+
+  /** The shortest characters which read back as \p value in the \p fmt style */
+  inline to_chars_result to_chars(char* first, char* last, float value, chars_format fmt)
+  {
+    return __::fp::to_chars(first, last, value, static_cast<__::fp::style>(static_cast<int>(fmt)), -1);
+  }
+  inline to_chars_result to_chars(char* first, char* last, double value, chars_format fmt)
+  {
+    return __::fp::to_chars(first, last, value, static_cast<__::fp::style>(static_cast<int>(fmt)), -1);
+  }
+  inline to_chars_result to_chars(char* first, char* last, long double value, chars_format fmt)
+  {
+    return __::fp::to_chars(first, last, static_cast<double>(value), static_cast<__::fp::style>(static_cast<int>(fmt)), -1);
+  }
+
+  /** \p value as by printf in the \p fmt style with the \p precision; the digits past the 120th significant one are zeros */
+  inline to_chars_result to_chars(char* first, char* last, float value, chars_format fmt, int precision)
+  {
+    return __::fp::to_chars(first, last, value, static_cast<__::fp::style>(static_cast<int>(fmt)), precision < 0 ? 6 : precision);
+  }
+  inline to_chars_result to_chars(char* first, char* last, double value, chars_format fmt, int precision)
+  {
+    return __::fp::to_chars(first, last, value, static_cast<__::fp::style>(static_cast<int>(fmt)), precision < 0 ? 6 : precision);
+  }
+  inline to_chars_result to_chars(char* first, char* last, long double value, chars_format fmt, int precision)
+  {
+    return __::fp::to_chars(first, last, static_cast<double>(value), static_cast<__::fp::style>(static_cast<int>(fmt)), precision < 0 ? 6 : precision);
+  }
+  ///\}
+
+  ///\name Floating point input
+  namespace __
+  {
+    namespace fp
+    {
+      template<class T>
+      inline from_chars_result from_chars(const char* first, const char* last, T& value, chars_format fmt)
+      {
+        from_chars_result r;
+        T v;
+        parse_status status;
+        r.ptr = parse(first, last, static_cast<int>(fmt), v, status);
+        if(!r.ptr){
+          r.ptr = first;
+          r.ec = errc::invalid_argument;
+        }else if(status == parse_out_of_range){
+          r.ec = errc::result_out_of_range;
+        }else{
+          value = v;
+          r.ec = errc();
+        }
+        return r;
+      }
+    }
+  }
+
+  /**
+   *	Parses the floating point number in the \p fmt style, correctly rounded to nearest.
+   *  The only sign accepted is '-', the hexadecimal numbers are written without the "0x" prefix.
+   *  The \p value is left unchanged when the number is invalid or rounds to infinity or to zero.
+   **/
+  inline from_chars_result from_chars(const char* first, const char* last, float& value, chars_format fmt = chars_format::general)
+  {
+    return __::fp::from_chars(first, last, value, fmt);
+  }
+  inline from_chars_result from_chars(const char* first, const char* last, double& value, chars_format fmt = chars_format::general)
+  {
+    return __::fp::from_chars(first, last, value, fmt);
+  }
+  inline from_chars_result from_chars(const char* first, const char* last, long double& value, chars_format fmt = chars_format::general)
+  {
+    double v;
+    const from_chars_result r = __::fp::from_chars(first, last, v, fmt);
+    if(r.ec == errc())
+      value = v;
+    return r;
+  }
+  ///\}
+
+  /** @} charconv */
+  /** @} utilities */
+}
+
+#endif // NTL__STLX_CHARCONV
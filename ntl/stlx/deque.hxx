@@ -11,6 +11,11 @@
 #include "memory.hxx"
 #include "algorithm.hxx"
 
+/** The deque allocates its elements by the blocks of this many bytes, or of 16 elements if they are larger */
+#ifndef STLX__DEQUE_BLOCK_BYTES
+#define STLX__DEQUE_BLOCK_BYTES 1024
+#endif
+
 namespace std {
 
 /**\addtogroup  lib_containers ********* 23 Containers library [containers]
@@ -19,11 +24,146 @@ namespace std {
 /**\addtogroup  lib_sequence *********** 23.2 Sequence containers [sequences]
  *@{*/
 
+  template <class T, class Allocator> class deque;
+
+  namespace __
+  {
+    /** The number of the deque elements in a block */
+    template<class T>
+    struct deque_block:
+      integral_constant<size_t, (sizeof(T) < STLX__DEQUE_BLOCK_BYTES / 16 ? STLX__DEQUE_BLOCK_BYTES / sizeof(T) : 16)>
+    {};
+
+    /**
+     *	@brief The deque iterator: the element and the node of the block map which holds the element's block
+     **/
+    template<class T, class Pointer, class Reference>
+    class deque_iterator
+    {
+      template<class, class> friend class std::deque;
+      typedef T** map_pointer;
+      static const ptrdiff_t block = deque_block<T>::value;
+
+    public:
+      typedef random_access_iterator_tag  iterator_category;
+      typedef T                           value_type;
+      typedef ptrdiff_t                   difference_type;
+      typedef Pointer                     pointer;
+      typedef Reference                   reference;
+
+      deque_iterator()
+        :cur(), node()
+      {}
+
+      /** Converts the iterator to the const_iterator */
+      deque_iterator(const deque_iterator<T, T*, T&>& i)
+        :cur(i.get()), node(i.get_node())
+      {}
+
+      reference operator*() const { return *cur; }
+      pointer operator->() const  { return cur; }
+      reference operator[](difference_type n) const { return *(*this + n); }
+
+      deque_iterator& operator++()
+      {
+        if(++cur == *node + block){
+          ++node;
+          cur = *node;
+        }
+        return *this;
+      }
+      deque_iterator operator++(int)
+      {
+        deque_iterator tmp(*this);
+        ++*this;
+        return tmp;
+      }
+
+      deque_iterator& operator--()
+      {
+        if(cur == *node){
+          --node;
+          cur = *node + block;
+        }
+        --cur;
+        return *this;
+      }
+      deque_iterator operator--(int)
+      {
+        deque_iterator tmp(*this);
+        --*this;
+        return tmp;
+      }
+
+      deque_iterator& operator+=(difference_type n)
+      {
+        if(!n)
+          return *this;
+        const difference_type offset = n + (cur - *node);
+        if(offset >= 0 && offset < block){
+          cur += n;
+        }else{
+          const difference_type nodes = offset > 0 ? offset / block : -((-offset - 1) / block) - 1;
+          node += nodes;
+          cur = *node + (offset - nodes * block);
+        }
+        return *this;
+      }
+      deque_iterator& operator-=(difference_type n) { return *this += -n; }
+
+      friend deque_iterator operator+(deque_iterator i, difference_type n) { return i += n; }
+      friend deque_iterator operator+(difference_type n, deque_iterator i) { return i += n; }
+      friend deque_iterator operator-(deque_iterator i, difference_type n) { return i -= n; }
+
+      friend difference_type operator-(const deque_iterator& x, const deque_iterator& y)
+      {
+        if(x.node == y.node)
+          return x.cur - y.cur;
+        return (x.node - y.node) * block + (x.cur - *x.node) - (y.cur - *y.node);
+      }
+
+      friend bool operator==(const deque_iterator& x, const deque_iterator& y) { return x.cur == y.cur; }
+      friend bool operator!=(const deque_iterator& x, const deque_iterator& y) { return x.cur != y.cur; }
+      friend bool operator< (const deque_iterator& x, const deque_iterator& y) { return x.node == y.node ? x.cur < y.cur : x.node < y.node; }
+      friend bool operator> (const deque_iterator& x, const deque_iterator& y) { return y < x; }
+      friend bool operator<=(const deque_iterator& x, const deque_iterator& y) { return !(y < x); }
+      friend bool operator>=(const deque_iterator& x, const deque_iterator& y) { return !(x < y); }
+
+      ///\cond __
+      T* get() const { return cur; }
+      map_pointer get_node() const { return node; }
+      ///\endcond
+
+    private:
+      deque_iterator(T* cur, map_pointer node)
+        :cur(cur), node(node)
+      {}
+
+      T* cur;
+      map_pointer node;
+    };
+  }
+
+  /**
+   *	@brief Class template deque [23.2.2]
+   *
+   *  The elements are kept in the fixed-size blocks (see STLX__DEQUE_BLOCK_BYTES), the map is an array of
+   *  pointers to the blocks. The insertion at either end constructs the element in the first or the last block,
+   *  or in a new block, so it never moves the elements and keeps the references to them valid;
+   *  the reallocation of the map moves only the block pointers.
+   *
+   *  The blocks emptied by the removal at the ends are freed, except one kept for the next new block,
+   *  and the map is recentered instead of grown while at most half of it is in use: a deque used as a FIFO queue
+   *  holds the memory proportional to its size only.
+   **/
   template <class T, class Allocator = allocator<T> >
-  class deque 
+  class deque
   {
-    typedef typename  
+    typedef typename
       Allocator::template rebind<T>::other          allocator;
+    typedef typename
+      Allocator::template rebind<T*>::other         map_allocator;
+    typedef T**                                     map_pointer;
   public:
     // types:
     typedef T                                       value_type;
@@ -35,90 +175,74 @@ namespace std {
     typedef typename  allocator::size_type          size_type;
     typedef typename  allocator::difference_type    difference_type;
 
-    typedef pointer                                 iterator;
-    typedef const_pointer                           const_iterator;
+    typedef __::deque_iterator<T, T*, T&>             iterator;
+    typedef __::deque_iterator<T, const T*, const T&> const_iterator;
     typedef std::reverse_iterator<iterator>         reverse_iterator;
     typedef std::reverse_iterator<const_iterator>   const_reverse_iterator;
 
   public:
     ///\name 23.2.2.1 construct/copy/destroy:
     explicit deque(const Allocator& a = Allocator())
-      :alloc(a), left(), right(), capL(), capR(), base_(), cap_()
+      :map_(), map_size_(), spare_(), alloc(a), map_alloc(alloc)
     {}
     explicit deque(size_type n)
-      :alloc(), left(), right(), capL(), capR(), base_(), cap_()
+      :map_(), map_size_(), spare_(), alloc(), map_alloc(alloc)
     {
-      if(n){
-        reserve(n);
-        capR -= n;
-      #if !defined(NTL_CXX_RV) || defined(NTL_CXX_RVFIX)
-        while(n--)
-          alloc.construct(right++, T());
-      #else
-        while(n--)
-          alloc.construct(right++, forward<value_type>(T()));
-      #endif
-      }
+      resize(n);
     }
 
     deque(size_type n, const T& value, const Allocator& a = Allocator())
-      :alloc(a), left(), right(), capL(), capR(), base_(), cap_()
+      :map_(), map_size_(), spare_(), alloc(a), map_alloc(alloc)
     {
-      if(n){
-        reserve(n);
-        capR -= n;
-        while(n--)
-          alloc.construct(right++, value);
-      }
+      while(n--)
+        push_back(value);
     }
 
     template <class InputIterator>
     deque(InputIterator first, InputIterator last, const Allocator& a = Allocator(), typename enable_if<!is_integral<InputIterator>::value>::type* =0)
-      :alloc(a), left(), right(), capL(), capR(), base_(), cap_()
+      :map_(), map_size_(), spare_(), alloc(a), map_alloc(alloc)
     {
-      assign(first, last, typename iterator_traits<InputIterator>::iterator_category());
+      append(first, last);
     }
 
     deque(const deque<T,Allocator>& x)
-      :alloc(x.alloc), left(), right(), capL(), capR(), base_(), cap_()
+      :map_(), map_size_(), spare_(), alloc(x.alloc), map_alloc(alloc)
     {
-      assign(x.cbegin(), x.cend());
+      append(x.cbegin(), x.cend());
     }
 
     deque(const deque& x, const Allocator& a)
-      :alloc(a), left(), right(), capL(), capR(), base_(), cap_()
+      :map_(), map_size_(), spare_(), alloc(a), map_alloc(alloc)
     {
-      assign(x.cbegin(), x.cend());
+      append(x.cbegin(), x.cend());
     }
-    
+
     deque(initializer_list<T> il)
-      :left(), right(), capL(), capR(), base_(), cap_()
+      :map_(), map_size_(), spare_(), alloc(), map_alloc(alloc)
     {
-      assign(il.begin(), il.end(), forward_iterator_tag());
+      append(il.begin(), il.end());
     }
     deque(initializer_list<T> il, const Allocator& a)
-      :alloc(a), left(), right(), capL(), capR(), base_(), cap_()
+      :map_(), map_size_(), spare_(), alloc(a), map_alloc(alloc)
     {
-      assign(il.begin(), il.end(), forward_iterator_tag());
+      append(il.begin(), il.end());
     }
 
     #ifdef NTL_CXX_RV
     deque(deque&& x)
-      :alloc(), left(), right(), capL(), capR(), base_(), cap_()
+      :map_(), map_size_(), spare_(), alloc(), map_alloc(alloc)
     {
       swap(x);
     }
     deque(deque&& x, const Allocator& a)
-      :alloc(a), left(), right(), capL(), capR(), base_(), cap_()
+      :map_(), map_size_(), spare_(), alloc(a), map_alloc(alloc)
     {
       if(x.get_allocator() == a){
         swap(x);
       }else{
-        // move elements using the array_allocator
-        // TODO: reserve(x.size())
-        reserve(x.size());
-        right = uninitialized_move(x.begin(), x.end(), right);
-        capR -= x.size();
+        // move elements using the own allocator
+        for(iterator i = x.begin(); i != x.end(); ++i)
+          push_back(std::move(*i));
         x.clear();
       }
     }
@@ -127,13 +251,13 @@ namespace std {
     ///\name Range extension
     template<class Iter>
     explicit deque(std::range<Iter>&& R)
-      :left(), right(), capL(), capR(), base_(), cap_()
+      :map_(), map_size_(), spare_(), alloc(), map_alloc(alloc)
     {
       assign(forward<Range>(R));
     }
     template<class Iter>
     explicit deque(std::range<Iter>&& R, const Allocator& a)
-      :alloc(a), left(), right(), capL(), capR(), base_(), cap_()
+      :map_(), map_size_(), spare_(), alloc(a), map_alloc(alloc)
     {
       assign(forward<Range>(R));
     }
@@ -161,23 +285,20 @@ namespace std {
     {
       dispose();
     }
-    
+
     deque& operator=(initializer_list<T> il)
     {
-      //dispose();
-      assign(il.begin(), il.end(), forward_iterator_tag());
+      assign(il.begin(), il.end());
       return *this;
     }
 
     deque<T,Allocator>& operator=(const deque<T,Allocator>& x)
     {
-      if(&x != this){
-        //dispose();
+      if(&x != this)
         assign(x.cbegin(), x.cend());
-      }
       return *this;
     }
-    
+
     #ifdef NTL_CXX_RV
     deque<T,Allocator>& operator=(deque<T,Allocator>&& x)
     {
@@ -188,257 +309,220 @@ namespace std {
       return *this;
     }
     #endif
-    
+
     template <class InputIterator>
     void assign(InputIterator first, InputIterator last, typename enable_if<!is_integral<InputIterator>::value>::type* =0)
     {
-      assign(first, last, typename iterator_traits<InputIterator>::iterator_category());
+      clear();
+      append(first, last);
     }
 
     void assign(size_type n, const T& t)
     {
-      const size_type cap = capacity();
-      if(n > cap){
-        dispose();
-        reserve(n);
-        capR -= n;
-      }else{
-        clear();
-        // adjust pointers to place elements
-        // after clear they are in the middle
-        const size_type d = n/2;
-        left -= d; capL -= d;
-        capR -= d + (n&1);
-        right = left;
-      }
+      clear();
       while(n--)
-        alloc.construct(right++, t);
-      validate();
+        push_back(t);
     }
 
     void assign(initializer_list<T> il)
     {
-      assign(il.begin(), il.end(), forward_iterator_tag());
+      assign(il.begin(), il.end());
     }
-    
+
     allocator_type get_allocator() const { return alloc; }
 
     ///\name iterators:
-    iterator        begin()                 { return left; }
-    const_iterator  begin() const           { return left; }
-    const_iterator cbegin() const           { return left; }
+    iterator        begin()                 { return start_; }
+    const_iterator  begin() const           { return start_; }
+    const_iterator cbegin() const           { return start_; }
+
+    iterator        end()                   { return finish_; }
+    const_iterator  end() const             { return finish_; }
+    const_iterator cend() const             { return finish_; }
 
-    iterator        end()                   { return right; }
-    const_iterator  end() const             { return right; }
-    const_iterator cend() const             { return right; }
+    reverse_iterator        rbegin()        { return reverse_iterator(end()); }
+    const_reverse_iterator  rbegin() const  { return const_reverse_iterator(end()); }
+    const_reverse_iterator crbegin() const  { return const_reverse_iterator(end()); }
 
-    reverse_iterator        rbegin()        { return reverse_iterator(right); }
-    const_reverse_iterator  rbegin() const  { return const_reverse_iterator(right); }
-    const_reverse_iterator crbegin() const  { return const_reverse_iterator(right); }
+    reverse_iterator        rend()          { return reverse_iterator(begin()); }
+    const_reverse_iterator  rend() const    { return const_reverse_iterator(begin()); }
+    const_reverse_iterator crend() const    { return const_reverse_iterator(begin()); }
 
-    reverse_iterator        rend()          { return reverse_iterator(left); }
-    const_reverse_iterator  rend() const    { return const_reverse_iterator(left); }
-    const_reverse_iterator crend() const    { return const_reverse_iterator(left); }
-    
 
     ///\name 23.2.2.2 capacity:
-    size_type size() const      { return right - left; }
+    size_type size() const      { return static_cast<size_type>(finish_ - start_); }
     size_type max_size() const  { return alloc.max_size(); }
-    
+
     void resize(size_type sz)
     {
-    #ifndef NTL_CXX_RV
-      resize(sz, value_type());
-      return;
-    #else
-      const size_type len = size();
-      if(sz < len)
-        erase(left+sz, right);
-      else if(sz > len){
-        sz -= len;
-        if(sz > capR)
-          reallocate(sz/*-capR*/);
-        capR -= sz;
-      #if !defined(NTL_CXX_RV) || defined(NTL_CXX_RVFIX)
-        while(sz--)
-          alloc.construct(right++, T());
-      #else
-        while(sz--)
-          alloc.construct(right++, forward<value_type>(T()));
-      #endif
-        validate();
+      while(size() > sz)
+        pop_back();
+      while(size() < sz){
+        alloc.construct(back_slot(), T());
+        commit_back();
       }
-    #endif
     }
     void resize(size_type sz, const T& c)
     {
-      const size_type len = size();
-      if(sz < len)
-        erase(left+sz, right);
-      else if(sz > len)
-        insert(right, sz-len, c);
-      validate();
+      while(size() > sz)
+        pop_back();
+      while(size() < sz)
+        push_back(c);
     }
 
+    /** Frees the spare block and the unused part of the map */
     void shrink_to_fit()
     {
-      if(!empty() && size() > can_shrink)
-        reallocate();
-      validate();
+      if(spare_){
+        alloc.deallocate(spare_, block);
+        spare_ = 0;
+      }
+      if(map_){
+        const size_type nodes = static_cast<size_type>(finish_.node - start_.node) + 1;
+        if(map_size_ > nodes + min_map)
+          remap(nodes + min_map, nodes, 0, false);
+      }
     }
-    
-    bool empty() const { return left == right; }
-    
+
+    bool empty() const { return start_ == finish_; }
+
     ///\name element access:
-    reference       operator[](size_type n)       { return *(left+n); }
-    const_reference operator[](size_type n) const { return *(left+n); }
-    
+    reference       operator[](size_type n)       { return start_[static_cast<difference_type>(n)]; }
+    const_reference operator[](size_type n) const { return start_[static_cast<difference_type>(n)]; }
+
     reference at(size_type n)
     {
-      if(n > size()) __ntl_throw(out_of_range());
-      return *(left+n);
+      if(n >= size()) __ntl_throw(out_of_range());
+      return (*this)[n];
     }
     const_reference at(size_type n) const
     {
-      if(n > size()) __ntl_throw(out_of_range());
-      return *(left+n);
+      if(n >= size()) __ntl_throw(out_of_range());
+      return (*this)[n];
     }
-    
-    reference front()             { return *left; }
-    const_reference front() const { return *left; }
-    reference back()              { return *(right-1); }
-    const_reference back() const  { return *(right-1); }
-    
+
+    reference front()             { return *start_.cur; }
+    const_reference front() const { return *start_.cur; }
+    reference back()              { iterator i = finish_; return *--i; }
+    const_reference back() const  { iterator i = finish_; return *--i; }
+
     ///\name 23.2.2.3 modifiers:
     #ifdef NTL_CXX_VT
     template <class... Args> void emplace_front(Args&&... args)
     {
-      if(empty())
-        reserve();
-      else if(!capL)
-        relocate(false);
-      alloc.construct(--left, std::forward<Args>(args)...); --capL;
-      validate();
+      alloc.construct(front_slot(), std::forward<Args>(args)...);
+      commit_front();
     }
 
     template <class... Args> void emplace_back(Args&&... args)
     {
-      if(empty())
-        reserve();
-      else if(!capR)
-        relocate(true);
-      alloc.construct(right++, std::forward<Args>(args)...); --capR;
-      validate();
+      alloc.construct(back_slot(), std::forward<Args>(args)...);
+      commit_back();
     }
 
     template <class... Args> iterator emplace(const_iterator position, Args&&... args)
     {
-      assert(position >= left && position <= right);
-      if(position == right){
+      if(position == cbegin()){
+        emplace_front(std::forward<Args>(args)...);
+        return begin();
+      }else if(position == cend()){
         emplace_back(std::forward<Args>(args)...);
-        return right-1;
+        return end() - 1;
       }
-      pointer pos = insert_impl(position);
-      alloc.construct(pos, std::forward<Args>(args)...);
-      validate();
-      return pos;
+      value_type v(std::forward<Args>(args)...);
+      return insert_inside(position, v);
     }
     #endif
 
     #ifdef NTL_CXX_RV
     void push_front(T&& x)
     {
-      if(empty())
-        reserve();
-      else if(!capL)
-        relocate(false);
-      alloc.construct(--left, forward<value_type>(x)); --capL;
-      validate();
+      alloc.construct(front_slot(), forward<value_type>(x));
+      commit_front();
     }
     void push_back(T&& x)
     {
-      if(empty())
-        reserve();
-      else if(!capR)
-        relocate(true);
-      alloc.construct(right++, forward<value_type>(x)); --capR;
-      validate();
+      alloc.construct(back_slot(), forward<value_type>(x));
+      commit_back();
     }
     #endif
 
     void push_front(const T& x)
     {
-      if(empty())
-        reserve();
-      else if(!capL)
-        relocate(false);
-      alloc.construct(--left, x); --capL;
-      validate();
+      alloc.construct(front_slot(), x);
+      commit_front();
     }
 
     void push_back(const T& x)
     {
-      if(empty())
-        reserve();
-      else if(!capR)
-        relocate(true);
-      alloc.construct(right++, x); --capR;
-      validate();
+      alloc.construct(back_slot(), x);
+      commit_back();
     }
 
     void pop_front()
     {
-      if(!empty())
-        alloc.destroy(left++), ++capL;
-      validate();
+      if(empty())
+        return;
+      alloc.destroy(start_.cur);
+      if(++start_.cur == *start_.node + block){
+        // the block is empty, the next one holds the rest (or is the end)
+        release(*start_.node);
+        start_.cur = *++start_.node;
+      }
     }
     void pop_back()
     {
-      if(!empty())
-        alloc.destroy(--right), ++capR;
-      validate();
+      if(empty())
+        return;
+      if(finish_.cur == *finish_.node){
+        release(*finish_.node);
+        finish_.cur = *--finish_.node + block;
+      }
+      alloc.destroy(--finish_.cur);
     }
 
     #ifdef NTL_CXX_RV
     iterator insert(const_iterator position, T&& x)
     {
-      assert(position >= left && position <= right);
-      if(position == right){
+      if(position == cbegin()){
+        push_front(forward<value_type>(x));
+        return begin();
+      }else if(position == cend()){
         push_back(forward<value_type>(x));
-        return right-1;
+        return end() - 1;
       }
-      pointer pos = insert_impl(position);
-      alloc.construct(pos, forward<value_type>(x));
-      validate();
-      return pos;
+      value_type v(forward<value_type>(x));
+      return insert_inside(position, v);
     }
     #endif
 
     iterator insert(const_iterator position, const T& x)
     {
-      assert(position >= left && position <= right);
-      if(position == right){
+      if(position == cbegin()){
+        push_front(x);
+        return begin();
+      }else if(position == cend()){
         push_back(x);
-        return right-1;
+        return end() - 1;
       }
-      pointer pos = insert_impl(position);
-      alloc.construct(pos, x);
-      validate();
-      return pos;
+      value_type v(x);
+      return insert_inside(position, v);
     }
 
     void insert(const_iterator position, size_type n, const T& x)
     {
-      assert(position >= left && position <= right);
-      const ptrdiff_t diff = position-left;
-      if(n > capR)
-        reallocate(n/*-capR*/); // invalidates iterators
-      pointer pos = left + diff;
-      move_backward(pos, right, pos+n+(right-pos)); // shift right
-      capR -= n; right += n;
-      while(n--)
-        alloc.construct(pos++, x);
-      validate();
+      const difference_type index = position - cbegin();
+      const value_type v(x); // x may be our element
+      if(static_cast<size_type>(index) < size() / 2){
+        for(size_type i = 0; i < n; i++)
+          push_front(v);
+        std::rotate(begin(), begin() + n, begin() + (n + index));
+      }else{
+        const difference_type old = static_cast<difference_type>(size());
+        for(size_type i = 0; i < n; i++)
+          push_back(v);
+        std::rotate(begin() + index, begin() + old, end());
+      }
     }
 
     template <class InputIterator>
@@ -454,260 +538,248 @@ namespace std {
 
     iterator erase(const_iterator position)
     {
-      assert(!empty() && position >= left && position < right);
-      iterator pos;
-      if(position == left) // front
-        alloc.destroy(left++), ++capL, pos = left;
-      else if(position == right-1) // back
-        alloc.destroy(--right), ++capR, pos = right;
-      else{
-        // erasing element inside deque, move elements
-        pos = const_cast<iterator>(position);
-        alloc.destroy(pos);
-        move(pos+1, right, pos);
-        --right, ++capR;
+      const difference_type index = position - cbegin();
+      const iterator pos = begin() + index;
+      if(static_cast<size_type>(index) < size() / 2){
+        std::move_backward(begin(), pos, pos + 1);
+        pop_front();
+      }else{
+        std::move(pos + 1, end(), pos);
+        pop_back();
       }
-      validate();
-      return pos;
+      return begin() + index;
     }
 
     iterator erase(const_iterator first, const_iterator last)
     {
-      assert(first >= left && last <= right);
-      if(first == left && last == right){
-        // clear all
-        return erase_all(no_dtor());
-      }else{
-        if(first != last){
-          pointer l = const_cast<pointer>(last), f = const_cast<pointer>(first);
-          if(l == right)
-            l = f;
-          else
-            l = move(l, right, f);  // move left tailing elements, l points to remainder
-          capR += right-l;
-          if(no_dtor::value)
-            right = l;
-          else while(right != l)     // destroy reminder
-            alloc.destroy(--right);
-          validate();
+      const difference_type index = first - cbegin(), n = last - first;
+      if(n == static_cast<difference_type>(size())){
+        clear();
+        return end();
+      }
+      if(n){
+        // move the shorter side over the erased elements
+        const iterator pos = begin() + index;
+        if(static_cast<size_type>(index) < (size() - n) / 2){
+          std::move_backward(begin(), pos, pos + n);
+          for(difference_type i = 0; i < n; i++)
+            pop_front();
+        }else{
+          std::move(pos + n, end(), pos);
+          for(difference_type i = 0; i < n; i++)
+            pop_back();
         }
-        return const_cast<pointer>(first);
       }
+      return begin() + index;
     }
 
     void swap(deque<T,Allocator>& x)
     {
       if(this != &x){
         using std::swap;
-        pointer l = left, r = right;
-        size_type cl = capL, cr = capR;
-        left = x.left, right = x.right;
-        capL = x.capL, capR = x.capR;
-        x.left = l, x.right = r;
-        x.capL = cl, x.capR = cr;
+        swap(map_, x.map_);
+        swap(map_size_, x.map_size_);
+        swap(start_, x.start_);
+        swap(finish_, x.finish_);
+        swap(spare_, x.spare_);
         swap(alloc, x.alloc);
-        swap(base_, x.base_);
-        swap(cap_,  x.cap_);
+        swap(map_alloc, x.map_alloc);
       }
     }
 
+    /** Destroys the elements and frees their blocks but one */
     void clear()
     {
-      if(!empty())
-        erase_all(no_dtor());
+      if(!map_)
+        return;
+      if(!__::no_dtor<T>::value)
+        for(iterator i = start_; i != finish_; ++i)
+          alloc.destroy(i.cur);
+      for(map_pointer node = start_.node + 1; node <= finish_.node; ++node)
+        release(*node);
+      finish_.node = start_.node;
+      start_.cur = finish_.cur = *start_.node + block / 2;
     }
     ///\}
   protected:
-    // we can fast relocate if type is pod
-    static const bool can_fast_relocate = 0 && has_trivial_copy_constructor<T>::value;
-    static const size_type can_shrink = 32;
-    //typedef __::bool_type<is_pod<T>::value || has_trivial_destructor<T>::value> no_dtor;
-    typedef false_type no_dtor;
-
-    // capacity helpers
-    size_type capacity_factor(size_type n) const { /*if(n == 0) n = 1; return n*2; }*/ return (n + 4) * 2; }
-    size_type capacity() const 
-    {
-      size_type c = (right - left) + capL + capR;
-      assert(c == cap_);
-      __unused(c);
-      return cap_;
-    }
-    bool can_relocate(size_type n) const { return n > capacity_factor(size()); }
-
-    void validate()
-    {
-      capacity(); //-V530
-      base();
-    }
-    // allocate memory
-    void reserve(size_type n = 0)
-    { // pre: container must be cleared
-      const size_type cap = cap_ = capacity_factor(n);
-      pointer p = base_ = alloc.allocate(cap);
-      //if(!p) return;
-      pointer middle = p + cap/2;
-      right = left = middle - n/2;
-      capL = left - p; capR = cap - capL;
-      validate();
-      // post: left & right points to the new uninitialized element (or in the middle if n == 0)
-    }
-
-    pointer base() const 
-    {
-      pointer b = left - capL;
-      assert(!b || b == base_);
-      __unused(b);
-      return base_;
-    }
-
-    void relocate(bool is_right)
-    {
-      validate();
-      // param: which side needed a space
-      if(can_fast_relocate){
-        // TODO: define offset to relocate
-        if(is_right && can_relocate(capL)){
-          // move the contents left
-        }else if(!is_right && can_relocate(capR)){
-          // move the contents right
-        }
-        return;
+    static const size_type block = __::deque_block<T>::value;
+    static const size_type min_map = 8;
+
+    /** Allocates the map and the first block with the room at both sides */
+    void initialize()
+    {
+      if(!spare_)
+        spare_ = alloc.allocate(block);
+      map_ = map_alloc.allocate(min_map);
+      map_size_ = min_map;
+      const map_pointer node = map_ + min_map / 2;
+      *node = spare_;
+      spare_ = 0;
+      start_ = finish_ = iterator(*node + block / 2, node);
+    }
+
+    /** The raw memory for the element after the last one; the block after it is ready when it is the last slot */
+    T* back_slot()
+    {
+      if(!map_)
+        initialize();
+      if(finish_.cur == *finish_.node + (block - 1)){
+        if(finish_.node + 1 == map_ + map_size_)
+          grow_map(false);
+        if(!spare_)
+          spare_ = alloc.allocate(block);
       }
-      reallocate();
+      return finish_.cur;
     }
 
-    void reallocate(size_type n = 0)
+    /** Counts in the element constructed at back_slot() */
+    void commit_back()
     {
-      validate();
-      pointer l = left, r = right, p = base();
-      const size_type cap = capacity(), c = max(capacity(), n);
-      reserve(c);
-      validate();
-      if(r-l){
-        right = uninitialized_move(l, r, right);
-        capR -= r - l;
+      if(++finish_.cur == *finish_.node + block){
+        *++finish_.node = spare_;
+        spare_ = 0;
+        finish_.cur = *finish_.node;
       }
-      if(p)
-        alloc.deallocate(p, cap);
-      validate();
     }
 
-    iterator erase_all(true_type)
+    /** The raw memory for the element before the first one, in the spare block when the first block is full */
+    T* front_slot()
     {
-      // no dtor, just adjust pointers
-      const pointer p = base();
-      const size_type cap = capacity();
-      right = left = p + cap/2;
-      capL = left - p; capR = cap - capL;
-      validate();
-      return right;
+      if(!map_)
+        initialize();
+      if(start_.cur == *start_.node){
+        if(start_.node == map_)
+          grow_map(true);
+        if(!spare_)
+          spare_ = alloc.allocate(block);
+        return spare_ + (block - 1);
+      }
+      return start_.cur - 1;
     }
 
-    iterator erase_all(false_type)
+    /** Counts in the element constructed at front_slot() */
+    void commit_front()
     {
-      pointer p = left;
-      while(p != right)
-        alloc.destroy(p++);
-      return erase_all(true_type());
+      if(start_.cur == *start_.node){
+        *--start_.node = spare_;
+        spare_ = 0;
+        start_.cur = *start_.node + (block - 1);
+      }else{
+        --start_.cur;
+      }
     }
 
-    void dispose()
+    /** Keeps one free block for the next new one */
+    void release(T* b)
     {
-      if(base()){
-        if(!empty())
-          clear();
-        alloc.deallocate(base(), capacity());
-        left = right = base_ = nullptr;
-        capL = capR = cap_ = 0;
+      if(!spare_)
+        spare_ = b;
+      else
+        alloc.deallocate(b, block);
+    }
+
+    /** Makes the room for one more node at the front or at the back */
+    void grow_map(bool at_front)
+    {
+      const size_type nodes = static_cast<size_type>(finish_.node - start_.node) + 1;
+      // the FIFO use frees the nodes at one side as fast as it takes them at the other
+      if(map_size_ > 2 * (nodes + 1))
+        remap(map_size_, nodes, 1, at_front);
+      else
+        remap(map_size_ * 2 + 2, nodes, 1, at_front);
+    }
+
+    /** Moves the \p nodes block pointers to the middle of the map of \p size nodes, leaving \p room extra ones at one side */
+    void remap(size_type size, size_type nodes, size_type room, bool at_front)
+    {
+      const bool in_place = size == map_size_;
+      const map_pointer new_map = in_place ? map_ : map_alloc.allocate(size);
+      const map_pointer new_start = new_map + (size - nodes - room) / 2 + (at_front ? room : 0);
+      if(new_start < start_.node || !in_place)
+        std::copy(start_.node, finish_.node + 1, new_start);
+      else
+        std::copy_backward(start_.node, finish_.node + 1, new_start + nodes);
+      if(!in_place){
+        map_alloc.deallocate(map_, map_size_);
+        map_ = new_map;
+        map_size_ = size;
       }
+      start_.node = new_start;
+      finish_.node = new_start + (nodes - 1);
     }
 
-    template <class InputIterator>
-    void assign(InputIterator first, InputIterator last, random_access_iterator_tag)
+    void dispose()
     {
-      const size_type n = last - first;
-      const size_type cap = capacity();
-      if(n > cap){
-        dispose();
-        reserve(n);
-        capR -= n;
-      }else{
+      if(map_){
         clear();
-        // adjust pointers to place elements
-        // after clear they are in the middle
-        const size_type d = n/2;
-        left -= d; capL -= d;
-        capR -= d + (n&1); // +1 if odd
-        right = left;
+        alloc.deallocate(*start_.node, block);
+        map_alloc.deallocate(map_, map_size_);
       }
-      while(first != last){
-        alloc.construct(right++, *first);
-        ++first;
-      }
-      validate();
+      if(spare_)
+        alloc.deallocate(spare_, block);
+      map_ = 0;
+      map_size_ = 0;
+      spare_ = 0;
+      start_ = finish_ = iterator();
     }
+
     template <class InputIterator>
-    void assign(InputIterator first, InputIterator last, input_iterator_tag)
+    void append(InputIterator first, InputIterator last)
     {
-      clear();
-      while(first != last)
-        push_back(*first++);
-      validate();
-    }
-
-    pointer insert_impl(const_iterator position)
-    {
-      const ptrdiff_t diff = position - left;
-      if(empty() || !capR)
-        reallocate(size());
-      validate();
-      pointer pos = left+diff;
-      move_backward(pos, right, pos+1+(right-pos)); // shift right
-      ++right;
-      --capR;
-      validate();
-      return pos;
+      for(; first != last; ++first)
+        push_back(*first);
     }
 
-#if 0
-    template <class InputIterator>
-    void insert(const_iterator position, InputIterator first, InputIterator last, random_access_iterator_tag)
+    /** Inserts \p v before an inner \p position, shifting the shorter side */
+    iterator insert_inside(const_iterator position, value_type& v)
     {
-      // if need realloc, save pointers, allocate new and then move there old & new elements with 3 move operations
-      // if not, shift right & insert new elements
-      size_type n = last - first;
-      if(n > capR)
-        reallocate(n-capR);
-      move_backward(pos, right, pos+n); // shift right
-      capR -= n;
-
-      while(n--)
-        alloc.construct(right++, *first++);
+      const difference_type index = position - cbegin();
+      if(static_cast<size_type>(index) < size() / 2){
+        push_front(std::move(front()));
+        const iterator pos = begin() + index;
+        std::move(begin() + 2, pos + 1, begin() + 1);
+        *pos = std::move(v);
+        return pos;
+      }
+      push_back(std::move(back()));
+      const iterator pos = begin() + index;
+      std::move_backward(pos, end() - 2, end() - 1);
+      *pos = std::move(v);
+      return pos;
     }
-#endif
 
     template <class InputIterator>
     void insert(const_iterator position, InputIterator first, InputIterator last, input_iterator_tag)
     {
-      iterator pos = const_cast<iterator>(position);
-      while(first != last)
-        pos = insert(pos, *first++);
-      validate();
+      // append and rotate into the place
+      const difference_type index = position - cbegin(), old = static_cast<difference_type>(size());
+      append(first, last);
+      std::rotate(begin() + index, begin() + old, end());
     }
 
-    pointer uninitialized_move(pointer first, pointer last, pointer result)
+    template <class ForwardIterator>
+    void insert(const_iterator position, ForwardIterator first, ForwardIterator last, forward_iterator_tag)
     {
-      while(first != last)
-        alloc.construct(result++, move(*first++));
-      return result;
+      const difference_type index = position - cbegin();
+      if(static_cast<size_type>(index) >= size() / 2){
+        insert(position, first, last, input_iterator_tag());
+        return;
+      }
+      // prepend (reversed) and rotate into the place
+      difference_type n = 0;
+      for(; first != last; ++first, ++n)
+        push_front(*first);
+      std::reverse(begin(), begin() + n);
+      std::rotate(begin(), begin() + n, begin() + (n + index));
     }
 
-
   private:
-    pointer left, right, base_;
-    size_type capL, capR, cap_;
+    map_pointer map_;
+    size_type map_size_;
+    iterator start_, finish_;
+    T* spare_;
     allocator alloc;
+    map_allocator map_alloc;
   };
 
 
@@ -741,12 +813,12 @@ namespace std {
   {
     return rel_ops::operator <=(x, y);
   }
-  
-  
+
+
   // specialized algorithms:
   template <class T, class Allocator>
   inline void swap(deque<T,Allocator>& x, deque<T,Allocator>& y)  { x.swap(y); }
-  
+
   /**@} lib_sequence */
   /**@} lib_containers */
 }//namespace std
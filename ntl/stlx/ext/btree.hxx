@@ -0,0 +1,1056 @@
+/**\file*********************************************************************
+ *                                                                     \brief
+ *  B-tree based ordered associative containers
+ *
+ ****************************************************************************
+ */
+#ifndef NTL__EXT_BTREE
+#define NTL__EXT_BTREE
+#pragma once
+
+#include "../iterator.hxx"
+#include "../memory.hxx"
+#include "../functional.hxx"
+#include "../algorithm.hxx"
+#include "../initializer_list.hxx"
+#include "../stdexcept_fwd.hxx"
+
+namespace std
+{
+  namespace ext
+  {
+    namespace tree
+    {
+      namespace __
+      {
+        template<class Key>
+        struct identity_key
+        {
+          static const Key& key(const Key& x) { return x; }
+        };
+
+        template<class Key, class Value>
+        struct first_key
+        {
+          static const Key& key(const Value& x) { return x.first; }
+        };
+      }
+
+      /**
+       *	@brief B+ tree
+       *
+       *  Values are stored in the contiguous arrays of the leaf nodes, the leaves are linked into a list.
+       *  Internal nodes keep the separator keys only: every value of the child \c i is not greater than
+       *  the key \c i, which is not greater than every value of the child <tt>i+1</tt>.
+       *
+       *  Insertion and erasure move values within and between the nodes, so they invalidate all iterators,
+       *  pointers and references to the container elements. The iterator returned by insert() or erase() is valid.
+       *
+       *  @tparam KeyOfValue provides <tt>static const Key& key(const Value&)</tt>
+       *  @tparam IsUnique whether the equivalent keys are not allowed
+       **/
+      template<class Key, class Value, class Compare, class Allocator, class KeyOfValue, bool IsUnique>
+      class btree
+      {
+        typedef typename
+          Allocator::template rebind<Value>::other    allocator;
+      public:
+        typedef           Key                         key_type;
+        typedef           Value                       value_type;
+        typedef           Compare                     key_compare;
+        typedef           Allocator                   allocator_type;
+
+        typedef typename  allocator::pointer          pointer;
+        typedef typename  allocator::const_pointer    const_pointer;
+        typedef typename  allocator::reference        reference;
+        typedef typename  allocator::const_reference  const_reference;
+        typedef typename  allocator::size_type        size_type;
+        typedef typename  allocator::difference_type  difference_type;
+
+      protected:
+        /** target size of the node values array */
+        static const size_t node_bytes = 256;
+
+        static const size_type leaf_capacity = node_bytes / sizeof(value_type) < 4 ? 4 : node_bytes / sizeof(value_type);
+        static const size_type internal_capacity = node_bytes / (sizeof(key_type) + sizeof(void*)) < 4 ? 4 : node_bytes / (sizeof(key_type) + sizeof(void*));
+        static const size_type min_leaf = leaf_capacity / 2;
+        static const size_type min_internal = internal_capacity / 2;
+
+        struct internal_node;
+
+        struct node_base
+        {
+          internal_node* parent;
+          size_type pos;    // index in the parent's children
+          size_type count;  // number of values or keys
+          bool leaf;
+        };
+
+        // arrays have one spare slot: node is split after it overflows
+        struct leaf_node: node_base
+        {
+          leaf_node *prev, *next;
+          typename aligned_storage<sizeof(value_type) * (leaf_capacity + 1), alignof(value_type)>::type storage;
+
+          value_type* values() { return reinterpret_cast<value_type*>(&storage); }
+          const value_type* values() const { return reinterpret_cast<const value_type*>(&storage); }
+        };
+
+        struct internal_node: node_base
+        {
+          node_base* children[internal_capacity + 2];
+          typename aligned_storage<sizeof(key_type) * (internal_capacity + 1), alignof(key_type)>::type storage;
+
+          key_type* keys() { return reinterpret_cast<key_type*>(&storage); }
+        };
+
+        typedef typename Allocator::template rebind<leaf_node>::other     leaf_allocator;
+        typedef typename Allocator::template rebind<internal_node>::other internal_allocator;
+        typedef typename Allocator::template rebind<key_type>::other      key_allocator;
+
+        // the values of the sets are their keys, so the set iterator is constant as the one of std::set
+        typedef typename conditional<is_same<Key, Value>::value, const_pointer, pointer>::type      iterator_pointer;
+        typedef typename conditional<is_same<Key, Value>::value, const_reference, reference>::type  iterator_reference;
+
+        struct iterator_impl:
+          std::iterator<std::bidirectional_iterator_tag, value_type, difference_type, iterator_pointer, iterator_reference>
+        {
+          iterator_impl()
+            :n(), i()
+          {}
+
+          iterator_reference operator* () const { return n->values()[i]; }
+          iterator_pointer   operator->() const { return &n->values()[i]; }
+          iterator_impl& operator++()
+          {
+            if(++i == n->count && n->next)
+              n = n->next, i = 0;
+            return *this;
+          }
+          iterator_impl& operator--()
+          {
+            if(i == 0)
+              n = n->prev, i = n->count;
+            --i;
+            return *this;
+          }
+          iterator_impl operator++(int){ iterator_impl tmp( *this ); ++*this; return tmp; }
+          iterator_impl operator--(int){ iterator_impl tmp( *this ); --*this; return tmp; }
+
+          friend bool operator==(const iterator_impl& x, const iterator_impl& y)
+          { return x.n == y.n && x.i == y.i; }
+          friend bool operator!=(const iterator_impl& x, const iterator_impl& y)
+          { return !(x == y); }
+
+        protected:
+          iterator_impl(leaf_node* n, size_type i)
+            :n(n), i(i)
+          {}
+
+          leaf_node* n;
+          size_type i;
+
+          friend class btree;
+          friend struct const_iterator_impl;
+        };
+
+        struct const_iterator_impl:
+          std::iterator<std::bidirectional_iterator_tag, value_type, difference_type, const_pointer, const_reference>
+        {
+          const_iterator_impl()
+            :n(), i()
+          {}
+          const_iterator_impl(const iterator_impl& x)
+            :n(x.n), i(x.i)
+          {}
+
+          const_reference operator* () const { return n->values()[i]; }
+          const_pointer   operator->() const { return &n->values()[i]; }
+          const_iterator_impl& operator++()
+          {
+            if(++i == n->count && n->next)
+              n = n->next, i = 0;
+            return *this;
+          }
+          const_iterator_impl& operator--()
+          {
+            if(i == 0)
+              n = n->prev, i = n->count;
+            --i;
+            return *this;
+          }
+          const_iterator_impl operator++(int){ const_iterator_impl tmp( *this ); ++*this; return tmp; }
+          const_iterator_impl operator--(int){ const_iterator_impl tmp( *this ); --*this; return tmp; }
+
+          friend bool operator==(const const_iterator_impl& x, const const_iterator_impl& y)
+          { return x.n == y.n && x.i == y.i; }
+          friend bool operator!=(const const_iterator_impl& x, const const_iterator_impl& y)
+          { return !(x == y); }
+
+        private:
+          const_iterator_impl(const leaf_node* n, size_type i)
+            :n(n), i(i)
+          {}
+
+          const leaf_node* n;
+          size_type i;
+
+          friend class btree;
+        };
+
+      public:
+        typedef iterator_impl                         iterator;
+        typedef const_iterator_impl                   const_iterator;
+        typedef std::reverse_iterator<iterator>       reverse_iterator;
+        typedef std::reverse_iterator<const_iterator> const_reverse_iterator;
+
+      public:
+        explicit btree(const Compare& comp, const Allocator& a = Allocator())
+          :root_(), first_(), last_(), count_(0),
+          comparator_(comp), valloc(a), lalloc(a), ialloc(a), kalloc(a)
+        {}
+
+        btree(const btree& x)
+          :root_(), first_(), last_(), count_(0),
+          comparator_(x.comparator_), valloc(x.valloc), lalloc(x.lalloc), ialloc(x.ialloc), kalloc(x.kalloc)
+        {
+          insert_range(x.cbegin(), x.cend());
+        }
+
+        btree(const btree& x, const Allocator& a)
+          :root_(), first_(), last_(), count_(0),
+          comparator_(x.comparator_), valloc(a), lalloc(a), ialloc(a), kalloc(a)
+        {
+          insert_range(x.cbegin(), x.cend());
+        }
+
+#ifdef NTL_CXX_RV
+        btree(btree&& x)
+          :root_(), first_(), last_(), count_(0),
+          comparator_(x.comparator_), valloc(x.valloc), lalloc(x.lalloc), ialloc(x.ialloc), kalloc(x.kalloc)
+        {
+          swap(x);
+        }
+#endif
+
+        ~btree() __ntl_nothrow
+        {
+          clear();
+        }
+
+        btree& operator=(const btree& x)
+        {
+          if(this != &x){
+            clear();
+            comparator_ = x.comparator_;
+            insert_range(x.cbegin(), x.cend());
+          }
+          return *this;
+        }
+
+#ifdef NTL_CXX_RV
+        btree& operator=(btree&& x)
+        {
+          if(this != &x){
+            clear();
+            swap(x);
+          }
+          return *this;
+        }
+#endif
+
+        allocator_type get_allocator() const { return allocator_type(valloc); }
+
+        ///\name capacity
+        bool      empty() const     { return count_ == 0; }
+        size_type size()  const     { return count_; }
+        size_type max_size()  const { return valloc.max_size(); }
+
+        ///\name iterators
+        iterator                begin()        { return iterator(first_, 0); }
+        const_iterator          begin()  const { return const_iterator(first_, 0); }
+        iterator                end()          { return iterator(last_, last_ ? last_->count : 0);  }
+        const_iterator          end()    const { return const_iterator(last_, last_ ? last_->count : 0);  }
+
+        reverse_iterator        rbegin()       { return reverse_iterator(end());  }
+        const_reverse_iterator  rbegin() const { return const_reverse_iterator(end());  }
+        reverse_iterator        rend()         { return reverse_iterator(begin()); }
+        const_reverse_iterator  rend()   const { return const_reverse_iterator(begin()); }
+
+        const_iterator          cbegin() const { return begin(); }
+        const_iterator          cend()   const { return end();   }
+        const_reverse_iterator  crbegin()const { return rbegin();}
+        const_reverse_iterator  crend()  const { return rend();  }
+
+        ///\name modifiers
+        std::pair<iterator, bool> insert(const value_type& x)
+        {
+          if(IsUnique){
+            const iterator pos = lower_bound(key(x));
+            if(pos != end() && !comparator_(key(x), key(*pos)))
+              return std::make_pair(pos, false);
+            return std::make_pair(insert_at(descend(key(x), false), x), true);
+          }
+          return std::make_pair(insert_at(descend(key(x), true), x), true);
+        }
+
+        /** Appends \c x in constant time if the hint is end() and \c x is greater than the last element */
+        iterator insert(const_iterator hint, const value_type& x)
+        {
+          if(hint == cend() && last_){
+            const key_type& last = key(last_->values()[last_->count - 1]);
+            if(IsUnique ? comparator_(last, key(x)) : !comparator_(key(x), last))
+              return insert_at(iterator(last_, last_->count), x);
+          }
+          return insert(x).first;
+        }
+
+        template <class InputIterator>
+        void insert(InputIterator first, InputIterator last)
+        {
+          insert_range(first, last);
+        }
+
+        void insert(initializer_list<value_type> il)
+        {
+          insert_range(il.begin(), il.end());
+        }
+
+        iterator erase(const_iterator position)
+        {
+          leaf_node* const n = const_cast<leaf_node*>(position.n);
+          size_type i = position.i;
+          valloc.destroy(n->values() + i);
+          relocate_values(n->values() + i, n->values() + i + 1, n->count - i - 1);
+          --n->count;
+          --count_;
+
+          iterator next(n, i);
+          if(n == root_){
+            if(n->count == 0){
+              free_leaf(n);
+              root_ = nullptr;
+              first_ = last_ = nullptr;
+              return end();
+            }
+          }else if(n->count < min_leaf){
+            next = rebalance_leaf(n, i);
+          }
+          if(next.i == next.n->count && next.n->next)
+            next.n = next.n->next, next.i = 0;
+          return next;
+        }
+
+        size_type erase(const key_type& x)
+        {
+          iterator first = lower_bound(x);
+          size_type n = 0;
+          while(first != end() && !comparator_(x, key(*first)))
+            first = erase(first), ++n;
+          return n;
+        }
+
+        iterator erase(const_iterator first, const_iterator last)
+        {
+          if(first == cbegin() && last == cend()){
+            clear();
+            return end();
+          }
+          // erasure invalidates the last iterator, so count the elements first
+          difference_type n = distance(first, last);
+          iterator i(const_cast<leaf_node*>(first.n), first.i);
+          while(n--)
+            i = erase(i);
+          return i;
+        }
+
+        void swap(btree& x)
+        {
+          if(this != &x){
+            using std::swap;
+            swap(root_, x.root_);
+            swap(first_, x.first_);
+            swap(last_, x.last_);
+            swap(count_, x.count_);
+            swap(comparator_, x.comparator_);
+            swap(valloc, x.valloc);
+            swap(lalloc, x.lalloc);
+            swap(ialloc, x.ialloc);
+            swap(kalloc, x.kalloc);
+          }
+        }
+
+        void clear()
+        {
+          if(root_)
+            free_subtree(root_);
+          root_ = nullptr;
+          first_ = last_ = nullptr;
+          count_ = 0;
+        }
+
+        ///\name observers
+        key_compare key_comp() const { return comparator_; }
+
+        ///\name operations
+        iterator find(const key_type& x)
+        {
+          const iterator pos = lower_bound(x);
+          return pos == end() || comparator_(x, key(*pos)) ? end() : pos;
+        }
+        const_iterator find(const key_type& x) const { return const_cast<btree*>(this)->find(x); }
+
+        size_type count(const key_type& x) const
+        {
+          if(IsUnique)
+            return find(x) != end() ? 1 : 0;
+          const std::pair<const_iterator, const_iterator> r = equal_range(x);
+          return static_cast<size_type>(distance(r.first, r.second));
+        }
+
+        iterator lower_bound(const key_type& x)
+        {
+          return normalize(descend(x, false));
+        }
+        const_iterator lower_bound(const key_type& x) const { return const_cast<btree*>(this)->lower_bound(x); }
+
+        iterator upper_bound(const key_type& x)
+        {
+          return normalize(descend(x, true));
+        }
+        const_iterator upper_bound(const key_type& x) const { return const_cast<btree*>(this)->upper_bound(x); }
+
+        std::pair<iterator, iterator> equal_range(const key_type& x)
+        {
+          return std::make_pair(lower_bound(x), upper_bound(x));
+        }
+        std::pair<const_iterator, const_iterator> equal_range(const key_type& x) const
+        {
+          return std::make_pair(lower_bound(x), upper_bound(x));
+        }
+        ///\}
+
+      protected:
+        static const key_type& key(const value_type& v) { return KeyOfValue::key(v); }
+
+        /** index of the first key in [first, first+n) which is not less (or greater if \c upper) than \c x */
+        template<class T, class KeyOf>
+        size_type bound(const T* first, size_type n, const key_type& x, bool upper, KeyOf keyof) const
+        {
+          size_type lo = 0;
+          while(n){
+            const size_type half = n / 2;
+            const key_type& k = keyof(first[lo + half]);
+            if(upper ? !comparator_(x, k) : comparator_(k, x)){
+              lo += half + 1;
+              n -= half + 1;
+            }else{
+              n = half;
+            }
+          }
+          return lo;
+        }
+
+        static const key_type& self_key(const key_type& k) { return k; }
+        static const key_type& value_key(const value_type& v) { return key(v); }
+
+        /** leaf position of the lower (upper) bound of \c x, may point past the leaf values */
+        iterator descend(const key_type& x, bool upper)
+        {
+          node_base* n = root_;
+          if(!n)
+            return end();
+          while(!n->leaf){
+            internal_node* in = static_cast<internal_node*>(n);
+            n = in->children[bound(in->keys(), in->count, x, upper, &self_key)];
+          }
+          leaf_node* leaf = static_cast<leaf_node*>(n);
+          return iterator(leaf, bound(leaf->values(), leaf->count, x, upper, &value_key));
+        }
+
+        iterator normalize(iterator pos) const
+        {
+          if(pos.n && pos.i == pos.n->count && pos.n->next)
+            pos.n = pos.n->next, pos.i = 0;
+          return pos;
+        }
+
+        template<class InputIterator>
+        void insert_range(InputIterator first, InputIterator last)
+        {
+          const_iterator hint = cend();
+          for(; first != last; ++first){
+            insert(hint, *first);
+            hint = cend();
+          }
+        }
+
+        /** Moves \c n values (keys) from \c src to \c dst, the ranges may overlap */
+        template<class T, class A>
+        static void relocate(T* dst, T* src, size_type n, A& a)
+        {
+          if(dst < src){
+            for(size_type i = 0; i < n; i++){
+            #ifdef NTL_CXX_RV
+              a.construct(dst + i, std::move(src[i]));
+            #else
+              a.construct(dst + i, src[i]);
+            #endif
+              a.destroy(src + i);
+            }
+          }else if(dst > src){
+            for(size_type i = n; i--; ){
+            #ifdef NTL_CXX_RV
+              a.construct(dst + i, std::move(src[i]));
+            #else
+              a.construct(dst + i, src[i]);
+            #endif
+              a.destroy(src + i);
+            }
+          }
+        }
+        void relocate_values(value_type* dst, value_type* src, size_type n) { relocate(dst, src, n, valloc); }
+        void relocate_keys(key_type* dst, key_type* src, size_type n) { relocate(dst, src, n, kalloc); }
+
+        /** Moves \c n children from \c src to the position \c at of \c to, the ranges may overlap */
+        static void move_children(internal_node* to, size_type at, node_base** src, size_type n)
+        {
+          node_base** const dst = to->children + at;
+          if(dst < src){
+            for(size_type i = 0; i < n; i++)
+              link_child(to, at + i, src[i]);
+          }else{
+            for(size_type i = n; i--; )
+              link_child(to, at + i, src[i]);
+          }
+        }
+
+        static void link_child(internal_node* to, size_type i, node_base* c)
+        {
+          to->children[i] = c;
+          c->parent = to;
+          c->pos = i;
+        }
+
+        leaf_node* new_leaf()
+        {
+          leaf_node* n = lalloc.allocate(1);
+          n->parent = nullptr;
+          n->pos = n->count = 0;
+          n->leaf = true;
+          n->prev = n->next = nullptr;
+          return n;
+        }
+
+        internal_node* new_internal()
+        {
+          internal_node* n = ialloc.allocate(1);
+          n->parent = nullptr;
+          n->pos = n->count = 0;
+          n->leaf = false;
+          return n;
+        }
+
+        void free_leaf(leaf_node* n)
+        {
+          lalloc.deallocate(n, 1);
+        }
+
+        void free_internal(internal_node* n)
+        {
+          ialloc.deallocate(n, 1);
+        }
+
+        void free_subtree(node_base* n)
+        {
+          if(n->leaf){
+            leaf_node* leaf = static_cast<leaf_node*>(n);
+            for(size_type i = 0; i < leaf->count; i++)
+              valloc.destroy(leaf->values() + i);
+            free_leaf(leaf);
+          }else{
+            internal_node* in = static_cast<internal_node*>(n);
+            for(size_type i = 0; i <= in->count; i++)
+              free_subtree(in->children[i]);
+            for(size_type i = 0; i < in->count; i++)
+              kalloc.destroy(in->keys() + i);
+            free_internal(in);
+          }
+        }
+
+        /** Inserts \c x before the position \c pos of the leaf, splits the overflowed leaf */
+        iterator insert_at(iterator pos, const value_type& x)
+        {
+          if(!root_){
+            leaf_node* n = new_leaf();
+            root_ = first_ = last_ = n;
+            pos = iterator(n, 0);
+          }
+          leaf_node* n = pos.n;
+          const size_type i = pos.i;
+          relocate_values(n->values() + i + 1, n->values() + i, n->count - i);
+          __ntl_try{
+            valloc.construct(n->values() + i, x);
+          }
+          __ntl_catch(...){
+            relocate_values(n->values() + i, n->values() + i + 1, n->count - i);
+            if(count_ == 0)
+              clear_empty_root();
+            __ntl_rethrow;
+          }
+          ++n->count;
+          ++count_;
+          if(n->count <= leaf_capacity)
+            return pos;
+
+          // split the leaf; appending to the rightmost leaf keeps the left leaf full
+          const size_type split = (i == leaf_capacity && !n->next) ? leaf_capacity : (leaf_capacity + 1) / 2;
+          leaf_node* r = new_leaf();
+          relocate_values(r->values(), n->values() + split, n->count - split);
+          r->count = n->count - split;
+          n->count = split;
+          r->prev = n;
+          r->next = n->next;
+          if(n->next)
+            n->next->prev = r;
+          else
+            last_ = r;
+          n->next = r;
+
+          insert_parent(n, key(n->values()[split - 1]), r);
+          return i < split ? iterator(n, i) : iterator(r, i - split);
+        }
+
+        void clear_empty_root()
+        {
+          free_leaf(static_cast<leaf_node*>(root_));
+          root_ = nullptr;
+          first_ = last_ = nullptr;
+        }
+
+        /** Links \c right next to \c left, \c sep separates them */
+        void insert_parent(node_base* left, const key_type& sep, node_base* right)
+        {
+          internal_node* p = left->parent;
+          if(!p){
+            p = new_internal();
+            kalloc.construct(p->keys(), sep);
+            p->count = 1;
+            p->children[0] = left;
+            p->children[1] = right;
+            left->parent = right->parent = p;
+            left->pos = 0;
+            right->pos = 1;
+            root_ = p;
+            return;
+          }
+          const size_type i = left->pos;
+          relocate_keys(p->keys() + i + 1, p->keys() + i, p->count - i);
+          kalloc.construct(p->keys() + i, sep);
+          move_children(p, i + 2, p->children + i + 1, p->count - i);
+          p->children[i + 1] = right;
+          right->parent = p;
+          right->pos = i + 1;
+          ++p->count;
+          if(p->count <= internal_capacity)
+            return;
+
+          // split the internal node, the middle key goes up
+          const size_type mid = (internal_capacity + 1) / 2;
+          internal_node* r = new_internal();
+          r->count = p->count - mid - 1;
+          relocate_keys(r->keys(), p->keys() + mid + 1, r->count);
+          move_children(r, 0, p->children + mid + 1, r->count + 1);
+          p->count = mid;
+          insert_parent(p, p->keys()[mid], r);
+          kalloc.destroy(p->keys() + mid);
+        }
+
+        /** Restores the leaf occupancy after erasure, returns the new position of the element \c i */
+        iterator rebalance_leaf(leaf_node* n, size_type i)
+        {
+          internal_node* const p = n->parent;
+          const size_type pos = n->pos;
+          leaf_node* const right = pos < p->count ? static_cast<leaf_node*>(p->children[pos + 1]) : nullptr;
+          leaf_node* const left  = pos > 0 ? static_cast<leaf_node*>(p->children[pos - 1]) : nullptr;
+
+          if(right && right->count > min_leaf){
+            // borrow the first value of the right sibling
+            relocate_values(n->values() + n->count, right->values(), 1);
+            relocate_values(right->values(), right->values() + 1, right->count - 1);
+            ++n->count;
+            --right->count;
+            set_key(p, pos, key(n->values()[n->count - 1]));
+            return iterator(n, i);
+          }
+          if(left && left->count > min_leaf){
+            // borrow the last value of the left sibling
+            relocate_values(n->values() + 1, n->values(), n->count);
+            relocate_values(n->values(), left->values() + left->count - 1, 1);
+            ++n->count;
+            --left->count;
+            set_key(p, pos - 1, key(left->values()[left->count - 1]));
+            return iterator(n, i + 1);
+          }
+          if(right){
+            merge_leaves(n, right);
+            return iterator(n, i);
+          }
+          const size_type shift = left->count;
+          merge_leaves(left, n);
+          return iterator(left, shift + i);
+        }
+
+        void set_key(internal_node* p, size_type i, const key_type& k)
+        {
+          kalloc.destroy(p->keys() + i);
+          kalloc.construct(p->keys() + i, k);
+        }
+
+        /** Appends the right leaf to the left one and removes it */
+        void merge_leaves(leaf_node* left, leaf_node* right)
+        {
+          relocate_values(left->values() + left->count, right->values(), right->count);
+          left->count += right->count;
+          left->next = right->next;
+          if(right->next)
+            right->next->prev = left;
+          else
+            last_ = left;
+          internal_node* const p = left->parent;
+          remove_child(p, right->pos);
+          free_leaf(right);
+          rebalance_internal(p);
+        }
+
+        /** Removes the child \c i and the key before it */
+        void remove_child(internal_node* p, size_type i)
+        {
+          kalloc.destroy(p->keys() + i - 1);
+          relocate_keys(p->keys() + i - 1, p->keys() + i, p->count - i);
+          for(size_type j = i; j < p->count; j++){
+            p->children[j] = p->children[j + 1];
+            p->children[j]->pos = j;
+          }
+          --p->count;
+        }
+
+        void rebalance_internal(internal_node* n)
+        {
+          if(n == root_){
+            if(n->count == 0){
+              root_ = n->children[0];
+              root_->parent = nullptr;
+              root_->pos = 0;
+              free_internal(n);
+            }
+            return;
+          }
+          if(n->count >= min_internal)
+            return;
+
+          internal_node* const p = n->parent;
+          const size_type pos = n->pos;
+          internal_node* const right = pos < p->count ? static_cast<internal_node*>(p->children[pos + 1]) : nullptr;
+          internal_node* const left  = pos > 0 ? static_cast<internal_node*>(p->children[pos - 1]) : nullptr;
+
+          if(right && right->count > min_internal){
+            // rotate left through the parent
+            relocate_keys(n->keys() + n->count, p->keys() + pos, 1);
+            relocate_keys(p->keys() + pos, right->keys(), 1);
+            relocate_keys(right->keys(), right->keys() + 1, right->count - 1);
+            move_children(n, n->count + 1, right->children, 1);
+            move_children(right, 0, right->children + 1, right->count);
+            ++n->count;
+            --right->count;
+          }else if(left && left->count > min_internal){
+            // rotate right through the parent
+            relocate_keys(n->keys() + 1, n->keys(), n->count);
+            move_children(n, 1, n->children, n->count + 1);
+            relocate_keys(n->keys(), p->keys() + pos - 1, 1);
+            relocate_keys(p->keys() + pos - 1, left->keys() + left->count - 1, 1);
+            move_children(n, 0, left->children + left->count, 1);
+            ++n->count;
+            --left->count;
+          }else if(right){
+            merge_internal(n, right);
+          }else{
+            merge_internal(left, n);
+          }
+        }
+
+        /** Appends the separator and the right node to the left one and removes it */
+        void merge_internal(internal_node* left, internal_node* right)
+        {
+          internal_node* const p = left->parent;
+          const size_type sep = left->pos;
+          relocate_keys(left->keys() + left->count, p->keys() + sep, 1);
+          relocate_keys(left->keys() + left->count + 1, right->keys(), right->count);
+          move_children(left, left->count + 1, right->children, right->count + 1);
+          left->count += right->count + 1;
+
+          // the separator is already moved out
+          relocate_keys(p->keys() + sep, p->keys() + sep + 1, p->count - sep - 1);
+          for(size_type j = sep + 1; j < p->count; j++){
+            p->children[j] = p->children[j + 1];
+            p->children[j]->pos = j;
+          }
+          --p->count;
+          free_internal(right);
+          rebalance_internal(p);
+        }
+
+      protected:
+        node_base* root_;
+        leaf_node *first_, *last_;
+        size_type count_;
+
+        key_compare comparator_;
+        allocator valloc;
+        leaf_allocator lalloc;
+        internal_allocator ialloc;
+        key_allocator kalloc;
+      };
+
+      template<class K, class V, class C, class A, class KV, bool U>
+      inline bool operator == (const btree<K,V,C,A,KV,U>& x, const btree<K,V,C,A,KV,U>& y)
+      {
+        return x.size() == y.size() && equal(x.cbegin(), x.cend(), y.cbegin());
+      }
+
+      template<class K, class V, class C, class A, class KV, bool U>
+      inline bool operator != (const btree<K,V,C,A,KV,U>& x, const btree<K,V,C,A,KV,U>& y)
+      {
+        return !(x == y);
+      }
+
+      template<class K, class V, class C, class A, class KV, bool U>
+      inline bool operator < (const btree<K,V,C,A,KV,U>& x, const btree<K,V,C,A,KV,U>& y)
+      {
+        return lexicographical_compare(x.cbegin(), x.cend(), y.cbegin(), y.cend());
+      }
+
+      template<class K, class V, class C, class A, class KV, bool U>
+      inline bool operator > (const btree<K,V,C,A,KV,U>& x, const btree<K,V,C,A,KV,U>& y)
+      {
+        return y < x;
+      }
+
+      template<class K, class V, class C, class A, class KV, bool U>
+      inline bool operator <= (const btree<K,V,C,A,KV,U>& x, const btree<K,V,C,A,KV,U>& y)
+      {
+        return !(y < x);
+      }
+
+      template<class K, class V, class C, class A, class KV, bool U>
+      inline bool operator >= (const btree<K,V,C,A,KV,U>& x, const btree<K,V,C,A,KV,U>& y)
+      {
+        return !(x < y);
+      }
+    } // tree
+
+
+    /**
+     *	@brief B-tree based set with unique keys
+     *
+     *  Has the interface of std::set, but stores many keys per node, so lookups and range scans touch
+     *  much less cache lines.
+     *  @warning Unlike std::set, insertion and erasure invalidate all iterators and references to the elements.
+     **/
+    template <class Key, class Compare = less<Key>, class Allocator = allocator<Key> >
+    class btree_set:
+      public tree::btree<Key, Key, Compare, Allocator, tree::__::identity_key<Key>, true>
+    {
+      typedef tree::btree<Key, Key, Compare, Allocator, tree::__::identity_key<Key>, true> tree_type;
+    public:
+      typedef Compare value_compare;
+      typedef typename tree_type::const_iterator          iterator;
+      typedef typename tree_type::const_reverse_iterator  reverse_iterator;
+
+      explicit btree_set(const Compare& comp = Compare(), const Allocator& a = Allocator())
+        :tree_type(comp, a)
+      {}
+
+      template <class InputIterator>
+      btree_set(InputIterator first, InputIterator last, const Compare& comp = Compare(), const Allocator& a = Allocator())
+        :tree_type(comp, a)
+      {
+        tree_type::insert(first, last);
+      }
+
+      btree_set(initializer_list<Key> il, const Compare& comp = Compare(), const Allocator& a = Allocator())
+        :tree_type(comp, a)
+      {
+        tree_type::insert(il);
+      }
+
+      value_compare value_comp() const { return tree_type::key_comp(); }
+    };
+
+    /**
+     *	@brief B-tree based set with equivalent keys
+     *  @warning Unlike std::multiset, insertion and erasure invalidate all iterators and references to the elements.
+     **/
+    template <class Key, class Compare = less<Key>, class Allocator = allocator<Key> >
+    class btree_multiset:
+      public tree::btree<Key, Key, Compare, Allocator, tree::__::identity_key<Key>, false>
+    {
+      typedef tree::btree<Key, Key, Compare, Allocator, tree::__::identity_key<Key>, false> tree_type;
+    public:
+      typedef Compare value_compare;
+      typedef typename tree_type::const_iterator          iterator;
+      typedef typename tree_type::const_reverse_iterator  reverse_iterator;
+
+      explicit btree_multiset(const Compare& comp = Compare(), const Allocator& a = Allocator())
+        :tree_type(comp, a)
+      {}
+
+      template <class InputIterator>
+      btree_multiset(InputIterator first, InputIterator last, const Compare& comp = Compare(), const Allocator& a = Allocator())
+        :tree_type(comp, a)
+      {
+        tree_type::insert(first, last);
+      }
+
+      btree_multiset(initializer_list<Key> il, const Compare& comp = Compare(), const Allocator& a = Allocator())
+        :tree_type(comp, a)
+      {
+        tree_type::insert(il);
+      }
+
+      value_compare value_comp() const { return tree_type::key_comp(); }
+    };
+
+    namespace __
+    {
+      template <class Key, class T, class Compare>
+      class btree_value_compare:
+        public binary_function<pair<const Key, T>, pair<const Key, T>, bool>
+      {
+      public:
+        explicit btree_value_compare(const Compare& c)
+          :comp(c)
+        {}
+        bool operator()(const pair<const Key, T>& x, const pair<const Key, T>& y) const
+        {
+          return comp(x.first, y.first);
+        }
+      protected:
+        Compare comp;
+      };
+    }
+
+    /**
+     *	@brief B-tree based map with unique keys
+     *
+     *  Has the interface of std::map, but stores many elements per node, so lookups and range scans touch
+     *  much less cache lines.
+     *  @warning Unlike std::map, insertion and erasure invalidate all iterators and references to the elements.
+     **/
+    template <class Key, class T, class Compare = less<Key>, class Allocator = allocator<pair<const Key, T> > >
+    class btree_map:
+      public tree::btree<Key, pair<const Key, T>, Compare, Allocator, tree::__::first_key<Key, pair<const Key, T> >, true>
+    {
+      typedef tree::btree<Key, pair<const Key, T>, Compare, Allocator, tree::__::first_key<Key, pair<const Key, T> >, true> tree_type;
+    public:
+      typedef T                                       mapped_type;
+      typedef __::btree_value_compare<Key, T, Compare> value_compare;
+      typedef typename tree_type::value_type          value_type;
+      typedef typename tree_type::key_type            key_type;
+      typedef typename tree_type::iterator            iterator;
+      typedef typename tree_type::const_iterator      const_iterator;
+
+      explicit btree_map(const Compare& comp = Compare(), const Allocator& a = Allocator())
+        :tree_type(comp, a)
+      {}
+
+      template <class InputIterator>
+      btree_map(InputIterator first, InputIterator last, const Compare& comp = Compare(), const Allocator& a = Allocator())
+        :tree_type(comp, a)
+      {
+        tree_type::insert(first, last);
+      }
+
+      btree_map(initializer_list<value_type> il, const Compare& comp = Compare(), const Allocator& a = Allocator())
+        :tree_type(comp, a)
+      {
+        tree_type::insert(il);
+      }
+
+      ///\name element access
+      T& operator[](const key_type& x)
+      {
+        iterator i = tree_type::lower_bound(x);
+        if(i == tree_type::end() || tree_type::comparator_(x, i->first))
+          i = tree_type::insert(value_type(x, T())).first;
+        return i->second;
+      }
+
+      T& at(const key_type& x) __ntl_throws(out_of_range)
+      {
+        iterator i = tree_type::find(x);
+        if(i == tree_type::end())
+          __throw_out_of_range("specified key isn't exists in the map");
+        return i->second;
+      }
+
+      const T& at(const key_type& x) const __ntl_throws(out_of_range)
+      {
+        const_iterator i = tree_type::find(x);
+        if(i == tree_type::end())
+          __throw_out_of_range("specified key isn't exists in the map");
+        return i->second;
+      }
+      ///\}
+
+      value_compare value_comp() const { return value_compare(tree_type::key_comp()); }
+    };
+
+    /**
+     *	@brief B-tree based map with equivalent keys
+     *  @warning Unlike std::multimap, insertion and erasure invalidate all iterators and references to the elements.
+     **/
+    template <class Key, class T, class Compare = less<Key>, class Allocator = allocator<pair<const Key, T> > >
+    class btree_multimap:
+      public tree::btree<Key, pair<const Key, T>, Compare, Allocator, tree::__::first_key<Key, pair<const Key, T> >, false>
+    {
+      typedef tree::btree<Key, pair<const Key, T>, Compare, Allocator, tree::__::first_key<Key, pair<const Key, T> >, false> tree_type;
+    public:
+      typedef T                                       mapped_type;
+      typedef __::btree_value_compare<Key, T, Compare> value_compare;
+      typedef typename tree_type::value_type          value_type;
+
+      explicit btree_multimap(const Compare& comp = Compare(), const Allocator& a = Allocator())
+        :tree_type(comp, a)
+      {}
+
+      template <class InputIterator>
+      btree_multimap(InputIterator first, InputIterator last, const Compare& comp = Compare(), const Allocator& a = Allocator())
+        :tree_type(comp, a)
+      {
+        tree_type::insert(first, last);
+      }
+
+      btree_multimap(initializer_list<value_type> il, const Compare& comp = Compare(), const Allocator& a = Allocator())
+        :tree_type(comp, a)
+      {
+        tree_type::insert(il);
+      }
+
+      value_compare value_comp() const { return value_compare(tree_type::key_comp()); }
+    };
+
+    template <class Key, class Compare, class Allocator>
+    inline void swap(btree_set<Key,Compare,Allocator>& x, btree_set<Key,Compare,Allocator>& y) { x.swap(y); }
+
+    template <class Key, class Compare, class Allocator>
+    inline void swap(btree_multiset<Key,Compare,Allocator>& x, btree_multiset<Key,Compare,Allocator>& y) { x.swap(y); }
+
+    template <class Key, class T, class Compare, class Allocator>
+    inline void swap(btree_map<Key,T,Compare,Allocator>& x, btree_map<Key,T,Compare,Allocator>& y) { x.swap(y); }
+
+    template <class Key, class T, class Compare, class Allocator>
+    inline void swap(btree_multimap<Key,T,Compare,Allocator>& x, btree_multimap<Key,T,Compare,Allocator>& y) { x.swap(y); }
+  } // ext
+} // std
+#endif // NTL__EXT_BTREE
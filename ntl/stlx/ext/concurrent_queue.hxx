@@ -0,0 +1,447 @@
+/**\file*********************************************************************
+ *                                                                     \brief
+ *  Bounded lock-free queues and their blocking wrapper
+ *
+ ****************************************************************************
+ */
+#ifndef NTL__EXT_CONCURRENT_QUEUE
+#define NTL__EXT_CONCURRENT_QUEUE
+#pragma once
+
+#include "../atomic.hxx"
+#include "../memory.hxx"
+#include "../type_traits.hxx"
+#include "../condition_variable.hxx"
+
+namespace std
+{
+  namespace ext
+  {
+    namespace __
+    {
+      /** The indices written by the different threads are kept this far apart */
+      static const size_t cache_line = 64;
+
+      /** The smallest power of two not less than \p n and 2 */
+      inline size_t queue_capacity(size_t n)
+      {
+        size_t c = 2;
+        while(c < n)
+          c <<= 1;
+        return c;
+      }
+    }
+
+    /**
+     *	@brief Bounded lock-free multi-producer multi-consumer queue
+     *
+     *  The ring of the cells with the sequence numbers by D. Vyukov. The cell at the position \c pos is free for the
+     *  producer which claims \c pos when its sequence is \c pos, and is full for the consumer which claims \c pos
+     *  when its sequence is <tt>pos + 1</tt>; the consumer frees it for the next lap by storing <tt>pos + capacity</tt>.
+     *  The producers and the consumers claim the positions by CAS on their own index, so a push and a pop contend
+     *  only when they hit the same cell.
+     *
+     *  The capacity is rounded up to a power of two. The copy and the move of \c T must not throw,
+     *  since a claimed cell can't be given back.
+     **/
+    template<class T, class Allocator = allocator<T> >
+    class mpmc_queue
+    {
+      struct cell
+      {
+        atomic<size_t> sequence;
+        typename aligned_storage<sizeof(T), alignment_of<T>::value>::type storage;
+
+        T* value() { return reinterpret_cast<T*>(&storage); }
+      };
+      typedef typename Allocator::template rebind<cell>::other cell_allocator;
+
+    public:
+      typedef T         value_type;
+      typedef size_t    size_type;
+      typedef Allocator allocator_type;
+
+      explicit mpmc_queue(size_type capacity, const Allocator& a = Allocator())
+        :calloc(a), mask(__::queue_capacity(capacity) - 1), enqueue_pos(0), dequeue_pos(0)
+      {
+        cells = calloc.allocate(mask + 1);
+        for(size_type i = 0; i <= mask; i++){
+          ::new(static_cast<void*>(cells + i)) cell;
+          cells[i].sequence.store(i, memory_order_relaxed);
+        }
+      }
+
+      ~mpmc_queue()
+      {
+        for(size_type pos = dequeue_pos.load(memory_order_relaxed); ; pos++){
+          cell& c = cells[pos & mask];
+          if(c.sequence.load(memory_order_relaxed) != pos + 1)
+            break;
+          c.value()->~T();
+        }
+        calloc.deallocate(cells, mask + 1);
+      }
+
+      /** Appends a copy of \p v unless the queue is full */
+      bool try_push(const T& v)
+      {
+        size_type pos;
+        cell* const c = claim_push(pos);
+        if(!c)
+          return false;
+        ::new(static_cast<void*>(c->value())) T(v);
+        c->sequence.store(pos + 1, memory_order_release);
+        return true;
+      }
+
+#ifdef NTL_CXX_RV
+      /** Appends \p v unless the queue is full */
+      bool try_push(T&& v)
+      {
+        size_type pos;
+        cell* const c = claim_push(pos);
+        if(!c)
+          return false;
+        ::new(static_cast<void*>(c->value())) T(std::move(v));
+        c->sequence.store(pos + 1, memory_order_release);
+        return true;
+      }
+#endif
+
+      /** Moves the oldest element to \p v unless the queue is empty */
+      bool try_pop(T& v)
+      {
+        size_type pos;
+        cell* const c = claim_pop(pos);
+        if(!c)
+          return false;
+        v = std::move(*c->value());
+        c->value()->~T();
+        c->sequence.store(pos + mask + 1, memory_order_release);
+        return true;
+      }
+
+      size_type capacity() const { return mask + 1; }
+
+      /** The number of the elements, exact only while no other thread works with the queue */
+      size_type size() const
+      {
+        const size_type d = dequeue_pos.load(memory_order_relaxed), e = enqueue_pos.load(memory_order_relaxed);
+        return e > d ? e - d : 0;
+      }
+
+      bool empty() const { return size() == 0; }
+
+    private:
+      cell_allocator calloc;
+      cell* cells;
+      const size_type mask;
+      char pad0[__::cache_line];
+      atomic<size_t> enqueue_pos;
+      char pad1[__::cache_line];
+      atomic<size_t> dequeue_pos;
+      char pad2[__::cache_line];
+
+      cell* claim_push(size_type& pos)
+      {
+        pos = enqueue_pos.load(memory_order_relaxed);
+        for(;;){
+          cell* const c = &cells[pos & mask];
+          const intptr_t diff = static_cast<intptr_t>(c->sequence.load(memory_order_acquire) - pos);
+          if(diff == 0){
+            if(enqueue_pos.compare_exchange_weak(pos, pos + 1, memory_order_relaxed))
+              return c;
+          }else if(diff < 0){
+            // the consumer of the previous lap hasn't freed the cell yet
+            return nullptr;
+          }else
+            pos = enqueue_pos.load(memory_order_relaxed);
+        }
+      }
+
+      cell* claim_pop(size_type& pos)
+      {
+        pos = dequeue_pos.load(memory_order_relaxed);
+        for(;;){
+          cell* const c = &cells[pos & mask];
+          const intptr_t diff = static_cast<intptr_t>(c->sequence.load(memory_order_acquire) - (pos + 1));
+          if(diff == 0){
+            if(dequeue_pos.compare_exchange_weak(pos, pos + 1, memory_order_relaxed))
+              return c;
+          }else if(diff < 0){
+            return nullptr;
+          }else
+            pos = dequeue_pos.load(memory_order_relaxed);
+        }
+      }
+
+      mpmc_queue(const mpmc_queue&) __deleted;
+      mpmc_queue& operator=(const mpmc_queue&) __deleted;
+    };
+
+    /**
+     *	@brief Bounded wait-free single-producer single-consumer ring
+     *
+     *  Each side owns its index and keeps a copy of the other one, which is reloaded only when the ring looks
+     *  full (or empty) by the copy; so the index cache lines move between the cores once per lap at best rather than
+     *  per element. Only one thread may push and only one may pop at a time.
+     *
+     *  The capacity is rounded up to a power of two. The move of \c T must not throw.
+     **/
+    template<class T, class Allocator = allocator<T> >
+    class spsc_ring
+    {
+      typedef typename aligned_storage<sizeof(T), alignment_of<T>::value>::type slot;
+      typedef typename Allocator::template rebind<slot>::other slot_allocator;
+
+    public:
+      typedef T         value_type;
+      typedef size_t    size_type;
+      typedef Allocator allocator_type;
+
+      explicit spsc_ring(size_type capacity, const Allocator& a = Allocator())
+        :salloc(a), mask(__::queue_capacity(capacity) - 1), head(0), tail_copy(0), tail(0), head_copy(0)
+      {
+        slots = salloc.allocate(mask + 1);
+      }
+
+      ~spsc_ring()
+      {
+        for(size_type pos = head.load(memory_order_relaxed), end = tail.load(memory_order_relaxed); pos != end; pos++)
+          at(pos)->~T();
+        salloc.deallocate(slots, mask + 1);
+      }
+
+      /** Appends a copy of \p v unless the ring is full; the producer only */
+      bool try_push(const T& v)
+      {
+        const size_type pos = tail.load(memory_order_relaxed);
+        if(!room(pos))
+          return false;
+        ::new(static_cast<void*>(at(pos))) T(v);
+        tail.store(pos + 1, memory_order_release);
+        return true;
+      }
+
+#ifdef NTL_CXX_RV
+      /** Appends \p v unless the ring is full; the producer only */
+      bool try_push(T&& v)
+      {
+        const size_type pos = tail.load(memory_order_relaxed);
+        if(!room(pos))
+          return false;
+        ::new(static_cast<void*>(at(pos))) T(std::move(v));
+        tail.store(pos + 1, memory_order_release);
+        return true;
+      }
+#endif
+
+      /** Moves the oldest element to \p v unless the ring is empty; the consumer only */
+      bool try_pop(T& v)
+      {
+        const size_type pos = head.load(memory_order_relaxed);
+        if(pos == tail_copy){
+          tail_copy = tail.load(memory_order_acquire);
+          if(pos == tail_copy)
+            return false;
+        }
+        T* const p = at(pos);
+        v = std::move(*p);
+        p->~T();
+        head.store(pos + 1, memory_order_release);
+        return true;
+      }
+
+      size_type capacity() const { return mask + 1; }
+
+      /** The number of the elements, exact only while no other thread works with the ring */
+      size_type size() const
+      {
+        const size_type pos = head.load(memory_order_acquire);
+        return tail.load(memory_order_acquire) - pos;
+      }
+
+      bool empty() const { return size() == 0; }
+
+    private:
+      slot_allocator salloc;
+      slot* slots;
+      const size_type mask;
+      char pad0[__::cache_line];
+      // the consumer side
+      atomic<size_t> head;
+      size_type tail_copy;
+      char pad1[__::cache_line];
+      // the producer side
+      atomic<size_t> tail;
+      size_type head_copy;
+      char pad2[__::cache_line];
+
+      T* at(size_type pos) const { return reinterpret_cast<T*>(slots + (pos & mask)); }
+
+      bool room(size_type pos)
+      {
+        if(pos - head_copy <= mask)
+          return true;
+        head_copy = head.load(memory_order_acquire);
+        return pos - head_copy <= mask;
+      }
+
+      spsc_ring(const spsc_ring&) __deleted;
+      spsc_ring& operator=(const spsc_ring&) __deleted;
+    };
+
+    /**
+     *	@brief Blocking wrapper of the bounded queues
+     *
+     *  push() and pop() go through the lock-free \c Queue and take the mutex only to park the thread on the
+     *  condition variable when the queue is full (or empty). The other side checks the count of the parked
+     *  threads after each operation and notifies only when there are any, so the uncontended path has no lock.
+     *
+     *  close() wakes everybody: push() fails from then on, pop() still drains the queue and then fails.
+     *  The wrapper keeps the restrictions of \c Queue, the spsc_ring still wants a single producer and a single consumer.
+     **/
+    template<class Queue>
+    class blocking_queue
+    {
+    public:
+      typedef typename Queue::value_type  value_type;
+      typedef typename Queue::size_type   size_type;
+
+      explicit blocking_queue(size_type capacity)
+        :q(capacity), producers(0), consumers(0), closed_(false)
+      {}
+
+      /** Appends a copy of \p v, waits while the queue is full. Fails if the queue is closed. */
+      bool push(const value_type& v)
+      {
+        if(closed_.load(memory_order_acquire))
+          return false;
+        if(!q.try_push(v)){
+          unique_lock<mutex> lock(guard);
+          park _(producers);
+          while(!q.try_push(v)){
+            if(closed_.load(memory_order_acquire))
+              return false;
+            not_full.wait(lock);
+          }
+        }
+        wake(consumers, not_empty);
+        return true;
+      }
+
+#ifdef NTL_CXX_RV
+      /** Appends \p v, waits while the queue is full. Fails if the queue is closed. */
+      bool push(value_type&& v)
+      {
+        if(closed_.load(memory_order_acquire))
+          return false;
+        if(!q.try_push(std::move(v))){
+          unique_lock<mutex> lock(guard);
+          park _(producers);
+          while(!q.try_push(std::move(v))){
+            if(closed_.load(memory_order_acquire))
+              return false;
+            not_full.wait(lock);
+          }
+        }
+        wake(consumers, not_empty);
+        return true;
+      }
+#endif
+
+      /** Moves the oldest element to \p v, waits while the queue is empty. Fails if the queue is closed and empty. */
+      bool pop(value_type& v)
+      {
+        if(!q.try_pop(v)){
+          unique_lock<mutex> lock(guard);
+          park _(consumers);
+          while(!q.try_pop(v)){
+            if(closed_.load(memory_order_acquire))
+              return false;
+            not_empty.wait(lock);
+          }
+        }
+        wake(producers, not_full);
+        return true;
+      }
+
+      bool try_push(const value_type& v)
+      {
+        if(closed_.load(memory_order_acquire) || !q.try_push(v))
+          return false;
+        wake(consumers, not_empty);
+        return true;
+      }
+
+      bool try_pop(value_type& v)
+      {
+        if(!q.try_pop(v))
+          return false;
+        wake(producers, not_full);
+        return true;
+      }
+
+      /** Fails the pending and the future pushes, lets the pops drain the queue */
+      void close()
+      {
+        {
+          lock_guard<mutex> lock(guard);
+          closed_.store(true, memory_order_release);
+        }
+        not_full.notify_all();
+        not_empty.notify_all();
+      }
+
+      bool closed() const { return closed_.load(memory_order_acquire); }
+
+      size_type capacity() const { return q.capacity(); }
+      size_type size() const { return q.size(); }
+      bool empty() const { return q.empty(); }
+
+    private:
+      /** Counts the thread as parked while it rechecks the queue and waits */
+      struct park
+      {
+        atomic<unsigned>& count;
+        explicit park(atomic<unsigned>& count)
+          :count(count)
+        {
+          count.fetch_add(1);
+          atomic_thread_fence(memory_order_seq_cst);
+        }
+        ~park()
+        {
+          count.fetch_sub(1, memory_order_relaxed);
+        }
+      private:
+        park& operator=(const park&) __deleted;
+      };
+
+      /**
+       *	Notifies a parked thread of the other side. The fence orders the queue update before the count check,
+       *  as the park constructor orders the count update before the queue recheck, so one of them sees the other.
+       *  Taking the mutex makes sure the parked thread is already waiting.
+       **/
+      void wake(atomic<unsigned>& parked, condition_variable& cv)
+      {
+        atomic_thread_fence(memory_order_seq_cst);
+        if(parked.load(memory_order_relaxed)){
+          { lock_guard<mutex> lock(guard); }
+          cv.notify_one();
+        }
+      }
+
+      Queue q;
+      mutex guard;
+      condition_variable not_full, not_empty;
+      atomic<unsigned> producers, consumers;
+      atomic_bool closed_;
+
+      blocking_queue(const blocking_queue&) __deleted;
+      blocking_queue& operator=(const blocking_queue&) __deleted;
+    };
+  }
+}
+
+#endif // NTL__EXT_CONCURRENT_QUEUE
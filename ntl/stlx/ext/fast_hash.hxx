@@ -0,0 +1,243 @@
+/**\file*********************************************************************
+ *                                                                     \brief
+ *  Fast non-cryptographic hash functions
+ *
+ ****************************************************************************
+ */
+#ifndef NTL__EXT_FAST_HASH
+#define NTL__EXT_FAST_HASH
+#pragma once
+
+#include "../../cpu.hxx"
+#include "../../stdlib.hxx"
+#ifndef NTL__STLX_CSTDINT
+#include "../cstdint.hxx"
+#endif
+#ifndef NTL__STLX_CSTRING
+#include "../cstring.hxx"
+#endif
+
+#ifndef STLX__STRING_HASH
+// the hash<basic_string> and hash<basic_string_ref> implementation: 0 - FNV-1, 1 - CRC32C, 2 - wyhash
+#define STLX__STRING_HASH 2
+#endif
+
+namespace std
+{
+  namespace ext
+  {
+    /**
+     *	@brief Fast non-cryptographic hash functions
+     *
+     *  crc32c() is the Castagnoli CRC (iSCSI, RFC 3720), computed by the SSE4.2 crc32 instruction when
+     *  ntl::cpu::has() reports it and by the table otherwise. wyhash() is the 64-bit multiply-mix hash
+     *  after Wang Yi's wyhash: it reads 16 or 48 bytes per step and has no processor requirements.
+     *  hash_bytes() is the one selected by \c STLX__STRING_HASH, which the string hashes use.
+     **/
+    namespace hashing
+    {
+      namespace __
+      {
+        static const uint32_t crc32c_table[256] = {
+          0x00000000, 0xF26B8303, 0xE13B70F7, 0x1350F3F4, 0xC79A971F, 0x35F1141C, 0x26A1E7E8, 0xD4CA64EB,
+          0x8AD958CF, 0x78B2DBCC, 0x6BE22838, 0x9989AB3B, 0x4D43CFD0, 0xBF284CD3, 0xAC78BF27, 0x5E133C24,
+          0x105EC76F, 0xE235446C, 0xF165B798, 0x030E349B, 0xD7C45070, 0x25AFD373, 0x36FF2087, 0xC494A384,
+          0x9A879FA0, 0x68EC1CA3, 0x7BBCEF57, 0x89D76C54, 0x5D1D08BF, 0xAF768BBC, 0xBC267848, 0x4E4DFB4B,
+          0x20BD8EDE, 0xD2D60DDD, 0xC186FE29, 0x33ED7D2A, 0xE72719C1, 0x154C9AC2, 0x061C6936, 0xF477EA35,
+          0xAA64D611, 0x580F5512, 0x4B5FA6E6, 0xB93425E5, 0x6DFE410E, 0x9F95C20D, 0x8CC531F9, 0x7EAEB2FA,
+          0x30E349B1, 0xC288CAB2, 0xD1D83946, 0x23B3BA45, 0xF779DEAE, 0x05125DAD, 0x1642AE59, 0xE4292D5A,
+          0xBA3A117E, 0x4851927D, 0x5B016189, 0xA96AE28A, 0x7DA08661, 0x8FCB0562, 0x9C9BF696, 0x6EF07595,
+          0x417B1DBC, 0xB3109EBF, 0xA0406D4B, 0x522BEE48, 0x86E18AA3, 0x748A09A0, 0x67DAFA54, 0x95B17957,
+          0xCBA24573, 0x39C9C670, 0x2A993584, 0xD8F2B687, 0x0C38D26C, 0xFE53516F, 0xED03A29B, 0x1F682198,
+          0x5125DAD3, 0xA34E59D0, 0xB01EAA24, 0x42752927, 0x96BF4DCC, 0x64D4CECF, 0x77843D3B, 0x85EFBE38,
+          0xDBFC821C, 0x2997011F, 0x3AC7F2EB, 0xC8AC71E8, 0x1C661503, 0xEE0D9600, 0xFD5D65F4, 0x0F36E6F7,
+          0x61C69362, 0x93AD1061, 0x80FDE395, 0x72966096, 0xA65C047D, 0x5437877E, 0x4767748A, 0xB50CF789,
+          0xEB1FCBAD, 0x197448AE, 0x0A24BB5A, 0xF84F3859, 0x2C855CB2, 0xDEEEDFB1, 0xCDBE2C45, 0x3FD5AF46,
+          0x7198540D, 0x83F3D70E, 0x90A324FA, 0x62C8A7F9, 0xB602C312, 0x44694011, 0x5739B3E5, 0xA55230E6,
+          0xFB410CC2, 0x092A8FC1, 0x1A7A7C35, 0xE811FF36, 0x3CDB9BDD, 0xCEB018DE, 0xDDE0EB2A, 0x2F8B6829,
+          0x82F63B78, 0x709DB87B, 0x63CD4B8F, 0x91A6C88C, 0x456CAC67, 0xB7072F64, 0xA457DC90, 0x563C5F93,
+          0x082F63B7, 0xFA44E0B4, 0xE9141340, 0x1B7F9043, 0xCFB5F4A8, 0x3DDE77AB, 0x2E8E845F, 0xDCE5075C,
+          0x92A8FC17, 0x60C37F14, 0x73938CE0, 0x81F80FE3, 0x55326B08, 0xA759E80B, 0xB4091BFF, 0x466298FC,
+          0x1871A4D8, 0xEA1A27DB, 0xF94AD42F, 0x0B21572C, 0xDFEB33C7, 0x2D80B0C4, 0x3ED04330, 0xCCBBC033,
+          0xA24BB5A6, 0x502036A5, 0x4370C551, 0xB11B4652, 0x65D122B9, 0x97BAA1BA, 0x84EA524E, 0x7681D14D,
+          0x2892ED69, 0xDAF96E6A, 0xC9A99D9E, 0x3BC21E9D, 0xEF087A76, 0x1D63F975, 0x0E330A81, 0xFC588982,
+          0xB21572C9, 0x407EF1CA, 0x532E023E, 0xA145813D, 0x758FE5D6, 0x87E466D5, 0x94B49521, 0x66DF1622,
+          0x38CC2A06, 0xCAA7A905, 0xD9F75AF1, 0x2B9CD9F2, 0xFF56BD19, 0x0D3D3E1A, 0x1E6DCDEE, 0xEC064EED,
+          0xC38D26C4, 0x31E6A5C7, 0x22B65633, 0xD0DDD530, 0x0417B1DB, 0xF67C32D8, 0xE52CC12C, 0x1747422F,
+          0x49547E0B, 0xBB3FFD08, 0xA86F0EFC, 0x5A048DFF, 0x8ECEE914, 0x7CA56A17, 0x6FF599E3, 0x9D9E1AE0,
+          0xD3D3E1AB, 0x21B862A8, 0x32E8915C, 0xC083125F, 0x144976B4, 0xE622F5B7, 0xF5720643, 0x07198540,
+          0x590AB964, 0xAB613A67, 0xB831C993, 0x4A5A4A90, 0x9E902E7B, 0x6CFBAD78, 0x7FAB5E8C, 0x8DC0DD8F,
+          0xE330A81A, 0x115B2B19, 0x020BD8ED, 0xF0605BEE, 0x24AA3F05, 0xD6C1BC06, 0xC5914FF2, 0x37FACCF1,
+          0x69E9F0D5, 0x9B8273D6, 0x88D28022, 0x7AB90321, 0xAE7367CA, 0x5C18E4C9, 0x4F48173D, 0xBD23943E,
+          0xF36E6F75, 0x0105EC76, 0x12551F82, 0xE03E9C81, 0x34F4F86A, 0xC69F7B69, 0xD5CF889D, 0x27A40B9E,
+          0x79B737BA, 0x8BDCB4B9, 0x988C474D, 0x6AE7C44E, 0xBE2DA0A5, 0x4C4623A6, 0x5F16D052, 0xAD7D5351
+        };
+
+        inline uint32_t crc32c_soft(uint32_t crc, const uint8_t* p, size_t size)
+        {
+          for(; size; --size, ++p)
+            crc = crc32c_table[(crc ^ *p) & 0xFF] ^ (crc >> 8);
+          return crc;
+        }
+
+#ifdef NTL_CPU_SSE2
+        NTL_CPU_TARGET("sse4.2")
+        inline uint32_t crc32c_sse42(uint32_t crc, const uint8_t* p, size_t size)
+        {
+          using namespace ntl::intrinsic;
+# if defined(_M_X64) || defined(__x86_64__)
+          uint64_t c = crc;
+          for(; size >= 8; size -= 8, p += 8){
+            uint64_t v;
+            memcpy(&v, p, sizeof(v));
+            c = _mm_crc32_u64(c, v);
+          }
+          crc = static_cast<uint32_t>(c);
+# else
+          for(; size >= 4; size -= 4, p += 4){
+            uint32_t v;
+            memcpy(&v, p, sizeof(v));
+            crc = _mm_crc32_u32(crc, v);
+          }
+# endif
+          for(; size; --size, ++p)
+            crc = _mm_crc32_u8(crc, *p);
+          return crc;
+        }
+#endif
+
+        /** The full 128-bit product of \p a and \p b: the lower half goes to \p a, the upper one to \p b */
+        inline void multiply(uint64_t& a, uint64_t& b)
+        {
+#if defined(__SIZEOF_INT128__)
+          const unsigned __int128 r = static_cast<unsigned __int128>(a) * b;
+          a = static_cast<uint64_t>(r), b = static_cast<uint64_t>(r >> 64);
+#elif defined(_MSC_VER) && defined(_M_X64)
+          a = ntl::intrinsic::_umul128(a, b, &b);
+#else
+          const uint64_t mask = 0xFFFFFFFF;
+          const uint64_t a1 = a >> 32, a0 = a & mask, b1 = b >> 32, b0 = b & mask;
+          const uint64_t p00 = a0 * b0, p01 = a0 * b1, p10 = a1 * b0, p11 = a1 * b1;
+          const uint64_t middle = (p00 >> 32) + (p01 & mask) + (p10 & mask);
+          a = (middle << 32) | (p00 & mask);
+          b = p11 + (p01 >> 32) + (p10 >> 32) + (middle >> 32);
+#endif
+        }
+
+        inline uint64_t mix(uint64_t a, uint64_t b)
+        {
+          multiply(a, b);
+          return a ^ b;
+        }
+
+        inline uint64_t read8(const uint8_t* p)
+        {
+          uint64_t v;
+          memcpy(&v, p, sizeof(v));
+          return v;
+        }
+
+        inline uint64_t read4(const uint8_t* p)
+        {
+          uint32_t v;
+          memcpy(&v, p, sizeof(v));
+          return v;
+        }
+
+        /** One to three bytes: the first, the middle and the last ones */
+        inline uint64_t read3(const uint8_t* p, size_t size)
+        {
+          return (static_cast<uint64_t>(p[0]) << 16) | (static_cast<uint64_t>(p[size >> 1]) << 8) | p[size - 1];
+        }
+
+        static const uint64_t secret[4] = {
+          0xA0761D6478BD642FULL, 0xE7037ED1A0B428DBULL, 0x8EBC6AF09C88C6E3ULL, 0x589965CC75374CC3ULL
+        };
+      }
+
+      /** CRC-32C of the data, \p crc is the CRC of the preceding data */
+      inline uint32_t crc32c(const void* data, size_t size, uint32_t crc = 0)
+      {
+        const uint8_t* const p = reinterpret_cast<const uint8_t*>(data);
+#ifdef NTL_CPU_SSE2
+        if(ntl::cpu::has(ntl::cpu::sse42))
+          return ~__::crc32c_sse42(~crc, p, size);
+#endif
+        return ~__::crc32c_soft(~crc, p, size);
+      }
+
+      /** 64-bit hash of the data */
+      inline uint64_t wyhash(const void* data, size_t size, uint64_t seed = 0)
+      {
+        using namespace __;
+        const uint8_t* p = reinterpret_cast<const uint8_t*>(data);
+        seed ^= mix(seed ^ secret[0], secret[1]);
+        uint64_t a, b;
+        if(size <= 16){
+          if(size >= 4){
+            // two overlapping pairs of the 4-byte words
+            const size_t shift = (size >> 3) << 2;
+            a = (read4(p) << 32) | read4(p + shift);
+            b = (read4(p + size - 4) << 32) | read4(p + size - 4 - shift);
+          }else if(size > 0){
+            a = read3(p, size);
+            b = 0;
+          }else{
+            a = b = 0;
+          }
+        }else{
+          size_t i = size;
+          if(i > 48){
+            // three independent lanes
+            uint64_t see1 = seed, see2 = seed;
+            do{
+              seed = mix(read8(p) ^ secret[1], read8(p + 8) ^ seed);
+              see1 = mix(read8(p + 16) ^ secret[2], read8(p + 24) ^ see1);
+              see2 = mix(read8(p + 32) ^ secret[3], read8(p + 40) ^ see2);
+              p += 48, i -= 48;
+            }while(i > 48);
+            seed ^= see1 ^ see2;
+          }
+          for(; i > 16; p += 16, i -= 16)
+            seed = mix(read8(p) ^ secret[1], read8(p + 8) ^ seed);
+          // the last 16 bytes, overlapping the processed ones
+          a = read8(p + i - 16);
+          b = read8(p + i - 8);
+        }
+        a ^= secret[1];
+        b ^= seed;
+        multiply(a, b);
+        return mix(a ^ secret[0] ^ size, b ^ secret[1]);
+      }
+
+      /** FNV-1 hash of the data, the same as std::__::FNVHash */
+      inline size_t fnv(const void* data, size_t size)
+      {
+#if __SIZEOF_POINTER__ == 8 || defined(_M_X64)
+        size_t h = 14695981039346656037ULL;
+        const size_t prime = 0x100000001B3ULL;
+#else
+        size_t h = 2166136261UL;
+        const size_t prime = 0x01000193;
+#endif
+        for(const uint8_t* p = reinterpret_cast<const uint8_t*>(data); size--; p++)
+          h = h * prime ^ *p;
+        return h;
+      }
+
+      /** The hash of the data selected by \c STLX__STRING_HASH */
+      inline size_t hash_bytes(const void* data, size_t size)
+      {
+#if STLX__STRING_HASH == 0
+        return fnv(data, size);
+#elif STLX__STRING_HASH == 1
+        return crc32c(data, size);
+#else
+        return static_cast<size_t>(wyhash(data, size));
+#endif
+      }
+    }
+  }
+}
+
+#endif // NTL__EXT_FAST_HASH
@@ -0,0 +1,857 @@
+/**\file*********************************************************************
+ *                                                                     \brief
+ *  Open addressing hash table
+ *
+ ****************************************************************************
+ */
+#ifndef NTL__EXT_FLAT_HASHTABLE
+#define NTL__EXT_FLAT_HASHTABLE
+#pragma once
+
+#include "hashtable.hxx"
+#include "../../cpu.hxx"
+#include "../../stdlib.hxx"
+
+namespace std
+{
+  namespace ext
+  {
+    namespace hashtable
+    {
+      namespace __
+      {
+        /**
+         *	Slot control byte. Full slots keep the low 7 bits of the key hash,
+         *  free slots are marked by the negative values below.
+         **/
+        typedef int8_t ctrl_t;
+
+        static const ctrl_t ctrl_empty    = static_cast<ctrl_t>(-128);
+        static const ctrl_t ctrl_deleted  = -2;
+        static const ctrl_t ctrl_sentinel = -1;
+
+        /** Control bytes of the table without slots: \c begin() and \c end() both point here */
+        inline ctrl_t* empty_ctrl()
+        {
+          static ctrl_t sentinel[1] = { ctrl_sentinel };
+          return sentinel;
+        }
+
+        /** Index of the lowest set bit of the nonzero \p mask */
+        inline unsigned lowest_bit(uint32_t mask)
+        {
+          return ntl::bsf(mask);
+        }
+
+        /**
+         *	Group of the adjacent control bytes which are probed as a whole.
+         *  Each match function returns a bitmask with a bit set for every matched slot of the group.
+         **/
+        struct ctrl_group_portable
+        {
+          static const size_t width = 16;
+
+          explicit ctrl_group_portable(const ctrl_t* pos)
+            :ctrl(pos)
+          {}
+
+          uint32_t match(ctrl_t h2) const
+          {
+            uint32_t mask = 0;
+            for(unsigned i = 0; i < width; i++)
+              if(ctrl[i] == h2)
+                mask |= 1u << i;
+            return mask;
+          }
+
+          uint32_t match_empty() const
+          {
+            return match(ctrl_empty);
+          }
+
+          uint32_t match_empty_or_deleted() const
+          {
+            uint32_t mask = 0;
+            for(unsigned i = 0; i < width; i++)
+              if(ctrl[i] < ctrl_sentinel)
+                mask |= 1u << i;
+            return mask;
+          }
+
+          const ctrl_t* ctrl;
+        };
+
+#ifdef NTL_CPU_SSE2
+        /**
+         *	The control group probed by SSE2: all 16 control bytes are compared by a single instruction,
+         *  so a lookup miss is usually detected without touching any key.
+         **/
+        struct ctrl_group_sse2
+        {
+          static const size_t width = 16;
+
+          explicit ctrl_group_sse2(const ctrl_t* pos)
+            :ctrl(ntl::intrinsic::_mm_loadu_si128(reinterpret_cast<const __m128i*>(pos)))
+          {}
+
+          uint32_t match(ctrl_t h2) const
+          {
+            using namespace ntl::intrinsic;
+            return static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_set1_epi8(h2), ctrl)));
+          }
+
+          uint32_t match_empty() const
+          {
+            return match(ctrl_empty);
+          }
+
+          uint32_t match_empty_or_deleted() const
+          {
+            // ctrl < ctrl_sentinel
+            using namespace ntl::intrinsic;
+            return static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpgt_epi8(_mm_set1_epi8(ctrl_sentinel), ctrl)));
+          }
+
+          __m128i ctrl;
+        };
+
+        typedef ctrl_group_sse2     ctrl_group;
+#else
+        typedef ctrl_group_portable ctrl_group;
+#endif
+      }
+
+      /**
+       *	@brief Open addressing hash table
+       *
+       *  Elements are stored inline in a single slots array accompanied by a control bytes array.
+       *  A control byte of a full slot keeps 7 bits of the key hash, so the key comparison is performed
+       *  only for the slots with the matching hash fragment. Slots are probed by groups of ctrl_group::width
+       *  using the quadratic probing over groups.
+       *
+       *  Supports only unique keys; iterators and references are invalidated by rehashing.
+       **/
+      template<class Key, class Value,
+              class Hash = std::hash<Key>,
+              class Pred = std::equal_to<Key>,
+              class Allocator = std::allocator<std::pair<const Key,Value> >,
+              bool IsMap = true
+              >
+      class flat_hashtable:
+        public __::container_policy<Key,Value,IsMap>
+      {
+        typedef flat_hashtable                        hashtable;
+        typedef __::container_policy<Key,Value,IsMap> policy;
+
+        typedef integral_constant<bool, IsMap>        is_map;
+
+        typedef typename Allocator::template rebind<typename policy::value_type>::other allocator;
+      public:
+        /** default number of buckets: a single control group */
+        static const typename allocator::size_type initial_count = __::ctrl_group::width;
+
+        ///\name types
+        typedef typename policy::value_type           value_type;
+        typedef typename policy::key_type             key_type;
+
+        typedef           Hash                        hasher;
+        typedef           Pred                        key_equal;
+        typedef           Allocator                   allocator_type;
+
+        typedef typename  allocator::pointer          pointer;
+        typedef typename  allocator::const_pointer    const_pointer;
+        typedef typename  allocator::reference        reference;
+        typedef typename  allocator::const_reference  const_reference;
+        typedef typename  allocator::size_type        size_type;
+        typedef typename  allocator::difference_type  difference_type;
+        ///\}
+
+      protected:
+        // hash value type
+        typedef size_t hash_t;
+
+        typedef __::ctrl_t     ctrl_t;
+        typedef __::ctrl_group group;
+
+        typedef typename allocator_type::template rebind<value_type>::other node_allocator;
+        typedef typename allocator_type::template rebind<ctrl_t>::other     ctrl_allocator;
+
+        static const size_type npos = static_cast<size_type>(-1);
+
+        struct iterator_impl:
+          std::iterator<forward_iterator_tag, value_type, difference_type, pointer, reference>
+        {
+          iterator_impl()
+            :c(), p()
+          {}
+
+          reference operator* () const { return *p; }
+          pointer   operator->() const { return p; }
+          iterator_impl & operator++()
+          {
+            ++c, ++p;
+            skip_free();
+            return *this;
+          }
+          iterator_impl operator++(int)
+          {
+            iterator_impl tmp(*this);
+            ++*this;
+            return tmp;
+          }
+
+          friend bool operator==(const iterator_impl& x, const iterator_impl& y)
+          { return x.c == y.c; }
+
+          friend bool operator!=(const iterator_impl& x, const iterator_impl& y)
+          { return x.c != y.c; }
+
+        private:
+          iterator_impl(ctrl_t* c, value_type* p)
+            :c(c), p(p)
+          {}
+
+          void skip_free()
+          {
+            // the sentinel stops the scan at the end of table
+            while(*c < __::ctrl_sentinel)
+              ++c, ++p;
+          }
+
+          ctrl_t* c;
+          value_type* p;
+
+          friend class flat_hashtable;
+          friend struct const_iterator_impl;
+        };
+
+        struct const_iterator_impl:
+          std::iterator<forward_iterator_tag, const value_type, difference_type, const_pointer, const_reference>
+        {
+          const_iterator_impl()
+            :c(), p()
+          {}
+          const_iterator_impl(const iterator_impl& i)
+            :c(i.c), p(i.p)
+          {}
+
+          const_reference operator* () const { return *p; }
+          const_pointer   operator->() const { return p; }
+          const_iterator_impl& operator++()
+          {
+            ++c, ++p;
+            while(*c < __::ctrl_sentinel)
+              ++c, ++p;
+            return *this;
+          }
+          const_iterator_impl operator++(int)
+          {
+            const_iterator_impl tmp(*this);
+            ++*this;
+            return tmp;
+          }
+
+          friend bool
+            operator==(const const_iterator_impl& x, const const_iterator_impl& y)
+          { return x.c == y.c; }
+
+          friend bool
+            operator!=(const const_iterator_impl& x, const const_iterator_impl& y)
+          { return x.c != y.c; }
+
+        private:
+          const ctrl_t* c;
+          const value_type* p;
+
+          friend class flat_hashtable;
+        };
+
+        /** Each slot is a bucket, so the local iterator visits one element at most */
+        struct local_iterator_impl:
+          std::iterator<forward_iterator_tag, value_type, difference_type, pointer, reference>
+        {
+          local_iterator_impl(value_type* p = nullptr)
+            :p(p)
+          {}
+
+          reference operator* () const { return *p; }
+          pointer   operator->() const { return p; }
+          local_iterator_impl & operator++()
+          {
+            p = nullptr;
+            return *this;
+          }
+          local_iterator_impl operator++(int)
+          {
+            local_iterator_impl tmp(*this);
+            ++*this;
+            return tmp;
+          }
+
+          friend bool operator==(const local_iterator_impl& x, const local_iterator_impl& y)
+          { return x.p == y.p; }
+
+          friend bool operator!=(const local_iterator_impl& x, const local_iterator_impl& y)
+          { return x.p != y.p; }
+
+        private:
+          value_type* p;
+          friend struct const_local_iterator_impl;
+        };
+
+        struct const_local_iterator_impl:
+          std::iterator<forward_iterator_tag, const value_type, difference_type, const_pointer, const_reference>
+        {
+          const_local_iterator_impl(const value_type* p = nullptr)
+            :p(p)
+          {}
+          const_local_iterator_impl(const local_iterator_impl& i)
+            :p(i.p)
+          {}
+
+          const_reference operator* () const { return *p; }
+          const_pointer   operator->() const { return p; }
+          const_local_iterator_impl& operator++()
+          {
+            p = nullptr;
+            return *this;
+          }
+          const_local_iterator_impl operator++(int)
+          {
+            const_local_iterator_impl tmp(*this);
+            ++*this;
+            return tmp;
+          }
+
+          friend bool
+            operator==(const const_local_iterator_impl& x, const const_local_iterator_impl& y)
+          { return x.p == y.p; }
+
+          friend bool
+            operator!=(const const_local_iterator_impl& x, const const_local_iterator_impl& y)
+          { return x.p != y.p; }
+
+        private:
+          const value_type* p;
+        };
+
+      public:
+        typedef iterator_impl                         iterator;
+        typedef const_iterator_impl                   const_iterator;
+
+        typedef local_iterator_impl                   local_iterator;
+        typedef const_local_iterator_impl             const_local_iterator;
+
+      public:
+        ///\name Construct/copy/destroy
+        explicit flat_hashtable(size_type n, const hasher& hf = hasher(), const key_equal& eql = key_equal(), const allocator_type& a = allocator_type())
+          :ctrl_(__::empty_ctrl()), slots_(), capacity_(0), count_(0), growth_left_(0), max_factor(default_factor()),
+          hash_(hf), equal_(eql), nalloc(a), calloc_(a)
+        {
+          rehash(n);
+        }
+        ~flat_hashtable()
+        {
+          free_table();
+        }
+        flat_hashtable(const flat_hashtable& r)
+          :ctrl_(__::empty_ctrl()), slots_(), capacity_(0), count_(0), growth_left_(0), max_factor(r.max_factor),
+          hash_(r.hash_), equal_(r.equal_), nalloc(r.nalloc), calloc_(r.calloc_)
+        {
+          copy_from(r);
+        }
+        flat_hashtable(const flat_hashtable& r, const allocator_type& a)
+          :ctrl_(__::empty_ctrl()), slots_(), capacity_(0), count_(0), growth_left_(0), max_factor(r.max_factor),
+          hash_(r.hash_), equal_(r.equal_), nalloc(a), calloc_(a)
+        {
+          copy_from(r);
+        }
+        flat_hashtable& operator=(const flat_hashtable& r)
+        {
+          if(this != &r)
+            flat_hashtable(r).swap(*this);
+          return *this;
+        }
+#ifdef NTL_CXX_RV
+        flat_hashtable(flat_hashtable&& r)
+          :ctrl_(__::empty_ctrl()), slots_(), capacity_(0), count_(0), growth_left_(0), max_factor(r.max_factor),
+          hash_(std::move(r.hash_)), equal_(std::move(r.equal_)), nalloc(std::move(r.nalloc)), calloc_(std::move(r.calloc_))
+        {
+          swap_table(r);
+        }
+        flat_hashtable(flat_hashtable&& r, const allocator_type& a)
+          :ctrl_(__::empty_ctrl()), slots_(), capacity_(0), count_(0), growth_left_(0), max_factor(r.max_factor),
+          hash_(r.hash_), equal_(r.equal_), nalloc(a), calloc_(a)
+        {
+          if(r.nalloc == nalloc){
+            swap_table(r);
+          }else{
+            copy_from(r);
+            r.clear();
+          }
+        }
+        flat_hashtable& operator=(flat_hashtable&& r)
+        {
+          if(this != &r){
+            free_table();
+            swap(r);
+          }
+          return *this;
+        }
+#endif
+        ///\name size and capacity
+        bool empty() const { return count_ == 0; }
+        size_type size() const { return count_;  }
+        size_type max_size() const { return nalloc.max_size(); }
+
+        ///\name iterators
+        iterator begin()
+        {
+          iterator i(ctrl_, slots_);
+          i.skip_free();
+          return i;
+        }
+        const_iterator begin() const  { return const_cast<hashtable*>(this)->begin(); }
+        const_iterator cbegin() const { return const_cast<hashtable*>(this)->begin(); }
+        iterator end()                { return iterator(ctrl_ + capacity_, slots_ + capacity_); }
+        const_iterator end() const    { return const_cast<hashtable*>(this)->end(); }
+        const_iterator cend() const   { return const_cast<hashtable*>(this)->end(); }
+
+        ///\name modifiers
+        std::pair<iterator, bool> insert(const value_type& v)
+        {
+          const hash_t h = hash_key(value2key(v, is_map()));
+          size_type i = find_index(value2key(v, is_map()), h);
+          if(i != npos)
+            return std::make_pair(make_iterator(i), false);
+          i = prepare_insert(h);
+          nalloc.construct(slots_ + i, v);
+          commit_insert(i, h);
+          return std::make_pair(make_iterator(i), true);
+        }
+
+#ifdef NTL_CXX_RV
+        std::pair<iterator, bool> insert(value_type&& v)
+        {
+          const hash_t h = hash_key(value2key(v, is_map()));
+          size_type i = find_index(value2key(v, is_map()), h);
+          if(i != npos)
+            return std::make_pair(make_iterator(i), false);
+          i = prepare_insert(h);
+          nalloc.construct(slots_ + i, std::move(v));
+          commit_insert(i, h);
+          return std::make_pair(make_iterator(i), true);
+        }
+#endif
+
+        iterator insert(const_iterator /*hint*/, const value_type& v)
+        {
+          return insert(v).first;
+        }
+
+        template <class InputIterator>
+        void insert(InputIterator first, InputIterator last)
+        {
+          for(; first != last; ++first)
+            insert(*first);
+        }
+
+        iterator erase(const_iterator position)
+        {
+          if(position == cend())
+            return end();
+          const size_type i = position.p - slots_;
+          erase_slot(i);
+          iterator next = make_iterator(i);
+          next.skip_free();
+          return next;
+        }
+
+        size_type erase(const key_type& k)
+        {
+          const size_type i = find_index(k, hash_key(k));
+          if(i == npos)
+            return 0;
+          erase_slot(i);
+          return 1;
+        }
+
+        iterator erase(const_iterator first, const_iterator last)
+        {
+          while(first != last)
+            first = erase(first);
+          return make_iterator(last.p - slots_);
+        }
+
+        void clear()
+        {
+          if(count_){
+            for(size_type i = 0; i < capacity_; i++){
+              if(ctrl_[i] >= 0)
+                nalloc.destroy(slots_ + i);
+            }
+            count_ = 0;
+          }
+          if(capacity_){
+            memset(ctrl_, __::ctrl_empty, capacity_);
+            growth_left_ = growth_limit(capacity_);
+          }
+        }
+
+        void swap(hashtable& x)
+        {
+          if(this == &x)
+            return;
+
+          using std::swap;
+          swap_table(x);
+          swap(nalloc,   x.nalloc);
+          swap(calloc_,  x.calloc_);
+          swap(hash_,    x.hash_);
+          swap(equal_,   x.equal_);
+          swap(max_factor, x.max_factor);
+        }
+
+        ///\name observers
+        hasher hash_function()  const { return hash_;  }
+        key_equal key_eq()      const { return equal_; }
+
+        ///\name lookup
+        iterator find(const key_type& k)
+        {
+          const size_type i = find_index(k, hash_key(k));
+          return i == npos ? end() : make_iterator(i);
+        }
+
+        const_iterator find(const key_type& k) const
+        {
+          return const_cast<hashtable*>(this)->find(k);
+        }
+
+        size_type count(const key_type& k) const
+        {
+          return find_index(k, hash_key(k)) != npos ? 1 : 0;
+        }
+
+        std::pair<iterator, iterator> equal_range(const key_type& k)
+        {
+          iterator i = find(k), e = i;
+          if(e != end())
+            ++e;
+          return make_pair(i, e);
+        }
+
+        std::pair<const_iterator, const_iterator> equal_range(const key_type& k) const
+        {
+          return const_cast<hashtable*>(this)->equal_range(k);
+        }
+
+        ///\name bucket interface
+        size_type bucket_count() const { return capacity_; }
+        size_type max_bucket_count() const { return nalloc.max_size(); }
+
+        size_type bucket_size(size_type n) const
+        {
+          assert(n < bucket_count());
+          return ctrl_[n] >= 0 ? 1 : 0;
+        }
+
+        /** Returns the slot of the key if it exists, or the first slot of the key's probe sequence otherwise */
+        size_type bucket(const key_type& k) const
+        {
+          const hash_t h = hash_key(k);
+          const size_type i = find_index(k, h);
+          return i != npos ? i : (h1(h) & group_mask()) * group::width;
+        }
+
+        local_iterator begin(size_type n)
+        {
+          assert(n < bucket_count());
+          return ctrl_[n] >= 0 ? slots_ + n : nullptr;
+        }
+        const_local_iterator begin(size_type n) const
+        {
+          assert(n < bucket_count());
+          return ctrl_[n] >= 0 ? slots_ + n : nullptr;
+        }
+        const_local_iterator cbegin(size_type n)const { return begin(n); }
+
+        local_iterator end(size_type n)
+        {
+          assert(n < bucket_count()); (void)n;
+          return local_iterator(nullptr);
+        }
+        const_local_iterator end(size_type n)   const
+        {
+          assert(n < bucket_count()); (void)n;
+          return const_local_iterator(nullptr);
+        }
+        const_local_iterator cend(size_type n)  const { return end(n); }
+
+        ///\name hash policy
+        float load_factor() const     { return capacity_ ? float(count_) / capacity_ : 0.0f; }
+        float max_load_factor() const { return max_factor; }
+        /** Changes the maximum load factor, which is limited by 7/8 to keep free slots which terminate probing */
+        void max_load_factor(float z)
+        {
+          assert(z > 0);
+          max_factor = z < default_factor() ? z : default_factor();
+          if(capacity_)
+            resize(capacity_for(count_));
+        }
+
+        /** Rebuilds the table with at least \c n buckets, rounded up to a power of two which holds the current elements */
+        void rehash(size_type n)
+        {
+          size_type capacity = capacity_for(count_);
+          while(capacity < n)
+            capacity <<= 1;
+          if(capacity != capacity_ || growth_left_ == 0)
+            resize(capacity);
+        }
+
+        /** Rebuilds the table to hold at least \c n elements without rehashing */
+        void reserve(size_type n)
+        {
+          rehash(capacity_for(n));
+        }
+        ///\}
+
+      protected:
+        static float default_factor() { return 0.875f; }
+
+        /** Spreads the hash over all bits: the integral std::hash is an identity function */
+        static hash_t hash_mix(hash_t h)
+        {
+        #ifndef _M_X64
+          h *= 0x9E3779B9u;
+          return h ^ (h >> 16);
+        #else
+          h *= 0x9E3779B97F4A7C15ull;
+          return h ^ (h >> 32);
+        #endif
+        }
+
+        hash_t hash_key(const key_type& k) const { return hash_mix(hash_(k)); }
+
+        static size_type h1(hash_t h) { return static_cast<size_type>(h >> 7); }
+        static ctrl_t    h2(hash_t h) { return static_cast<ctrl_t>(h & 0x7F); }
+
+        size_type group_mask() const { return capacity_ / group::width - 1; }
+
+        size_type growth_limit(size_type capacity) const
+        {
+          const size_type limit = static_cast<size_type>(capacity * max_factor);
+          return limit == 0 ? 1 : limit < capacity ? limit : capacity - 1;
+        }
+
+        /** Smallest power of two capacity which holds \c n elements */
+        size_type capacity_for(size_type n) const
+        {
+          size_type capacity = group::width;
+          while(growth_limit(capacity) < n)
+            capacity <<= 1;
+          return capacity;
+        }
+
+        iterator make_iterator(size_type i)
+        {
+          return iterator(ctrl_ + i, slots_ + i);
+        }
+
+        size_type find_index(const key_type& k, hash_t h) const
+        {
+          if(!capacity_)
+            return npos;
+          const size_type mask = group_mask();
+          const ctrl_t fragment = h2(h);
+          size_type g = h1(h) & mask;
+          for(size_type step = 0; ; g = (g + ++step) & mask){
+            const size_type base = g * group::width;
+            const group grp(ctrl_ + base);
+            for(uint32_t m = grp.match(fragment); m; m &= m - 1){
+              const size_type i = base + __::lowest_bit(m);
+              if(equal_(k, value2key(slots_[i], is_map())))
+                return i;
+            }
+            // an empty slot terminates the probe sequence
+            if(grp.match_empty())
+              return npos;
+          }
+        }
+
+        size_type find_free(hash_t h) const
+        {
+          return find_free(ctrl_, capacity_, h);
+        }
+
+        static size_type find_free(const ctrl_t* ctrl, size_type capacity, hash_t h)
+        {
+          const size_type mask = capacity / group::width - 1;
+          size_type g = h1(h) & mask;
+          for(size_type step = 0; ; g = (g + ++step) & mask){
+            const uint32_t m = group(ctrl + g * group::width).match_empty_or_deleted();
+            if(m)
+              return g * group::width + __::lowest_bit(m);
+          }
+        }
+
+        /** Returns a free slot for the new element, growing the table if needed */
+        size_type prepare_insert(hash_t h)
+        {
+          if(!capacity_)
+            resize(capacity_for(1));
+          size_type i = find_free(h);
+          if(growth_left_ == 0 && ctrl_[i] != __::ctrl_deleted){
+            // reclaim tombstones if they hold a half of the growth limit, grow otherwise
+            size_type capacity = capacity_;
+            if(count_ * 2 >= growth_limit(capacity_))
+              capacity = max(capacity_ * 2, capacity_for(count_ + 1));
+            resize(capacity);
+            i = find_free(h);
+          }
+          return i;
+        }
+
+        void commit_insert(size_type i, hash_t h)
+        {
+          if(ctrl_[i] == __::ctrl_empty)
+            --growth_left_;
+          ctrl_[i] = h2(h);
+          ++count_;
+        }
+
+        void erase_slot(size_type i)
+        {
+          nalloc.destroy(slots_ + i);
+          --count_;
+          // Probing passes through the group only when it was full, so the slot of
+          // a group which still has an empty slot can be reused as empty.
+          const size_type base = i & ~(group::width - 1);
+          if(group(ctrl_ + base).match_empty()){
+            ctrl_[i] = __::ctrl_empty;
+            ++growth_left_;
+          }else{
+            ctrl_[i] = __::ctrl_deleted;
+          }
+        }
+
+        /**
+         *  Moves all elements to the new table with the given capacity.
+         *  The table is left unchanged if an allocation, the hash or the element copy throws.
+         **/
+        void resize(size_type capacity)
+        {
+          ctrl_t* const ctrl = calloc_.allocate(capacity + 1);
+          value_type* slots = nullptr;
+          __ntl_try{
+            slots = nalloc.allocate(capacity);
+          }
+          __ntl_catch(...){
+            calloc_.deallocate(ctrl, capacity + 1);
+            __ntl_rethrow;
+          }
+          memset(ctrl, __::ctrl_empty, capacity);
+          ctrl[capacity] = __::ctrl_sentinel;
+
+          __ntl_try{
+            for(size_type i = 0; i < capacity_; i++){
+              if(ctrl_[i] < 0)
+                continue;
+              value_type& v = slots_[i];
+              const hash_t h = hash_key(value2key(v, is_map()));
+              const size_type n = find_free(ctrl, capacity, h);
+              // the elements which may throw on move are copied, so the old table stays intact
+              nalloc.construct(slots + n, move_if_noexcept(v));
+              ctrl[n] = h2(h);
+            }
+          }
+          __ntl_catch(...){
+            for(size_type n = 0; n < capacity; n++)
+              if(ctrl[n] >= 0)
+                nalloc.destroy(slots + n);
+            calloc_.deallocate(ctrl, capacity + 1);
+            nalloc.deallocate(slots, capacity);
+            __ntl_rethrow;
+          }
+
+          if(capacity_){
+            for(size_type i = 0; i < capacity_; i++)
+              if(ctrl_[i] >= 0)
+                nalloc.destroy(slots_ + i);
+            calloc_.deallocate(ctrl_, capacity_ + 1);
+            nalloc.deallocate(slots_, capacity_);
+          }
+          ctrl_ = ctrl;
+          slots_ = slots;
+          capacity_ = capacity;
+          growth_left_ = growth_limit(capacity) - count_;
+        }
+
+        void copy_from(const flat_hashtable& r)
+        {
+          reserve(r.size());
+          for(const_iterator i = r.cbegin(), e = r.cend(); i != e; ++i){
+            const hash_t h = hash_key(value2key(*i, is_map()));
+            const size_type n = prepare_insert(h);
+            nalloc.construct(slots_ + n, *i);
+            commit_insert(n, h);
+          }
+        }
+
+        void free_table()
+        {
+          clear();
+          if(capacity_){
+            calloc_.deallocate(ctrl_, capacity_ + 1);
+            nalloc.deallocate(slots_, capacity_);
+          }
+          ctrl_ = __::empty_ctrl();
+          slots_ = nullptr;
+          capacity_ = growth_left_ = 0;
+        }
+
+        void swap_table(hashtable& x)
+        {
+          using std::swap;
+          swap(ctrl_,     x.ctrl_);
+          swap(slots_,    x.slots_);
+          swap(capacity_, x.capacity_);
+          swap(count_,    x.count_);
+          swap(growth_left_, x.growth_left_);
+        }
+
+        template<class V> static const key_type& value2key(const V& x, true_type)   { return x.first; }
+        template<class V> static const key_type& value2key(const V& x, false_type)  { return x; }
+
+      protected:
+        ctrl_t* ctrl_;
+        value_type* slots_;
+        size_type capacity_;
+
+        size_type count_;
+        size_type growth_left_;
+        float max_factor;
+
+        hasher hash_;
+        key_equal equal_;
+
+        node_allocator nalloc;
+        ctrl_allocator calloc_;
+      };
+
+      /** Table policy which selects flat_hashtable as the backing store of unordered_map and unordered_set */
+      struct flat_policy
+      {
+        template<class Key, class Value, class Hash, class Pred, class Allocator, bool IsMap, bool IsUnique>
+        struct table
+        {
+          static_assert(IsUnique, "flat_hashtable supports unique keys only");
+          typedef flat_hashtable<Key,Value,Hash,Pred,Allocator,IsMap> type;
+        };
+      };
+    }
+  }
+}
+
+#endif // NTL__EXT_FLAT_HASHTABLE
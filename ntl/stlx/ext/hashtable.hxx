@@ -524,7 +524,7 @@ namespace std
           bucket_type& b = buckets_.first[n];
 
           if(is_unique::value && b.elems){
-            // allow only unique keys
+            // allow only unique keys, the stored hash values are compared first as in find()
             if(b.hash == hkey || b.dirty){
               for(const node_type* p = b.elems; p; p = p->next)
                 if(p->hkey == hkey && equal_(value2key(p->elem, is_map()), value2key(v, is_map())))
@@ -664,12 +664,14 @@ namespace std
         ///\name lookup
         iterator find(const key_type& k)
         {
-          const size_type n = bucket(k);
+          const hash_t hkey = hash_(k);
+          const size_type n = mapkey(hkey);
           bucket_type& b = buckets_.first[n];
           if(b.size == 0)
             return end();
+          // compare the stored hash values first, the key predicate is called only for candidates
           for(local_iterator li = begin(n), lend = end(n); li != lend; ++li){
-            if(equal_(k, value2key(li.p->elem, is_map())))
+            if(li.p->hkey == hkey && equal_(k, value2key(li.p->elem, is_map())))
               return iterator(li.p, &b, buckets_.second);
           }
           return end();
@@ -810,6 +812,12 @@ namespace std
           }
           balloc.deallocate(buckets.first, buckets.second-buckets.first);
         }
+
+        /** Rebuilds the table to hold at least \c n elements without exceeding max_load_factor() */
+        void reserve(size_type n)
+        {
+          rehash(static_cast<size_type>(n / max_load_factor()) + 1);
+        }
         ///\}
 
       protected:
@@ -902,6 +910,16 @@ namespace std
         node_allocator nalloc;
         bucket_allocator balloc;
       };
+
+      /** Table policy which selects chained_hashtable as the backing store of unordered containers (default) */
+      struct chained_policy
+      {
+        template<class Key, class Value, class Hash, class Pred, class Allocator, bool IsMap, bool IsUnique>
+        struct table
+        {
+          typedef chained_hashtable<Key,Value,Hash,Pred,Allocator,IsMap,IsUnique> type;
+        };
+      };
     }
   }
 }
@@ -0,0 +1,305 @@
+/**\file*********************************************************************
+ *                                                                     \brief
+ *  Locale independent integer conversions
+ *
+ ****************************************************************************
+ */
+#ifndef NTL__EXT_INTEGER_CHARS
+#define NTL__EXT_INTEGER_CHARS
+#pragma once
+
+#ifndef NTL__STLX_CSTDINT
+#include "../cstdint.hxx"
+#endif
+#ifndef NTL__STLX_CSTRING
+#include "../cstring.hxx"
+#endif
+
+namespace std
+{
+  namespace __
+  {
+    /**
+     *	Integer conversion engine.
+     *
+     *  The decimal numbers are written two digits per step from the pairs table and parsed eight digits per step
+     *  by the SWAR arithmetic, the power of two bases use shifts, the other ones the division. The values are
+     *  converted as 32-bit unsigned magnitudes unless the type is wider, so the 32-bit targets don't call
+     *  the 64-bit division helpers for the common types. Nothing depends on the locale and nothing is allocated.
+     **/
+    namespace intconv
+    {
+      static const char digit_pairs[] =
+        "00010203040506070809"
+        "10111213141516171819"
+        "20212223242526272829"
+        "30313233343536373839"
+        "40414243444546474849"
+        "50515253545556575859"
+        "60616263646566676869"
+        "70717273747576777879"
+        "80818283848586878889"
+        "90919293949596979899";
+
+      static const char lower_digits[] = "0123456789abcdefghijklmnopqrstuvwxyz";
+      static const char upper_digits[] = "0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZ";
+
+      /** The value of the digit character in the bases up to 36, 0xFF for the other characters */
+      static const unsigned char digit_values[256] = {
+        0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,
+        0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,
+        0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,
+        0,   1,   2,   3,   4,   5,   6,   7,   8,   9,   0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,
+        0xFF,10,  11,  12,  13,  14,  15,  16,  17,  18,  19,  20,  21,  22,  23,  24,
+        25,  26,  27,  28,  29,  30,  31,  32,  33,  34,  35,  0xFF,0xFF,0xFF,0xFF,0xFF,
+        0xFF,10,  11,  12,  13,  14,  15,  16,  17,  18,  19,  20,  21,  22,  23,  24,
+        25,  26,  27,  28,  29,  30,  31,  32,  33,  34,  35,  0xFF,0xFF,0xFF,0xFF,0xFF,
+        0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,
+        0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,
+        0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,
+        0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,
+        0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,
+        0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,
+        0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,
+        0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF
+      };
+
+      /** The longest number: 64 binary digits and the sign */
+      static const size_t max_size = 65;
+
+      /** The unsigned type the values of \c T are converted in */
+      template<class T, size_t Size = sizeof(T)> struct magnitude { typedef uint32_t type; };
+      template<class T> struct magnitude<T, 8> { typedef uint64_t type; };
+
+      template<class T>
+      inline bool is_signed_type()
+      {
+        return T(-1) < T(0);
+      }
+
+      /** The magnitude of the value, \p negative is set for the negative ones */
+      template<class T>
+      inline typename magnitude<T>::type absolute(T value, bool& negative)
+      {
+        typedef typename magnitude<T>::type U;
+        negative = is_signed_type<T>() && value < T(0);
+        const U u = static_cast<U>(value);
+        return negative ? U(0) - u : u;
+      }
+
+      inline unsigned decimal_length(uint32_t v)
+      {
+        unsigned n = 1;
+        for(;;){
+          if(v < 10) return n;
+          if(v < 100) return n + 1;
+          if(v < 1000) return n + 2;
+          if(v < 10000) return n + 3;
+          v /= 10000;
+          n += 4;
+        }
+      }
+
+      inline unsigned decimal_length(uint64_t v)
+      {
+        // each step removes exactly eight digits while the value is wider than 32 bits
+        unsigned n = 0;
+        for(; v > 0xFFFFFFFF; n += 8)
+          v /= 100000000;
+        return n + decimal_length(static_cast<uint32_t>(v));
+      }
+
+      /** log2 of the power of two base, 0 for the other bases */
+      inline unsigned base_shift(unsigned base)
+      {
+        if(base & (base - 1))
+          return 0;
+        unsigned shift = 0;
+        while(base >>= 1)
+          ++shift;
+        return shift;
+      }
+
+      /** The number of the digits of \p v in \p base */
+      template<class U>
+      inline unsigned length(U v, unsigned base)
+      {
+        if(base == 10)
+          return decimal_length(static_cast<typename magnitude<U>::type>(v));
+        unsigned n = 1;
+        if(const unsigned shift = base_shift(base)){
+          while(v >>= shift)
+            ++n;
+        }else{
+          while(v >= base)
+            v /= base, ++n;
+        }
+        return n;
+      }
+
+      /** Writes the decimal digits backwards, two per step */
+      inline char* put_decimal(char* end, uint32_t v)
+      {
+        while(v >= 100){
+          const unsigned d = (v % 100) * 2;
+          v /= 100;
+          *--end = digit_pairs[d + 1];
+          *--end = digit_pairs[d];
+        }
+        if(v >= 10){
+          *--end = digit_pairs[v * 2 + 1];
+          *--end = digit_pairs[v * 2];
+        }else{
+          *--end = static_cast<char>('0' + v);
+        }
+        return end;
+      }
+
+      inline char* put_decimal(char* end, uint64_t v)
+      {
+        // 32-bit chunks of eight digits, so only one 64-bit division per chunk
+        while(v > 0xFFFFFFFF){
+          const uint64_t q = v / 100000000;
+          uint32_t low = static_cast<uint32_t>(v - q * 100000000);
+          v = q;
+          for(int i = 0; i < 4; i++){
+            const unsigned d = (low % 100) * 2;
+            low /= 100;
+            *--end = digit_pairs[d + 1];
+            *--end = digit_pairs[d];
+          }
+        }
+        return put_decimal(end, static_cast<uint32_t>(v));
+      }
+
+      /** Writes the digits of \p v backwards ending at \p end */
+      template<class U>
+      inline char* put_digits(char* end, U v, unsigned base, bool upper = false)
+      {
+        if(base == 10)
+          return put_decimal(end, static_cast<typename magnitude<U>::type>(v));
+        const char* const digits = upper ? upper_digits : lower_digits;
+        if(const unsigned shift = base_shift(base)){
+          const unsigned mask = base - 1;
+          do{
+            *--end = digits[static_cast<unsigned>(v) & mask];
+            v >>= shift;
+          }while(v);
+        }else{
+          do{
+            *--end = digits[static_cast<unsigned>(v % base)];
+            v /= base;
+          }while(v);
+        }
+        return end;
+      }
+
+      /** Writes the signed number to the buffer of at least max_size characters and returns the end of it */
+      template<class T>
+      inline char* format(char* first, T value, unsigned base = 10, bool upper = false)
+      {
+        bool negative;
+        const typename magnitude<T>::type u = absolute(value, negative);
+        if(negative)
+          *first++ = '-';
+        char* const end = first + length(u, base);
+        put_digits(end, u, base, upper);
+        return end;
+      }
+
+      inline bool is_digit(char c)
+      {
+        return static_cast<unsigned char>(c - '0') < 10;
+      }
+
+      /** Eight digits loaded as a little endian integer */
+      inline uint64_t load_eight(const char* p)
+      {
+        uint64_t v;
+        memcpy(&v, p, sizeof(v));
+        return v;
+      }
+
+      inline bool is_eight_digits(uint64_t v)
+      {
+        return !(((v + 0x4646464646464646ULL) | (v - 0x3030303030303030ULL)) & 0x8080808080808080ULL);
+      }
+
+      /** The value of eight digits by three multiplications */
+      inline uint32_t eight_digits(uint64_t v)
+      {
+        const uint64_t mask = 0x000000FF000000FFULL, mul1 = 0x000F424000000064ULL, mul2 = 0x0000271000000001ULL;
+        v -= 0x3030303030303030ULL;
+        v = (v * 10) + (v >> 8);
+        v = (((v & mask) * mul1) + (((v >> 16) & mask) * mul2)) >> 32;
+        return static_cast<uint32_t>(v);
+      }
+
+      /** Parses the decimal digits, eight per step */
+      template<class U>
+      inline const char* parse_decimal(const char* first, const char* last, U& value, bool& overflow)
+      {
+        const char* p = first;
+        while(p != last && *p == '0')
+          ++p;
+        // nineteen significant digits always fit in 64 bits
+        const char* const significant = p;
+        uint64_t v = 0;
+        while(last - p >= 8 && p - significant <= 11 && is_eight_digits(load_eight(p))){
+          v = v * 100000000 + eight_digits(load_eight(p));
+          p += 8;
+        }
+        for(; p != last && p - significant < 19 && is_digit(*p); ++p)
+          v = v * 10 + static_cast<unsigned>(*p - '0');
+
+        overflow = false;
+        if(p != last && is_digit(*p)){
+          const unsigned d = static_cast<unsigned>(*p++ - '0');
+          if(v > (0xFFFFFFFFFFFFFFFFULL - d) / 10)
+            overflow = true;
+          else
+            v = v * 10 + d;
+          for(; p != last && is_digit(*p); ++p)
+            overflow = true;
+        }
+        if(v > static_cast<U>(~U(0)))
+          overflow = true;
+        value = static_cast<U>(v);
+        return p;
+      }
+
+      /**
+       *	Parses the digits of the unsigned number in \p base.
+       *  All the digits are consumed, \p overflow is set if their value doesn't fit in \p U.
+       *  \return the end of the digits, \p first if there are none.
+       **/
+      template<class U>
+      inline const char* parse(const char* first, const char* last, U& value, unsigned base, bool& overflow)
+      {
+        if(base == 10)
+          return parse_decimal(first, last, value, overflow);
+
+        const U max_base = static_cast<U>(~U(0)) / base;
+        const unsigned max_digit = static_cast<unsigned>(static_cast<U>(~U(0)) % base);
+        U v = 0;
+        overflow = false;
+        const char* p = first;
+        for(; p != last; ++p){
+          const unsigned d = digit_values[static_cast<unsigned char>(*p)];
+          if(d >= base)
+            break;
+          if(overflow)
+            continue;
+          if(v < max_base || (v == max_base && d <= max_digit))
+            v = v * base + d;
+          else
+            overflow = true;
+        }
+        value = v;
+        return p;
+      }
+    }
+  }
+}
+
+#endif // NTL__EXT_INTEGER_CHARS
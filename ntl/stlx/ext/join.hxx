@@ -11,9 +11,26 @@
 #include "../type_traits.hxx"
 #include "../string_ref.hxx"
 #include "../sstream.hxx"
+#include "../charconv.hxx"
 
 namespace std
 {
+  namespace __
+  {
+    /** Appends the number as by to_chars(), without the temporary string */
+    template<typename Number>
+    inline void append_number(std::string& o, Number n)
+    {
+      char buf[intconv::max_size];
+      o.append(buf, std::to_chars(buf, buf + sizeof(buf), n).ptr);
+    }
+
+    inline void append_number(std::string& o, bool n)
+    {
+      o.append(1, n ? '1' : '0');
+    }
+  }
+
   /**
    *	@brief Default Formatter
    *	
@@ -37,7 +54,7 @@ namespace std
     template<typename Number>
     typename std::enable_if<std::is_arithmetic<Number>::value, void>::type operator()(std::string& o, Number n) const
     {
-      o.append(std::to_string(n));
+      __::append_number(o, n);
     }
   };
 
@@ -47,7 +64,7 @@ namespace std
     template<typename Number>
     typename std::enable_if<std::is_arithmetic<Number>::value, void>::type operator()(std::string& o, Number n) const
     {
-      o.append(std::to_string(n));
+      __::append_number(o, n);
     }
   };
 
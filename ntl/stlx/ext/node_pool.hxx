@@ -0,0 +1,201 @@
+/**\file*********************************************************************
+ *                                                                     \brief
+ *  Node pool allocator for the node based containers
+ *
+ ****************************************************************************
+ */
+#ifndef NTL__EXT_NODE_POOL
+#define NTL__EXT_NODE_POOL
+#pragma once
+
+#include "../memory.hxx"
+
+namespace std
+{
+  namespace ext
+  {
+    /**
+     *	@brief Node pool allocator
+     *
+     *  Allocates nodes of the single type from the cache line aligned chunks obtained from \c Allocator.
+     *  The chunk size doubles with each chunk up to the \c max_chunk_size bytes. Deallocated nodes are kept
+     *  in the free list and reused, all memory is returned to \c Allocator at once by release() or by the destructor.
+     *
+     *  Only one node per allocation is supported. A copy of the pool shares nothing with the original
+     *  except the underlying allocator.
+     **/
+    template<class Node, class Allocator>
+    class node_pool
+    {
+      typedef typename Allocator::template rebind<Node>::other node_allocator;
+      typedef typename Allocator::template rebind<char>::other raw_allocator;
+
+      /** chunk header placed at the beginning of the raw block */
+      struct chunk
+      {
+        chunk* next;
+        size_t size;
+      };
+
+      /** free node reuses the node storage */
+      struct free_node
+      {
+        free_node* next;
+      };
+
+    public:
+      typedef typename node_allocator::value_type       value_type;
+      typedef typename node_allocator::pointer          pointer;
+      typedef typename node_allocator::const_pointer    const_pointer;
+      typedef typename node_allocator::size_type        size_type;
+      typedef typename node_allocator::difference_type  difference_type;
+
+      static const size_t cache_line = 64;
+      static const size_t min_chunk_nodes = 16;
+      static const size_t max_chunk_size = 64 * 1024;
+
+      static_assert(sizeof(Node) >= sizeof(free_node), "node is too small to be pooled");
+
+    public:
+      explicit node_pool(const Allocator& a = Allocator())
+        :nalloc(a), ralloc(a), chunks(), free_list(), cur(), end(), next_count(min_chunk_nodes)
+      {}
+
+      node_pool(const node_pool& x)
+        :nalloc(x.nalloc), ralloc(x.ralloc), chunks(), free_list(), cur(), end(), next_count(min_chunk_nodes)
+      {}
+
+      ~node_pool() __ntl_nothrow
+      {
+        release();
+      }
+
+      /** Returns a copy of the underlying allocator */
+      operator Allocator() const { return Allocator(ralloc); }
+
+      pointer allocate(size_type n, const void* = 0)
+      {
+        assert(n == 1); (void)n;
+        if(free_list){
+          free_node* p = free_list;
+          free_list = p->next;
+          return reinterpret_cast<pointer>(p);
+        }
+        if(cur == end)
+          grow();
+        return cur++;
+      }
+
+      void deallocate(pointer p, size_type /*n*/)
+      {
+        free_node* const f = reinterpret_cast<free_node*>(p);
+        f->next = free_list;
+        free_list = f;
+      }
+
+#ifdef NTL_CXX_VT
+      template<class... Args>
+      void construct(pointer p, Args&&... args)
+      {
+        nalloc.construct(p, std::forward<Args>(args)...);
+      }
+#elif defined(NTL_CXX_RV)
+      template<class U>
+      void construct(pointer p, U&& x)
+      {
+        nalloc.construct(p, std::forward<U>(x));
+      }
+#else
+      template<class U>
+      void construct(pointer p, const U& x)
+      {
+        nalloc.construct(p, x);
+      }
+#endif
+
+      void destroy(pointer p)
+      {
+        nalloc.destroy(p);
+      }
+
+      size_type max_size() const __ntl_nothrow { return nalloc.max_size(); }
+
+      /** Returns all chunks to the underlying allocator. Nodes must be destroyed before. */
+      void release() __ntl_nothrow
+      {
+        while(chunks){
+          chunk* c = chunks;
+          chunks = c->next;
+          ralloc.deallocate(reinterpret_cast<char*>(c), c->size);
+        }
+        free_list = nullptr;
+        cur = end = nullptr;
+        next_count = min_chunk_nodes;
+      }
+
+      void swap(node_pool& x)
+      {
+        using std::swap;
+        swap(nalloc, x.nalloc);
+        swap(ralloc, x.ralloc);
+        swap(chunks, x.chunks);
+        swap(free_list, x.free_list);
+        swap(cur, x.cur);
+        swap(end, x.end);
+        swap(next_count, x.next_count);
+      }
+
+    private:
+      node_pool& operator=(const node_pool&);
+
+      void grow()
+      {
+        const size_t size = cache_line + next_count * sizeof(Node) + cache_line;
+        char* const raw = ralloc.allocate(size);
+        chunk* const c = reinterpret_cast<chunk*>(raw);
+        c->next = chunks;
+        c->size = size;
+        chunks = c;
+
+        // nodes begin at the first cache line boundary after the header
+        const uintptr_t first = (reinterpret_cast<uintptr_t>(raw) + sizeof(chunk) + cache_line - 1) & ~(cache_line - 1);
+        cur = reinterpret_cast<pointer>(first);
+        end = cur + next_count;
+
+        if(next_count * sizeof(Node) * 2 <= max_chunk_size)
+          next_count *= 2;
+      }
+
+    private:
+      node_allocator nalloc;
+      raw_allocator  ralloc;
+
+      chunk* chunks;
+      free_node* free_list;
+      pointer cur, end;
+      size_t next_count;
+    };
+
+    template<class Node, class Allocator>
+    inline void swap(node_pool<Node, Allocator>& x, node_pool<Node, Allocator>& y)
+    {
+      x.swap(y);
+    }
+
+    /** Releases all nodes of the pool at once, returns \c false if the allocator is not a pool */
+    template<class Allocator>
+    inline bool release_nodes(Allocator&)
+    {
+      return false;
+    }
+
+    template<class Node, class Allocator>
+    inline bool release_nodes(node_pool<Node, Allocator>& pool)
+    {
+      pool.release();
+      return true;
+    }
+  }
+}
+
+#endif // NTL__EXT_NODE_POOL
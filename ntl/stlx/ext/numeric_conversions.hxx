@@ -16,6 +16,14 @@
 # include "../type_traits.hxx"
 #endif
 
+#ifndef NTL__EXT_INTEGER_CHARS
+# include "integer_chars.hxx"
+#endif
+
+#ifndef NTL__EXT_FLOAT_PARSE
+# include "float_parse.hxx"
+#endif
+
 namespace ntl { namespace numeric {
 
   namespace detail
@@ -109,7 +117,7 @@ namespace ntl { namespace numeric {
                               std::size_t* taken = 0, char thousands_sep = '\0', char decimal_sep = '\0')
   {
     using std::size_t;
-    convresult result = conv_result::bad_format;
+    namespace intconv = std::__::intconv;
     value = 0;
     if(taken) *taken = 0;
     (void)decimal_sep; // reserved for floating point numbers
@@ -142,72 +150,88 @@ namespace ntl { namespace numeric {
 
     // detect or skip base prefix (only on unknown base or base = 8|16)
     unsigned lbase = 10;
-    if((base == 0 || base == 8 || base == 16) && in[0] == '0' && len && in[1]){
-      in++, len--;
-      if(in[0] == 'x' || in[0] == 'X')
+    const char* zero = 0; // the end of the zero taken as the prefix, it is the number if no digits follow
+    if((base == 0 || base == 8 || base == 16) && in[0] == '0' && len != 1 && in[1]){
+      zero = ++in, len--;
+      if(base != 8 && (in[0] == 'x' || in[0] == 'X'))
         lbase = 16, in++, len--;
       else
         lbase = 8;
     }
     if(!base) base = lbase;
 
-    // initialization
-    const storage_type max_val2 = minus ? static_cast<storage_type>(min_val) : max_val;
-    const unsigned rem = static_cast<unsigned>(max_val2 % base);
-    const storage_type max_base_val = max_val2 / base;
+    // the digits end at the first non digit, the NUL or the length given
+    const char* last = in;
+    for(size_t n = static_cast<size_t>(len); n && (intconv::digit_values[static_cast<unsigned char>(*last)] < base || (*last == thousands_sep && thousands_sep && last != in)); --n)
+      ++last;
 
-    // parse state
-    //const bool use_dcep = base == 10 && decimal_sep != '\0';
+    storage_type u = 0;
     bool overflow = false;
-
-    size_t ic = 0; // number of digits extracted
-    do{
-      char c = *in;
-      if(!c)
-        break;
-
-      if(value != 0 && c == thousands_sep) // skip group separator in the middle of digits (only in octal or decimal base)
-        continue;
-
-      #define InRange(ch, a, b)  (unsigned(ch - a) <= b - a)
-      #define InRangeI(ch, a, b) (unsigned((ch & ~(1<<5)) - a) <= b - a)
-
-      unsigned digit;
-      if(detail::mini_ctype::is(detail::mini_ctype::alpha, c))
-        digit = (c & ~(1 << 5)) - 'A' + 10;
-      else if(detail::mini_ctype::is(detail::mini_ctype::digit, c))
-        digit = c - '0';
-      else
-        break;
-      if(digit >= base)
-        break;
-
-      ++ic;
-      if(value < max_base_val || (value == max_base_val && digit <= rem))
-        value = value * base + digit;
-      else{
-        overflow = true;
-        break;
+    const char* end;
+    if(!thousands_sep){
+      end = intconv::parse(in, last, u, base, overflow);
+    }else{
+      // the separators between the digits are skipped
+      const storage_type max_base = static_cast<storage_type>(~storage_type(0)) / base;
+      const unsigned max_digit = static_cast<unsigned>(static_cast<storage_type>(~storage_type(0)) % base);
+      for(end = in; end != last; ++end){
+        if(*end == thousands_sep || overflow)
+          continue;
+        const unsigned digit = intconv::digit_values[static_cast<unsigned char>(*end)];
+        if(u < max_base || (u == max_base && digit <= max_digit))
+          u = u * base + digit;
+        else
+          overflow = true;
       }
-    }while(++in && --len && *in);
+    }
 
-   if(taken) *taken = in - str;
-    if(!ic)
+    if(end == in && zero)
+      end = zero;
+    if(taken) *taken = end - str;
+    convresult result;
+    if(end == in && !zero)
       result = conv_result::bad_format;
-    else if(len == 0 || !*in)
+    else if(end >= in && (static_cast<size_t>(end - in) == static_cast<size_t>(len) || !*end))
       result = conv_result::eof;
     else
       result = conv_result::ok;
 
-    if(overflow){
+    const storage_type limit = minus ? storage_type(0) - static_cast<storage_type>(min_val) : max_val;
+    if(overflow || u > limit){
       value = minus ? min_val : max_val;
       result = conv_result::overflow;
-    }else if(minus)
-      value = static_cast<storage_type>( -static_cast<signed_storage_type>(value) );
+    }else
+      value = minus ? storage_type(0) - u : u;
 
     return result;
   }
 
+  /**
+   *	Converts the floating point number as strtod does: the leading spaces and the sign are skipped,
+   *  the hexadecimal numbers with the "0x" prefix, "inf" and "nan" are accepted. The value is correctly rounded.
+   *  \return conv_result::overflow when the value rounds to infinity or to zero, which is stored.
+   **/
+  template<typename T>
+  static convresult str2float(T& value, const char* str, std::ssize_t len, std::size_t* taken = 0)
+  {
+    value = 0;
+    if(taken) *taken = 0;
+    if(len < 0)
+      for(len = 0; str[len]; len++);
+
+    const char* in = str, * const last = str + len;
+    while(in != last && detail::mini_ctype::is(detail::mini_ctype::space, *in))
+      in++;
+
+    std::__::fp::parse_status status;
+    const char* const end = std::__::fp::parse(in, last, std::__::fp::parse_c | std::__::fp::parse_general, value, status);
+    if(!end)
+      return conv_result::bad_format;
+    if(taken) *taken = end - str;
+    if(status == std::__::fp::parse_out_of_range)
+      return conv_result::overflow;
+    return end == last ? conv_result::eof : conv_result::ok;
+  }
 
   template<typename storage_type>
   static convresult num2str(storage_type value, bool is_signed, char* const str, std::size_t len, int base = 10, std::size_t* written = 0)
@@ -219,36 +243,22 @@ namespace ntl { namespace numeric {
     else if(!(base >= 2 && base <= 36))
       return conv_result::bad_base;
 
-    char buf[max_number_size];
-    buf[0] = '+';
-    char *p = buf+1, *s = str;
-
-    if(is_signed && base == 10 && static_cast<typename std::make_signed<storage_type>::type>(value) < 0)
-      buf[0] = '-',
-      value = static_cast<storage_type>(-static_cast<typename std::make_signed<storage_type>::type>(value));
-
-    do {
-      char c = static_cast<char>( value % base );
-      c = c + (c >= 10 ? 'a'-10 : '0');
-      *p++ = c;
-    }while((value /= base) != 0);
-
-    const size_t size = (p-buf) - (buf[0] == '+');
+    // the negative numbers are signed in decimal only, the other bases show their bits
+    const bool minus = is_signed && base == 10 && static_cast<typename std::make_signed<storage_type>::type>(value) < 0;
+    if(minus)
+      value = storage_type(0) - value;
+    const std::size_t size = minus + std::__::intconv::length(value, base);
     if(size > len)
       return conv_result::eof;
 
     if(written)
       *written = size;
-
-    if(*buf == '-')
-      *s++ = '-';
-
-    while(--p > buf)
-      *s++ = *p;
+    if(minus)
+      *str = '-';
+    std::__::intconv::put_digits(str + size, value, base);
     if(size < len)
-      *s = '\0';
-
-    return value == 0 ? conv_result::ok : conv_result::eof;
+      str[size] = '\0';
+    return conv_result::ok;
   }
 
 
@@ -353,6 +363,42 @@ namespace ntl { namespace numeric {
     return static_cast<value_t>(value);
   }
 
+  inline double strtod(const char * __restrict nptr, const char ** __restrict endptr = 0)
+  {
+    std::size_t taken;
+    double value;
+    str2float(value, nptr, -1, &taken);
+    if(endptr) *endptr = nptr + taken;
+    return value;
+  }
+
+  inline double strtod(const char * __restrict nptr, size_t len, const char ** __restrict endptr = 0)
+  {
+    std::size_t taken;
+    double value;
+    str2float(value, nptr, len, &taken);
+    if(endptr) *endptr = nptr + taken;
+    return value;
+  }
+
+  inline float strtof(const char * __restrict nptr, const char ** __restrict endptr = 0)
+  {
+    std::size_t taken;
+    float value;
+    str2float(value, nptr, -1, &taken);
+    if(endptr) *endptr = nptr + taken;
+    return value;
+  }
+
+  inline float strtof(const char * __restrict nptr, size_t len, const char ** __restrict endptr = 0)
+  {
+    std::size_t taken;
+    float value;
+    str2float(value, nptr, len, &taken);
+    if(endptr) *endptr = nptr + taken;
+    return value;
+  }
+
   //////////////////////////////////////////////////////////////////////////
   namespace detail
   {
@@ -403,7 +449,7 @@ namespace ntl { namespace numeric {
   inline wchar_t* itow(T value, wchar_t (&str)[N], int radix = 10, std::size_t* written = 0)
   {
     static_assert(std::is_integral<T>::value, "only integral types supported");
-    typedef detail::select<T>::type storage_type;
+    typedef typename detail::select<T>::type storage_type;
     char buf[max_number_size];
     std::size_t lwritten;
     const convresult re = num2str<storage_type>(static_cast<storage_type>(value), std::is_signed<T>::value, buf, N, radix, &lwritten);
@@ -0,0 +1,102 @@
+/**\file*********************************************************************
+ *                                                                     \brief
+ *  Parallel sort
+ *
+ ****************************************************************************
+ */
+#ifndef NTL__EXT_PARALLEL_SORT
+#define NTL__EXT_PARALLEL_SORT
+#pragma once
+
+#include "../algorithm.hxx"
+#include "../thread.hxx"
+
+namespace std
+{
+  namespace ext
+  {
+    /**
+     *	@brief Parallel execution request for the algorithms which have a parallel overload
+     *
+     *  The work is split between at most \c threads threads, zero means thread::hardware_concurrency().
+     **/
+    struct parallel_t
+    {
+      explicit parallel_t(unsigned threads = 0)
+        :threads(threads)
+      {}
+
+      unsigned threads;
+    };
+
+    /** Parallel execution on all processors */
+    static const parallel_t par;
+  }
+
+  namespace __
+  {
+    /** Ranges shorter than this are not split between the threads */
+    static const ptrdiff_t parallel_sort_threshold = 32 * 1024;
+
+    template<class RandomAccessIterator, class Compare>
+    inline void parallel_sort(RandomAccessIterator first, RandomAccessIterator last, Compare comp, unsigned threads);
+
+    template<class RandomAccessIterator, class Compare>
+    struct parallel_sort_task
+    {
+      RandomAccessIterator first, last;
+      Compare comp;
+      unsigned threads;
+
+      void operator()() const
+      {
+        parallel_sort(first, last, comp, threads);
+      }
+    };
+
+    /**
+     *	Partitions the range once and sorts the left part in a new thread, the right one in the current thread.
+     *  Each part gets its share of the threads, so at most \p threads - 1 threads are started.
+     **/
+    template<class RandomAccessIterator, class Compare>
+    inline void parallel_sort(RandomAccessIterator first, RandomAccessIterator last, Compare comp, unsigned threads)
+    {
+      typedef typename iterator_traits<RandomAccessIterator>::value_type value_type;
+      if(threads < 2 || last - first < parallel_sort_threshold){
+        pdqsort(first, last, comp);
+        return;
+      }
+
+      choose_pivot(first, last, comp);
+      const RandomAccessIterator pivot_pos = partition_right(first, last, comp, is_branchless_sortable<value_type, Compare>()).first;
+
+      const unsigned left_threads = threads / 2;
+      const parallel_sort_task<RandomAccessIterator, Compare> left = { first, pivot_pos, comp, left_threads };
+      thread worker(left);
+      parallel_sort(pivot_pos + 1, last, comp, threads - left_threads);
+      worker.join();
+    }
+  }
+
+  /**
+   *	Sorts the range using several threads.
+   *  The already sorted and the reversed ranges are finished in a single pass as by sort().
+   **/
+  template<class RandomAccessIterator, class Compare>
+  inline void sort(const ext::parallel_t& policy, RandomAccessIterator first, RandomAccessIterator last, Compare comp)
+  {
+    if(__::sort_monotonic(first, last, comp, false))
+      return;
+    unsigned threads = policy.threads ? policy.threads : thread::hardware_concurrency();
+    __::parallel_sort(first, last, comp, threads ? threads : 1);
+  }
+
+  template<class RandomAccessIterator>
+  inline void sort(const ext::parallel_t& policy, RandomAccessIterator first, RandomAccessIterator last)
+  {
+    typedef typename iterator_traits<RandomAccessIterator>::value_type value_type;
+    sort(policy, first, last, less<value_type>());
+  }
+}
+
+#endif // NTL__EXT_PARALLEL_SORT
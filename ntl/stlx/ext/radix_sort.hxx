@@ -0,0 +1,477 @@
+/**\file*********************************************************************
+ *                                                                     \brief
+ *  Radix sort
+ *
+ ****************************************************************************
+ */
+#ifndef NTL__EXT_RADIX_SORT
+#define NTL__EXT_RADIX_SORT
+#pragma once
+
+#include "../algorithm.hxx"
+#include "../string_ref.hxx"
+#include "../vector.hxx"
+
+namespace std
+{
+  namespace ext
+  {
+    /** The default key of radix_sort(): the element itself */
+    struct radix_identity
+    {
+      template<class T>
+      const T& operator()(const T& x) const { return x; }
+    };
+
+    namespace radix
+    {
+      /** Ranges shorter than this are sorted by comparison */
+      static const size_t comparison_threshold = 64;
+      /** String buckets shorter than this are finished by the insertion sort */
+      static const size_t string_insertion_threshold = 32;
+
+      ///\name Keys
+
+      typedef char signed_promotion[1];
+      typedef char unsigned_promotion[2];
+      signed_promotion& promotion_of(int);
+      signed_promotion& promotion_of(long);
+      signed_promotion& promotion_of(long long);
+      unsigned_promotion& promotion_of(unsigned);
+      unsigned_promotion& promotion_of(unsigned long);
+      unsigned_promotion& promotion_of(unsigned long long);
+
+      /** The integral key is signed as its type, the enumeration one as its underlying type */
+      template<class K, bool = is_enum<K>::value>
+      struct signed_key: integral_constant<bool, is_signed<K>::value>
+      {};
+
+      template<class K>
+      struct signed_key<K, true>
+#if (defined(_MSC_VER) && _MSC_VER >= 1700) || defined(__GNUC__) || defined(__clang__)
+        : integral_constant<bool, is_signed<__underlying_type(K)>::value>
+#else
+        // the unscoped enumeration is promoted to the integer type of the same signedness
+        : integral_constant<bool, sizeof(promotion_of(K())) == sizeof(signed_promotion)>
+#endif
+      {};
+
+      /** Maps the integral key to the unsigned one with the same order */
+      template<class K, bool = is_floating_point<K>::value>
+      struct numeric_key
+      {
+        typedef typename make_unsigned<K>::type type;
+
+        static type bits(K k)
+        {
+          const type sign = signed_key<K>::value ? type(type(1) << (sizeof(type) * 8 - 1)) : type(0);
+          return static_cast<type>(k) ^ sign;
+        }
+      };
+
+      /** Maps the IEEE 754 key to the unsigned one with the same order: the negative values are inverted, the sign bit is set in the others */
+      template<class K>
+      struct numeric_key<K, true>
+      {
+        typedef typename conditional<sizeof(K) == sizeof(uint32_t), uint32_t, uint64_t>::type type;
+        static_assert(sizeof(K) == sizeof(type), "only the 32 and 64-bit floating point keys are supported");
+
+        static type bits(K k)
+        {
+          type b;
+          memcpy(&b, &k, sizeof(b));
+          const type sign = type(1) << (sizeof(type) * 8 - 1);
+          return (b & sign) ? type(~b) : type(b | sign);
+        }
+      };
+
+      template<class K>
+      struct numeric_tag {};
+
+      /** Character access to the string keys */
+      template<class S>
+      struct string_key;
+
+      template<class charT, class traits, class Allocator>
+      struct string_key<basic_string<charT, traits, Allocator> >
+      {
+        typedef charT char_type;
+        typedef basic_string<charT, traits, Allocator> key_type;
+
+        /** Stores the character \p c of \p k to \p ch or returns false if \p k is shorter */
+        static bool at(const key_type& k, size_t c, char_type& ch)
+        {
+          if(c >= k.size())
+            return false;
+          ch = k.data()[c];
+          return true;
+        }
+      };
+
+      template<class charT, class traits>
+      struct string_key<basic_string_ref<charT, traits> >
+      {
+        typedef charT char_type;
+        typedef basic_string_ref<charT, traits> key_type;
+
+        static bool at(const key_type& k, size_t c, char_type& ch)
+        {
+          if(c >= k.size())
+            return false;
+          ch = k.data()[c];
+          return true;
+        }
+      };
+
+      /** Null-terminated string. The characters before \p c are known to be nonzero, so the length is never counted. */
+      template<class charT>
+      struct string_key<const charT*>
+      {
+        typedef charT char_type;
+        typedef const charT* key_type;
+
+        static bool at(key_type k, size_t c, char_type& ch)
+        {
+          ch = k[c];
+          return ch != charT();
+        }
+      };
+
+      template<class S>
+      struct string_tag {};
+
+      template<class K>
+      inline typename enable_if<is_arithmetic<K>::value || is_enum<K>::value, numeric_tag<K> >::type key_kind(const K&)
+      {
+        return numeric_tag<K>();
+      }
+
+      template<class charT, class traits, class Allocator>
+      inline string_tag<basic_string<charT, traits, Allocator> > key_kind(const basic_string<charT, traits, Allocator>&)
+      {
+        return string_tag<basic_string<charT, traits, Allocator> >();
+      }
+
+      template<class charT, class traits>
+      inline string_tag<basic_string_ref<charT, traits> > key_kind(const basic_string_ref<charT, traits>&)
+      {
+        return string_tag<basic_string_ref<charT, traits> >();
+      }
+
+      template<class charT>
+      inline string_tag<const charT*> key_kind(const charT*)
+      {
+        return string_tag<const charT*>();
+      }
+
+      ///\name Scratch buffer
+
+      /**
+       *	@brief Room for the n elements moved out of the range being sorted.
+       *
+       *  The caller's buffer holds the constructed objects and is assigned to.
+       *  Otherwise a temporary buffer is allocated and its objects are constructed
+       *  by the first pass over the whole range, all the later passes assign.
+       **/
+      template<class T>
+      class scratch
+      {
+      public:
+        scratch(T* buffer, size_t n)
+          :p(buffer), n(n), owned(!buffer), constructed(buffer != nullptr)
+        {
+          if(owned){
+            pair<T*, ptrdiff_t> tmp = get_temporary_buffer<T>(static_cast<ptrdiff_t>(n));
+            p = tmp.first;
+            if(p && static_cast<size_t>(tmp.second) < n){
+              return_temporary_buffer(p);
+              p = nullptr;
+            }
+          }
+        }
+
+        ~scratch()
+        {
+          if(owned && p){
+            if(constructed)
+              for(size_t i = 0; i < n; i++)
+                p[i].~T();
+            return_temporary_buffer(p);
+          }
+        }
+
+        T* get() const { return p; }
+
+        void put(size_t i, T& x)
+        {
+          if(constructed)
+            p[i] = std::move(x);
+          else
+            new (static_cast<void*>(p + i)) T(std::move(x));
+        }
+
+        /** A pass over the whole range has filled the buffer */
+        void filled() { constructed = true; }
+
+      private:
+        T* p;
+        size_t n;
+        bool owned, constructed;
+
+        scratch(const scratch&) __deleted;
+        scratch& operator=(const scratch&) __deleted;
+      };
+
+      ///\name LSD sort of the numeric keys
+
+      template<class K, class KeyOf>
+      struct numeric_less
+      {
+        KeyOf key;
+
+        template<class T>
+        bool operator()(const T& x, const T& y) const
+        {
+          return numeric_key<K>::bits(key(x)) < numeric_key<K>::bits(key(y));
+        }
+      };
+
+      /**
+       *	Sorts by one byte of the key per pass, from the least significant one, ping-ponging between the range and the scratch buffer.
+       *  The histograms of all the bytes are gathered by a single pass; the bytes equal in all keys are skipped.
+       **/
+      template<class RandomAccessIterator, class KeyOf, class K>
+      inline void sort(RandomAccessIterator first, RandomAccessIterator last, KeyOf key, typename iterator_traits<RandomAccessIterator>::value_type* buffer, numeric_tag<K>)
+      {
+        typedef typename iterator_traits<RandomAccessIterator>::value_type value_type;
+        typedef typename numeric_key<K>::type bits_type;
+        static const size_t passes = sizeof(bits_type);
+
+        const size_t n = static_cast<size_t>(last - first);
+        const numeric_less<K, KeyOf> comp = { key };
+        if(n < comparison_threshold){
+          std::stable_sort(first, last, comp);
+          return;
+        }
+
+        // the histograms are too large for the stack
+        pair<size_t*, ptrdiff_t> counts = get_temporary_buffer<size_t>(passes * 256);
+        if(!counts.first || static_cast<size_t>(counts.second) < passes * 256){
+          return_temporary_buffer(counts.first);
+          std::stable_sort(first, last, comp);
+          return;
+        }
+        scratch<value_type> tmp(buffer, n);
+        if(!tmp.get()){
+          return_temporary_buffer(counts.first);
+          std::stable_sort(first, last, comp);
+          return;
+        }
+
+        size_t* const count = counts.first;
+        std::fill_n(count, passes * 256, size_t(0));
+        for(RandomAccessIterator i = first; i != last; ++i){
+          const bits_type b = numeric_key<K>::bits(key(*i));
+          for(size_t pass = 0; pass < passes; pass++)
+            ++count[pass * 256 + static_cast<uint8_t>(b >> (pass * 8))];
+        }
+
+        bool in_scratch = false;
+        value_type* const s = tmp.get();
+        for(size_t pass = 0; pass < passes; pass++){
+          size_t* const c = count + pass * 256;
+          const bits_type probe = numeric_key<K>::bits(key(in_scratch ? s[0] : *first));
+          if(c[static_cast<uint8_t>(probe >> (pass * 8))] == n)
+            continue;
+
+          size_t sum = 0;
+          for(size_t d = 0; d < 256; d++){
+            const size_t t = c[d];
+            c[d] = sum;
+            sum += t;
+          }
+
+          const unsigned shift = static_cast<unsigned>(pass * 8);
+          if(in_scratch){
+            for(size_t i = 0; i < n; i++)
+              first[c[static_cast<uint8_t>(numeric_key<K>::bits(key(s[i])) >> shift)]++] = std::move(s[i]);
+          }else{
+            for(RandomAccessIterator i = first; i != last; ++i)
+              tmp.put(c[static_cast<uint8_t>(numeric_key<K>::bits(key(*i)) >> shift)]++, *i);
+            tmp.filled();
+          }
+          in_scratch = !in_scratch;
+        }
+        if(in_scratch)
+          std::move(s, s + n, first);
+        return_temporary_buffer(count);
+      }
+
+      ///\name MSD sort of the string keys
+
+      /** The byte \p d of the key or zero past its end; the digits are the bytes of the big-endian unsigned characters */
+      template<class S, class K>
+      inline size_t string_digit(const K& k, size_t d)
+      {
+        typedef typename string_key<S>::char_type char_type;
+        typedef typename make_unsigned<char_type>::type uchar_type;
+        char_type ch;
+        if(!string_key<S>::at(k, d / sizeof(char_type), ch))
+          return 0;
+        const unsigned shift = static_cast<unsigned>((sizeof(char_type) - 1 - d % sizeof(char_type)) * 8);
+        return static_cast<size_t>(static_cast<uint8_t>(static_cast<uchar_type>(ch) >> shift)) + 1;
+      }
+
+      /** Compares the keys from the character \p c, the ones before are equal */
+      template<class S, class K>
+      inline bool string_less(const K& x, const K& y, size_t c)
+      {
+        typedef typename string_key<S>::char_type char_type;
+        typedef typename make_unsigned<char_type>::type uchar_type;
+        for(;; c++){
+          char_type a, b;
+          const bool ha = string_key<S>::at(x, c, a), hb = string_key<S>::at(y, c, b);
+          if(!hb)
+            return false;
+          if(!ha)
+            return true;
+          if(a != b)
+            return static_cast<uchar_type>(a) < static_cast<uchar_type>(b);
+        }
+      }
+
+      template<class S, class KeyOf>
+      struct string_compare
+      {
+        KeyOf key;
+        size_t from;
+
+        template<class T>
+        bool operator()(const T& x, const T& y) const
+        {
+          return string_less<S>(key(x), key(y), from);
+        }
+      };
+
+      struct string_bucket
+      {
+        size_t first, size, depth;
+      };
+
+      /**
+       *	Distributes the range by one byte of the key per pass, from the most significant one, and the buckets further on.
+       *  The strings ended at the current byte are done. The histogram and the pending buckets are kept on the heap rather than on the stack.
+       **/
+      template<class RandomAccessIterator, class KeyOf, class S>
+      inline void sort(RandomAccessIterator first, RandomAccessIterator last, KeyOf key, typename iterator_traits<RandomAccessIterator>::value_type* buffer, string_tag<S>)
+      {
+        typedef typename iterator_traits<RandomAccessIterator>::value_type value_type;
+        typedef typename string_key<S>::char_type char_type;
+
+        const size_t n = static_cast<size_t>(last - first);
+        string_compare<S, KeyOf> comp = { key, 0 };
+        if(n < comparison_threshold){
+          std::stable_sort(first, last, comp);
+          return;
+        }
+        scratch<value_type> tmp(buffer, n);
+        if(!tmp.get()){
+          std::stable_sort(first, last, comp);
+          return;
+        }
+
+        value_type* const s = tmp.get();
+        vector<string_bucket> pending;
+        const string_bucket all = { 0, n, 0 };
+        pending.push_back(all);
+        // the histogram and the bucket positions
+        vector<size_t> histogram(257 * 2);
+        size_t* const count = histogram.data(), * const at = count + 257;
+        bool whole = true;
+
+        while(!pending.empty()){
+          const string_bucket b = pending.back();
+          pending.pop_back();
+          const RandomAccessIterator from = first + b.first;
+          if(b.size < string_insertion_threshold){
+            comp.from = b.depth / sizeof(char_type);
+            std::stable_sort(from, from + b.size, comp);
+            continue;
+          }
+
+          std::fill_n(count, 257, size_t(0));
+          for(size_t i = 0; i < b.size; i++)
+            ++count[string_digit<S>(key(from[i]), b.depth)];
+
+          const size_t d0 = string_digit<S>(key(*from), b.depth);
+          if(count[d0] == b.size && !whole){
+            // the same byte everywhere, go deeper without moving
+            if(d0 != 0){
+              const string_bucket next = { b.first, b.size, b.depth + 1 };
+              pending.push_back(next);
+            }
+            continue;
+          }
+
+          size_t sum = 0;
+          for(size_t d = 0; d < 257; d++){
+            const size_t t = count[d];
+            count[d] = sum;
+            sum += t;
+          }
+          std::copy(count, count + 257, at);
+          for(size_t i = 0; i < b.size; i++)
+            tmp.put(at[string_digit<S>(key(from[i]), b.depth)]++, from[i]);
+          if(whole){
+            tmp.filled();
+            whole = false;
+          }
+          std::move(s, s + b.size, from);
+
+          // bucket 0 holds the ended strings
+          for(size_t d = 1; d < 257; d++){
+            const size_t size = (d < 256 ? count[d + 1] : b.size) - count[d];
+            if(size > 1){
+              const string_bucket next = { b.first + count[d], size, b.depth + 1 };
+              pending.push_back(next);
+            }
+          }
+        }
+      }
+    }
+
+    /**
+     *	@brief Sorts the range by the key of its elements, keeping the order of the equal keys.
+     *
+     *  The key returned by \p key is either an arithmetic or enumeration value or a string:
+     *  basic_string, basic_string_ref or a pointer to the null-terminated characters.
+     *  The numbers are sorted by the bytes from the least significant one in the linear time,
+     *  the strings are sorted by the bytes from the first one and the ended strings go first.
+     *  Floating point keys are ordered by the sign and the magnitude, so -0.0 precedes +0.0.
+     *
+     *  \p buffer points to \c last - \c first constructed objects used as the scratch storage;
+     *  if it is null, a temporary buffer is allocated and the comparison sort is used when it is not available.
+     **/
+    template<class RandomAccessIterator, class KeyOf>
+    inline void radix_sort(RandomAccessIterator first, RandomAccessIterator last, KeyOf key, typename iterator_traits<RandomAccessIterator>::value_type* buffer)
+    {
+      if(last - first < 2)
+        return;
+      radix::sort(first, last, key, buffer, radix::key_kind(key(*first)));
+    }
+
+    template<class RandomAccessIterator, class KeyOf>
+    inline void radix_sort(RandomAccessIterator first, RandomAccessIterator last, KeyOf key)
+    {
+      radix_sort(first, last, key, nullptr);
+    }
+
+    template<class RandomAccessIterator>
+    inline void radix_sort(RandomAccessIterator first, RandomAccessIterator last)
+    {
+      radix_sort(first, last, radix_identity(), nullptr);
+    }
+  }
+}
+
+#endif // NTL__EXT_RADIX_SORT
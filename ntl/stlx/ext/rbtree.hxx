@@ -5,6 +5,7 @@
 #include "../iterator.hxx"
 #include "../memory.hxx"
 #include "../functional.hxx"
+#include "node_pool.hxx"
 
 namespace std 
 {
@@ -12,7 +13,21 @@ namespace std
   {
     namespace tree
     {
-      template<class T, class Compare = std::less<T>, class Allocator = std::allocator<T> >
+      /** Node allocation policy: nodes are taken from the node_pool and released in bulk by clear() (default) */
+      struct pooled_nodes
+      {
+        template<class Node, class Allocator>
+        struct apply { typedef node_pool<Node, Allocator> type; };
+      };
+
+      /** Node allocation policy: every node is allocated separately by the tree's allocator */
+      struct allocated_nodes
+      {
+        template<class Node, class Allocator>
+        struct apply { typedef typename Allocator::template rebind<Node>::other type; };
+      };
+
+      template<class T, class Compare = std::less<T>, class Allocator = std::allocator<T>, class NodePolicy = pooled_nodes>
       class rb_tree
       {
         typedef typename
@@ -106,7 +121,8 @@ namespace std
           node& operator=(const node& n);
         };
 
-        typedef typename rb_tree<T, Compare, Allocator>::node node_type;
+        typedef typename rb_tree<T, Compare, Allocator, NodePolicy>::node node_type;
+        typedef typename NodePolicy::template apply<node_type, Allocator>::type node_allocator_type;
 
         struct iterator_impl:
           std::iterator<std::bidirectional_iterator_tag, value_type, difference_type, pointer, reference>
@@ -130,12 +146,12 @@ namespace std
 
         protected:
           node_type* p;
-          rb_tree<T, Compare, Allocator>* tree_;
+          rb_tree<T, Compare, Allocator, NodePolicy>* tree_;
 
           friend struct const_iterator_impl;
-          friend class rb_tree<T,Compare, Allocator>;
+          friend class rb_tree<T,Compare, Allocator, NodePolicy>;
 
-          iterator_impl(node_type* const p, rb_tree<T, Compare, Allocator>* tree)
+          iterator_impl(node_type* const p, rb_tree<T, Compare, Allocator, NodePolicy>* tree)
             :p(p), tree_(tree)
           {}
 
@@ -174,9 +190,9 @@ namespace std
 
         private:
           const node_type* p;
-          const rb_tree<T, Compare, Allocator>* tree_;
+          const rb_tree<T, Compare, Allocator, NodePolicy>* tree_;
 
-          const_iterator_impl(const node_type* const p, const rb_tree<T, Compare, Allocator>* tree)
+          const_iterator_impl(const node_type* const p, const rb_tree<T, Compare, Allocator, NodePolicy>* tree)
             :p(p), tree_(tree)
           {}
 
@@ -436,9 +452,11 @@ namespace std
           return std::make_pair(insert_impl(place.second, construct_node(x), greater), true);
         }
 
-        iterator insert(const_iterator /*position*/, const value_type& x)
+        /** Appends \c x without the tree descent if the hint is end() and \c x is greater than the last element */
+        iterator insert(const_iterator position, const value_type& x)
         {
-          // TODO: implement fast insert function based on position
+          if(position == cend() && last_ && elem_less(last_->elem, x))
+            return insert_impl(last_, construct_node(x), true);
           return insert(x).first;
         }
 
@@ -490,6 +508,9 @@ namespace std
           {
             using std::swap;
             swap(succ->elem, erasable->elem);
+            // the erasable node keeps the successor's element now
+            if ( succ == last_ )
+              last_ = erasable;
           }
           if ( succ->color() == node::black && x )
           {
@@ -525,7 +546,7 @@ namespace std
           return pos == end() ? 0 : (erase(pos), 1);
         }
 
-        void swap(rb_tree<T, Compare, Allocator>& tree)
+        void swap(rb_tree<T, Compare, Allocator, NodePolicy>& tree)
         {
           if ( this != &tree )
           {
@@ -541,8 +562,134 @@ namespace std
 
         void clear()
         {
-          if(empty())
+          if(empty()){
+            ext::release_nodes(node_allocator);
+            return;
+          }
+          // pooled nodes of the trivially destructible elements are freed without the tree walk
+          if(!has_trivial_destructor<T>::value || !ext::release_nodes(node_allocator))
+            destroy_nodes();
+
+          first_ = last_ = root_ = nullptr;
+          count_ = 0;
+        }
+
+        ///\name Set operations extension
+        /** Moves the elements of \c x which are not in this tree, equivalent elements are left in \c x. Runs in linear time. */
+        void merge(rb_tree& x)
+        {
+          if(this == &x || x.empty())
+            return;
+          node_list to, kept;
+          node* a = flatten();
+          node* b = x.flatten();
+          __ntl_try{
+            while(b){
+              if(a && elem_less(a->elem, b->elem)){
+                node* const n = a->child[right];
+                to.push_back(a);
+                a = n;
+              }else if(a && !elem_less(b->elem, a->elem)){
+                node* n = a->child[right];
+                to.push_back(a);
+                a = n;
+                n = b->child[right];
+                kept.push_back(b);
+                b = n;
+              }else{
+            #ifdef NTL_CXX_RV
+                to.push_back(construct_node(std::move(b->elem)));
+            #else
+                to.push_back(construct_node(b->elem));
+            #endif
+                node* const n = b->child[right];
+                x.node_allocator.destroy(b);
+                x.node_allocator.deallocate(b, 1);
+                b = n;
+              }
+            }
+          }
+          __ntl_catch(...){
+            to.splice(a);
+            kept.splice(b);
+            link_sorted(to);
+            x.link_sorted(kept);
+            __ntl_rethrow;
+          }
+          to.splice(a);
+          link_sorted(to);
+          x.link_sorted(kept);
+        }
+
+        /** Inserts the copies of the elements of \c x which are not in this tree. Runs in linear time. */
+        void unite(const rb_tree& x)
+        {
+          if(this == &x || x.empty())
+            return;
+          node_list to;
+          node* a = flatten();
+          __ntl_try{
+            for(const node* b = x.first_; b; b = x.next(b, right)){
+              while(a && elem_less(a->elem, b->elem)){
+                node* const n = a->child[right];
+                to.push_back(a);
+                a = n;
+              }
+              if(a && !elem_less(b->elem, a->elem)){
+                node* const n = a->child[right];
+                to.push_back(a);
+                a = n;
+              }else{
+                to.push_back(construct_node(b->elem));
+              }
+            }
+          }
+          __ntl_catch(...){
+            to.splice(a);
+            link_sorted(to);
+            __ntl_rethrow;
+          }
+          to.splice(a);
+          link_sorted(to);
+        }
+
+        /** Erases the elements which are not in \c x. Runs in linear time. */
+        void intersect(const rb_tree& x)
+        {
+          if(this == &x || empty())
             return;
+          node_list to;
+          node* a = flatten();
+          const node* b = x.first_;
+          __ntl_try{
+            while(a){
+              while(b && elem_less(b->elem, a->elem))
+                b = x.next(b, right);
+              node* const n = a->child[right];
+              if(b && !elem_less(a->elem, b->elem)){
+                to.push_back(a);
+              }else{
+                node_allocator.destroy(a);
+                node_allocator.deallocate(a, 1);
+              }
+              a = n;
+            }
+          }
+          __ntl_catch(...){
+            to.splice(a);
+            link_sorted(to);
+            __ntl_rethrow;
+          }
+          link_sorted(to);
+        }
+        ///\}
+
+        // observes
+        value_compare value_comp() const { return comparator_; }
+
+      protected:
+        void destroy_nodes()
+        {
           while(first_){
             node* erasable = first_;
             assert(!erasable->child[left]);
@@ -567,15 +714,9 @@ namespace std
             node_allocator.destroy(erasable);
             node_allocator.deallocate(erasable, 1);
           }
-
-          first_ = last_ = root_ = nullptr;
-          count_ = 0;
+          ext::release_nodes(node_allocator);
         }
 
-        // observes
-        value_compare value_comp() const { return comparator_; }
-
-      protected:
         node* next(node* from, direction_type direction) const __ntl_nothrow
         {
           // if --begin() || ++end(), do nothing;
@@ -605,6 +746,101 @@ namespace std
           return next(const_cast<node*>(from), direction);
         }
 
+        /** ascending list of the nodes chained by the right links */
+        struct node_list
+        {
+          node *head, *tail;
+          size_type count;
+
+          node_list()
+            :head(), tail(), count()
+          {}
+
+          void push_back(node* p)
+          {
+            if(tail)
+              tail->child[right] = p;
+            else
+              head = p;
+            tail = p;
+            ++count;
+          }
+
+          /** appends the rest of the chain starting at \c p */
+          void splice(node* p)
+          {
+            while(p){
+              node* const n = p->child[right];
+              push_back(p);
+              p = n;
+            }
+          }
+        };
+
+        /** Unlinks all nodes into the ascending list chained by the right links, leaves the tree empty */
+        node* flatten() __ntl_nothrow
+        {
+          // the successor search reads only the left links of the ancestors and the right links of the following nodes
+          for(node* p = first_; p; ){
+            node* const succ = next(p, right);
+            p->child[right] = succ;
+            p = succ;
+          }
+          node* const list = first_;
+          root_ = first_ = last_ = nullptr;
+          count_ = 0;
+          return list;
+        }
+
+        /** Links the ascending list into the balanced tree, the tree must be empty */
+        void link_sorted(const node_list& list) __ntl_nothrow
+        {
+          assert(empty());
+          if(!list.count)
+            return;
+          // all levels but the last one are full: the last one is red, others are black
+          unsigned red_depth = 0;
+          for(size_type n = list.count; n > 1; n >>= 1)
+            ++red_depth;
+          node* head = list.head;
+          root_ = link_subtree(head, list.count, 0, red_depth);
+          root_->parent_and_color = node::black;
+          first_ = list.head;
+          last_ = list.tail;
+          count_ = list.count;
+        }
+
+        static node* link_subtree(node*& list, size_type n, unsigned depth, unsigned red_depth) __ntl_nothrow
+        {
+          if(!n)
+            return nullptr;
+          const size_type half = (n - 1) / 2;
+          node* const l = link_subtree(list, half, depth + 1, red_depth);
+          node* const p = list;
+          list = list->child[right];
+          p->parent_and_color = depth == red_depth ? node::red : node::black;
+          p->child[left] = l;
+          if(l)
+            l->parent(p);
+          node* const r = link_subtree(list, n - 1 - half, depth + 1, red_depth);
+          p->child[right] = r;
+          if(r)
+            r->parent(p);
+          return p;
+        }
+
+        std::pair<iterator, bool> insert_node(node* np)
+        {
+          bool greater = false;
+          std::pair<node*, node*> place = find_node(np->elem, greater);
+          if(place.first){
+            node_allocator.destroy(np);
+            node_allocator.deallocate(np, 1);
+            return std::make_pair(make_iterator(place.first), false);
+          }
+          return std::make_pair(insert_impl(place.second, np, greater), true);
+        }
+
         void rotate(node* x, direction_type direction) __ntl_nothrow
         {
           direction_type const reverse = reverse_direction(direction);;
@@ -739,10 +975,32 @@ namespace std
         template<class InputIterator>
         void insert_range(InputIterator first, InputIterator last)
         {
-          while(first != last){
-            insert(*first);
+          if(empty() && first != last){
+            // sorted unique input is linked into the balanced tree at once, without the descents and rebalancing
+            node_list sorted;
+            node* np = nullptr;
+            __ntl_try{
+              for(; first != last; ++first){
+                np = construct_node(*first);
+                if(sorted.tail && !elem_less(sorted.tail->elem, np->elem))
+                  break;
+                sorted.push_back(np);
+                np = nullptr;
+              }
+            }
+            __ntl_catch(...){
+              link_sorted(sorted);
+              __ntl_rethrow;
+            }
+            link_sorted(sorted);
+            if(!np)
+              return;
+            // not sorted, continue one by one
+            insert_node(np);
             ++first;
           }
+          for(; first != last; ++first)
+            insert(cend(), *first);
         }
 
       protected:
@@ -752,48 +1010,48 @@ namespace std
         size_type count_;
 
         value_compare comparator_;
-        typename allocator_type::template rebind<node_type>::other node_allocator;
+        node_allocator_type node_allocator;
       };
 
-      template<class T, class Compare, class Allocator>
-      inline bool operator == (const rb_tree<T, Compare, Allocator>& x, const rb_tree<T, Compare, Allocator>& y)
+      template<class T, class Compare, class Allocator, class NodePolicy>
+      inline bool operator == (const rb_tree<T, Compare, Allocator, NodePolicy>& x, const rb_tree<T, Compare, Allocator, NodePolicy>& y)
       {
         return x.size() == y.size() && equal(x.cbegin(), x.cend(), y.cbegin());
       }
 
-      template<class T, class Compare, class Allocator>
-      inline bool operator != (const rb_tree<T, Compare, Allocator>& x, const rb_tree<T, Compare, Allocator>& y)
+      template<class T, class Compare, class Allocator, class NodePolicy>
+      inline bool operator != (const rb_tree<T, Compare, Allocator, NodePolicy>& x, const rb_tree<T, Compare, Allocator, NodePolicy>& y)
       {
         return std::rel_ops::operator !=(x, y);
       }
 
-      template<class T, class Compare, class Allocator>
-      inline bool operator < (const rb_tree<T, Compare, Allocator>& x, const rb_tree<T, Compare, Allocator>& y)
+      template<class T, class Compare, class Allocator, class NodePolicy>
+      inline bool operator < (const rb_tree<T, Compare, Allocator, NodePolicy>& x, const rb_tree<T, Compare, Allocator, NodePolicy>& y)
       {
         return lexicographical_compare(x.cbegin(), x.cend(), y.cbegin(), y.cend());
       }
 
-      template<class T, class Compare, class Allocator>
-      inline bool operator > (const rb_tree<T, Compare, Allocator>& x, const rb_tree<T, Compare, Allocator>& y)
+      template<class T, class Compare, class Allocator, class NodePolicy>
+      inline bool operator > (const rb_tree<T, Compare, Allocator, NodePolicy>& x, const rb_tree<T, Compare, Allocator, NodePolicy>& y)
       {
         return std::rel_ops::operator >(x, y);
       }
 
-      template<class T, class Compare, class Allocator>
-      inline bool operator <= (const rb_tree<T, Compare, Allocator>& x, const rb_tree<T, Compare, Allocator>& y)
+      template<class T, class Compare, class Allocator, class NodePolicy>
+      inline bool operator <= (const rb_tree<T, Compare, Allocator, NodePolicy>& x, const rb_tree<T, Compare, Allocator, NodePolicy>& y)
       {
         return std::rel_ops::operator <=(x, y);
       }
 
-      template<class T, class Compare, class Allocator>
-      inline bool operator >= (const rb_tree<T, Compare, Allocator>& x, const rb_tree<T, Compare, Allocator>& y)
+      template<class T, class Compare, class Allocator, class NodePolicy>
+      inline bool operator >= (const rb_tree<T, Compare, Allocator, NodePolicy>& x, const rb_tree<T, Compare, Allocator, NodePolicy>& y)
       {
         return std::rel_ops::operator >=(x, y);
       }
 
       // specialized algorithms
-      template<class T, class Compare, class Allocator>
-      inline void swap(rb_tree<T, Compare, Allocator>& x, rb_tree<T, Compare, Allocator>& y)
+      template<class T, class Compare, class Allocator, class NodePolicy>
+      inline void swap(rb_tree<T, Compare, Allocator, NodePolicy>& x, rb_tree<T, Compare, Allocator, NodePolicy>& y)
       {
         x.swap(y);
       }
@@ -0,0 +1,2031 @@
+/**\file*********************************************************************
+ *                                                                     \brief
+ *  Regular expression compiler and matching automata
+ *
+ ****************************************************************************
+ */
+#ifndef NTL__EXT_REGEX_ENGINE
+#define NTL__EXT_REGEX_ENGINE
+#pragma once
+
+// included by regex.hxx after regex_constants, regex_error and regex_traits
+
+#ifndef NTL__STLX_CSTDINT
+#include "../cstdint.hxx"
+#endif
+#ifndef NTL__STLX_VECTOR
+#include "../vector.hxx"
+#endif
+#ifndef NTL__STLX_ITERATOR
+#include "../iterator.hxx"
+#endif
+#ifndef NTL__STLX_ATOMIC
+#include "../atomic.hxx"
+#endif
+#ifndef NTL__STLX_ALGORITHM
+#include "../algorithm.hxx"
+#endif
+
+/** The memory taken by one lazy DFA cache of a regular expression, in bytes. The cache is flushed when it is full. */
+#ifndef STLX__REGEX_DFA_CACHE
+#define STLX__REGEX_DFA_CACHE (1024*1024)
+#endif
+
+/** The largest compiled program, in instructions. The counted repetitions are expanded, so `x{1000}` takes a thousand copies of `x`. */
+#ifndef STLX__REGEX_MAX_PROGRAM
+#define STLX__REGEX_MAX_PROGRAM 65536
+#endif
+
+/** The deepest group nesting accepted by the parser */
+#ifndef STLX__REGEX_MAX_DEPTH
+#define STLX__REGEX_MAX_DEPTH 256
+#endif
+
+/** The largest visited bitmap of the capturing backtracker, in bits; the longer matches are resolved by the Pike VM */
+#ifndef STLX__REGEX_BACKTRACK_BITS
+#define STLX__REGEX_BACKTRACK_BITS (256*1024*8)
+#endif
+
+/** The backtracking steps allowed per instruction and input character for the patterns with backreferences */
+#ifndef STLX__REGEX_BACKREF_STEPS
+#define STLX__REGEX_BACKREF_STEPS 4
+#endif
+
+/** The backtracking steps allowed to the patterns with backreferences on top of STLX__REGEX_BACKREF_STEPS */
+#ifndef STLX__REGEX_BACKREF_BASE
+#define STLX__REGEX_BACKREF_BASE (1024*1024)
+#endif
+
+/** The characters the anchored DFA may scan per input character at the prefilter candidates before the search goes unanchored */
+#ifndef STLX__REGEX_PREFILTER_WORK
+#define STLX__REGEX_PREFILTER_WORK 4
+#endif
+
+namespace std
+{
+  namespace __
+  {
+    /**
+     *	Regular expression engine.
+     *
+     *  The pattern is parsed into a tree and compiled to a Thompson NFA: a program of the character tests, the prioritized
+     *  splits and jumps, the capture saves and the zero width assertions. The input is never rescanned unless the pattern
+     *  has backreferences:
+     *
+     *  - the prefilter skips the text no match can start in: the compiler finds a literal every match starts with, or one
+     *    it holds at a bounded offset, or the few characters it may start with. The literal is found by the vectorized
+     *    std::search of the contiguous ranges and only its candidates are tried by the anchored DFA; when that costs
+     *    more than STLX__REGEX_PREFILTER_WORK characters per input character, the rest is scanned unanchored.
+     *  - the lazy DFA simulates the NFA a whole ordered thread list at a time and caches every computed transition, so a
+     *    character costs one table lookup once the states are built. The cache has a fixed budget and is flushed when it
+     *    is full; when it keeps flushing without progress the search falls back to the Pike VM.
+     *  - the forward DFA finds the end of the leftmost-first match, the DFA of the reversed program run back from that end
+     *    finds its start. The POSIX grammars want the longest match, so one more forward DFA pass which keeps all the
+     *    threads extends it from that start.
+     *  - the capture groups are resolved on the matched span only, by the backtracker which never visits an (instruction,
+     *    position) pair twice, or by the Pike VM when that bitmap would be too big.
+     *  - the backreferences are not regular, so these patterns are matched by the plain backtracker which counts its
+     *    steps and throws regex_error(error_complexity) after a budget linear in the input.
+     *
+     *  The ECMAScript repetitions clear the captures of their atom at every iteration, and an iteration past the minimum
+     *  fails when it matches nothing. The automata keep no loop state for the latter, so the compiler emits such an
+     *  iteration of a nullable atom twice: the copy which has matched nothing yet fails at its end, its consuming
+     *  instructions continue in the other one. Every nesting level of the nullable loops doubles their code.
+     *
+     *  So any pattern without backreferences is matched in O(m*n) time at worst, and in O(n) once its DFA fits the cache.
+     *  The lookahead assertions are not supported for the same reason as the backreferences.
+     **/
+    namespace re
+    {
+      typedef regex_constants::syntax_option_type syntax_type;
+      typedef regex_constants::match_flag_type match_type;
+
+      static const uint32_t npos = ~0u;
+      static const size_t unset = static_cast<size_t>(-1);
+
+      template<class charT>
+      inline uint32_t code_of(charT c) { return static_cast<uint32_t>(c); }
+      inline uint32_t code_of(char c) { return static_cast<unsigned char>(c); }
+      inline uint32_t code_of(signed char c) { return static_cast<unsigned char>(c); }
+
+      inline void error(regex_constants::error_type e)
+      {
+        __ntl_throw(regex_error(e));
+      }
+
+      enum opcode { op_char, op_any, op_set, op_split, op_jump, op_save, op_clear, op_assert, op_backref, op_fail, op_match };
+      enum assertion { assert_begin, assert_end, assert_word, assert_not_word };
+
+      /** NFA instruction */
+      struct instruction
+      {
+        uint8_t op;
+        uint8_t arg;    ///< op_char, op_backref: compare case insensitively; op_any: stop at the line terminators; op_assert: the assertion
+        uint32_t x;     ///< the character code, set, jump target, slot or group; op_clear: the first slot
+        uint32_t y;     ///< the less preferred split target; op_clear: the slot past the last; the consuming instructions: the next one unless 0
+      };
+
+      /** The instruction after the consuming \p in at \p pc */
+      inline uint32_t next_pc(const instruction& in, uint32_t pc) { return in.y ? in.y : pc + 1; }
+
+      /** Bracket expression or class escape */
+      template<class charT, class traits>
+      struct char_set
+      {
+        typedef typename traits::char_class_type class_type;
+
+        vector<pair<uint32_t, uint32_t> > ranges;
+        vector<class_type> not_classes;     // [\D\W] is a union of the complements
+        class_type classes;
+        bool negate, icase;
+        uint32_t low[8];                    // the answers for the codes below 256
+
+        char_set()
+          :classes(), negate(), icase()
+        {}
+
+        bool raw_test(charT c, const traits& tr) const
+        {
+          const uint32_t u = code_of(c);
+          for(size_t i = 0; i < ranges.size(); i++)
+            if(ranges[i].first <= u && u <= ranges[i].second)
+              return true;
+          if(classes != class_type() && tr.isctype(c, classes))
+            return true;
+          for(size_t i = 0; i < not_classes.size(); i++)
+            if(!tr.isctype(c, not_classes[i]))
+              return true;
+          return false;
+        }
+
+        bool slow_test(charT c, const traits& tr) const
+        {
+          const bool r = raw_test(c, tr) || (icase && raw_test(tr.translate_nocase(c), tr));
+          return r != negate;
+        }
+
+        /** Tabulates the codes below 256; without case a member makes its whole case folding class a member */
+        void finish(const traits& tr)
+        {
+          bool raw[256], folded[256] = {};
+          for(uint32_t c = 0; c < 256; c++){
+            raw[c] = raw_test(static_cast<charT>(c), tr);
+            const uint32_t f = code_of(tr.translate_nocase(static_cast<charT>(c)));
+            if(icase && raw[c] && f < 256)
+              folded[f] = true;
+          }
+          for(uint32_t i = 0; i < 8; i++)
+            low[i] = 0;
+          for(uint32_t c = 0; c < 256; c++){
+            bool r = raw[c];
+            if(icase && !r){
+              const uint32_t f = code_of(tr.translate_nocase(static_cast<charT>(c)));
+              r = f < 256 ? folded[f] : raw_test(static_cast<charT>(f), tr);
+            }
+            if(r != negate)
+              low[c >> 5] |= 1u << (c & 31);
+          }
+        }
+
+        bool test(charT c, const traits& tr) const
+        {
+          const uint32_t u = code_of(c);
+          return u < 256 ? ((low[u >> 5] >> (u & 31)) & 1) != 0 : slow_test(c, tr);
+        }
+      };
+
+      /** The lazily built DFA: the states are the ordered NFA thread lists, the transitions are computed on demand */
+      struct dfa_cache
+      {
+        struct state
+        {
+          uint32_t kernel, size;    ///< the threads waiting for the next character, in priority order
+          uint32_t flags;
+          uint32_t hash;
+        };
+
+        vector<state> states;
+        vector<uint32_t> threads;
+        vector<uint32_t> next;      ///< states x classes: 0 unknown, otherwise 1 + (target << 1 | matched before the character)
+        vector<uint32_t> index;     ///< open addressing, state number + 1
+        size_t memory;
+
+        // scratch space of the transition computation
+        vector<uint32_t> stack, list, kernel, marks;
+        uint32_t epoch;
+
+        dfa_cache()
+          :memory(), epoch()
+        {}
+
+        void clear()
+        {
+          states.clear();
+          threads.clear();
+          next.clear();
+          index.clear();
+          memory = 0;
+        }
+      };
+
+      enum cache_kind { cache_forward, cache_full, cache_reverse, cache_longest, cache_kinds };
+      enum prefilter_mode { skip_none, skip_prefix, skip_window, skip_first };
+
+      /** Compiled regular expression */
+      template<class charT, class traits>
+      struct program
+      {
+        typedef charT char_type;
+        typedef traits traits_type;
+        typedef char_set<charT, traits> set_type;
+
+        vector<instruction> code;       ///< save 0, the pattern, save 1, match, then the unanchored search loop
+        vector<instruction> reverse;    ///< the reversed pattern for the DFA, without the captures
+        vector<set_type> sets;
+        traits tr;
+        syntax_type syntax;
+        unsigned marks;                 ///< capture groups
+        uint32_t search_start;
+        bool backrefs, word_assertions, anchored;
+        bool longest;                   ///< leftmost-longest (POSIX) rather than leftmost-first (ECMAScript)
+
+        /** What every match starts with or holds, to skip the text no match starts in */
+        struct prefilter
+        {
+          uint8_t mode;                 ///< prefilter_mode
+          vector<charT> literal;        ///< held by every match at [low, high] characters from its start, \c high is \c npos when unbounded
+          uint32_t low, high;
+          uint32_t first[8];            ///< the codes below 256 a match may start with in the \c skip_first mode
+          bool wide;                    ///< and whether the codes above may
+        } filter;
+
+        uint8_t classes[256];           ///< the DFA alphabet: the codes no instruction tells apart share a class
+        uint32_t class_count;
+        uint32_t fold[256];
+        uint32_t word[8];
+        typename traits::char_class_type word_class;
+
+        mutable dfa_cache caches[cache_kinds];
+        mutable atomic_flag busy[cache_kinds];
+
+        program(const traits& tr, syntax_type syntax)
+          :tr(tr), syntax(syntax), marks(), search_start(), backrefs(), word_assertions(), anchored(),
+          longest(!(syntax & regex_constants::ECMAScript)), class_count(1)
+        {
+          for(unsigned i = 0; i < cache_kinds; i++)
+            busy[i].clear();
+          filter.mode = skip_none;
+          filter.low = filter.high = 0;
+          filter.wide = false;
+          const charT w = static_cast<charT>('w');
+          word_class = tr.lookup_classname(&w, &w + 1);
+          for(uint32_t c = 0; c < 8; c++)
+            word[c] = filter.first[c] = 0;
+          for(uint32_t c = 0; c < 256; c++){
+            fold[c] = code_of(tr.translate_nocase(static_cast<charT>(c)));
+            if(tr.isctype(static_cast<charT>(c), word_class))
+              word[c >> 5] |= 1u << (c & 31);
+            classes[c] = 0;
+          }
+        }
+
+        uint32_t folded(charT c) const
+        {
+          const uint32_t u = code_of(c);
+          return u < 256 ? fold[u] : code_of(tr.translate_nocase(c));
+        }
+
+        bool is_word(charT c) const
+        {
+          const uint32_t u = code_of(c);
+          return u < 256 ? ((word[u >> 5] >> (u & 31)) & 1) != 0 : tr.isctype(c, word_class);
+        }
+
+        /** Can a match start with \p c in the \c skip_first mode */
+        bool may_start(charT c) const
+        {
+          const uint32_t u = code_of(c);
+          return u < 256 ? ((filter.first[u >> 5] >> (u & 31)) & 1) != 0 : filter.wide;
+        }
+
+        /** Does the consuming instruction accept \p c */
+        bool test(const instruction& in, charT c) const
+        {
+          switch(in.op){
+          case op_char:
+            return (in.arg ? folded(c) : code_of(c)) == in.x;
+          case op_any:
+            {
+              const uint32_t u = code_of(c);
+              return !in.arg || !(u == '\n' || u == '\r' || u == 0x2028 || u == 0x2029);
+            }
+          case op_set:
+            return sets[in.x].test(c, tr);
+          }
+          return false;
+        }
+
+        /** Builds the DFA alphabet */
+        void finish()
+        {
+          // split the classes by every distinct character test
+          vector<bool> seen_sets(sets.size());
+          uint32_t seen_chars[2][8] = {};
+          bool seen_any[2] = {};
+          bool answers[256];
+          for(size_t pc = 0; pc < code.size(); pc++){
+            const instruction& in = code[pc];
+            if(in.op == op_assert && (in.arg == assert_word || in.arg == assert_not_word))
+              word_assertions = true;
+            if(in.op == op_char && in.x < 256){
+              uint32_t& seen = seen_chars[in.arg][in.x >> 5];
+              if(seen & (1u << (in.x & 31)))
+                continue;
+              seen |= 1u << (in.x & 31);
+            }else if(in.op == op_set){
+              if(seen_sets[in.x])
+                continue;
+              seen_sets[in.x] = true;
+            }else if(in.op == op_any){
+              if(seen_any[in.arg])
+                continue;
+              seen_any[in.arg] = true;
+            }else if(in.op != op_char)
+              continue;
+            for(uint32_t c = 0; c < 256; c++)
+              answers[c] = test(in, static_cast<charT>(c));
+            refine(answers);
+          }
+          if(word_assertions){
+            for(uint32_t c = 0; c < 256; c++)
+              answers[c] = is_word(static_cast<charT>(c));
+            refine(answers);
+          }
+        }
+
+      private:
+        void refine(const bool answers[256])
+        {
+          uint16_t map[512];
+          for(uint32_t i = 0; i < 512; i++)
+            map[i] = 0xFFFF;
+          uint32_t count = 0;
+          for(uint32_t c = 0; c < 256; c++){
+            uint16_t& k = map[classes[c] * 2 + answers[c]];
+            if(k == 0xFFFF)
+              k = static_cast<uint16_t>(count++);
+            classes[c] = static_cast<uint8_t>(k);
+          }
+          class_count = count;
+        }
+        program(const program&);
+        program& operator=(const program&);
+      };
+
+      /**
+       *	Pattern compiler.
+       *
+       *  The ECMAScript grammar without the lookahead; the POSIX grammars share it, except the basic ones
+       *  escape the groups and the braces and have neither `+`, `?` nor `|`.
+       **/
+      template<class charT, class traits>
+      class compiler
+      {
+        typedef program<charT, traits> program_type;
+        typedef char_set<charT, traits> set_type;
+        typedef typename traits::char_class_type class_type;
+
+        enum kind { n_empty, n_char, n_any, n_set, n_group, n_concat, n_alt, n_repeat, n_assert, n_backref };
+        struct node
+        {
+          uint8_t kind, greedy;
+          uint32_t value, min, max;
+          uint32_t child, next;
+        };
+
+      public:
+        compiler(program_type& prog, const charT* first, const charT* last)
+          :prog(prog), p(first), end(last), out(), depth(), max_backref()
+        {
+          using namespace regex_constants;
+          ecma = (prog.syntax & ECMAScript) != 0;
+          bre = (prog.syntax & (basic | grep)) != 0;
+          icase = (prog.syntax & regex_constants::icase) != 0;
+        }
+
+        void compile()
+        {
+          const uint32_t root = disjunction();
+          if(p != end)
+            error(regex_constants::error_paren);
+          if(max_backref > prog.marks)
+            error(regex_constants::error_backref);
+
+          out = &prog.code;
+          emit(op_save, 0, 0);
+          emit_node(root, false);
+          emit(op_save, 0, 1);
+          emit(op_match);
+          // lazy .* in front of the pattern for the unanchored DFA
+          prog.search_start = emit(op_split, 0, 0, static_cast<uint32_t>(out->size() + 1));
+          emit(op_any);
+          emit(op_jump, 0, prog.search_start);
+
+          if(!prog.backrefs){
+            out = &prog.reverse;
+            emit_node(root, true);
+            emit(op_match);
+          }
+          prog.anchored = anchored(root);
+          if(!prog.anchored)
+            prefilter(root);
+          prog.finish();
+        }
+
+      private:
+        program_type& prog;
+        const charT *p, *end;
+        vector<node> nodes;
+        vector<instruction>* out;
+        unsigned depth, max_backref;
+        bool ecma, bre, icase;
+
+        ///\name parser
+        bool at(char c) const { return p != end && *p == static_cast<charT>(c); }
+        bool at_escaped(char c) const { return end - p >= 2 && p[0] == static_cast<charT>('\\') && p[1] == static_cast<charT>(c); }
+        bool at_group() const { return bre ? at_escaped('(') : at('('); }
+        bool at_close() const { return depth && (bre ? at_escaped(')') : at(')')); }
+        bool at_bar() const
+        {
+          using namespace regex_constants;
+          return (!bre && at('|')) || ((prog.syntax & (grep | egrep)) && at('\n'));
+        }
+
+        uint32_t make(uint8_t kind, uint32_t value = 0)
+        {
+          const node n = { kind, true, value, 0, 0, npos, npos };
+          nodes.push_back(n);
+          return static_cast<uint32_t>(nodes.size() - 1);
+        }
+
+        uint32_t make_set(const set_type& s)
+        {
+          prog.sets.push_back(s);
+          prog.sets.back().finish(prog.tr);
+          return make(n_set, static_cast<uint32_t>(prog.sets.size() - 1));
+        }
+
+        uint32_t disjunction()
+        {
+          const uint32_t first = alternative();
+          if(!at_bar())
+            return first;
+          const uint32_t alt = make(n_alt);
+          nodes[alt].child = first;
+          for(uint32_t last = first; at_bar(); ){
+            ++p;
+            const uint32_t next = alternative();
+            nodes[last].next = next;
+            last = next;
+          }
+          return alt;
+        }
+
+        uint32_t alternative()
+        {
+          const uint32_t seq = make(n_concat);
+          for(uint32_t last = npos; p != end && !at_bar() && !at_close(); ){
+            const uint32_t t = term();
+            if(last == npos)
+              nodes[seq].child = t;
+            else
+              nodes[last].next = t;
+            last = t;
+          }
+          return seq;
+        }
+
+        uint32_t term()
+        {
+          if(at('^')){
+            ++p;
+            return make(n_assert, assert_begin);
+          }
+          if(at('$')){
+            ++p;
+            return make(n_assert, assert_end);
+          }
+          if(ecma && (at_escaped('b') || at_escaped('B'))){
+            p += 2;
+            return make(n_assert, p[-1] == static_cast<charT>('b') ? assert_word : assert_not_word);
+          }
+          uint32_t a = atom();
+          do{
+            uint32_t min, max;
+            if(at('*')){
+              ++p;
+              min = 0, max = npos;
+            }else if(!bre && at('+')){
+              ++p;
+              min = 1, max = npos;
+            }else if(!bre && at('?')){
+              ++p;
+              min = 0, max = 1;
+            }else if(bre ? at_escaped('{') : at('{')){
+              p += bre ? 2 : 1;
+              braces(min, max);
+            }else
+              break;
+            const uint32_t r = make(n_repeat);
+            nodes[r].child = a;
+            nodes[r].min = min;
+            nodes[r].max = max;
+            if(ecma && at('?')){
+              ++p;
+              nodes[r].greedy = false;
+            }
+            a = r;
+          }while(!ecma);
+          return a;
+        }
+
+        void braces(uint32_t& min, uint32_t& max)
+        {
+          if(!number(min))
+            error(p == end ? regex_constants::error_brace : regex_constants::error_badbrace);
+          max = min;
+          if(at(',')){
+            ++p;
+            if(!number(max))
+              max = npos;
+          }
+          if(bre ? !at_escaped('}') : !at('}'))
+            error(p == end ? regex_constants::error_brace : regex_constants::error_badbrace);
+          p += bre ? 2 : 1;
+          if(max < min)
+            error(regex_constants::error_badbrace);
+        }
+
+        bool number(uint32_t& n)
+        {
+          const charT* const start = p;
+          int d;
+          for(n = 0; p != end && (d = prog.tr.value(*p, 10)) >= 0; ++p){
+            n = n * 10 + d;
+            if(n > STLX__REGEX_MAX_PROGRAM)
+              error(regex_constants::error_badbrace);
+          }
+          return p != start;
+        }
+
+        uint32_t atom()
+        {
+          if(at('.')){
+            ++p;
+            return make(n_any);
+          }
+          if(at('[')){
+            ++p;
+            return bracket();
+          }
+          if(at_group())
+            return group();
+          if((!bre && at(')')) || at_escaped(')'))
+            error(regex_constants::error_paren);
+          if(at('*') || (!bre && (at('+') || at('?') || at('{'))) || at_escaped('{'))
+            error(regex_constants::error_badrepeat);
+          if(at('\\'))
+            return escape();
+          return make(n_char, code_of(*p++));
+        }
+
+        uint32_t group()
+        {
+          p += bre ? 2 : 1;
+          uint32_t index = npos;
+          if(ecma && at('?')){
+            if(end - p < 2 || p[1] != static_cast<charT>(':'))
+              error(regex_constants::error_complexity);   // lookahead
+            p += 2;
+          }else if(!(prog.syntax & regex_constants::nosubs))
+            index = ++prog.marks;
+          if(++depth > STLX__REGEX_MAX_DEPTH)
+            error(regex_constants::error_stack);
+          const uint32_t g = make(n_group, index);
+          const uint32_t inner = disjunction();
+          nodes[g].child = inner;
+          if(bre ? !at_escaped(')') : !at(')'))
+            error(regex_constants::error_paren);
+          p += bre ? 2 : 1;
+          --depth;
+          return g;
+        }
+
+        class_type class_name(charT c) const
+        {
+          const charT name = static_cast<charT>(code_of(c) | 0x20);
+          return prog.tr.lookup_classname(&name, &name + 1, icase);
+        }
+
+        static bool is_class_escape(uint32_t c)
+        {
+          return c == 'd' || c == 'D' || c == 's' || c == 'S' || c == 'w' || c == 'W';
+        }
+
+        /** The character escapes, after the backslash */
+        uint32_t char_escape()
+        {
+          const uint32_t c = code_of(*p++);
+          if(!ecma)
+            return c;
+          switch(c){
+          case 'f': return '\f';
+          case 'n': return '\n';
+          case 'r': return '\r';
+          case 't': return '\t';
+          case 'v': return '\v';
+          case '0': return 0;
+          case 'c':
+            if(p == end || !prog.tr.isctype(*p, prog.tr.lookup_classname(alpha_name, alpha_name + 5)))
+              error(regex_constants::error_escape);
+            return code_of(*p++) % 32;
+          case 'x':
+          case 'u':
+            {
+              uint32_t v = 0;
+              for(int n = c == 'x' ? 2 : 4; n; n--, ++p){
+                int d;
+                if(p == end || (d = prog.tr.value(*p, 16)) < 0)
+                  error(regex_constants::error_escape);
+                v = v * 16 + d;
+              }
+              return v;
+            }
+          }
+          const charT ch = static_cast<charT>(c);
+          if(prog.tr.isctype(ch, prog.tr.lookup_classname(alnum_name, alnum_name + 5)) || ch == static_cast<charT>('_'))
+            error(regex_constants::error_escape);
+          return c;
+        }
+
+        uint32_t escape()
+        {
+          ++p;
+          if(p == end)
+            error(regex_constants::error_escape);
+          const uint32_t c = code_of(*p);
+          if(ecma && is_class_escape(c)){
+            ++p;
+            set_type s;
+            s.icase = icase;
+            s.classes = class_name(static_cast<charT>(c));
+            s.negate = c < 'a';
+            return make_set(s);
+          }
+          if((ecma || bre) && c >= '1' && c <= '9'){
+            uint32_t n = 0;
+            do{
+              n = n * 10 + (code_of(*p++) - '0');
+            }while(ecma && p != end && *p >= static_cast<charT>('0') && *p <= static_cast<charT>('9') && n < 1000);
+            prog.backrefs = true;
+            if(n > max_backref)
+              max_backref = n;
+            return make(n_backref, n);
+          }
+          if(bre && (c == '}'))
+            error(regex_constants::error_badbrace);
+          return make(n_char, char_escape());
+        }
+
+        /** The bracket element: adds the classes itself, returns true with a character */
+        bool element(set_type& s, uint32_t& value)
+        {
+          if(at('[') && end - p >= 2 && (p[1] == static_cast<charT>(':') || p[1] == static_cast<charT>('.') || p[1] == static_cast<charT>('='))){
+            const charT kind = p[1];
+            p += 2;
+            const charT* const name = p;
+            while(!(end - p >= 2 && p[0] == kind && p[1] == static_cast<charT>(']'))){
+              if(p == end)
+                error(regex_constants::error_brack);
+              ++p;
+            }
+            const charT* const name_end = p;
+            p += 2;
+            if(kind == static_cast<charT>(':')){
+              const class_type k = prog.tr.lookup_classname(name, name_end, icase);
+              if(k == class_type())
+                error(regex_constants::error_ctype);
+              s.classes |= k;
+              return false;
+            }
+            const typename traits::string_type element = prog.tr.lookup_collatename(name, name_end);
+            if(element.size() != 1)
+              error(regex_constants::error_collate);
+            value = code_of(element[0]);
+            return true;
+          }
+          if(at('\\') && (ecma || (prog.syntax & regex_constants::awk))){
+            if(++p == end)
+              error(regex_constants::error_escape);
+            const uint32_t c = code_of(*p);
+            if(ecma && is_class_escape(c)){
+              ++p;
+              if(c < 'a')
+                s.not_classes.push_back(class_name(static_cast<charT>(c)));
+              else
+                s.classes |= class_name(static_cast<charT>(c));
+              return false;
+            }
+            if(c == 'b' || c == '-'){
+              ++p;
+              value = c == 'b' ? '\b' : c;
+              return true;
+            }
+            value = char_escape();
+            return true;
+          }
+          value = code_of(*p++);
+          return true;
+        }
+
+        uint32_t bracket()
+        {
+          set_type s;
+          s.icase = icase;
+          if(at('^')){
+            ++p;
+            s.negate = true;
+          }
+          if(!ecma && at(']')){
+            ++p;
+            s.ranges.push_back(make_pair(uint32_t(']'), uint32_t(']')));
+          }
+          for(;;){
+            if(p == end)
+              error(regex_constants::error_brack);
+            if(at(']')){
+              ++p;
+              break;
+            }
+            uint32_t lo, hi;
+            if(!element(s, lo))
+              continue;
+            hi = lo;
+            if(at('-') && end - p >= 2 && p[1] != static_cast<charT>(']')){
+              ++p;
+              if(!element(s, hi) || hi < lo)
+                error(regex_constants::error_range);
+            }
+            s.ranges.push_back(make_pair(lo, hi));
+          }
+          return make_set(s);
+        }
+        ///\}
+
+        ///\name code generator
+        uint32_t emit(uint8_t op, uint8_t arg = 0, uint32_t x = 0, uint32_t y = 0)
+        {
+          if(out->size() >= STLX__REGEX_MAX_PROGRAM)
+            error(regex_constants::error_space);
+          const instruction in = { op, arg, x, y };
+          out->push_back(in);
+          return static_cast<uint32_t>(out->size() - 1);
+        }
+
+        uint32_t here() const { return static_cast<uint32_t>(out->size()); }
+
+        /** Points the split at \p body first when greedy, at the continuation first otherwise */
+        void patch_split(uint32_t split, uint32_t body, uint32_t cont, bool greedy)
+        {
+          (*out)[split].x = greedy ? body : cont;
+          (*out)[split].y = greedy ? cont : body;
+        }
+
+        void emit_node(uint32_t n, bool reverse)
+        {
+          const node nd = nodes[n];
+          switch(nd.kind){
+          case n_char:
+            emit(op_char, icase, icase ? prog.folded(static_cast<charT>(nd.value)) : nd.value);
+            break;
+          case n_any:
+            emit(op_any, ecma);
+            break;
+          case n_set:
+            emit(op_set, 0, nd.value);
+            break;
+          case n_assert:
+            {
+              uint32_t a = nd.value;
+              if(reverse && a < assert_word)
+                a = a == assert_begin ? assert_end : assert_begin;
+              emit(op_assert, static_cast<uint8_t>(a));
+            }
+            break;
+          case n_backref:
+            emit(op_backref, icase, nd.value);
+            break;
+          case n_group:
+            if(nd.value != npos && !reverse)
+              emit(op_save, 0, 2 * nd.value);
+            emit_node(nd.child, reverse);
+            if(nd.value != npos && !reverse)
+              emit(op_save, 0, 2 * nd.value + 1);
+            break;
+          case n_concat:
+            {
+              vector<uint32_t> children;
+              for(uint32_t c = nd.child; c != npos; c = nodes[c].next)
+                children.push_back(c);
+              for(size_t i = 0; i < children.size(); i++)
+                emit_node(children[reverse ? children.size() - 1 - i : i], reverse);
+            }
+            break;
+          case n_alt:
+            {
+              vector<uint32_t> jumps;
+              uint32_t c = nd.child;
+              for(; nodes[c].next != npos; c = nodes[c].next){
+                const uint32_t split = emit(op_split);
+                (*out)[split].x = here();
+                emit_node(c, reverse);
+                jumps.push_back(emit(op_jump));
+                (*out)[split].y = here();
+              }
+              emit_node(c, reverse);
+              for(size_t i = 0; i < jumps.size(); i++)
+                (*out)[jumps[i]].x = here();
+            }
+            break;
+          case n_repeat:
+            repeat(nd, reverse);
+            break;
+          }
+        }
+
+        void repeat(const node& nd, bool reverse)
+        {
+          const bool empty = nullable(nd.child);
+          uint32_t copies = nd.min;
+          if(nd.max == npos && nd.min && !empty)
+            copies--;
+          for(uint32_t i = 0; i < copies; i++)
+            iteration(nd.child, reverse, false);
+
+          if(nd.max == npos && nd.min && !empty){
+            // L: x; split L, E
+            const uint32_t body = here();
+            iteration(nd.child, reverse, false);
+            const uint32_t split = emit(op_split);
+            patch_split(split, body, here(), nd.greedy != 0);
+          }else if(nd.max == npos){
+            // L: split B, E; B: x; jmp L
+            const uint32_t split = emit(op_split);
+            const uint32_t body = here();
+            iteration(nd.child, reverse, empty);
+            emit(op_jump, 0, split);
+            patch_split(split, body, here(), nd.greedy != 0);
+          }else{
+            // split B1, E; B1: x; split B2, E; B2: x ... E:
+            vector<uint32_t> splits;
+            for(uint32_t i = nd.min; i < nd.max; i++){
+              splits.push_back(emit(op_split));
+              iteration(nd.child, reverse, empty);
+            }
+            for(size_t i = 0; i < splits.size(); i++)
+              patch_split(splits[i], splits[i] + 1, here(), nd.greedy != 0);
+          }
+        }
+
+        /** Emits an iteration of the atom \p n which clears its captures first; the \p nonempty one fails matching nothing */
+        void iteration(uint32_t n, bool reverse, bool nonempty)
+        {
+          // the reversed program only finds where the match starts, and the empty iterations change no match
+          if(reverse){
+            emit_node(n, reverse);
+            return;
+          }
+          uint32_t first = npos, last = 0;
+          if(ecma)
+            groups(n, first, last);
+          if(first < last)
+            emit(op_clear, 0, 2 * first, 2 * last);
+          if(!nonempty){
+            emit_node(n, reverse);
+            return;
+          }
+          // A: x; fail; B: x, the consuming instructions of A continue in B
+          const uint32_t a = here();
+          emit_node(n, reverse);
+          const uint32_t b = emit(op_fail) + 1;
+          emit_node(n, reverse);
+          for(uint32_t pc = a; pc + 1 < b; pc++){
+            instruction& in = (*out)[pc];
+            if(in.op == op_char || in.op == op_any || in.op == op_set || in.op == op_backref)
+              in.y = next_pc(in, pc) - a + b;
+          }
+        }
+
+        /** Widens [\p first, \p last) to the capture groups inside the node */
+        void groups(uint32_t n, uint32_t& first, uint32_t& last) const
+        {
+          const node& nd = nodes[n];
+          switch(nd.kind){
+          case n_group:
+            if(nd.value != npos){
+              first = std::min(first, nd.value);
+              last = std::max(last, nd.value + 1);
+            }
+            groups(nd.child, first, last);
+            break;
+          case n_repeat:
+            groups(nd.child, first, last);
+            break;
+          case n_concat: case n_alt:
+            for(uint32_t c = nd.child; c != npos; c = nodes[c].next)
+              groups(c, first, last);
+            break;
+          }
+        }
+
+        bool nullable(uint32_t n) const
+        {
+          const node& nd = nodes[n];
+          switch(nd.kind){
+          case n_char: case n_any: case n_set:
+            return false;
+          case n_group:
+            return nullable(nd.child);
+          case n_repeat:
+            return nd.min == 0 || nullable(nd.child);
+          case n_concat:
+            for(uint32_t c = nd.child; c != npos; c = nodes[c].next)
+              if(!nullable(c))
+                return false;
+            return true;
+          case n_alt:
+            for(uint32_t c = nd.child; c != npos; c = nodes[c].next)
+              if(nullable(c))
+                return true;
+            return false;
+          }
+          return true;
+        }
+
+        /** Can the pattern match only at the beginning of the text */
+        bool anchored(uint32_t n) const
+        {
+          const node& nd = nodes[n];
+          switch(nd.kind){
+          case n_assert:
+            return nd.value == assert_begin;
+          case n_group:
+            return anchored(nd.child);
+          case n_repeat:
+            return nd.min && anchored(nd.child);
+          case n_concat:
+            return nd.child != npos && anchored(nd.child);
+          case n_alt:
+            for(uint32_t c = nd.child; c != npos; c = nodes[c].next)
+              if(!anchored(c))
+                return false;
+            return true;
+          }
+          return false;
+        }
+        ///\}
+
+        ///\name prefilter
+        /** The longest bounded offset window of a literal the candidates are tried across */
+        static const uint32_t window_max = 64;
+        /** The most characters of the first character set */
+        static const uint32_t first_max = 16;
+        /** The longest literal kept */
+        static const size_t literal_max = 64;
+
+        /** What every match of a node holds */
+        struct facts
+        {
+          uint32_t min, max;            ///< the length bounds, \c max is \c npos when unbounded
+          vector<charT> prefix;         ///< every match starts with it
+          bool exact;                   ///< and is nothing else
+          vector<charT> inner;          ///< every match holds it at [low, high] characters from its start
+          uint32_t low, high;
+        };
+
+        static uint32_t add(uint32_t a, uint32_t b)
+        {
+          return a == npos || b == npos || a + b >= npos ? npos : a + b;
+        }
+
+        static uint32_t mul(uint32_t a, uint32_t b)
+        {
+          if(a == 0 || b == 0)
+            return 0;
+          const uint64_t r = static_cast<uint64_t>(a) * b;
+          return a == npos || b == npos || r >= npos ? npos : static_cast<uint32_t>(r);
+        }
+
+        /** Keeps the literal at [low, high] if it is better: bounded first, then longer, then with the narrower window */
+        static void consider(facts& f, const vector<charT>& literal, uint32_t low, uint32_t high)
+        {
+          if(literal.empty())
+            return;
+          if(!f.inner.empty()){
+            const bool bounded = high != npos, was = f.high != npos;
+            if(bounded != was ? !bounded : literal.size() != f.inner.size() ? literal.size() < f.inner.size() : !bounded || high - low >= f.high - f.low)
+              return;
+          }
+          f.inner = literal;
+          f.low = low, f.high = high;
+        }
+
+        facts analyze(uint32_t n) const
+        {
+          const node& nd = nodes[n];
+          facts f;
+          f.min = f.max = 0;
+          f.exact = true;
+          f.low = f.high = 0;
+          switch(nd.kind){
+          case n_char:
+            f.min = f.max = 1;
+            f.exact = !icase;
+            if(f.exact)
+              f.prefix.push_back(static_cast<charT>(nd.value));
+            break;
+          case n_any: case n_set:
+            f.min = f.max = 1;
+            f.exact = false;
+            break;
+          case n_backref:
+            f.max = npos;
+            f.exact = false;
+            break;
+          case n_group:
+            return analyze(nd.child);
+          case n_concat:
+            {
+              vector<charT> run;
+              uint32_t run_low = 0, run_high = 0;
+              bool in_run = false;
+              for(uint32_t c = nd.child; c != npos; c = nodes[c].next){
+                const facts g = analyze(c);
+                if(f.exact){
+                  f.prefix.insert(f.prefix.end(), g.prefix.begin(), g.prefix.end());
+                  f.exact = g.exact;
+                }
+                // the literal text runs across the exact children into the prefix of the next one
+                if(!in_run){
+                  run.clear();
+                  run_low = f.min, run_high = f.max;
+                }
+                const bool fits = run.size() + g.prefix.size() <= literal_max;
+                if(fits)
+                  run.insert(run.end(), g.prefix.begin(), g.prefix.end());
+                consider(f, run, run_low, run_high);
+                in_run = g.exact && fits;
+                consider(f, g.inner, add(f.min, g.low), add(f.max, g.high));
+                f.min = add(f.min, g.min);
+                f.max = add(f.max, g.max);
+              }
+              if(f.prefix.size() > literal_max){
+                f.prefix.resize(literal_max);
+                f.exact = false;
+              }
+            }
+            break;
+          case n_alt:
+            {
+              f = analyze(nd.child);
+              for(uint32_t c = nodes[nd.child].next; c != npos; c = nodes[c].next){
+                const facts g = analyze(c);
+                f.min = std::min(f.min, g.min);
+                f.max = std::max(f.max, g.max);
+                size_t common = 0;
+                while(common < f.prefix.size() && common < g.prefix.size() && f.prefix[common] == g.prefix[common])
+                  common++;
+                f.exact = f.exact && g.exact && common == f.prefix.size() && common == g.prefix.size();
+                f.prefix.resize(common);
+              }
+              f.inner.clear();
+              f.low = f.high = 0;
+              consider(f, f.prefix, 0, 0);
+            }
+            break;
+          case n_repeat:
+            {
+              const facts g = analyze(nd.child);
+              f.min = mul(g.min, nd.min);
+              f.max = nd.max == npos ? (g.max ? npos : 0) : mul(g.max, nd.max);
+              f.exact = g.exact && g.prefix.empty() && nd.min == nd.max;
+              if(nd.min){
+                // the first iteration
+                f.prefix = g.prefix;
+                f.inner = g.inner;
+                f.low = g.low, f.high = g.high;
+                if(g.exact && !g.prefix.empty()){
+                  for(uint32_t i = 1; i < nd.min && f.prefix.size() + g.prefix.size() <= literal_max; i++)
+                    f.prefix.insert(f.prefix.end(), g.prefix.begin(), g.prefix.end());
+                  f.exact = nd.min == nd.max && f.prefix.size() == mul(static_cast<uint32_t>(g.prefix.size()), nd.min);
+                }
+                consider(f, f.prefix, 0, 0);
+              }
+            }
+            break;
+          }
+          return f;
+        }
+
+        /** Adds the characters the nonempty matches of the node may start with, returns whether it matches empty */
+        bool starts(uint32_t n, uint32_t (&first)[8], bool& wide) const
+        {
+          const node& nd = nodes[n];
+          switch(nd.kind){
+          case n_char:
+            if(icase){
+              const uint32_t folded = prog.folded(static_cast<charT>(nd.value));
+              for(uint32_t c = 0; c < 256; c++)
+                if(prog.fold[c] == folded)
+                  first[c >> 5] |= 1u << (c & 31);
+              wide |= sizeof(charT) > 1;
+            }else if(nd.value < 256)
+              first[nd.value >> 5] |= 1u << (nd.value & 31);
+            else
+              wide = true;
+            return false;
+          case n_set:
+            for(uint32_t c = 0; c < 256; c++)
+              if(prog.sets[nd.value].test(static_cast<charT>(c), prog.tr))
+                first[c >> 5] |= 1u << (c & 31);
+            wide |= sizeof(charT) > 1;
+            return false;
+          case n_any: case n_backref:
+            for(uint32_t i = 0; i < 8; i++)
+              first[i] = ~0u;
+            wide = true;
+            return nd.kind == n_backref;
+          case n_group:
+            return starts(nd.child, first, wide);
+          case n_concat:
+            for(uint32_t c = nd.child; c != npos; c = nodes[c].next)
+              if(!starts(c, first, wide))
+                return false;
+            return true;
+          case n_alt:
+            {
+              bool empty = false;
+              for(uint32_t c = nd.child; c != npos; c = nodes[c].next)
+                empty |= starts(c, first, wide);
+              return empty;
+            }
+          case n_repeat:
+            return starts(nd.child, first, wide) || nd.min == 0;
+          }
+          return true;
+        }
+
+        /** Chooses the prefilter: the literal prefix, the literal at a bounded offset, else the first character set */
+        void prefilter(uint32_t root)
+        {
+          typename program_type::prefilter& filter = prog.filter;
+          const facts f = analyze(root);
+          if(f.min == 0)
+            return;
+          if(!f.prefix.empty()){
+            filter.mode = skip_prefix;
+            filter.literal = f.prefix;
+            return;
+          }
+          if(!f.inner.empty()){
+            // an unbounded one is still checked to be present
+            filter.literal = f.inner;
+            filter.low = f.low, filter.high = f.high;
+            if(f.high - f.low <= window_max){
+              filter.mode = skip_window;
+              return;
+            }
+          }
+          uint32_t first[8] = {};
+          bool wide = false;
+          if(starts(root, first, wide))
+            return;
+          uint32_t count = 0;
+          for(uint32_t c = 0; c < 256; c++)
+            count += (first[c >> 5] >> (c & 31)) & 1;
+          if(count > first_max)
+            return;
+          filter.mode = skip_first;
+          std::copy(first, first + 8, filter.first);
+          filter.wide = wide;
+        }
+        ///\}
+
+        static const charT alpha_name[5], alnum_name[5];
+      };
+
+      template<class charT, class traits>
+      const charT compiler<charT, traits>::alpha_name[5] = { 'a', 'l', 'p', 'h', 'a' };
+      template<class charT, class traits>
+      const charT compiler<charT, traits>::alnum_name[5] = { 'a', 'l', 'n', 'u', 'm' };
+
+      /** The matched text and the flags which tell what lies around it */
+      template<class It>
+      struct subject
+      {
+        It first, last;
+        bool prev_avail, begin_ok, end_ok, no_begin_boundary, no_end_boundary;
+
+        subject(It first, It last, match_type flags)
+          :first(first), last(last),
+          prev_avail((flags & regex_constants::match_prev_avail) != 0),
+          begin_ok(!prev_avail && !(flags & regex_constants::match_not_bol)),
+          end_ok(!(flags & regex_constants::match_not_eol)),
+          no_begin_boundary(!prev_avail && (flags & regex_constants::match_not_bow)),
+          no_end_boundary((flags & regex_constants::match_not_eow) != 0)
+        {}
+
+        template<class Program>
+        bool word_before(const Program& prog, It p) const
+        {
+          if(p == first && !prev_avail)
+            return false;
+          --p;
+          return prog.is_word(*p);
+        }
+
+        template<class Program>
+        bool holds(const Program& prog, uint8_t a, It p) const
+        {
+          if(a == assert_begin)
+            return p == first && begin_ok;
+          if(a == assert_end)
+            return p == last && end_ok;
+          bool boundary = word_before(prog, p) != (p != last && prog.is_word(*p));
+          if((p == first && no_begin_boundary) || (p == last && no_end_boundary))
+            boundary = false;
+          return boundary == (a == assert_word);
+        }
+      };
+
+      /** The surroundings of a DFA scan, in the scan direction */
+      struct scan_context
+      {
+        bool begin_ok, word_before, no_begin_boundary;
+        bool end_ok, word_after, no_end_boundary;
+      };
+
+      /** The surroundings of a forward scan of the text from \p p */
+      template<class Program, class It>
+      inline scan_context forward_context(const Program& prog, const subject<It>& text, It p)
+      {
+        const scan_context ctx = { p == text.first && text.begin_ok, text.word_before(prog, p), p == text.first && text.no_begin_boundary,
+                                   text.end_ok, false, text.no_end_boundary };
+        return ctx;
+      }
+
+      /**
+       *	Lazy DFA.
+       *
+       *  A state is the ordered list of the threads waiting for a character (the kernel) plus the facts about the
+       *  previous character the assertions need. A transition follows the empty paths of the kernel knowing the next
+       *  character, notes whether the match instruction was reached on the way, then steps the threads over the character.
+       *  In the leftmost-first mode the threads after the match are cut, as they could only give a less preferred match.
+       **/
+      template<class Program>
+      class dfa
+      {
+        typedef typename Program::char_type charT;
+        enum { at_begin = 1, after_word = 2, no_boundary = 4 };
+        static const uint32_t dead = 0x7FFFFFFE;   // 1 + (dead << 1 | 1) must not wrap to the unknown 0
+
+      public:
+        enum result { no_match, match, gave_up };
+
+        dfa(const Program& prog, const vector<instruction>& code, dfa_cache& cache, bool leftmost_first)
+          :prog(prog), code(code), cache(cache), cut(leftmost_first), scanned(), flush_scanned(), flushes(), flushed()
+        {
+          if(cache.marks.size() < code.size())
+            cache.marks.resize(code.size());
+        }
+
+        /**
+         *	Scans <tt>[p,last)</tt> from the \p start instruction. The match end goes to \p end: the last one found, or the
+         *  first one with \p earliest, or only the one at \p last when \p full.
+         **/
+        template<class It>
+        result run(It p, It last, uint32_t start, const scan_context& ctx, bool earliest, bool full, It& end)
+        {
+          const uint32_t stride = prog.class_count;
+          cache.kernel.assign(1, start);
+          uint32_t s = intern((ctx.begin_ok ? at_begin : 0) | (ctx.word_before && prog.word_assertions ? after_word : 0) | (ctx.no_begin_boundary ? no_boundary : 0));
+          if(s == npos)
+            return gave_up;
+          bool found = false;
+          for(; p != last; ++p, ++scanned){
+            const charT c = *p;
+            const uint32_t u = code_of(c);
+            uint32_t t = u < 256 ? cache.next[s * stride + prog.classes[u]] : 0;
+            if(!t && !(t = transition(s, c, u < 256 ? prog.classes[u] : npos)))
+              return gave_up;
+            --t;
+            if((t & 1) && !full){
+              found = true;
+              end = p;
+              if(earliest)
+                return match;
+            }
+            s = t >> 1;
+            if(s == dead)
+              return found ? match : no_match;
+          }
+          const typename dfa_cache::state& st = cache.states[s];
+          cache.kernel.assign(cache.threads.begin() + st.kernel, cache.threads.begin() + st.kernel + st.size);
+          if(closure(st.flags, ctx.word_after && prog.word_assertions, true, ctx.end_ok, ctx.no_end_boundary)){
+            found = true;
+            end = last;
+          }
+          return found ? match : no_match;
+        }
+
+        /** The characters scanned by all the runs */
+        size_t work() const { return scanned; }
+
+      private:
+        const Program& prog;
+        const vector<instruction>& code;
+        dfa_cache& cache;
+        const bool cut;
+        size_t scanned, flush_scanned, flushes;
+        bool flushed;
+
+        bool mark(uint32_t pc)
+        {
+          if(cache.marks[pc] == cache.epoch)
+            return false;
+          cache.marks[pc] = cache.epoch;
+          return true;
+        }
+
+        void next_epoch()
+        {
+          if(++cache.epoch == 0){
+            cache.marks.assign(cache.marks.size(), 0);
+            cache.epoch = 1;
+          }
+        }
+
+        static bool holds(uint8_t a, uint32_t flags, bool word, bool at_end, bool end_ok, bool no_end_boundary)
+        {
+          if(a == assert_begin)
+            return (flags & at_begin) != 0;
+          if(a == assert_end)
+            return at_end && end_ok;
+          bool boundary = ((flags & after_word) != 0) != word;
+          if((flags & no_boundary) || (at_end && no_end_boundary))
+            boundary = false;
+          return boundary == (a == assert_word);
+        }
+
+        /** Follows the empty paths of the kernel, puts the consuming threads to the list; true if the match is reached */
+        bool closure(uint32_t flags, bool word, bool at_end, bool end_ok, bool no_end_boundary)
+        {
+          vector<uint32_t>& stack = cache.stack;
+          bool matched = false;
+          cache.list.clear();
+          next_epoch();
+          for(size_t i = 0; i < cache.kernel.size(); i++){
+            stack.push_back(cache.kernel[i]);
+            while(!stack.empty()){
+              uint32_t pc = stack.back();
+              stack.pop_back();
+              while(mark(pc)){
+                const instruction& in = code[pc];
+                if(in.op == op_split){
+                  stack.push_back(in.y);
+                  pc = in.x;
+                }else if(in.op == op_jump)
+                  pc = in.x;
+                else if(in.op == op_save || in.op == op_clear)
+                  pc++;
+                else if(in.op == op_assert){
+                  if(!holds(in.arg, flags, word, at_end, end_ok, no_end_boundary))
+                    break;
+                  pc++;
+                }else if(in.op == op_fail)
+                  break;
+                else if(in.op == op_match){
+                  if(cut){
+                    stack.clear();
+                    return true;
+                  }
+                  matched = true;
+                  break;
+                }else{
+                  cache.list.push_back(pc);
+                  break;
+                }
+              }
+            }
+          }
+          return matched;
+        }
+
+        /** Computes the transition of the state \p s over \p c and caches it under the class \p cls */
+        uint32_t transition(uint32_t s, charT c, uint32_t cls)
+        {
+          const typename dfa_cache::state st = cache.states[s];
+          cache.kernel.assign(cache.threads.begin() + st.kernel, cache.threads.begin() + st.kernel + st.size);
+          const bool word = prog.word_assertions && prog.is_word(c);
+          const bool matched = closure(st.flags, word, false, false, false);
+
+          vector<uint32_t>& k = cache.kernel;
+          k.clear();
+          next_epoch();
+          for(size_t i = 0; i < cache.list.size(); i++){
+            const uint32_t pc = cache.list[i];
+            const uint32_t to = next_pc(code[pc], pc);
+            if(prog.test(code[pc], c) && mark(to))
+              k.push_back(to);
+          }
+          flushed = false;
+          uint32_t target = dead;
+          if(!k.empty() && (target = intern(word ? after_word : 0)) == npos)
+            return 0;
+          const uint32_t t = 1 + (target << 1 | matched);
+          if(cls != npos && !flushed)
+            cache.next[s * prog.class_count + cls] = t;
+          return t;
+        }
+
+        /** Finds or adds the state of the current kernel; npos when the cache thrashes */
+        uint32_t intern(uint32_t flags)
+        {
+          const vector<uint32_t>& k = cache.kernel;
+          uint32_t h = 2166136261u ^ flags;
+          for(size_t i = 0; i < k.size(); i++)
+            h = (h ^ k[i]) * 16777619u;
+          if(!cache.index.empty()){
+            const size_t mask = cache.index.size() - 1;
+            for(size_t i = h & mask; cache.index[i]; i = (i + 1) & mask){
+              const typename dfa_cache::state& st = cache.states[cache.index[i] - 1];
+              if(st.hash == h && st.flags == flags && st.size == k.size() && std::equal(k.begin(), k.end(), cache.threads.begin() + st.kernel))
+                return cache.index[i] - 1;
+            }
+          }
+
+          const size_t cost = sizeof(dfa_cache::state) + (k.size() + prog.class_count + 2) * sizeof(uint32_t);
+          if(cache.memory + cost > STLX__REGEX_DFA_CACHE){
+            // flush, unless the states built since the last flush were barely used
+            if(cost > STLX__REGEX_DFA_CACHE / 4 || (flushes && scanned - flush_scanned < 10 * cache.states.size()))
+              return npos;
+            cache.clear();
+            flush_scanned = scanned;
+            flushes++;
+            flushed = true;
+          }
+          cache.memory += cost;
+
+          const typename dfa_cache::state st = { static_cast<uint32_t>(cache.threads.size()), static_cast<uint32_t>(k.size()), flags, h };
+          cache.threads.insert(cache.threads.end(), k.begin(), k.end());
+          cache.states.push_back(st);
+          cache.next.resize(cache.states.size() * prog.class_count);
+          const uint32_t n = static_cast<uint32_t>(cache.states.size());
+          if(2 * n > cache.index.size())
+            rehash(cache.index.empty() ? 64 : 2 * cache.index.size());
+          else
+            insert(n);
+          return n - 1;
+        }
+
+        void insert(uint32_t n)
+        {
+          const size_t mask = cache.index.size() - 1;
+          size_t i = cache.states[n - 1].hash & mask;
+          while(cache.index[i])
+            i = (i + 1) & mask;
+          cache.index[i] = n;
+        }
+
+        void rehash(size_t size)
+        {
+          cache.index.assign(size, 0);
+          for(uint32_t n = 1; n <= cache.states.size(); n++)
+            insert(n);
+        }
+      };
+
+      /**
+       *	Backtracking matcher.
+       *
+       *  With the visited bitmap (a bit per instruction and position) it explores no thread twice, which is linear in the span
+       *  and gives the leftmost-first captures. The patterns with backreferences can't use it since the captures matter then;
+       *  their steps are counted against the budget instead.
+       **/
+      template<class Program, class It>
+      class backtracker
+      {
+        struct job
+        {
+          uint32_t pc, slot;
+          size_t offset;
+          It p;
+        };
+
+      public:
+        vector<size_t> slots;
+
+        backtracker(const Program& prog, const subject<It>& text, size_t budget)
+          :prog(prog), text(text), budget(budget), steps()
+        {}
+
+        /**
+         *	Matches at \p start (the offset \p origin) consuming no further than \p limit, \p span characters away.
+         *  Without the budget the visited bitmap is used. The match must end at \p required unless it is \c unset.
+         **/
+        bool run(It start, size_t origin, It limit, size_t span, size_t required, bool not_null)
+        {
+          const size_t captures = 2 * (prog.marks + 1);
+          slots.assign(captures, unset);
+          if(!budget)
+            visited.assign((prog.code.size() * (span + 1) + 31) / 32, 0);
+          jobs.clear();
+          push(0, unset, origin, start);
+          while(!jobs.empty()){
+            const job j = jobs.back();
+            jobs.pop_back();
+            if(j.pc == npos){
+              slots[j.slot] = j.offset;
+              continue;
+            }
+            uint32_t pc = j.pc;
+            size_t off = j.offset;
+            It p = j.p;
+            for(;;){
+              if(!budget){
+                const size_t bit = pc * (span + 1) + (off - origin);
+                if(visited[bit >> 5] & (1u << (bit & 31)))
+                  break;
+                visited[bit >> 5] |= 1u << (bit & 31);
+              }else if(++steps > budget)
+                error(regex_constants::error_complexity);
+
+              const instruction& in = prog.code[pc];
+              switch(in.op){
+              case op_char: case op_any: case op_set:
+                if(p == limit || !prog.test(in, *p))
+                  break;
+                ++p, ++off;
+                pc = next_pc(in, pc);
+                continue;
+              case op_split:
+                push(in.y, unset, off, p);
+                pc = in.x;
+                continue;
+              case op_jump:
+                pc = in.x;
+                continue;
+              case op_save:
+                save(in.x, off);
+                pc++;
+                continue;
+              case op_clear:
+                for(uint32_t slot = in.x; slot < in.y; slot++)
+                  if(slots[slot] != unset)
+                    save(slot, unset);
+                pc++;
+                continue;
+              case op_assert:
+                if(!text.holds(prog, in.arg, p))
+                  break;
+                pc++;
+                continue;
+              case op_backref:
+                {
+                  const size_t before = off;
+                  if(!backref(in, p, off, limit))
+                    break;
+                  pc = off != before ? next_pc(in, pc) : pc + 1;
+                }
+                continue;
+              case op_fail:
+                break;
+              case op_match:
+                if((required != unset && off != required) || (not_null && off == slots[0]))
+                  break;
+                return true;
+              }
+              break;
+            }
+          }
+          return false;
+        }
+
+      private:
+        const Program& prog;
+        const subject<It>& text;
+        vector<job> jobs;
+        vector<uint32_t> visited;
+        const size_t budget;
+        size_t steps;
+
+        void push(uint32_t pc, uint32_t slot, size_t offset, It p)
+        {
+          const job j = { pc, slot, offset, p };
+          jobs.push_back(j);
+        }
+
+        void save(uint32_t slot, size_t off)
+        {
+          push(npos, slot, slots[slot], text.first);
+          slots[slot] = off;
+        }
+
+        bool backref(const instruction& in, It& p, size_t& off, It limit)
+        {
+          const size_t b = slots[2 * in.x], e = slots[2 * in.x + 1];
+          if(b == unset || e == unset)
+            return true;
+          It q = text.first;
+          std::advance(q, b);
+          for(size_t n = e - b; n; n--, ++q, ++p, ++off){
+            if(p == limit)
+              return false;
+            if(in.arg ? prog.folded(*q) != prog.folded(*p) : !(*q == *p))
+              return false;
+          }
+          return true;
+        }
+      };
+
+      /**
+       *	Pike VM: the NFA simulation which carries the captures of every thread, linear in the input for any pattern
+       *  without backreferences. The fallback when the DFA thrashes or the capture span is too long to backtrack.
+       **/
+      template<class Program, class It>
+      class pike_vm
+      {
+        struct thread_list
+        {
+          vector<uint32_t> dense, sparse;
+          vector<size_t> slots;
+          uint32_t size;
+
+          bool insert(uint32_t pc)
+          {
+            const uint32_t i = sparse[pc];
+            if(i < size && dense[i] == pc)
+              return false;
+            sparse[pc] = size;
+            dense[size++] = pc;
+            return true;
+          }
+        };
+        struct entry
+        {
+          uint32_t pc, slot;
+          size_t value;
+        };
+
+      public:
+        vector<size_t> slots;
+
+        pike_vm(const Program& prog, const subject<It>& text, size_t nslots)
+          :prog(prog), text(text), nslots(nslots)
+        {
+          const size_t n = prog.code.size();
+          for(unsigned i = 0; i < 2; i++){
+            lists[i].dense.resize(n);
+            lists[i].sparse.resize(n);
+            lists[i].slots.resize(n * nslots);
+            lists[i].size = 0;
+          }
+        }
+
+        /** Finds the leftmost-first match starting at \p start (or only there when \p anchored), see backtracker::run() */
+        bool run(It start, size_t origin, It limit, bool anchored, size_t required, bool not_null)
+        {
+          thread_list *c = &lists[0], *n = &lists[1];
+          c->size = 0;
+          bool matched = false;
+          It p = start;
+          for(size_t off = origin;; ++off){
+            if(!matched && (!anchored || off == origin)){
+              temp.assign(nslots, unset);
+              add(*c, 0, p, off);
+            }
+            if(!c->size && (matched || anchored))
+              break;
+            const bool at_end = p == limit;
+            It q = p;
+            n->size = 0;
+            if(!at_end)
+              ++q;
+            for(uint32_t i = 0; i < c->size; i++){
+              const uint32_t pc = c->dense[i];
+              const instruction& in = prog.code[pc];
+              const size_t* const ts = &c->slots[pc * nslots];
+              if(in.op == op_match){
+                if((required != unset && off != required) || (not_null && off == ts[0]))
+                  continue;
+                slots.assign(ts, ts + nslots);
+                matched = true;
+                break;
+              }
+              if(!at_end && prog.test(in, *p)){
+                temp.assign(ts, ts + nslots);
+                add(*n, next_pc(in, pc), q, off + 1);
+              }
+            }
+            if(at_end)
+              break;
+            std::swap(c, n);
+            p = q;
+          }
+          return matched;
+        }
+
+      private:
+        const Program& prog;
+        const subject<It>& text;
+        const size_t nslots;
+        thread_list lists[2];
+        vector<size_t> temp;
+        vector<entry> stack;
+
+        /** Adds the thread at \p pc with the captures in \p temp and everything reachable from it by the empty paths */
+        void add(thread_list& l, uint32_t pc0, It p, size_t off)
+        {
+          const entry first = { pc0, npos, 0 };
+          stack.push_back(first);
+          while(!stack.empty()){
+            const entry e = stack.back();
+            stack.pop_back();
+            if(e.pc == npos){
+              temp[e.slot] = e.value;
+              continue;
+            }
+            for(uint32_t pc = e.pc; l.insert(pc); ){
+              const instruction& in = prog.code[pc];
+              if(in.op == op_split){
+                const entry alt = { in.y, 0, 0 };
+                stack.push_back(alt);
+                pc = in.x;
+              }else if(in.op == op_jump)
+                pc = in.x;
+              else if(in.op == op_save){
+                if(in.x < nslots){
+                  const entry restore = { npos, in.x, temp[in.x] };
+                  stack.push_back(restore);
+                  temp[in.x] = off;
+                }
+                pc++;
+              }else if(in.op == op_clear){
+                for(uint32_t slot = in.x; slot < in.y && slot < nslots; slot++){
+                  const entry restore = { npos, slot, temp[slot] };
+                  stack.push_back(restore);
+                  temp[slot] = unset;
+                }
+                pc++;
+              }else if(in.op == op_assert){
+                if(!text.holds(prog, in.arg, p))
+                  break;
+                pc++;
+              }else if(in.op == op_fail)
+                break;
+              else{
+                std::copy(temp.begin(), temp.end(), l.slots.begin() + pc * nslots);
+                break;
+              }
+            }
+          }
+        }
+      };
+
+      /** Borrows the shared DFA cache of the program or, while another thread holds it, a private one */
+      template<class Program>
+      class cache_lease
+      {
+      public:
+        cache_lease(const Program& prog, cache_kind kind)
+          :prog(prog), kind(kind), owned(!prog.busy[kind].test_and_set(memory_order_acquire))
+        {}
+        ~cache_lease()
+        {
+          if(owned)
+            prog.busy[kind].clear(memory_order_release);
+        }
+        dfa_cache& get() { return owned ? prog.caches[kind] : local; }
+      private:
+        const Program& prog;
+        const cache_kind kind;
+        const bool owned;
+        dfa_cache local;
+        cache_lease(const cache_lease&);
+        cache_lease& operator=(const cache_lease&);
+      };
+
+      /** Walks the positions a match may start at by the prefilter of the program */
+      template<class Program, class It>
+      class candidates
+      {
+        typedef typename Program::char_type charT;
+      public:
+        candidates(const Program& prog, It last, size_t length)
+          :prog(prog), filter(prog.filter), last(last), length(length), found(unset)
+        {}
+
+        /** Does the filter tell the candidates or is every position one */
+        bool skips() const { return filter.mode != skip_none; }
+
+        /** Can a match start at or after \p p (at the offset \p off): the literal every match holds is there */
+        bool possible(It p, size_t off) const
+        {
+          if(filter.literal.empty() || filter.mode == skip_prefix || filter.mode == skip_window)
+            return true;
+          if(length - off < filter.low + filter.literal.size())
+            return false;
+          std::advance(p, filter.low);
+          return find(p) != last;
+        }
+
+        /** The first candidate at or after \p p, at the offset \p off which is updated, or \c last when none is left */
+        It next(It p, size_t& off)
+        {
+          switch(filter.mode){
+          case skip_prefix:
+            {
+              const It q = find(p);
+              off += static_cast<size_t>(std::distance(p, q));
+              return q;
+            }
+          case skip_window:
+            // the literal found first at or after p + low gives the earliest start
+            if(found == unset || found < off + filter.low){
+              if(length - off < filter.low + filter.literal.size())
+                return end(off);
+              It s = p;
+              std::advance(s, filter.low);
+              const It q = find(s);
+              if(q == last)
+                return end(off);
+              found = off + filter.low + static_cast<size_t>(std::distance(s, q));
+            }
+            if(found > off + filter.high){
+              std::advance(p, found - filter.high - off);
+              off = found - filter.high;
+            }
+            return p;
+          case skip_first:
+            for(; p != last && !prog.may_start(*p); ++p)
+              ++off;
+            return p;
+          }
+          return p;
+        }
+
+      private:
+        const Program& prog;
+        const typename Program::prefilter& filter;
+        const It last;
+        const size_t length;
+        size_t found;         ///< the offset of the literal in the window mode
+
+        It find(It p) const
+        {
+          const charT* const literal = &filter.literal[0];
+          return std::search(p, last, literal, literal + filter.literal.size());
+        }
+
+        It end(size_t& off) const
+        {
+          off = length;
+          return last;
+        }
+      };
+
+      /**
+       *	Finds the leftmost-first match of \p prog in <tt>[first,last)</tt>, or a match of the whole range with \p full.
+       *  The capture offsets from \p first go to \p slots unless it is null.
+       **/
+      template<class Program, class It>
+      bool execute(const Program& prog, It first, It last, match_type flags, bool full, vector<size_t>* slots)
+      {
+        typedef dfa<Program> dfa_type;
+        const subject<It> text(first, last, flags);
+        const bool not_null = (flags & regex_constants::match_not_null) != 0;
+        const bool anchored = full || (flags & regex_constants::match_continuous) || prog.anchored;
+        const size_t length = static_cast<size_t>(std::distance(first, last));
+
+        // no match starts before the first candidate of the prefilter, which never matches empty
+        candidates<Program, It> filter(prog, last, length);
+        const bool skip = !anchored && filter.skips();
+        It from = first;
+        size_t origin = 0;
+        if(!anchored && !filter.possible(first, 0))
+          return false;
+        if(skip && (from = filter.next(first, origin)) == last)
+          return false;
+
+        if(prog.backrefs){
+          backtracker<Program, It> bt(prog, text, STLX__REGEX_BACKREF_BASE + STLX__REGEX_BACKREF_STEPS * prog.code.size() * (length + 1));
+          for(It p = from; ; ){
+            if(bt.run(p, origin, last, length - origin, full ? length : unset, not_null)){
+              if(slots)
+                slots->swap(bt.slots);
+              return true;
+            }
+            if(anchored || p == last)
+              return false;
+            ++p, ++origin;
+            if(skip && (p = filter.next(p, origin)) == last)
+              return false;
+          }
+        }
+
+        if(!not_null){
+          cache_lease<Program> lease(prog, full ? cache_full : cache_forward);
+          dfa_type forward(prog, prog.code, lease.get(), !full);
+          It end;
+          typename dfa_type::result r;
+          bool at_candidate = false;
+          if(skip){
+            // try the candidates anchored while that costs little, then scan the rest unanchored
+            const size_t budget = STLX__REGEX_PREFILTER_WORK * (length - origin + 64);
+            for(size_t tries = 1; ; tries++){
+              r = forward.run(from, last, 0, forward_context(prog, text, from), !slots, false, end);
+              if(r != dfa_type::no_match){
+                at_candidate = r == dfa_type::match;
+                break;
+              }
+              ++from, ++origin;
+              if((from = filter.next(from, origin)) == last)
+                return false;
+              if(forward.work() + 16 * tries > budget){
+                r = forward.run(from, last, prog.search_start, forward_context(prog, text, from), !slots, false, end);
+                break;
+              }
+            }
+          }else
+            r = forward.run(from, last, anchored ? 0 : prog.search_start, forward_context(prog, text, from), !slots, full, end);
+          if(r == dfa_type::no_match)
+            return false;
+          if(r == dfa_type::match && !slots)
+            return true;
+          if(r == dfa_type::match){
+            It start = from;
+            bool located = true;
+            if(!anchored && !at_candidate){
+              // run the reversed pattern back from the end, the longest match gives the start
+              cache_lease<Program> back(prog, cache_reverse);
+              dfa_type reverse(prog, prog.reverse, back.get(), false);
+              const scan_context rctx = { end == last && text.end_ok, end != last && prog.is_word(*end), end == last && text.no_end_boundary,
+                                          from == first && text.begin_ok, text.word_before(prog, from), from == first && text.no_begin_boundary };
+              std::reverse_iterator<It> rstart;
+              located = reverse.run(std::reverse_iterator<It>(end), std::reverse_iterator<It>(from), 0, rctx, false, false, rstart) == dfa_type::match;
+              if(located)
+                start = rstart.base();
+            }
+            if(located && prog.longest && !full){
+              cache_lease<Program> extension(prog, cache_longest);
+              dfa_type extend(prog, prog.code, extension.get(), false);
+              located = extend.run(start, last, 0, forward_context(prog, text, start), false, false, end) == dfa_type::match;
+            }
+            if(located){
+              const size_t s = origin + static_cast<size_t>(std::distance(from, start)), e = s + static_cast<size_t>(std::distance(start, end));
+              if(prog.marks == 0){
+                slots->resize(2);
+                (*slots)[0] = s, (*slots)[1] = e;
+                return true;
+              }
+              // resolve the groups on the span only
+              if(prog.code.size() * (e - s + 1) <= STLX__REGEX_BACKTRACK_BITS){
+                backtracker<Program, It> bt(prog, text, 0);
+                if(bt.run(start, s, end, e - s, e, false)){
+                  slots->swap(bt.slots);
+                  return true;
+                }
+              }else{
+                pike_vm<Program, It> vm(prog, text, 2 * (prog.marks + 1));
+                if(vm.run(start, s, end, true, e, false)){
+                  slots->swap(vm.slots);
+                  return true;
+                }
+              }
+            }
+          }
+        }
+
+        pike_vm<Program, It> vm(prog, text, slots ? 2 * (prog.marks + 1) : 2);
+        if(!vm.run(from, origin, last, anchored, full ? length : unset, not_null))
+          return false;
+        if(slots)
+          slots->swap(vm.slots);
+        return true;
+      }
+
+    } // re
+  } // __
+} // std
+
+#endif // NTL__EXT_REGEX_ENGINE
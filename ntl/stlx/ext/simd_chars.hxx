@@ -0,0 +1,442 @@
+/**\file*********************************************************************
+ *                                                                     \brief
+ *  Vectorized character sequence primitives for char_traits
+ *
+ ****************************************************************************
+ */
+#ifndef NTL__EXT_SIMD_CHARS
+#define NTL__EXT_SIMD_CHARS
+#pragma once
+
+#include "../../cpu.hxx"
+#include "../../stdlib.hxx"
+
+namespace std
+{
+  namespace ext
+  {
+    /**
+     *	@brief Vectorized character sequence primitives
+     *
+     *  find(), compare(), length() and search() work on the 1, 2 and 4 byte characters. The SSE2 versions are used
+     *  when the target has SSE2, the AVX2 versions are selected at run time by ntl::cpu::has().
+     *
+     *  find() and compare() never read outside of the given range: the last partial block is handled
+     *  by the block overlapping the already checked characters. length() reads only the aligned blocks,
+     *  which never cross a page boundary and so never fault past the terminating zero.
+     **/
+    namespace simd
+    {
+      namespace __
+      {
+        /** Scalar versions, also used for the short sequences */
+        template<typename charT>
+        inline const charT* find_scalar(const charT* s, size_t n, charT c)
+        {
+          for(; n; --n, ++s)
+            if(*s == c)
+              return s;
+          return nullptr;
+        }
+
+        template<typename charT>
+        inline size_t length_scalar(const charT* s)
+        {
+          const charT* p = s;
+          while(*p)
+            ++p;
+          return static_cast<size_t>(p - s);
+        }
+
+        /** Compares the mismatched characters: \c char as unsigned (as memcmp does), the others by value */
+        template<typename charT>
+        inline int order(charT a, charT b)
+        {
+          return a < b ? -1 : 1;
+        }
+
+        inline int order(char a, char b)
+        {
+          return static_cast<unsigned char>(a) < static_cast<unsigned char>(b) ? -1 : 1;
+        }
+
+        template<typename charT>
+        inline int compare_scalar(const charT* s1, const charT* s2, size_t n)
+        {
+          for(; n; --n, ++s1, ++s2)
+            if(*s1 != *s2)
+              return order(*s1, *s2);
+          return 0;
+        }
+
+        template<typename charT>
+        inline bool equal(const charT* s1, const charT* s2, size_t n)
+        {
+          for(; n; --n, ++s1, ++s2)
+            if(*s1 != *s2)
+              return false;
+          return true;
+        }
+
+        /** Returns the position preceding the maximal suffix of \p x and its period, by the character order or by the reverse one */
+        template<typename charT>
+        inline size_t maximal_suffix(const charT* x, size_t m, bool reversed, size_t& period)
+        {
+          size_t ms = size_t(-1), j = 0, k = 1, p = 1;
+          while(j + k < m){
+            const charT a = x[j + k], b = x[ms + k];
+            if(reversed ? b < a : a < b){
+              j += k;
+              k = 1;
+              p = j - ms;
+            }else if(a == b){
+              if(k != p)
+                ++k;
+              else
+                j += p, k = 1;
+            }else{
+              ms = j++;
+              k = p = 1;
+            }
+          }
+          period = p;
+          return ms;
+        }
+
+        /**
+         *	Two-Way string matching (Crochemore & Perrin): linear time and constant space.
+         *  The needle is split at the critical position; the right part is matched first, then the left one.
+         **/
+        template<typename charT>
+        inline const charT* two_way(const charT* s, size_t n, const charT* x, size_t m)
+        {
+          size_t period, rperiod;
+          size_t suffix = maximal_suffix(x, m, false, period) + 1;
+          const size_t rsuffix = maximal_suffix(x, m, true, rperiod) + 1;
+          if(suffix < rsuffix)
+            suffix = rsuffix, period = rperiod;
+
+          const size_t last = n - m;
+          if(equal(x, x + period, suffix)){
+            // periodic needle: the matched prefix of the period is remembered after a shift
+            size_t memory = 0;
+            for(size_t j = 0; j <= last; ){
+              size_t i = suffix > memory ? suffix : memory;
+              while(i < m && x[i] == s[i + j])
+                ++i;
+              if(i < m){
+                j += i - suffix + 1;
+                memory = 0;
+                continue;
+              }
+              i = suffix;
+              while(i > memory && x[i - 1] == s[i - 1 + j])
+                --i;
+              if(i <= memory)
+                return s + j;
+              j += period;
+              memory = m - period;
+            }
+          }else{
+            period = (suffix > m - suffix ? suffix : m - suffix) + 1;
+            for(size_t j = 0; j <= last; ){
+              size_t i = suffix;
+              while(i < m && x[i] == s[i + j])
+                ++i;
+              if(i < m){
+                j += i - suffix + 1;
+                continue;
+              }
+              i = suffix;
+              while(i && x[i - 1] == s[i - 1 + j])
+                --i;
+              if(!i)
+                return s + j;
+              j += period;
+            }
+          }
+          return nullptr;
+        }
+
+#ifdef NTL_CPU_SSE2
+        /** Lane operations by the character size */
+        template<size_t Size> struct lane;
+
+        template<> struct lane<1>
+        {
+          static __m128i set1(uint32_t c) { return ntl::intrinsic::_mm_set1_epi8(static_cast<char>(c)); }
+          static __m128i cmpeq(__m128i a, __m128i b) { return ntl::intrinsic::_mm_cmpeq_epi8(a, b); }
+#ifdef NTL_CPU_AVX2
+          NTL_CPU_TARGET("avx2") static __m256i set1x(uint32_t c) { return ntl::intrinsic::_mm256_set1_epi8(static_cast<char>(c)); }
+          NTL_CPU_TARGET("avx2") static __m256i cmpeqx(__m256i a, __m256i b) { return ntl::intrinsic::_mm256_cmpeq_epi8(a, b); }
+#endif
+        };
+
+        template<> struct lane<2>
+        {
+          static __m128i set1(uint32_t c) { return ntl::intrinsic::_mm_set1_epi16(static_cast<short>(c)); }
+          static __m128i cmpeq(__m128i a, __m128i b) { return ntl::intrinsic::_mm_cmpeq_epi16(a, b); }
+#ifdef NTL_CPU_AVX2
+          NTL_CPU_TARGET("avx2") static __m256i set1x(uint32_t c) { return ntl::intrinsic::_mm256_set1_epi16(static_cast<short>(c)); }
+          NTL_CPU_TARGET("avx2") static __m256i cmpeqx(__m256i a, __m256i b) { return ntl::intrinsic::_mm256_cmpeq_epi16(a, b); }
+#endif
+        };
+
+        template<> struct lane<4>
+        {
+          static __m128i set1(uint32_t c) { return ntl::intrinsic::_mm_set1_epi32(static_cast<int>(c)); }
+          static __m128i cmpeq(__m128i a, __m128i b) { return ntl::intrinsic::_mm_cmpeq_epi32(a, b); }
+#ifdef NTL_CPU_AVX2
+          NTL_CPU_TARGET("avx2") static __m256i set1x(uint32_t c) { return ntl::intrinsic::_mm256_set1_epi32(static_cast<int>(c)); }
+          NTL_CPU_TARGET("avx2") static __m256i cmpeqx(__m256i a, __m256i b) { return ntl::intrinsic::_mm256_cmpeq_epi32(a, b); }
+#endif
+        };
+
+        /** Bitmask of the matched bytes, each character sets sizeof(charT) bits */
+        template<typename charT>
+        inline uint32_t match16(const charT* p, __m128i v)
+        {
+          using namespace ntl::intrinsic;
+          return static_cast<uint32_t>(_mm_movemask_epi8(lane<sizeof(charT)>::cmpeq(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p)), v)));
+        }
+
+        template<typename charT>
+        inline const charT* find_sse2(const charT* s, size_t n, charT c)
+        {
+          static const size_t block = 16 / sizeof(charT);
+          if(n < block)
+            return find_scalar(s, n, c);
+
+          const __m128i v = lane<sizeof(charT)>::set1(static_cast<uint32_t>(c));
+          const charT* const last = s + (n - block);
+          for(;;){
+            if(s > last)
+              s = last;   // the tail overlaps the checked characters
+            if(const uint32_t mask = match16(s, v))
+              return s + ntl::bsf(mask) / sizeof(charT);
+            if(s == last)
+              return nullptr;
+            s += block;
+          }
+        }
+
+        template<typename charT>
+        inline int compare_sse2(const charT* s1, const charT* s2, size_t n)
+        {
+          using namespace ntl::intrinsic;
+          static const size_t block = 16 / sizeof(charT);
+          if(n < block)
+            return compare_scalar(s1, s2, n);
+
+          const size_t last = n - block;
+          for(size_t i = 0;; i += block){
+            if(i > last)
+              i = last;
+            const __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(s1 + i)),
+                          b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(s2 + i));
+            if(const uint32_t mask = static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(a, b))) ^ 0xFFFF){
+              const size_t at = i + ntl::bsf(mask) / sizeof(charT);
+              return order(s1[at], s2[at]);
+            }
+            if(i == last)
+              return 0;
+          }
+        }
+
+        template<typename charT>
+        inline size_t length_sse2(const charT* s)
+        {
+          using namespace ntl::intrinsic;
+          if(reinterpret_cast<uintptr_t>(s) % sizeof(charT))
+            return length_scalar(s);
+
+          // the aligned block never crosses a page; the bytes before s are masked off
+          const uintptr_t skip = reinterpret_cast<uintptr_t>(s) & 15;
+          const char* p = reinterpret_cast<const char*>(s) - skip;
+          const __m128i zero = _mm_setzero_si128();
+          uint32_t mask = static_cast<uint32_t>(_mm_movemask_epi8(lane<sizeof(charT)>::cmpeq(_mm_load_si128(reinterpret_cast<const __m128i*>(p)), zero))) >> skip;
+          if(mask)
+            return ntl::bsf(mask) / sizeof(charT);
+          for(;;){
+            p += 16;
+            mask = static_cast<uint32_t>(_mm_movemask_epi8(lane<sizeof(charT)>::cmpeq(_mm_load_si128(reinterpret_cast<const __m128i*>(p)), zero)));
+            if(mask)
+              return (static_cast<size_t>(p - reinterpret_cast<const char*>(s)) + ntl::bsf(mask)) / sizeof(charT);
+          }
+        }
+
+        /** The needles up to this length are searched by the first and the last character filter */
+        static const size_t filter_needle_max = 32;
+
+        /**
+         *	Compares the first and the last needle characters at the 16 byte block of the positions at once,
+         *  only the positions where both match are verified. \p m is at least 2, \p n is at least \p m.
+         **/
+        template<typename charT>
+        inline const charT* search_sse2(const charT* s, size_t n, const charT* x, size_t m)
+        {
+          static const size_t block = 16 / sizeof(charT);
+          const __m128i first = lane<sizeof(charT)>::set1(static_cast<uint32_t>(x[0])),
+                        last  = lane<sizeof(charT)>::set1(static_cast<uint32_t>(x[m - 1]));
+          size_t i = 0;
+          for(; i + m - 1 + block <= n; i += block){
+            uint32_t mask = match16(s + i, first) & match16(s + i + m - 1, last);
+            while(mask){
+              const unsigned bit = ntl::bsf(mask);
+              const size_t at = i + bit / sizeof(charT);
+              if(equal(s + at + 1, x + 1, m - 2))
+                return s + at;
+              mask &= ~(((1u << sizeof(charT)) - 1) << bit);
+            }
+          }
+          for(; i + m <= n; ++i)
+            if(s[i] == x[0] && s[i + m - 1] == x[m - 1] && equal(s + i + 1, x + 1, m - 2))
+              return s + i;
+          return nullptr;
+        }
+
+#ifdef NTL_CPU_AVX2
+        template<typename charT>
+        NTL_CPU_TARGET("avx2") inline uint32_t match32(const charT* p, __m256i v)
+        {
+          using namespace ntl::intrinsic;
+          return static_cast<uint32_t>(_mm256_movemask_epi8(lane<sizeof(charT)>::cmpeqx(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(p)), v)));
+        }
+
+        /** Checks the whole 32 byte blocks, returns the index of the first match or the number of characters checked */
+        template<typename charT>
+        NTL_CPU_TARGET("avx2") inline size_t find_avx2(const charT* s, size_t n, charT c)
+        {
+          static const size_t block = 32 / sizeof(charT);
+          const __m256i v = lane<sizeof(charT)>::set1x(static_cast<uint32_t>(c));
+          size_t i = 0;
+          for(; i + block <= n; i += block){
+            if(const uint32_t mask = match32(s + i, v)){
+              i += ntl::bsf(mask) / sizeof(charT);
+              break;
+            }
+          }
+          ntl::intrinsic::_mm256_zeroupper();
+          return i;
+        }
+
+        /** Compares the whole 32 byte blocks, returns the index of the first mismatch or the number of characters compared */
+        template<typename charT>
+        NTL_CPU_TARGET("avx2") inline size_t mismatch_avx2(const charT* s1, const charT* s2, size_t n)
+        {
+          using namespace ntl::intrinsic;
+          static const size_t block = 32 / sizeof(charT);
+          size_t i = 0;
+          for(; i + block <= n; i += block){
+            const __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(s1 + i)),
+                          b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(s2 + i));
+            if(const uint32_t mask = ~static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(a, b)))){
+              i += ntl::bsf(mask) / sizeof(charT);
+              break;
+            }
+          }
+          _mm256_zeroupper();
+          return i;
+        }
+
+        template<typename charT>
+        NTL_CPU_TARGET("avx2") inline size_t length_avx2(const charT* s)
+        {
+          using namespace ntl::intrinsic;
+          const uintptr_t skip = reinterpret_cast<uintptr_t>(s) & 31;
+          const char* p = reinterpret_cast<const char*>(s) - skip;
+          const __m256i zero = lane<sizeof(charT)>::set1x(0);
+          uint32_t mask = static_cast<uint32_t>(_mm256_movemask_epi8(lane<sizeof(charT)>::cmpeqx(_mm256_load_si256(reinterpret_cast<const __m256i*>(p)), zero))) >> skip;
+          if(mask){
+            _mm256_zeroupper();
+            return ntl::bsf(mask) / sizeof(charT);
+          }
+          do{
+            p += 32;
+            mask = static_cast<uint32_t>(_mm256_movemask_epi8(lane<sizeof(charT)>::cmpeqx(_mm256_load_si256(reinterpret_cast<const __m256i*>(p)), zero)));
+          }while(!mask);
+          _mm256_zeroupper();
+          return (static_cast<size_t>(p - reinterpret_cast<const char*>(s)) + ntl::bsf(mask)) / sizeof(charT);
+        }
+#endif // NTL_CPU_AVX2
+#endif // NTL_CPU_SSE2
+      } // __
+
+      /** Returns a pointer to the first \p c within [s, s + n) or \c nullptr */
+      template<typename charT>
+      inline const charT* find(const charT* s, size_t n, charT c)
+      {
+#ifdef NTL_CPU_SSE2
+# ifdef NTL_CPU_AVX2
+        if(n >= 32 / sizeof(charT) && ntl::cpu::has(ntl::cpu::avx2)){
+          const size_t i = __::find_avx2(s, n, c);
+          if(i < n && s[i] == c)
+            return s + i;
+          s += i, n -= i;
+        }
+# endif
+        return __::find_sse2(s, n, c);
+#else
+        return __::find_scalar(s, n, c);
+#endif
+      }
+
+      /** Lexicographically compares \p n characters, \c char is compared as unsigned */
+      template<typename charT>
+      inline int compare(const charT* s1, const charT* s2, size_t n)
+      {
+#ifdef NTL_CPU_SSE2
+# ifdef NTL_CPU_AVX2
+        if(n >= 32 / sizeof(charT) && ntl::cpu::has(ntl::cpu::avx2)){
+          const size_t i = __::mismatch_avx2(s1, s2, n);
+          if(i < n && s1[i] != s2[i])
+            return __::order(s1[i], s2[i]);
+          s1 += i, s2 += i, n -= i;
+        }
+# endif
+        return __::compare_sse2(s1, s2, n);
+#else
+        return __::compare_scalar(s1, s2, n);
+#endif
+      }
+
+      /** Returns the number of characters before the terminating zero */
+      template<typename charT>
+      inline size_t length(const charT* s)
+      {
+#ifdef NTL_CPU_SSE2
+# ifdef NTL_CPU_AVX2
+        if(reinterpret_cast<uintptr_t>(s) % sizeof(charT) == 0 && ntl::cpu::has(ntl::cpu::avx2))
+          return __::length_avx2(s);
+# endif
+        return __::length_sse2(s);
+#else
+        return __::length_scalar(s);
+#endif
+      }
+
+      /**
+       *	Returns a pointer to the first occurrence of [x, x + m) within [s, s + n) or \c nullptr.
+       *  The short needles are found by the vectorized first and last character filter,
+       *  the longer ones by the Two-Way algorithm, which has no quadratic worst case.
+       **/
+      template<typename charT>
+      inline const charT* search(const charT* s, size_t n, const charT* x, size_t m)
+      {
+        if(m == 0)
+          return s;
+        if(n < m)
+          return nullptr;
+        if(m == 1)
+          return find(s, n, x[0]);
+#ifdef NTL_CPU_SSE2
+        if(m <= __::filter_needle_max)
+          return __::search_sse2(s, n, x, m);
+#endif
+        return __::two_way(s, n, x, m);
+      }
+    } // simd
+  }
+}
+
+#endif // NTL__EXT_SIMD_CHARS
@@ -0,0 +1,490 @@
+/**\file*********************************************************************
+ *                                                                     \brief
+ *  Work-stealing thread pool
+ *
+ ****************************************************************************
+ */
+#ifndef NTL__EXT_THREAD_POOL
+#define NTL__EXT_THREAD_POOL
+#pragma once
+
+#include "../future.hxx"
+#include "concurrent_queue.hxx"
+
+/**
+ *  Nonzero routes std::async(launch::async) to the ext::default_thread_pool(), zero (the default) starts a %thread per call.
+ *  The pool breaks the "as if in a new thread" rule: the tasks waiting for each other can exhaust the workers
+ *  and the thread_local objects are shared between the tasks.
+ **/
+#ifndef STLX__ASYNC_POOL
+#define STLX__ASYNC_POOL 0
+#endif
+
+namespace std
+{
+  namespace ext
+  {
+    namespace __
+    {
+      /** The unit of work queued to the pool, run() executes and deletes it */
+      struct pool_task
+      {
+        pool_task* next;
+
+        pool_task()
+          :next()
+        {}
+        virtual void run() = 0;
+      protected:
+        ~pool_task()
+        {}
+      };
+
+      /** Runs \c f and stores its result (or its exception) to the promise */
+      template<class R, class F>
+      struct future_task:
+        pool_task
+      {
+        F f;
+        promise<R> result;
+
+        explicit future_task(const F& f)
+          :f(f)
+        {}
+
+        void run()
+        {
+          __ntl_try {
+            invoke(is_void<R>());
+          }
+          __ntl_catch(...) {
+            result.set_exception(current_exception());
+          }
+          delete this;
+        }
+
+      private:
+        void invoke(false_type) { result.set_value(f()); }
+        void invoke(true_type)  { f(); result.set_value(); }
+      };
+
+#ifdef NTL_CXX_VT
+      /** Calls the function with the stored arguments */
+      template<class R, class Args>
+      struct bound_call
+      {
+        std::__::func::detail::function<R, Args> fn;
+        Args args;
+
+        template<class F>
+        bound_call(const F& f, const Args& args)
+          :fn(f), args(args)
+        {}
+
+        R operator()() const { return fn(args); }
+      };
+#endif
+
+      /**
+       *	@brief Chase-Lev work-stealing deque
+       *
+       *  The owner pushes and pops at the bottom without a lock, the thieves take the oldest tasks from the top,
+       *  and only the last task left is contended by CAS on \c top. The circular array grows by doubling; the replaced
+       *  arrays can still be read by a late thief and are freed with the deque.
+       *  (D. Chase, Y. Lev. Dynamic circular work-stealing deque; N. M. Le et al. Correct and efficient work-stealing
+       *  for weak memory models.)
+       **/
+      class work_deque
+      {
+        struct ring
+        {
+          ptrdiff_t mask;
+          ring* retired;
+          atomic<pool_task*>* slots;
+
+          explicit ring(ptrdiff_t size, ring* retired = 0)
+            :mask(size - 1), retired(retired), slots(new atomic<pool_task*>[size])
+          {}
+          ~ring()
+          {
+            delete[] slots;
+          }
+
+          pool_task* get(ptrdiff_t i) const { return slots[i & mask].load(memory_order_relaxed); }
+          void put(ptrdiff_t i, pool_task* t) { slots[i & mask].store(t, memory_order_relaxed); }
+        };
+
+      public:
+        explicit work_deque(ptrdiff_t capacity = 256)
+          :top(0), bottom(0), array(new ring(capacity))
+        {}
+
+        ~work_deque()
+        {
+          for(ring* r = array.load(memory_order_relaxed); r; ){
+            ring* retired = r->retired;
+            delete r;
+            r = retired;
+          }
+        }
+
+        /** Appends the task at the bottom, the owner only */
+        void push(pool_task* x)
+        {
+          const ptrdiff_t b = bottom.load(memory_order_relaxed), t = top.load(memory_order_acquire);
+          ring* a = array.load(memory_order_relaxed);
+          if(b - t > a->mask)
+            a = grow(a, t, b);
+          a->put(b, x);
+          bottom.store(b + 1, memory_order_release);
+        }
+
+        /** Takes the newest task, the owner only */
+        pool_task* pop()
+        {
+          const ptrdiff_t b = bottom.load(memory_order_relaxed) - 1;
+          ring* a = array.load(memory_order_relaxed);
+          bottom.store(b, memory_order_relaxed);
+          atomic_thread_fence(memory_order_seq_cst);
+          ptrdiff_t t = top.load(memory_order_relaxed);
+          if(t > b){
+            bottom.store(b + 1, memory_order_relaxed);
+            return 0;
+          }
+          pool_task* x = a->get(b);
+          if(t == b){
+            // the last one, race the thieves for it
+            if(!top.compare_exchange_strong(t, t + 1, memory_order_seq_cst, memory_order_relaxed))
+              x = 0;
+            bottom.store(b + 1, memory_order_relaxed);
+          }
+          return x;
+        }
+
+        /** Takes the oldest task, any thread. Fails if the deque is empty or another thread won the task. */
+        pool_task* steal()
+        {
+          ptrdiff_t t = top.load(memory_order_acquire);
+          atomic_thread_fence(memory_order_seq_cst);
+          const ptrdiff_t b = bottom.load(memory_order_acquire);
+          if(t >= b)
+            return 0;
+          pool_task* x = array.load(memory_order_acquire)->get(t);
+          return top.compare_exchange_strong(t, t + 1, memory_order_seq_cst, memory_order_relaxed) ? x : 0;
+        }
+
+        bool empty() const
+        {
+          return bottom.load(memory_order_relaxed) <= top.load(memory_order_relaxed);
+        }
+
+      private:
+        ring* grow(ring* a, ptrdiff_t t, ptrdiff_t b)
+        {
+          ring* r = new ring((a->mask + 1) * 2, a);
+          for(ptrdiff_t i = t; i < b; i++)
+            r->put(i, a->get(i));
+          array.store(r, memory_order_release);
+          return r;
+        }
+
+        atomic<ptrdiff_t> top;
+        char pad0[cache_line - sizeof(atomic<ptrdiff_t>)];
+        atomic<ptrdiff_t> bottom;
+        atomic<ring*> array;
+        char pad1[cache_line - sizeof(atomic<ptrdiff_t>) - sizeof(atomic<ring*>)];
+
+        work_deque(const work_deque&) __deleted;
+        work_deque& operator=(const work_deque&) __deleted;
+      };
+    }
+
+    /**
+     *	@brief Work-stealing thread pool
+     *
+     *  Each worker owns a Chase-Lev deque: the tasks submitted by a worker (the nested tasks) go to its own deque
+     *  and are run newest first, an idle worker steals the oldest task from a randomly chosen victim. The tasks
+     *  submitted by the other threads go through a shared inbox, which the workers check before stealing.
+     *
+     *  The workers which found nothing park on a condition variable; a submission notifies one of them
+     *  only if any is parked, so the busy pool takes no lock but the inbox one.
+     *
+     *  The destructor runs all the queued tasks (and the tasks they submit) and joins the workers.
+     *  A task waiting for another task's future occupies its worker; don't wait in more tasks than the pool has workers.
+     **/
+    class thread_pool
+    {
+    public:
+      /** Starts \p threads workers, thread::hardware_concurrency() ones if zero */
+      explicit thread_pool(unsigned threads = 0)
+        :count(threads ? threads : thread::hardware_concurrency()), inbox_head(), inbox_tail(), inbox_size(0),
+        queued(0), idle(0), stopping(false)
+      {
+        if(!count)
+          count = 1;
+        workers = new worker[count];
+        for(unsigned i = 0; i < count; i++){
+          workers[i].seed = i * 0x9E3779B9u + 1;
+          workers[i].handle = new thread(&thread_pool::worker_routine, this, i);
+        }
+      }
+
+      /** Runs the queued tasks and joins the workers */
+      ~thread_pool()
+      {
+        {
+          lock_guard<mutex> lock(guard);
+          stopping.store(true, memory_order_relaxed);
+        }
+        wakeup.notify_all();
+        for(unsigned i = 0; i < count; i++){
+          workers[i].handle->join();
+          delete workers[i].handle;
+        }
+        delete[] workers;
+      }
+
+      /** Queues \p f, the returned future gets its result or its %exception */
+      template<class F>
+      future<typename result_of<F()>::type> submit(F f)
+      {
+        typedef typename result_of<F()>::type R;
+        __::future_task<R, F>* t = new __::future_task<R, F>(f);
+        future<R> r = t->result.get_future();
+        enqueue(t);
+        return move(r);
+      }
+
+      /** The number of the workers */
+      unsigned size() const { return count; }
+
+    private:
+      struct worker
+      {
+        __::work_deque tasks;
+        thread* handle;
+        uint32_t seed;
+      };
+
+      /** The pool and the index of the worker running on the calling thread */
+      struct worker_slot
+      {
+        const thread_pool* pool;
+        unsigned index;
+      };
+
+      static worker_slot& this_worker()
+      {
+      #ifdef NTL_CXX_THREADL
+        static thread_local worker_slot slot;
+      #else
+        static __declspec(thread) worker_slot slot;
+      #endif
+        return slot;
+      }
+
+      void enqueue(__::pool_task* t)
+      {
+        // counted first: the parked workers recheck the count, and a worker which sees it nonzero keeps looking
+        queued.fetch_add(1);
+        const unsigned self = current();
+        if(self < count){
+          workers[self].tasks.push(t);
+        }else{
+          lock_guard<mutex> lock(inbox_guard);
+          if(inbox_tail)
+            inbox_tail->next = t;
+          else
+            inbox_head = t;
+          inbox_tail = t;
+          inbox_size.store(inbox_size.load(memory_order_relaxed) + 1, memory_order_relaxed);
+        }
+        // see blocking_queue::wake
+        atomic_thread_fence(memory_order_seq_cst);
+        if(idle.load(memory_order_relaxed)){
+          { lock_guard<mutex> lock(guard); }
+          wakeup.notify_one();
+        }
+      }
+
+      /** The index of the calling worker, \c count for the other threads */
+      unsigned current() const
+      {
+        const worker_slot& slot = this_worker();
+        return slot.pool == this ? slot.index : count;
+      }
+
+      __::pool_task* take_inbox()
+      {
+        if(!inbox_size.load(memory_order_relaxed))
+          return 0;
+        lock_guard<mutex> lock(inbox_guard);
+        __::pool_task* t = inbox_head;
+        if(t){
+          inbox_head = t->next;
+          if(!inbox_head)
+            inbox_tail = 0;
+          inbox_size.store(inbox_size.load(memory_order_relaxed) - 1, memory_order_relaxed);
+        }
+        return t;
+      }
+
+      /** Own deque, the inbox, then one round over the other workers starting at a random one */
+      __::pool_task* find(unsigned self)
+      {
+        worker& w = workers[self];
+        __::pool_task* t = w.tasks.pop();
+        if(!t)
+          t = take_inbox();
+        if(!t && count > 1){
+          // xorshift32
+          w.seed ^= w.seed << 13; w.seed ^= w.seed >> 17; w.seed ^= w.seed << 5;
+          const unsigned start = w.seed % count;
+          for(unsigned i = 0; i < count && !t; i++){
+            const unsigned victim = (start + i) % count;
+            if(victim != self)
+              t = workers[victim].tasks.steal();
+          }
+        }
+        return t;
+      }
+
+      void work(unsigned self)
+      {
+        for(;;){
+          if(__::pool_task* t = find(self)){
+            queued.fetch_sub(1, memory_order_relaxed);
+            t->run();
+            continue;
+          }
+          if(queued.load(memory_order_relaxed)){
+            // a task is being queued or was lost to another thief
+            this_thread::yield();
+            continue;
+          }
+          unique_lock<mutex> lock(guard);
+          idle.fetch_add(1);
+          atomic_thread_fence(memory_order_seq_cst);
+          while(!queued.load(memory_order_relaxed)){
+            if(stopping.load(memory_order_relaxed)){
+              idle.fetch_sub(1, memory_order_relaxed);
+              return;
+            }
+            wakeup.wait(lock);
+          }
+          idle.fetch_sub(1, memory_order_relaxed);
+        }
+      }
+
+      static void worker_routine(thread_pool* pool, unsigned self)
+      {
+        worker_slot& slot = this_worker();
+        slot.pool = pool;
+        slot.index = self;
+        pool->work(self);
+        slot.pool = 0;
+      }
+
+      worker* workers;
+      unsigned count;
+
+      mutex inbox_guard;
+      __::pool_task* inbox_head, *inbox_tail;
+      atomic<size_t> inbox_size;
+
+      atomic<size_t> queued;
+      atomic<unsigned> idle;
+      atomic_bool stopping;
+      mutex guard;
+      condition_variable wakeup;
+
+      thread_pool(const thread_pool&) __deleted;
+      thread_pool& operator=(const thread_pool&) __deleted;
+    };
+
+    namespace __
+    {
+      inline void construct_default_pool(void* storage)
+      {
+        ::new(storage) thread_pool();
+      }
+    }
+
+    /**
+     *	@brief The process-wide pool std::async runs on
+     *
+     *  Started on the first use with thread::hardware_concurrency() workers. It is never destroyed,
+     *  the parked workers end with the process.
+     **/
+    inline thread_pool& default_thread_pool()
+    {
+      static once_flag once;
+      static aligned_storage<sizeof(thread_pool), alignment_of<thread_pool>::value>::type storage;
+      call_once(once, &__::construct_default_pool, static_cast<void*>(&storage));
+      return *reinterpret_cast<thread_pool*>(&storage);
+    }
+  }
+
+  namespace __
+  {
+    inline void run_pool_task(ext::__::pool_task* t)
+    {
+      t->run();
+    }
+
+    /**
+     *	Runs \p f in a new %thread for launch::async, or on the default pool if STLX__ASYNC_POOL is nonzero.
+     *  The future has no deferred state, so launch::deferred alone runs \p f at the call.
+     **/
+    template<class F>
+    inline future<typename result_of<F()>::type> launch_task(launch policy, F f)
+    {
+      typedef typename result_of<F()>::type R;
+      const bool concurrent = (static_cast<unsigned>(policy) & static_cast<unsigned>(launch::async)) != 0;
+#if STLX__ASYNC_POOL
+      if(concurrent)
+        return ext::default_thread_pool().submit(f);
+#endif
+      ext::__::future_task<R, F>* t = new ext::__::future_task<R, F>(f);
+      future<R> r = t->result.get_future();
+      if(concurrent)
+        thread(&run_pool_task, static_cast<ext::__::pool_task*>(t)).detach();
+      else
+        t->run();
+      return move(r);
+    }
+  }
+
+  ///\name 30.6.8 Function template async [futures.async]
+#if defined(NTL_CXX_VT) || defined(NTL_DOC)
+
+  template <class F, class... Args>
+  inline
+    future<typename result_of<typename decay<F>::type(typename decay<Args>::type...)>::type>
+    async(launch policy, F&& f, Args&&... args)
+  {
+    typedef typename result_of<typename decay<F>::type(typename decay<Args>::type...)>::type R;
+    typedef typename __::tmap<typename decay<Args>::type...>::type Args_t;
+    return __::launch_task(policy, ext::__::bound_call<R, Args_t>(__::decay_copy(std::forward<F>(f)), make_tuple(std::forward<Args>(args)...)));
+  }
+
+#elif defined(NTL_CXX_RV)
+
+  template <class F>
+  inline future<typename result_of<F()>::type> async(launch policy, F&& f)
+  {
+    return __::launch_task(policy, __::decay_copy(std::forward<F>(f)));
+  }
+
+#else
+
+  template <class F>
+  inline future<typename result_of<F()>::type> async(launch policy, F f)
+  {
+    return __::launch_task(policy, f);
+  }
+
+#endif
+  ///\}
+}
+#endif // NTL__EXT_THREAD_POOL
@@ -6,7 +6,7 @@
 #include <nt/thread.hxx>
 #include <nt/system_error.hxx>
 #include <atomic.hxx>
-#include <vector>
+#include <chrono>
 
 #ifndef NTL_DISABLE_SRWLOCK
 # include <nt/srwlock.hxx>
@@ -16,6 +16,12 @@
 
 #include "op.hxx"
 #include "complete_op.hxx"
+#include "../timer_wheel.hxx"
+
+#ifndef STLX__IOCP_TIMER_RESOLUTION
+/** The tick of the io_service timers in 100 ns units, the timers expire at the first tick at or after their time (1 ms by default). */
+#define STLX__IOCP_TIMER_RESOLUTION 10000
+#endif
 
 namespace std { namespace tr2 { namespace sys {
 
@@ -30,19 +36,25 @@ namespace std { namespace tr2 { namespace sys {
     typedef __::timer_scheduler::timer_data timer_data;
     typedef ntl::nt::overlapped overlapped;
     
-    // sort by time, unique by handle
-    typedef std::vector<timer_data> timer_queue; // can't use std::priority_queue because of erase(timer)
+    // unique by handle, expire in the ticks order
+    typedef __::timer_wheel<ntl::nt::legacy_handle, timer_data> timer_queue;
 
-    struct find_timer
+    // posts the expired timers, re-arms the periodic ones
+    struct fire_timer
     {
-      ntl::nt::legacy_handle h;
-      bool operator()(const timer_queue::value_type& t) const
+      iocp_service* self;
+      void operator()(ntl::nt::legacy_handle h, timer_data t) const
       {
-        return h == t.h;
+        if(t.period.count() != 0) {
+          // periodic timer, arm him to the next period
+          t.fire += t.period.count();
+          self->timers.arm(h, t.fire, t);
+          self->post_immediate_completion(t.op);
+        } else {
+          // deadline timer, removed once fired
+          self->post_deferred_completion(t.op);
+        }
       }
-      explicit find_timer(ntl::nt::legacy_handle h)
-        : h(h)
-      {}
     };
     
     // system codes
@@ -59,6 +71,7 @@ namespace std { namespace tr2 { namespace sys {
       : service(ios)
       , timer_event(ntl::nt::SynchronizationEvent)
       , timer_thread(&iocp_service::timer_proc, this, true) // create_suspended
+      , timers(STLX__IOCP_TIMER_RESOLUTION, now())
       , scheduler(use_service<__::timer_scheduler>(ios))
       , self_id()
     {
@@ -192,12 +205,8 @@ namespace std { namespace tr2 { namespace sys {
       work_started();
 
       wlock lock(timer_lock);
-      const ntl::nt::legacy_handle t = reinterpret_cast<ntl::nt::legacy_handle>(timer);
-      timer_queue::iterator tm = std::find_if(timers.begin(), timers.end(), find_timer(t));
-      if(tm != timers.end()) {
-        timers.erase(tm);
-      }
-      timers.push_back(*data);
+      // replaces the previous wait of this timer
+      timers.arm(reinterpret_cast<ntl::nt::legacy_handle>(timer), data->fire, *data);
       timer_event.set();
       timer_thread.resume();
       return true;
@@ -209,17 +218,13 @@ namespace std { namespace tr2 { namespace sys {
         return 0;
 
       wlock lock(timer_lock);
-      const ntl::nt::legacy_handle t = reinterpret_cast<ntl::nt::legacy_handle>(timer);
-      timer_queue::iterator tm = std::find_if(timers.begin(), timers.end(), find_timer(t));
-      if(tm != timers.end()) {
-        async_operation* op = tm->op;
-        timers.erase(tm);
-
+      timer_data tm;
+      if(timers.cancel(reinterpret_cast<ntl::nt::legacy_handle>(timer), &tm)) {
         // wake up thread to recalculate timers
         timer_event.set();
 
         // complete handler with aborted code
-        on_completion(op, std::make_error_code(std::tr2::network::error::operation_aborted));
+        on_completion(tm.op, std::make_error_code(std::tr2::network::error::operation_aborted));
 
         return 1;
       }
@@ -367,56 +372,33 @@ namespace std { namespace tr2 { namespace sys {
     static size_t add_timer_(void* ctx, const void* timer, const timer_data* data)
     { return static_cast<iocp_service*>(ctx)->add_timer(timer, data); }
 
+    static ntl::nt::systime_t now()
+    {
+      return std::chrono::duration_cast<ntl::nt::system_duration>(std::chrono::system_clock::now().time_since_epoch()).count();
+    }
+
     uint32_t __stdcall timer_worker()
     {
       using namespace ntl::nt;
       ntl::nt::this_thread::setname("iocp::timer_proc");
 
-      uint32_t count;
-      legacy_handle handles[2] = { timer_event.get() };
-
       do {
 
-        timer_data first = {};
+        // expire the due timers at once and sleep until the next tick with timers
+        timer_queue::time_type next;
         {
-          count = 1;
           wlock lock(timer_lock);
-          if(!timers.empty()) {
-            // remove the last timer now to eliminate a possible concurrent change when fired
-            if(timers.size() > 1)
-              std::sort(timers.begin(), timers.end(), std::greater<timer_queue::value_type>());
-            first = timers.back();
-            //timers.pop_back();
-            handles[count++] = first.h;
-          }
+          const fire_timer fire = { this };
+          timers.advance(now(), fire);
+          next = timers.next_expiry();
         }
 
-        ntstatus st = NtWaitForMultipleObjects(count, handles, wait_type::WaitAny, false, infinite_timeout());
-        if(st == ntl::nt::status::wait_0) {
-          // queue was changed
-          continue;
-        }
-        else if(st == status::wait_1) {
-          // timer fired
-          wlock lock(timer_lock);
-          timer_queue::iterator tm = std::find_if(timers.begin(), timers.end(), find_timer(first.h));
-          if(tm != timers.end()) {
-            // fired and not erased yet
-            if(tm->period.count() != 0) {
-              // periodic timer, do not erase him
-              // just adjust fire time to period one
-              tm->fire += tm->period.count();
-              post_immediate_completion(first.op);
-
-            } else {
-              // deadline timer, remove him once fired
-              timers.erase(tm);
-              post_deferred_completion(first.op);
-            }
-          } else {
-            // if erased, operation_aborted will be sent 
-            first.h = 0;
-          }
+        if(next == timer_queue::never) {
+          timer_event.wait(false);
+        } else {
+          const systime_t left = next - now();
+          // the queue change wakes us up to recalculate timers
+          timer_event.wait_for(system_duration(left > 0 ? left : 0), false);
         }
 
       } while(shutdown.test(false));
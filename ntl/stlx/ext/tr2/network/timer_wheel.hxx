@@ -0,0 +1,290 @@
+/**\file*********************************************************************
+ *                                                                     \brief
+ *  Hierarchical timing wheel
+ *
+ ****************************************************************************
+ */
+#ifndef NTL__STLX_TR2_TIMER_WHEEL
+#define NTL__STLX_TR2_TIMER_WHEEL
+#pragma once
+
+#include "../../../cstdint.hxx"
+#include "../../../unordered_map.hxx"
+
+namespace std { namespace tr2 { namespace sys {
+
+  namespace __
+  {
+    /**
+     *	@brief Hierarchical timing wheel
+     *
+     *  Keeps the timers identified by \c Key with the payload \c T. The time is an integer in any units,
+     *  it is counted in the ticks of \c resolution units: a timer expires at the first tick at or after its time.
+     *  The wheel knows no clock, its owner passes the current time to advance().
+     *
+     *  There are 6 levels of 64 slots, the level \e n slot holds the timers due in 64<sup>n</sup> ticks granularity;
+     *  a slot of the upper level is moved down when the lower levels wrap around. The timers further than
+     *  64<sup>6</sup> ticks wait in the last level. Arming, re-arming and cancelling a timer take a constant time,
+     *  advance() takes the time proportional to the elapsed ticks with timers and to the expired timers.
+     **/
+    template<class Key, class T, class Hash = hash<Key> >
+    class timer_wheel
+    {
+      struct node
+      {
+        node*   next;
+        node**  pprev;
+        int64_t due;    // in ticks
+        Key     key;
+        T       value;
+        unsigned level;
+      };
+
+      typedef unordered_map<Key, node*, Hash> index_type;
+
+      static const unsigned slot_bits = 6, slots = 1 << slot_bits, levels = 6;
+
+      timer_wheel(const timer_wheel&) __deleted;
+      timer_wheel& operator=(const timer_wheel&) __deleted;
+    public:
+      typedef int64_t time_type;
+      typedef Key     key_type;
+      typedef T       value_type;
+
+      /** The result of next_expiry() when there are no timers */
+      static const time_type never = INT64_MAX;
+
+      /** Creates the wheel with the tick of \p resolution time units starting at \p now */
+      explicit timer_wheel(time_type resolution, time_type now = 0)
+        :resolution_(resolution), current(now / resolution)
+      {
+        assert(resolution > 0);
+        for(unsigned l = 0; l < levels; l++){
+          used[l] = 0;
+          for(unsigned s = 0; s < slots; s++)
+            wheel[l][s] = nullptr;
+        }
+      }
+
+      ~timer_wheel()
+      {
+        clear();
+      }
+
+      time_type resolution() const { return resolution_; }
+      size_t size() const { return index.size(); }
+      bool empty() const { return index.empty(); }
+
+      /** Arms the timer \p key to expire at \p time, replacing its previous time and payload */
+      void arm(const Key& key, time_type time, const T& value)
+      {
+        typename index_type::iterator i = index.find(key);
+        node* n;
+        if(i != index.end()){
+          n = i->second;
+          unlink(n);
+          n->value = value;
+        }else{
+          n = new node();
+          n->key = key;
+          n->value = value;
+          __ntl_try{
+            index.insert(typename index_type::value_type(key, n));
+          }
+          __ntl_catch(...){
+            delete n;
+            __ntl_rethrow;
+          }
+        }
+        n->due = time <= current * resolution_ ? current : (time - 1) / resolution_ + 1;
+        place(n);
+      }
+
+      /** Cancels the timer \p key and returns its payload in \p value, returns false if it wasn't armed */
+      bool cancel(const Key& key, T* value = nullptr)
+      {
+        typename index_type::iterator i = index.find(key);
+        if(i == index.end())
+          return false;
+        node* n = i->second;
+        index.erase(i);
+        unlink(n);
+        if(value)
+          *value = n->value;
+        delete n;
+        return true;
+      }
+
+      /** Whether the timer \p key is armed */
+      bool armed(const Key& key) const
+      {
+        return index.find(key) != index.end();
+      }
+
+      /**
+       *	@brief Expires the timers due at \p now
+       *  @details Calls <tt>f(key, value)</tt> for each expired timer in the order of their ticks;
+       *  the timer is already removed, so \p f may arm it again.
+       *  @return the number of expired timers
+       **/
+      template<class F>
+      size_t advance(time_type now, F f)
+      {
+        const int64_t target = now / resolution_;
+        node* expired = nullptr, **tail = &expired;
+        size_t count = 0;
+        while(current <= target){
+          if(index.empty()){
+            current = target + 1;
+            break;
+          }
+          // skip the ticks which cascade or expire nothing
+          unsigned lowest = 0;
+          while(!used[lowest])
+            lowest++;
+          if(lowest > 0){
+            const int64_t step = int64_t(1) << (slot_bits * lowest);
+            const int64_t next = (current + step - 1) & ~(step - 1);
+            if(next > target){
+              current = target + 1;
+              break;
+            }
+            current = next;
+          }
+
+          // cascade the upper levels at the wrap around
+          for(unsigned l = 1, shift = 0; l < levels && ((current >> shift) & (slots - 1)) == 0; l++, shift += slot_bits)
+            cascade(l, static_cast<unsigned>((current >> (shift + slot_bits)) & (slots - 1)));
+
+          node*& slot = wheel[0][current & (slots - 1)];
+          while(node* n = slot){
+            unlink(n);
+            index.erase(n->key);
+            *tail = n;
+            tail = &n->next;
+            count++;
+          }
+          ++current;
+        }
+
+        // the wheel is consistent, deliver the batch
+        *tail = nullptr;
+        struct disposer
+        {
+          node* list;
+          ~disposer()
+          {
+            while(node* n = list){
+              list = n->next;
+              delete n;
+            }
+          }
+        } batch = { expired };
+        while(node* n = batch.list){
+          batch.list = n->next;
+          const Key key = n->key;
+          const T value = n->value;
+          delete n;
+          f(key, value);
+        }
+        return count;
+      }
+
+      /** The earliest time at which advance() may expire a timer, a lower bound of the nearest timer time */
+      time_type next_expiry() const
+      {
+        if(index.empty())
+          return never;
+        int64_t tick = INT64_MAX;
+        for(unsigned l = 1; l < levels; l++){
+          if(used[l]){
+            // the upper level comes down at the wrap around of the levels below it
+            const int64_t step = int64_t(1) << (slot_bits * l);
+            tick = (current + step - 1) & ~(step - 1);
+            break;
+          }
+        }
+        if(used[0]){
+          for(unsigned k = 0; k < slots && current + k < tick; k++){
+            if(wheel[0][(current + k) & (slots - 1)]){
+              tick = current + k;
+              break;
+            }
+          }
+        }
+        return tick * resolution_;
+      }
+
+      /** Removes all timers */
+      void clear()
+      {
+        for(typename index_type::iterator i = index.begin(); i != index.end(); ++i)
+          delete i->second;
+        index.clear();
+        for(unsigned l = 0; l < levels; l++){
+          used[l] = 0;
+          for(unsigned s = 0; s < slots; s++)
+            wheel[l][s] = nullptr;
+        }
+      }
+
+    private:
+      void place(node* n)
+      {
+        int64_t delta = n->due - current, due = n->due;
+        unsigned level = 0;
+        if(delta < 0){
+          // overdue, expires at the next tick
+          due = current;
+        }else{
+          const int64_t span = int64_t(1) << (slot_bits * levels);
+          if(delta >= span){
+            // too far, wait in the last slot which the wheel reaches
+            due = current + span - 1;
+            delta = span - 1;
+          }
+          while(delta >= (int64_t(1) << (slot_bits * (level + 1))))
+            level++;
+        }
+        node*& head = wheel[level][(due >> (slot_bits * level)) & (slots - 1)];
+        n->next = head;
+        n->pprev = &head;
+        if(head)
+          head->pprev = &n->next;
+        head = n;
+        n->level = level;
+        used[level]++;
+      }
+
+      void unlink(node* n)
+      {
+        *n->pprev = n->next;
+        if(n->next)
+          n->next->pprev = n->pprev;
+        used[n->level]--;
+      }
+
+      void cascade(unsigned level, unsigned slot)
+      {
+        node* n = wheel[level][slot];
+        wheel[level][slot] = nullptr;
+        while(n){
+          node* const next = n->next;
+          used[level]--;
+          place(n);
+          n = next;
+        }
+      }
+
+    private:
+      node* wheel[levels][slots];
+      size_t used[levels];
+      index_type index;
+      const time_type resolution_;
+      int64_t current; // the next tick to expire
+    };
+
+  } // __ ns
+
+}}}
+#endif // NTL__STLX_TR2_TIMER_WHEEL
@@ -52,6 +52,8 @@ namespace std
 /**
  *	@brief 27.9.1.1 Class template basic_filebuf [filebuf]
  *  @details The class basic_filebuf<charT,traits> associates both the input sequence and the output sequence with a file.
+ *  A file opened for input with the NTL extension ios_base::mapped is mapped into memory as a whole and
+ *  becomes the get area itself; pipes, devices and files which need a character conversion are read through the buffer.
  **/
   template <class charT, class traits /*= char_traits<charT>*/ >
   class basic_filebuf:
@@ -78,12 +80,12 @@ namespace std
     ///\name 27.9.1.2 basic_filebuf constructors [filebuf.cons]
 
     basic_filebuf()
-      :mode(), our_buffer(true), encoding(ntl::Encoding::Default)
+      :mode(), our_buffer(true), encoding(ntl::Encoding::Default), view()
     {}
 
 #ifdef NTL_CXX_RV
     basic_filebuf(basic_filebuf&& rhs)
-      :mode(), our_buffer(true), encoding(ntl::Encoding::Default)
+      :mode(), our_buffer(true), encoding(ntl::Encoding::Default), view()
     {
       swap(rhs);
     }
@@ -118,6 +120,7 @@ namespace std
       swap(encoding, rhs.encoding);
       swap(mode, rhs.mode);
       swap(our_buffer, rhs.our_buffer);
+      swap(view, rhs.view);
     }
 
     ///\name 27.9.1.4 Member functions [filebuf.members]
@@ -156,6 +159,7 @@ namespace std
       */
 
       // at last, close file
+      unmap();
       f.close();
       return ok ? this : nullptr;
     }
@@ -168,6 +172,8 @@ namespace std
     {
       if(!f || !(mode & ios_base::in))
         return -1;
+      if(view)
+        return gptr() < egptr() ? egptr()-gptr() : -1;
 
       streamsize avail = egptr()-gptr(),
         in_avail = static_cast<streamsize>(f.size() - f.tell());
@@ -193,7 +199,10 @@ namespace std
       if(avail > 0)
         // just return it
         return traits_type::to_int_type(*gptr());
-      
+      if(view)
+        // the whole file is in the get area
+        return eof;
+
       bool ok;
       const bool writeable = (mode&ios_base::out) != 0;
       streamsize cb;
@@ -250,7 +259,7 @@ namespace std
     virtual int_type pbackfail(int_type c = traits::eof())
     {
       const int_type eof = traits_type::eof();
-      if(!f)
+      if(!f || view) // the mapped file is read-only
         return eof;
       _assert_msg("not implemented yet");
       return c;
@@ -258,19 +267,18 @@ namespace std
 
     virtual streamsize xsputn(const char_type* s, streamsize n)
     {
-      if(n <= default_file_buffer_size)
+      // the data which fits the free buffer space or is smaller than the buffer is buffered
+      if(n <= epptr()-pptr() || n < buf.second || !f || !(mode & ios_base::out))
         return basic_streambuf::xsputn(s, n);
-      else if(!f)
-        return 0;
-      // directly put the large data
-
-      // put the pending data
-      overflow();
-      // request file space & write data
-      f.size(f.tell() + n);
+
+      // the large data goes to the file directly, after the pending data
+      if(const streamsize pending = pptr()-pbase()){
+        if(!write(pbase(), pending))
+          return 0;
+        reset();
+      }
       streamsize written;
       write(s, n, &written);
-      f.flush();
       return written;
     }
 
@@ -301,6 +309,8 @@ namespace std
 
     virtual basic_streambuf<charT,traits>* setbuf(char_type* s, streamsize n)
     {
+      if(view) // the mapped file is the buffer
+        return this;
       if(!s && !n){
         // unbuffered io
         our_buffer = true;
@@ -332,6 +342,15 @@ namespace std
       if(off != 0 && width <= 0)
         return re;
 
+      if(view){
+        // seek inside the get area, which starts at the file beginning
+        char_type* const from = way == ios_base::beg ? eback() : way == ios_base::cur ? gptr() : egptr();
+        if(off < eback()-from || off > egptr()-from)
+          return re;
+        setg(eback(), from+off, egptr());
+        return pos_type(off_type(gptr()-eback()));
+      }
+
       if(way != ios_base::cur || off != 0 && pptr()-pbase()){
         if(sync() == -1)
           return re;
@@ -353,6 +372,8 @@ namespace std
       pos_type re = pos_type(off_type(-1));
       if(!f)
         return re;
+      if(view)
+        return seekoff(off_type(sp), ios_base::beg);
       _assert_msg("not implemented yet");
       (void)sp;
       return re;
@@ -614,12 +635,6 @@ namespace std
         }
       }
 
-      // setup buffer
-      if(!buf.second){
-        reallocate_buffer(default_file_buffer_size);
-        reset();
-      }
-
       // detect encoding on nonempty file
       if(bom_size > 0){
         ntl::EncodingType file_enc = parse_encoding(bom, bom_size);
@@ -629,9 +644,51 @@ namespace std
           enc = file_enc;
       }
       this->encoding = enc;
+
+      // map file or setup buffer
+      if(!((mode & ios_base::mapped) && !(mode & ios_base::out) && map()) && !buf.second){
+        reallocate_buffer(default_file_buffer_size);
+        reset();
+      }
       return ok;
     }
 
+    /** Maps the whole file as the get area if it is read without conversion */
+    bool map()
+    {
+#ifndef NTL_SUBSYSTEM_KM
+      const bool direct = (mode & ios_base::binary) || encoding == ntl::Encoding::Default || static_cast<size_t>(encoding) == sizeof(char_type);
+      const native_file::size_type size = f.size(), pos = f.tell();
+      if(!direct || size <= 0 || static_cast<uint64_t>(size) > static_cast<size_t>(-1) / 2)
+        return false;
+
+      // pipes and devices have no sections, they are read through the buffer
+      using namespace NTL_SUBSYSTEM_NS;
+      section s(f.get(), page_protection::page_readonly, allocation_attributes::sec_commit, section::map_read | section::query);
+      if(!s)
+        return false;
+      char_type* const p = static_cast<char_type*>(s.mmap(0, page_protection::page_readonly));
+      if(!p)
+        return false;
+      view = s.detach();
+      setg(p, p + static_cast<size_t>(pos) / sizeof(char_type), p + static_cast<size_t>(size) / sizeof(char_type));
+      return true;
+#else
+      return false;
+#endif
+    }
+
+    void unmap()
+    {
+#ifndef NTL_SUBSYSTEM_KM
+      if(view){
+        NTL_SUBSYSTEM_NS::section::munmap(view);
+        view = nullptr;
+        setg(buf.first, buf.first, buf.first);
+      }
+#endif
+    }
+
     bool write(const char_type* from, const char_type* to, streamsize* written = 0)
     {
       return write(from, to-from, written);
@@ -745,6 +802,7 @@ namespace std
     ntl::EncodingType encoding;
     ios_base::openmode mode;
     bool our_buffer;
+    void* view; // the mapped file, see ios_base::mapped
   };
 
 
@@ -1156,4 +1156,7 @@ namespace std
   /** @} thread_futures */
   /** @} threads */
 } // std
+
+// the definition of async
+#include "ext/thread_pool.hxx"
 #endif // NTL__STLX_FUTURE
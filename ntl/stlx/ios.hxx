@@ -187,6 +187,8 @@ class ios_base
     static constexpr const openmode out     = 1 << 4;
     /** perform input and output in binary mode (as opposed to text mode) (0x20) */
     static constexpr const openmode binary  = 1 << 5;
+    /** NTL extension: map the whole file read-only into memory and read it without buffering (0x40) */
+    static constexpr const openmode mapped  = 1 << 6;
 
     /// 27.4.2.1.5 Type ios_base::seekdir [ios::seekdir]
     ///\todo must be static const
@@ -182,7 +182,7 @@ class basic_istream : virtual public basic_ios<charT, traits>
             n = static_cast<ValueT>(value);
           else {
             state |= ios_base::failbit;
-            value = value < lim::__min ? lim::__min : lim::__max;
+            n = value < lim::__min ? lim::__min : lim::__max;
           }
         //}
       }
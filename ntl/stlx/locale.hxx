@@ -1500,6 +1500,7 @@ protected:
 }//namespace std
 
 #include "ios.hxx"
+#include "charconv.hxx"
 
 namespace std {
 
@@ -1842,9 +1843,10 @@ class num_get : public locale::facet
       if(!(str.flags() & ios_base::boolalpha)){
 
         // integral bool
-        unsigned value = get_int<unsigned long, signed long>(in,end,str,err, numeric_limits<bool>::__max, numeric_limits<bool>::__min);
+        long value;
+        in = get_int(in, end, str, err, value);
         v = value != 0;
-        if(value > 1)
+        if(static_cast<unsigned long>(value) > 1)
           err |= ios_base::failbit;
       }else{
         // textual bool
@@ -1877,253 +1879,231 @@ class num_get : public locale::facet
     }
     _NTL_LOC_VIRTUAL iter_type do_get(iter_type in, iter_type end, ios_base& f, ios_base::iostate& err, long& v) const
     {
-      unsigned long value = get_int<unsigned long, signed long>(in,end,f,err, numeric_limits<long>::__max, numeric_limits<long>::__min);
-      v = static_cast<long>(value);
-      return in;
+      return get_int(in, end, f, err, v);
     }
     _NTL_LOC_VIRTUAL iter_type do_get(iter_type in, iter_type end, ios_base& f, ios_base::iostate& err, long long& v) const
     {
-      unsigned long long value = get_int<unsigned long long, signed long long>(in,end,f,err, numeric_limits<long long>::__max, numeric_limits<long long>::__min);
-      v = static_cast<long long>(value);
-      return in;
+      return get_int(in, end, f, err, v);
     }
     _NTL_LOC_VIRTUAL iter_type do_get(iter_type in, iter_type end, ios_base& f, ios_base::iostate& err, unsigned short& v) const
     {
-      unsigned value = get_int<unsigned long, signed long>(in,end,f,err, numeric_limits<unsigned short>::__max, numeric_limits<unsigned short>::__min);
-      v = static_cast<unsigned short>(value);
-      return in;
+      return get_int(in, end, f, err, v);
     }
     _NTL_LOC_VIRTUAL iter_type do_get(iter_type in, iter_type end, ios_base& f, ios_base::iostate& err, unsigned int& v) const
     {
-      v = get_int<unsigned long, signed long>(in,end,f,err, numeric_limits<unsigned int>::__max, numeric_limits<unsigned int>::__min);
-      return in;
+      return get_int(in, end, f, err, v);
     }
     _NTL_LOC_VIRTUAL iter_type do_get(iter_type in, iter_type end, ios_base& f, ios_base::iostate& err, unsigned long& v) const
     {
-      v = get_int<unsigned long, signed long>(in,end,f,err, numeric_limits<unsigned long>::__max, numeric_limits<unsigned long>::__min);
-      return in;
+      return get_int(in, end, f, err, v);
     }
     _NTL_LOC_VIRTUAL iter_type do_get(iter_type in, iter_type end, ios_base& f, ios_base::iostate& err, unsigned long long& v) const
     {
-      v = get_int<unsigned long long, signed long long>(in,end,f,err, numeric_limits<unsigned long long>::__max, numeric_limits<unsigned long long>::__min);
-      return in;
+      return get_int(in, end, f, err, v);
     }
     _NTL_LOC_VIRTUAL iter_type do_get(iter_type in, iter_type end, ios_base& f, ios_base::iostate& err, float& v) const
     {
-      v = static_cast<float>(get_float(in, end, f, err, numeric_limits<float>::max(), numeric_limits<float>::min()));
-      return in;
+      return get_float(in, end, f, err, v);
     }
     _NTL_LOC_VIRTUAL iter_type do_get(iter_type in, iter_type end, ios_base& f, ios_base::iostate& err, double& v) const
     {
-      v = static_cast<double>(get_float(in, end, f, err, numeric_limits<double>::max(), numeric_limits<double>::min()));
-      return in;
+      return get_float(in, end, f, err, v);
     }
     _NTL_LOC_VIRTUAL iter_type do_get(iter_type in, iter_type end, ios_base& f, ios_base::iostate& err, long double& v) const
     {
-      v = static_cast<long double>(get_float(in, end, f, err, numeric_limits<long double>::max(), numeric_limits<long double>::min()));
+      double value;
+      in = get_float(in, end, f, err, value);
+      v = value;
       return in;
     }
     _NTL_LOC_VIRTUAL iter_type do_get(iter_type in, iter_type end, ios_base& f, ios_base::iostate& err, void*& v) const
     {
-      // turn on hexadecimal mode for parsing pointer value
-      const ios_base::fmtflags prev_base = (f.flags() & ios_base::basefield);
-      f.setf(ios_base::hex, ios_base::basefield);
-
-      uintptr_t value = get_int<uintptr_t, intptr_t>(in,end,f,err, numeric_limits<uintptr_t>::__max, numeric_limits<uintptr_t>::__min);
-      v =reinterpret_cast<void*>(value);
-      f.setf(prev_base, ios_base::basefield);  // restore previous base flag
+      // the pointer value is always hexadecimal
+      uintptr_t value;
+      in = get_int(in, end, f, err, value, 16);
+      v = reinterpret_cast<void*>(value);
       return in;
     }
     ///\}
 private:
-  static long double get_float(iter_type in, iter_type end, ios_base& str, ios_base::iostate& err, long double max_val, long double min_val)
+  /**
+   *	Stage 2 keeps only the significant digits of the number and the power of ten they are scaled by,
+   *  stage 3 rounds them directly to the requested type by the __::fp engine.
+   **/
+  template<class T>
+  static iter_type get_float(iter_type in, iter_type end, ios_base& str, ios_base::iostate& err, T& v)
   {
-    if(in == end){
-      err |= ios_base::eofbit;
-      return 0;
-    }
-
-    // initialization
     const numpunct<char_type>& np = use_facet< numpunct<char_type> >(str.getloc());
-    const ctype<char_type>& check = use_facet< ctype<char_type> >(str.getloc());
-
-    const ios_base::fmtflags flags = str .flags();
-    const ios_base::fmtflags basefield = (flags & ios_base::basefield);
-
-    const char_type thousands_sep = np.thousands_sep(), decimal_sep = np.decimal_point();
-    const size_t group_width = np.grouping().length();
-
-    const unsigned base = basefield == ios_base::oct ? 8 : basefield == ios_base::hex ? 16 : 10;
-    ctype_base::mask base_mask = ctype_base::xdigit;
-
-    bool dec_extracted = false;
-    char valuebuf[128], *pval = valuebuf;
-    size_t ic = 0;
-    do {
-      char_type ct = *in;
-      if(in == end)
-        break;
-      char c = static_cast<char>(ct);
-      bool discard = ct == thousands_sep && group_width > 0;
-      if(discard){
-        if(!dec_extracted)
-          continue;
-        // thousand sep isn't valid in decimal part
-        ic = 0;
-        break;
+    const char_type decimal_sep = np.decimal_point(), thousands_sep = np.thousands_sep();
+    const bool grouping = !np.grouping().empty();
+
+    static const char src_atoms[] = "0123456789+-eE";
+    enum { zero, plus = 10, minus, exp_lower, exp_upper, atoms_count };
+    char_type atoms[atoms_count];
+    use_facet< ctype<char_type> >(str.getloc()).widen(src_atoms, src_atoms + atoms_count, atoms);
+
+    // the digits past max_digits only matter for the rounding, the nonzero ones are kept as a single '1'
+    static const size_t max_digits = __::fp::shifted_decimal::max_digits;
+    char digits[max_digits + 1];
+    size_t count = 0;
+    int64_t scale = 0;
+    bool negative = false, fraction = false, valid = false, sticky = false;
+
+    if(in != end && (*in == atoms[plus] || *in == atoms[minus])){
+      negative = *in == atoms[minus];
+      ++in;
+    }
+    for(; in != end; ++in){
+      const char_type c = *in;
+      if(c == decimal_sep && !fraction){
+        fraction = true;
+        continue;
       }
-      if(ct == decimal_sep) {
-        c = '.', dec_extracted = true;
-        base_mask = ctype_base::digit;
-      } else if(ct != '-' && ct != '+') {
-        // check is it a valid digit
-        if(dec_extracted && (c == 'e' || c == 'E')){
-          // ok
-        }else {
-          // check digit
-          if(!check.is(base_mask, c))
-            break;
-          // check base
-          unsigned digit;
-          if(check.is(ctype_base::alpha, c))
-            //digit = ct.toupper(c) - 'A' + 10;
-            digit = (c & ~(1 << 5)) - 'A' + 10;
-          else
-            digit = c - '0';
-          if(digit >= base)
-            break;
-        }
+      // thousands separators are discarded in the integral part only
+      if(c == thousands_sep && grouping && valid && !fraction)
+        continue;
+      const unsigned digit = static_cast<unsigned>(c - atoms[zero]);
+      if(digit > 9)
+        break;
+      valid = true;
+      if(count < max_digits){
+        // the leading zeros are not stored
+        if(count != 0 || digit != 0)
+          digits[count++] = static_cast<char>('0' + digit);
+        if(fraction)
+          scale--;
+      }else{
+        sticky |= digit != 0;
+        if(!fraction)
+          scale++;
       }
-      ++ic;
-      *pval++ = c;
-    } while(++in, true);
+    }
 
-    // NOTE: may be bad/fail bit on format error?
-    static const ios_base::iostate bad_format = ios_base::failbit;
+    if(valid && in != end && (*in == atoms[exp_lower] || *in == atoms[exp_upper])){
+      bool negative_exponent = false;
+      if(++in != end && (*in == atoms[plus] || *in == atoms[minus])){
+        negative_exponent = *in == atoms[minus];
+        ++in;
+      }
+      int64_t e = 0;
+      valid = false;
+      for(; in != end; ++in){
+        const unsigned digit = static_cast<unsigned>(*in - atoms[zero]);
+        if(digit > 9)
+          break;
+        valid = true;
+        if(e < __::fp::max_explicit_exponent)
+          e = e * 10 + digit;
+      }
+      scale += negative_exponent ? -e : e;
+    }
 
-    if(ic == 0)
-      err |= bad_format;
     if(in == end)
       err |= ios_base::eofbit;
-
-    // extract
-    *pval = 0;
-    long double value = 0;
-    if(ic){
-      value = std::strtod(*valuebuf == '-' ? valuebuf+1 : valuebuf, &pval);
-      if(value == 0.0){}
-      else if(value > max_val)
-        value = max_val;
-      else if (value < min_val)
-        value = min_val;
-      else if(*valuebuf == '-')
-        value = -value; 
-    }
-    return value;
+    if(!valid){
+      v = 0;
+      err |= ios_base::failbit;
+      return in;
+    }
+    if(sticky){
+      digits[count++] = '1';
+      scale--;
+    }
+
+    __::fp::decimal_number d;
+    d.negative = negative;
+    d.integer = digits;
+    d.integer_length = count;
+    d.fraction = digits + count;
+    d.fraction_length = 0;
+    d.explicit_exponent = scale;
+    __::fp::finish_decimal(d);
+    T value;
+    if(__::fp::convert(d, value) == __::fp::parse_out_of_range && value != 0){
+      // overflow stores the largest value, the underflow is not an error
+      value = negative ? -numeric_limits<T>::max() : numeric_limits<T>::max();
+      err |= ios_base::failbit;
+    }
+    v = value;
+    return in;
   }
 
-  template<typename storage_type, typename signed_storage_type> // this function will instantiated only two times: for 64bit and all other types
-  static storage_type get_int(iter_type in, iter_type end, ios_base& str, ios_base::iostate& err, storage_type max_val, signed_storage_type min_val)
+  /**
+   *	Stage 2 keeps only the significant digits narrowed to ASCII, stage 3 converts them by the __::intconv engine.
+   *  The value out of range of \p T stores its nearest limit and sets failbit,
+   *  the unsigned types take the negative numbers modulo 2^N as strtoull does.
+   **/
+  template<class T>
+  static iter_type get_int(iter_type in, iter_type end, ios_base& str, ios_base::iostate& err, T& v, unsigned base = 0)
   {
-    if(in == end){
-      err |= ios_base::eofbit;
-      return 0;
-    }
-
-    // initialization
     const numpunct<char_type>& np = use_facet< numpunct<char_type> >(str.getloc());
-    const ctype<char_type>& ct = use_facet< ctype<char_type> >(str.getloc());
-
-    const ios_base::fmtflags flags = str .flags();
-    const ios_base::fmtflags basefield = (flags & ios_base::basefield);
-
     const char_type thousands_sep = np.thousands_sep();
-    const size_t group_width = np.grouping().length();
-
-    const unsigned base = basefield == ios_base::oct ? 8 : basefield == ios_base::hex ? 16 : 10;
-    unsigned rem = static_cast<unsigned>(max_val % base);
-    const ctype_base::mask base_mask = base == 16 ? ctype_base::xdigit : ctype_base::digit;
-
-    // parse state
-    bool minus = false, sign_extracted = false, prefix_extracted = false, overflow = false;
-
-    storage_type value = 0, max_base_val = max_val / base;
-
-    // NOTE: may be bad/fail bit on format error?
-    static const ios_base::iostate bad_format = ios_base::failbit;
-
-    prefix_extracted = base != 8 && base != 16; // 8 & 16 have special prefix
-
-    size_t ic = 0; // number of digits extracted
-    do{
-      char_type c = *in;
-      if(in == end)
-        break;
-
-      if(base != 16 && value != 0 && group_width > 0 && c == thousands_sep) // skip group separator in the middle of digits (only in octal or decimal base)
-        continue;
-
-      if(c == '-' || c == '+'){
-        if(sign_extracted || ic > 0)  // break on second sign or in the middle of number ("+123-456" == 123, -456)
-          break;
-        sign_extracted = true;
-        minus = c == '-';
-        if(minus){
-          max_base_val = static_cast<storage_type>(min_val);
-          rem = static_cast<unsigned>(max_base_val % base);
-        }
-        continue;
-      }
-
-      // skip prefix
-      if(!prefix_extracted && c == '0'){
-        ++ic;
+    const bool grouping = !np.grouping().empty();
+    if(!base){
+      const ios_base::fmtflags basefield = str.flags() & ios_base::basefield;
+      base = basefield == ios_base::oct ? 8 : basefield == ios_base::hex ? 16 : 10;
+    }
+
+    static const char src_atoms[] = "0123456789abcdefABCDEFxX+-";
+    enum { zero, lower_a = 10, upper_a = 16, lower_x = 22, upper_x, plus, minus, atoms_count };
+    char_type atoms[atoms_count];
+    use_facet< ctype<char_type> >(str.getloc()).widen(src_atoms, src_atoms + atoms_count, atoms);
+
+    // the leading zeros are not stored, so the longer numbers are out of range anyway
+    char digits[__::intconv::max_size];
+    size_t count = 0;
+    bool negative = false, valid = false, overflow = false;
+
+    if(in != end && (*in == atoms[plus] || *in == atoms[minus])){
+      negative = *in == atoms[minus];
+      ++in;
+    }
+    if(base == 16 && in != end && *in == atoms[zero]){
+      valid = true;
+      if(++in != end && (*in == atoms[lower_x] || *in == atoms[upper_x]))
+        ++in;
+    }
+    for(; in != end; ++in){
+      const char_type c = *in;
+      if(c == thousands_sep && grouping && valid)
         continue;
+      unsigned digit = static_cast<unsigned>(c - atoms[zero]);
+      if(digit > 9 && base == 16){
+        if((digit = static_cast<unsigned>(c - atoms[lower_a])) < 6 || (digit = static_cast<unsigned>(c - atoms[upper_a])) < 6)
+          digit += 10;
       }
-
-      if(base == 16 && (c == 'x' || c == 'X')){
-        if(prefix_extracted || ic > 1)  // break on 'x' ("0x123x")
-          break;
-        ic--;
-        continue;
-      }
-
-
-      prefix_extracted = true;
-
-      // check is it a valid digit
-      if(!ct.is(base_mask, c))
-        break;
-
-      // its a valid character, use it
-      unsigned digit;
-      if(ct.is(ctype_base::alpha, c))
-        //digit = ct.toupper(c) - 'A' + 10;
-        digit = (c & ~(1 << 5)) - 'A' + 10;
-      else
-        digit = c - '0';
       if(digit >= base)
         break;
-
-      ++ic;
-      if(value < max_base_val || (value == max_base_val && digit <= rem))
-        value = value * base + digit;
-      else{
+      valid = true;
+      if(count == 0 && digit == 0)
+        continue;
+      if(count < sizeof(digits))
+        digits[count++] = __::intconv::lower_digits[digit];
+      else
         overflow = true;
-        break;
-      }
-    }while(++in, true);
-
-    if(overflow)
-      value = minus ? static_cast<storage_type>(min_val) : max_val;
-    else if(minus)
-      value = static_cast<storage_type>( -static_cast<signed_storage_type>(value) );
+    }
 
-    if(ic == 0)
-      err |= bad_format;
     if(in == end)
       err |= ios_base::eofbit;
-    return value;
+    if(!valid){
+      v = 0;
+      err |= ios_base::failbit;
+      return in;
+    }
+
+    typedef typename __::intconv::magnitude<T>::type U;
+    U u;
+    bool range_error;
+    __::intconv::parse(digits, digits + count, u, base, range_error);
+    const bool is_signed = __::intconv::is_signed_type<T>();
+    const U limit = static_cast<U>(numeric_limits<T>::__max) + (is_signed && negative);
+    if(overflow || range_error || u > limit){
+      v = is_signed && negative ? numeric_limits<T>::__min : numeric_limits<T>::__max;
+      err |= ios_base::failbit;
+    }else{
+      v = static_cast<T>(negative ? U(0) - u : u);
+    }
+    return in;
   }
 };
 
@@ -2208,19 +2188,19 @@ class num_put : public locale::facet
 
     _NTL_LOC_VIRTUAL iter_type do_put(iter_type out, ios_base& str, char_type fill, long v) const
     {
-      return put_int(out, str, fill, v, true);
+      return put_int(out, str, fill, v);
     }
     _NTL_LOC_VIRTUAL iter_type do_put(iter_type out, ios_base& str, char_type fill, unsigned long v) const
     {
-      return put_int(out, str, fill, v, false);
+      return put_int(out, str, fill, v);
     }
     _NTL_LOC_VIRTUAL iter_type do_put(iter_type out, ios_base& str, char_type fill, long long v) const
     {
-      return put_int(out, str, fill, v, true, true);
+      return put_int(out, str, fill, v);
     }
     _NTL_LOC_VIRTUAL iter_type do_put(iter_type out, ios_base& str, char_type fill, unsigned long long v) const
     {
-      return put_int(out, str, fill, v, false, true);
+      return put_int(out, str, fill, v);
     }
     _NTL_LOC_VIRTUAL iter_type do_put(iter_type out, ios_base& str, char_type fill, double v) const
     {
@@ -2228,96 +2208,67 @@ class num_put : public locale::facet
     }
     _NTL_LOC_VIRTUAL iter_type do_put(iter_type out, ios_base& str, char_type fill, long double v) const
     {
-      return return put_float(out, str, fill, v);
+      return put_float(out, str, fill, static_cast<double>(v));
     }
     _NTL_LOC_VIRTUAL iter_type do_put(iter_type out, ios_base& str, char_type fill, const void* v) const
     {
-      return put_int(out,str,fill,reinterpret_cast<unsigned long long>(v), false, sizeof(void*) > sizeof(long), true);
+      return put_int(out, str, fill, reinterpret_cast<uintptr_t>(v), true);
     }
     ///\}
   private:
-    static iter_type put_int(iter_type out, ios_base& str, char_type fill, unsigned long long v, bool signed_v, bool long_v = false, bool pointer_v = false)
-    {
-      const ios_base::fmtflags flags = str.flags();
-      const ios_base::fmtflags adjust = flags & ios_base::adjustfield;
-      const ios_base::fmtflags basefield = flags & ios_base::basefield;
-      const bool               uppercase = (flags & ios_base::uppercase) != 0;
-      //const ios_base::fmtflags floatfield = flags & ios_base::floatfield;
-      const bool               showpos = (flags & ios_base::showpos) != 0;
-      const bool               showbase = (flags & ios_base::showbase) != 0;
-
-
-      // [dec, oct, hex] = [0, 2, 4]
-      static const char bases[] = {'u', 'o', 'x'};
-
-      // %[flags] [width] [.precision] [{h | l | ll | I | I32 | I64}]type
-      char fmtbuf[16];
-      char* fmt = fmtbuf;
-      *fmt++ = '%';
-      if(showpos)
-        *fmt++ = '+';
-      if(showbase && !pointer_v) // pointer have a custom prefix always
-        *fmt++ = '#';
-
-      if(pointer_v){
-        *fmt = 'p';
-      }else{
-        if(long_v)
-          *fmt++ = 'I', *fmt++ = '6', *fmt++ = '4';
-
-        *fmt = bases[basefield >> 6]; // (base >> 5) / 2
-
-        if(basefield == ios_base::dec && signed_v)
-          *fmt = 'd';
-        else if(basefield == ios_base::hex && uppercase)
-          *fmt = 'X';
-      }
-      *++fmt = 0;
-
-      char buf[128], *valuebuf = buf; // may not enough if large width
-      streamsize l = _snprintf(buf, _countof(buf), fmtbuf, long_v ? v : static_cast<unsigned long>(v));
-
-      if(basefield == ios_base::hex && showbase && v == 0)
-        pointer_v = true;
+    /**
+     *	The digits are generated by the __::intconv engine and laid out, grouped and padded as the floating point ones.
+     *  The pointers are written as "0x" and all of their hexadecimal digits.
+     **/
+    template<class T>
+    static iter_type put_int(iter_type out, ios_base& str, char_type fill, T v, bool pointer_v = false)
+    {
+      const ios_base::fmtflags flags = str.flags(),
+        basefield = flags & ios_base::basefield,
+        adjust = flags & ios_base::adjustfield;
+      const bool showbase = (flags & ios_base::showbase) != 0,
+        uppercase = pointer_v || (flags & ios_base::uppercase) != 0;
+      const unsigned base = pointer_v || basefield == ios_base::hex ? 16 : basefield == ios_base::oct ? 8 : 10;
+
+      // the values are signed in decimal only, the other bases show their bits
+      typedef typename __::intconv::magnitude<T>::type U;
+      bool negative = false;
+      const U u = base == 10 ? __::intconv::absolute(v, negative) : static_cast<U>(v);
+
+      __::fp::layout l;
+      const int digits = static_cast<int>(__::intconv::length(u, base));
+      // the octal base is shown by a leading zero digit, as by printf %#o
+      const int min_digits = pointer_v ? static_cast<int>(sizeof(void*) * 2) : showbase && base == 8 && u != 0 ? digits + 1 : 0;
+      l.length = digits < min_digits ? min_digits : digits;
+      memset(l.digits, '0', l.length - digits);
+      __::intconv::put_digits(l.digits + l.length, u, base, uppercase);
+      l.integral = l.length;
+      l.fraction_zeros = l.fraction = l.exponent_length = 0;
+      l.point = false;
+      l.grouped = !pointer_v;
+      l.sign = negative ? '-' : base == 10 && (flags & ios_base::showpos) && __::intconv::is_signed_type<T>() ? '+' : 0;
+      l.prefix = pointer_v ? "0x" : showbase && base == 16 && u != 0 ? (uppercase ? "0X" : "0x") : "";
+
+      // group & sep
+      const numpunct<charT>& punct = use_facet< numpunct<charT> >(str.getloc());
+      const string grouping = punct.grouping();
+      const size_t len = __::fp::size(l, grouping.data(), grouping.size());
 
       // adjust
       const streamsize width = str.width();
-      if(width && width > l){
-        streamsize pad = width - l;
-        if(pointer_v)
-          pad -= 2;
-
-        // pad before
-        if(adjust == ios_base::internal && l > 0){
-          if(valuebuf[0] == '-' || valuebuf[0] == '+'){
-            // copy only sign
-            out = copy_n(valuebuf, 1, out);
-            valuebuf++, l--;
-          }else if(basefield == ios_base::hex && showbase){
-            // copy '0x'
-            out = copy_n(valuebuf, 2, out);
-            valuebuf += 2, l -= 2;
-          } else if(pointer_v){
-            out = copy_n("0x",2,out);
-            pointer_v = false;
-          }
-        }
-        if(adjust != ios_base::left)
-          out = __::fill_n(out, pad, fill);
-
-        if(pointer_v)
-          out = copy_n("0x",2,out);
-
-        out = copy_n(valuebuf, l, out);
-
-        // pad after
-        if(adjust == ios_base::left)
-          out = __::fill_n(out, pad, fill);
+      const streamsize pad = width > static_cast<streamsize>(len) ? width - static_cast<streamsize>(len) : 0;
+      if(pad && adjust == ios_base::internal){
+        // pad after the sign and the base prefix
+        out = __::fp::put_prefix<charT>(l, out);
+        out = __::fill_n(out, pad, fill);
       }else{
-        if(pointer_v)
-          out = copy_n("0x",2,out);
-        out = copy_n(valuebuf, l, out);
+        if(pad && adjust != ios_base::left)
+          out = __::fill_n(out, pad, fill);
+        out = __::fp::put_prefix<charT>(l, out);
       }
+      out = __::fp::put_number(l, out, charT(), punct.thousands_sep(), grouping.data(), grouping.size());
+      if(pad && adjust == ios_base::left)
+        out = __::fill_n(out, pad, fill);
       str.width(0);
       return out;
     }
@@ -2328,96 +2279,38 @@ class num_put : public locale::facet
         floatfield = flags & ios_base::floatfield,
         adjust = flags & ios_base::adjustfield;
 
-      static const char type[] = {'g', 'f', 'e', 'a'};
-      // %
-      char fmtbuf[16], *fmt = fmtbuf;
-      *fmt++ = '%';
-      if(flags & ios_base::showpos)
-        *fmt++ = '+';
-      if(flags & ios_base::showpoint)
-        *fmt++ = '#';
-
-      // precision
-      if(floatfield != ios_base::floatfield){
-        *fmt++ = '.';
-        size_t n;
-        ntl::numeric::itoa(str.precision(), fmt, _countof(fmtbuf), 10, &n);
-        fmt += n;
-      }
-      // type
-      *fmt = type[floatfield >> 11];
-      if(flags & ios_base::uppercase)
-        *fmt -= 'a'-'A';
-      fmt[1] = 0;
+      // [general, fixed, scientific, hex], the hexadecimal style ignores the precision
+      static const __::fp::style styles[] = {__::fp::general_style, __::fp::fixed_style, __::fp::scientific_style, __::fp::hex_style};
+      const streamsize precision = str.precision();
+      const unsigned fmt = __::fp::hexprefix
+        | (flags & ios_base::showpos   ? __::fp::showpos   : 0)
+        | (flags & ios_base::showpoint ? __::fp::showpoint : 0)
+        | (flags & ios_base::uppercase ? __::fp::uppercase : 0);
 
-      char floatbuf[128];
-      size_t len = ntl::msvcrt::snprintf(floatbuf, _countof(floatbuf), fmtbuf, v);
+      // the digits are generated directly, without the printf format round trip
+      __::fp::layout l;
+      __::fp::format(l, v, styles[floatfield >> 11],
+        floatfield == ios_base::floatfield ? -1 : precision < 0 ? 6 : precision > INT_MAX ? INT_MAX : static_cast<int>(precision), fmt);
 
-      charT value[128], *valuebuf = value;
-      if(len > 0)
-      {
-        // group & sep
-        const numpunct<charT>& punct = use_facet< numpunct<charT> >(str.getloc());
-        const string vec = punct.grouping();
-        const charT ts = punct.thousands_sep(),
-          ds = punct.decimal_point();
-
-        size_t group = 0, groupsize = 0, groups = vec.size();
-        int i = 0;
-        size_t to = _countof(value) - 1;
-
-        bool nogroup = vec.empty() || memchr(floatbuf, '.', len) != nullptr;
-        if(!nogroup)
-          groupsize = vec[0];
-        
-        for(ssize_t from = len-1; from >= 0; from--, to--, i++){
-          const char c = floatbuf[from];
-          if(nogroup){
-            value[to] = c != '.' ? c : ds;
-
-            if(c == '.'){
-              // setup grouping
-              nogroup = vec.empty();
-              if(!nogroup)
-                groupsize = vec[group];
-              i = -1;
-            }
-            continue;
-          }
-          if(i == groupsize && groupsize > 0 && groupsize != CHAR_MAX 
-            && c != '+' && c != '-'){ // prevent "-,123,456"
-            // new group
-            value[to--] = ts;
-            if(group+1 < groups){
-              groupsize = vec[++group];
-            }
-            i = 0;
-          }
-          value[to] = c;
-        }
-        to++;
-        len = _countof(value) - to;
-        valuebuf = &value[to];
-      }
+      // group & sep
+      const numpunct<charT>& punct = use_facet< numpunct<charT> >(str.getloc());
+      const string grouping = punct.grouping();
+      const size_t len = __::fp::size(l, grouping.data(), grouping.size());
 
       // adjust
-      const size_t width = str.width();
-      const bool need_adjust = width && width > len;
-      streamsize pad = width - len;
-      if(need_adjust){
-        // pad before
-        if(adjust == ios_base::internal && len > 0 && (valuebuf[0] == '-' || valuebuf[0] == '+') ){
-          // copy only sign
-          out = copy_n(valuebuf, 1, out);
-          valuebuf++, len--;
-        }
-        if(adjust != ios_base::left)
+      const streamsize width = str.width();
+      const streamsize pad = width > static_cast<streamsize>(len) ? width - static_cast<streamsize>(len) : 0;
+      if(pad && adjust == ios_base::internal){
+        // pad after the sign and 0x
+        out = __::fp::put_prefix<charT>(l, out);
+        out = __::fill_n(out, pad, fill);
+      }else{
+        if(pad && adjust != ios_base::left)
           out = __::fill_n(out, pad, fill);
+        out = __::fp::put_prefix<charT>(l, out);
       }
-
-      out = copy_n(valuebuf, len, out);
-
-      if(need_adjust && adjust == ios_base::left)    // after
+      out = __::fp::put_number(l, out, punct.decimal_point(), punct.thousands_sep(), grouping.data(), grouping.size());
+      if(pad && adjust == ios_base::left)
         out = __::fill_n(out, pad, fill);
       str.width(0);
       return out;
@@ -343,6 +343,15 @@ public:
       }
     }
 
+    ///\name Set operations extension
+    /** Moves the elements of \c x with the keys which are not in this map, others are left in \c x. Runs in linear time. */
+    void merge(map<Key,T,Compare,Allocator>& x) { tree_type::merge(x); }
+    /** Inserts the copies of the elements of \c x with the keys which are not in this map. Runs in linear time. */
+    void unite(const map<Key,T,Compare,Allocator>& x) { tree_type::unite(x); }
+    /** Erases the elements with the keys which are not in \c x. Runs in linear time. */
+    void intersect(const map<Key,T,Compare,Allocator>& x) { tree_type::intersect(x); }
+    ///\}
+
     // observers:
     key_compare key_comp() const { return val_comp_.comp; }
     value_compare value_comp() const { return val_comp_; }
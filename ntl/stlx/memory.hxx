@@ -321,6 +321,59 @@ inline bool operator!=(const allocator<T>&, const allocator<U>&) __ntl_nothrow
 
 ///\}
 
+namespace ext
+{
+  ///\name Relocation and in-place growth of the container storage
+
+  /**
+   *	@brief Whether an object of \c T can be moved to another address by copying its bytes
+   *  @details The source is not destroyed after such move, so the containers relocate their elements with a
+   *  single memcpy. True for the trivially copyable types; specialize it as true_type for a type which doesn't
+   *  keep pointers to itself or to its parts.
+   **/
+  template<class T>
+  struct is_trivially_relocatable:
+    integral_constant<bool, has_trivial_copy_constructor<T>::value && has_trivial_destructor<T>::value>
+  {};
+
+  /** The default allocator has no state */
+  template<class T>
+  struct is_trivially_relocatable<allocator<T> >: true_type {};
+
+  /**
+   *	@brief Growth of the allocated blocks in place
+   *  @details An allocator which can grow a block without moving it declares the member
+   *  <tt>bool expand(pointer p, size_type n, size_type m)</tt>: it resizes the block \p p of \p n objects
+   *  to \p m objects, or fails and leaves the block intact. The containers try it before they allocate a new block
+   *  and move the elements; for the other allocators expand() fails.
+   **/
+  template<class Alloc>
+  struct allocator_expansion
+  {
+    typedef typename Alloc::pointer   pointer;
+    typedef typename Alloc::size_type size_type;
+
+  private:
+    template<class A, bool (A::*)(pointer, size_type, size_type)> struct probe;
+    template<class A> static char test(probe<A, &A::expand>*);
+    template<class A> static char (&test(...))[2];
+
+  public:
+    /** Whether \c Alloc declares expand() */
+    static const bool value = sizeof(test<Alloc>(0)) == 1;
+
+    static bool expand(Alloc& a, pointer p, size_type n, size_type m)
+    {
+      return expand(a, p, n, m, integral_constant<bool, value>());
+    }
+
+  private:
+    static bool expand(Alloc& a, pointer p, size_type n, size_type m, true_type) { return a.expand(p, n, m); }
+    static bool expand(Alloc&, pointer, size_type, size_type, false_type) { return false; }
+  };
+  ///\}
+}
+
 ///\ 20.6.6 Scoped allocator adaptor [allocator.adaptor]
 template <class OuterA, class InnerA = void>
 class scoped_allocator_adaptor;
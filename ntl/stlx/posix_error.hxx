@@ -121,5 +121,8 @@ namespace std
   using posix_error::make_error_code;
   using posix_error::make_error_condition;
 
+  /** The portable error conditions by their C++11 name */
+  typedef posix_error::posix_errno errc;
+
   /** @} syserr */
 }
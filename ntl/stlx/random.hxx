@@ -14,6 +14,7 @@
 #include "ratio.hxx"
 #include "cmath.hxx"
 #include "ext/numeric_conversions.hxx"
+#include "../cpu.hxx"
 
 #ifndef NTL_CXX_CONSTEXPR
 //#pragma push_macro("constexpr")
@@ -26,15 +27,12 @@ namespace ntl
 #ifdef _MSC_VER_PURE
   namespace intrinsic
   {
-    NTL_EXTERNAPI void __cdecl __cpuid(int cpuInfo[4], int function_id);
-    NTL_EXTERNAPI void __cdecl __cpuidex(int cpuInfo[4], int function_id, int subfunction_id);
-
     NTL_EXTERNAPI int __cdecl _rdrand16_step(uint16_t* val);
     NTL_EXTERNAPI int __cdecl _rdrand32_step(uint32_t* val);
     NTL_EXTERNAPI int __cdecl _rdseed16_step(uint16_t* val);
     NTL_EXTERNAPI int __cdecl _rdseed32_step(uint32_t* val);
 
-    #pragma intrinsic(_rdrand16_step, _rdrand32_step, _rdseed16_step, _rdseed32_step, __cpuid, __cpuidex)
+    #pragma intrinsic(_rdrand16_step, _rdrand32_step, _rdseed16_step, _rdseed32_step)
 #ifdef _M_X64
     NTL_EXTERNAPI int __cdecl _rdrand64_step(uint64_t* val);
     NTL_EXTERNAPI int __cdecl _rdseed64_step(uint64_t* val);
@@ -12,6 +12,11 @@
 #include "iosfwd.hxx"
 #include "stdexcept.hxx"
 #include "locale.hxx"
+#include "cstring.hxx"
+#include "vector.hxx"
+#include "memory.hxx"
+#include "iterator.hxx"
+#include "algorithm.hxx"
 
 namespace std
 {
@@ -19,33 +24,33 @@ namespace std
   // 28.5, regex constants:
   namespace regex_constants {
     typedef unsigned syntax_option_type;
-    static const syntax_option_type icase;
-    static const syntax_option_type nosubs;
-    static const syntax_option_type optimize;
-    static const syntax_option_type collate;
-    static const syntax_option_type ECMAScript;
-    static const syntax_option_type basic;
-    static const syntax_option_type extended;
-    static const syntax_option_type awk;
-    static const syntax_option_type grep;
-    static const syntax_option_type egrep;
+    static const syntax_option_type icase      = 1 << 0;
+    static const syntax_option_type nosubs     = 1 << 1;
+    static const syntax_option_type optimize   = 1 << 2;
+    static const syntax_option_type collate    = 1 << 3;
+    static const syntax_option_type ECMAScript = 1 << 4;
+    static const syntax_option_type basic      = 1 << 5;
+    static const syntax_option_type extended   = 1 << 6;
+    static const syntax_option_type awk        = 1 << 7;
+    static const syntax_option_type grep       = 1 << 8;
+    static const syntax_option_type egrep      = 1 << 9;
 
     typedef unsigned match_flag_type;
-    static const match_flag_type match_default = 0;
-    static const match_flag_type match_not_bol;
-    static const match_flag_type match_not_eol;
-    static const match_flag_type match_not_bow;
-    static const match_flag_type match_not_eow;
-    static const match_flag_type match_any;
-    static const match_flag_type match_not_null;
-    static const match_flag_type match_continuous;
-    static const match_flag_type match_prev_avail;
-    static const match_flag_type format_default = 0;
-    static const match_flag_type format_sed;
-    static const match_flag_type format_no_copy;
-    static const match_flag_type format_first_only;
-
-    enum error_type 
+    static const match_flag_type match_default     = 0;
+    static const match_flag_type match_not_bol     = 1 << 0;
+    static const match_flag_type match_not_eol     = 1 << 1;
+    static const match_flag_type match_not_bow     = 1 << 2;
+    static const match_flag_type match_not_eow     = 1 << 3;
+    static const match_flag_type match_any         = 1 << 4;
+    static const match_flag_type match_not_null    = 1 << 5;
+    static const match_flag_type match_continuous  = 1 << 6;
+    static const match_flag_type match_prev_avail  = 1 << 7;
+    static const match_flag_type format_default    = 0;
+    static const match_flag_type format_sed        = 1 << 8;
+    static const match_flag_type format_no_copy    = 1 << 9;
+    static const match_flag_type format_first_only = 1 << 10;
+
+    enum error_type
     {
       error_collate,
       error_ctype,
@@ -64,11 +69,35 @@ namespace std
   } // namespace regex_constants
 
   // 28.6, class regex_error:
-  class regex_error: public std::runtime_error 
+  class regex_error: public std::runtime_error
   {
   public:
-    explicit regex_error(regex_constants::error_type ecode);
-    regex_constants::error_type code() const;
+    explicit regex_error(regex_constants::error_type ecode)
+      :runtime_error(message(ecode)), ecode(ecode)
+    {}
+    regex_constants::error_type code() const { return ecode; }
+  private:
+    regex_constants::error_type ecode;
+
+    static const char* message(regex_constants::error_type e)
+    {
+      static const char* const messages[] = {
+        "invalid collating element name",
+        "invalid character class name",
+        "invalid escaped character or trailing escape",
+        "invalid back reference",
+        "mismatched [ and ]",
+        "mismatched ( and )",
+        "mismatched { and }",
+        "invalid range in a {} expression",
+        "invalid character range",
+        "regular expression is too large",
+        "nothing to repeat",
+        "regular expression can't be matched in linear time",
+        "regular expression is nested too deeply"
+      };
+      return static_cast<size_t>(e) < sizeof(messages) / sizeof(*messages) ? messages[e] : "regular expression error";
+    }
   };
 
   // 28.7, class template regex_traits:
@@ -78,34 +107,110 @@ namespace std
     typedef charT char_type;
     typedef std::basic_string<char_type> string_type;
     typedef std::locale locale_type;
-    typedef bitmask_type char_class_type;
+    typedef unsigned char_class_type;
+
+    regex_traits()
+    {}
 
-    regex_traits();
+    static std::size_t length(const char_type* p) { return char_traits<char_type>::length(p); }
+    charT translate(charT c) const { return c; }
+    charT translate_nocase(charT c) const { return use_facet<ctype<charT> >(loc).tolower(c); }
 
-    static std::size_t length(const char_type* p);
-    charT translate(charT c) const;
-    charT translate_nocase(charT c) const;
-    
     template <class ForwardIterator>
-    string_type transform(ForwardIterator first, ForwardIterator last) const;
+    string_type transform(ForwardIterator first, ForwardIterator last) const
+    {
+      return string_type(first, last);
+    }
     template <class ForwardIterator>
-    string_type transform_primary(ForwardIterator first, ForwardIterator last) const;
+    string_type transform_primary(ForwardIterator first, ForwardIterator last) const
+    {
+      string_type s(first, last);
+      for(typename string_type::iterator i = s.begin(); i != s.end(); ++i)
+        *i = translate_nocase(*i);
+      return s;
+    }
+    /** Only the single characters name themselves */
     template <class ForwardIterator>
-    string_type lookup_collatename(ForwardIterator first, ForwardIterator last) const;
+    string_type lookup_collatename(ForwardIterator first, ForwardIterator last) const
+    {
+      const string_type s(first, last);
+      return s.size() == 1 ? s : string_type();
+    }
 
     template <class ForwardIterator>
-    char_class_type lookup_classname(ForwardIterator first, ForwardIterator last, bool icase = false) const;
+    char_class_type lookup_classname(ForwardIterator first, ForwardIterator last, bool icase = false) const
+    {
+      static const struct { const char* name; char_class_type mask; } classes[] = {
+        { "alnum", static_cast<uint16_t>(ctype_base::alnum) }, { "alpha", static_cast<uint16_t>(ctype_base::alpha) },
+        { "blank", static_cast<uint16_t>(ctype_base::blank) }, { "cntrl", static_cast<uint16_t>(ctype_base::cntrl) },
+        { "d", static_cast<uint16_t>(ctype_base::digit) },     { "digit", static_cast<uint16_t>(ctype_base::digit) },
+        { "graph", static_cast<uint16_t>(ctype_base::graph) }, { "lower", static_cast<uint16_t>(ctype_base::lower) },
+        { "print", static_cast<uint16_t>(ctype_base::print) }, { "punct", static_cast<uint16_t>(ctype_base::punct) },
+        { "s", static_cast<uint16_t>(ctype_base::space) },     { "space", static_cast<uint16_t>(ctype_base::space) },
+        { "upper", static_cast<uint16_t>(ctype_base::upper) }, { "w", static_cast<uint16_t>(ctype_base::alnum) | underscore },
+        { "xdigit", static_cast<uint16_t>(ctype_base::xdigit) }
+      };
+      char name[8];
+      size_t n = 0;
+      for(; first != last; ++first){
+        const charT c = *first;
+        if(n == sizeof(name) - 1 || c < charT('A') || c > charT('z'))
+          return 0;
+        name[n++] = static_cast<char>(c) | 0x20;
+      }
+      name[n] = 0;
+      for(size_t i = 0; i < sizeof(classes) / sizeof(*classes); i++)
+        if(std::strcmp(name, classes[i].name) == 0)
+          return icase && (classes[i].mask & static_cast<uint16_t>(ctype_base::alpha)) ? classes[i].mask | static_cast<uint16_t>(ctype_base::alpha) : classes[i].mask;
+      return 0;
+    }
+
+    bool isctype(charT c, char_class_type f) const
+    {
+      const char_class_type m = f & 0xFFFF;
+      return (m && use_facet<ctype<charT> >(loc).is(static_cast<ctype_base::mask>(m), c)) || ((f & underscore) && c == charT('_'));
+    }
+
+    int value(charT ch, int radix) const
+    {
+      int v = -1;
+      if(ch >= charT('0') && ch <= charT('9'))
+        v = static_cast<int>(ch - charT('0'));
+      else if(ch >= charT('a') && ch <= charT('f'))
+        v = static_cast<int>(ch - charT('a')) + 10;
+      else if(ch >= charT('A') && ch <= charT('F'))
+        v = static_cast<int>(ch - charT('A')) + 10;
+      return v < radix ? v : -1;
+    }
+
+    locale_type imbue(locale_type l)
+    {
+      std::swap(loc, l);
+      return l;
+    }
+    locale_type getloc()const { return loc; }
 
-    bool isctype(charT c, char_class_type f) const;
-    int value(charT ch, int radix) const;
-    locale_type imbue(locale_type l);
-    locale_type getloc()const;
+  private:
+    static const char_class_type underscore = 1 << 16;
+    locale_type loc;
   };
 
+} // std
+
+#include "ext/regex_engine.hxx"
+
+namespace std
+{
+  namespace __ { namespace re {
+    struct access;
+  }}
+
   // 28.8, class template basic_regex:
   template <class charT, class traits = regex_traits<charT> >
   class basic_regex
   {
+    friend struct __::re::access;
+    typedef __::re::program<charT, traits> program_type;
   public:
     // types:
     typedef charT value_type;
@@ -125,43 +230,110 @@ namespace std
     static const regex_constants::syntax_option_type egrep      = regex_constants::egrep;
 
     // 28.8.2, construct/copy/destroy:
-    basic_regex();
+    /** The empty expression, it matches nothing */
+    basic_regex()
+      :flags_()
+    {}
 
-    explicit basic_regex(const charT* p, flag_type f = regex_constants::ECMAScript);
-    basic_regex(const charT* p, size_t len, flag_type f);
-    basic_regex(const basic_regex&);
+    explicit basic_regex(const charT* p, flag_type f = regex_constants::ECMAScript)
+    {
+      assign(p, f);
+    }
+    basic_regex(const charT* p, size_t len, flag_type f)
+    {
+      assign(p, len, f);
+    }
+    basic_regex(const basic_regex& e)
+      :traits_(e.traits_), prog(e.prog), flags_(e.flags_)
+    {}
     template <class ST, class SA>
-    explicit basic_regex(const basic_string<charT, ST, SA>& p, flag_type f = regex_constants::ECMAScript);
+    explicit basic_regex(const basic_string<charT, ST, SA>& p, flag_type f = regex_constants::ECMAScript)
+    {
+      assign(p, f);
+    }
     template <class ForwardIterator>
-    basic_regex(ForwardIterator first, ForwardIterator last, flag_type f = regex_constants::ECMAScript);
-    basic_regex(initializer_list<charT>, flag_type = regex_constants::ECMAScript);
-    ~basic_regex();
+    basic_regex(ForwardIterator first, ForwardIterator last, flag_type f = regex_constants::ECMAScript)
+    {
+      assign(first, last, f);
+    }
+    basic_regex(initializer_list<charT> il, flag_type f = regex_constants::ECMAScript)
+    {
+      assign(il, f);
+    }
+    ~basic_regex()
+    {}
 
-    basic_regex& operator=(const basic_regex&);
-    basic_regex& operator=(const charT* ptr);
+    basic_regex& operator=(const basic_regex& e) { return assign(e); }
+    basic_regex& operator=(const charT* ptr) { return assign(ptr); }
     template <class ST, class SA>
-    basic_regex& operator=(const basic_string<charT, ST, SA>& p);
-    
+    basic_regex& operator=(const basic_string<charT, ST, SA>& p) { return assign(p); }
+
     // 28.8.3, assign:
-    basic_regex& assign(const basic_regex& that);
-    basic_regex& assign(const charT* ptr, flag_type f = regex_constants::ECMAScript);
-    basic_regex& assign(const charT* p, size_t len, flag_type f);
+    basic_regex& assign(const basic_regex& that)
+    {
+      traits_ = that.traits_;
+      prog = that.prog;
+      flags_ = that.flags_;
+      return *this;
+    }
+    basic_regex& assign(const charT* ptr, flag_type f = regex_constants::ECMAScript)
+    {
+      return assign(ptr, traits::length(ptr), f);
+    }
+    /** Compiles the pattern, throws regex_error and keeps the previous one if it is invalid */
+    basic_regex& assign(const charT* p, size_t len, flag_type f)
+    {
+      using namespace regex_constants;
+      if(!(f & (ECMAScript | basic | extended | awk | grep | egrep)))
+        f |= ECMAScript;
+      shared_ptr<program_type> compiled(new program_type(traits_, f));
+      __::re::compiler<charT, traits>(*compiled, p, p + len).compile();
+      prog = compiled;
+      flags_ = f;
+      return *this;
+    }
     template <class string_traits, class A>
-    basic_regex& assign(const basic_string<charT, string_traits, A>& s, flag_type f = regex_constants::ECMAScript);
+    basic_regex& assign(const basic_string<charT, string_traits, A>& s, flag_type f = regex_constants::ECMAScript)
+    {
+      return assign(s.data(), s.size(), f);
+    }
     template <class InputIterator>
-    basic_regex& assign(InputIterator first, InputIterator last, flag_type f = regex_constants::ECMAScript);
-    basic_regex& assign(initializer_list<charT>, flag_type = regex_constants::ECMAScript);
+    basic_regex& assign(InputIterator first, InputIterator last, flag_type f = regex_constants::ECMAScript)
+    {
+      const basic_string<charT> s(first, last);
+      return assign(s.data(), s.size(), f);
+    }
+    basic_regex& assign(initializer_list<charT> il, flag_type f = regex_constants::ECMAScript)
+    {
+      return assign(il.begin(), il.size(), f);
+    }
 
     // 28.8.4, const operations:
-    unsigned mark_count() const;
-    flag_type flags() const;
-    
+    unsigned mark_count() const { return prog ? prog->marks : 0; }
+    flag_type flags() const { return flags_; }
+
     // 28.8.5, locale:
-    locale_type imbue(locale_type loc);
-    locale_type getloc() const;
-    
+    /** Sets the locale, the expression becomes empty */
+    locale_type imbue(locale_type loc)
+    {
+      prog.reset();
+      flags_ = 0;
+      return traits_.imbue(loc);
+    }
+    locale_type getloc() const { return traits_.getloc(); }
+
     // 28.8.6, swap:
-    void swap(basic_regex&);
+    void swap(basic_regex& e)
+    {
+      std::swap(traits_, e.traits_);
+      prog.swap(e.prog);
+      std::swap(flags_, e.flags_);
+    }
+
+  private:
+    traits traits_;
+    shared_ptr<program_type> prog;    // shared by the copies, immutable but for the DFA caches
+    flag_type flags_;
   };
   typedef basic_regex<char> regex;
   typedef basic_regex<wchar_t> wregex;
@@ -175,7 +347,7 @@ namespace std
 
   // 28.9, class template sub_match:
   template <class BidirectionalIterator>
-  class sub_match: public std::pair<BidirectionalIterator, BidirectionalIterator> 
+  class sub_match: public std::pair<BidirectionalIterator, BidirectionalIterator>
   {
   public:
     typedef typename iterator_traits<BidirectionalIterator>::value_type value_type;
@@ -184,13 +356,17 @@ namespace std
 
     bool matched;
 
-    difference_type length() const;
-    operator basic_string<value_type>() const;
-    basic_string<value_type> str() const;
+    sub_match()
+      :matched()
+    {}
+
+    difference_type length() const { return matched ? std::distance(this->first, this->second) : 0; }
+    operator basic_string<value_type>() const { return str(); }
+    basic_string<value_type> str() const { return matched ? basic_string<value_type>(this->first, this->second) : basic_string<value_type>(); }
 
-    int compare(const sub_match& s) const;
-    int compare(const basic_string<value_type>& s) const;
-    int compare(const value_type* s) const;
+    int compare(const sub_match& s) const { return str().compare(s.str()); }
+    int compare(const basic_string<value_type>& s) const { return str().compare(s); }
+    int compare(const value_type* s) const { return str().compare(s); }
   };
   typedef sub_match<const char*> csub_match;
   typedef sub_match<const wchar_t*> wcsub_match;
@@ -199,104 +375,122 @@ namespace std
 
   // 28.9.2, sub_match non-member operators:
   template <class BiIter>
-  bool operator==(const sub_match<BiIter>& lhs, const sub_match<BiIter>& rhs);
+  inline bool operator==(const sub_match<BiIter>& lhs, const sub_match<BiIter>& rhs) { return lhs.compare(rhs) == 0; }
   template <class BiIter>
-  bool operator!=(const sub_match<BiIter>& lhs, const sub_match<BiIter>& rhs);
+  inline bool operator!=(const sub_match<BiIter>& lhs, const sub_match<BiIter>& rhs) { return lhs.compare(rhs) != 0; }
   template <class BiIter>
-  bool operator<(const sub_match<BiIter>& lhs, const sub_match<BiIter>& rhs);
+  inline bool operator<(const sub_match<BiIter>& lhs, const sub_match<BiIter>& rhs) { return lhs.compare(rhs) < 0; }
   template <class BiIter>
-  bool operator<=(const sub_match<BiIter>& lhs, const sub_match<BiIter>& rhs);
+  inline bool operator<=(const sub_match<BiIter>& lhs, const sub_match<BiIter>& rhs) { return lhs.compare(rhs) <= 0; }
   template <class BiIter>
-  bool operator>=(const sub_match<BiIter>& lhs, const sub_match<BiIter>& rhs);
+  inline bool operator>=(const sub_match<BiIter>& lhs, const sub_match<BiIter>& rhs) { return lhs.compare(rhs) >= 0; }
   template <class BiIter>
-  bool operator>(const sub_match<BiIter>& lhs, const sub_match<BiIter>& rhs);
-  
+  inline bool operator>(const sub_match<BiIter>& lhs, const sub_match<BiIter>& rhs) { return lhs.compare(rhs) > 0; }
+
+  namespace __ { namespace re {
+    template <class BiIter, class ST, class SA>
+    inline int compare(const sub_match<BiIter>& m, const basic_string<typename iterator_traits<BiIter>::value_type, ST, SA>& s)
+    {
+      return m.compare(basic_string<typename iterator_traits<BiIter>::value_type>(s.data(), s.size()));
+    }
+    template <class BiIter>
+    inline int compare(const sub_match<BiIter>& m, typename iterator_traits<BiIter>::value_type const& c)
+    {
+      return m.compare(basic_string<typename iterator_traits<BiIter>::value_type>(1, c));
+    }
+  }}
+
   template <class BiIter, class ST, class SA>
-  bool operator==(const basic_string<typename iterator_traits<BiIter>::value_type, ST, SA>& lhs, const sub_match<BiIter>& rhs);
+  inline bool operator==(const basic_string<typename iterator_traits<BiIter>::value_type, ST, SA>& lhs, const sub_match<BiIter>& rhs) { return __::re::compare(rhs, lhs) == 0; }
   template <class BiIter, class ST, class SA>
-  bool operator!=(const basic_string<typename iterator_traits<BiIter>::value_type, ST, SA>& lhs, const sub_match<BiIter>& rhs);
+  inline bool operator!=(const basic_string<typename iterator_traits<BiIter>::value_type, ST, SA>& lhs, const sub_match<BiIter>& rhs) { return __::re::compare(rhs, lhs) != 0; }
   template <class BiIter, class ST, class SA>
-  bool operator<(const basic_string<typename iterator_traits<BiIter>::value_type, ST, SA>& lhs, const sub_match<BiIter>& rhs);
+  inline bool operator<(const basic_string<typename iterator_traits<BiIter>::value_type, ST, SA>& lhs, const sub_match<BiIter>& rhs) { return __::re::compare(rhs, lhs) > 0; }
   template <class BiIter, class ST, class SA>
-  bool operator>(const basic_string<typename iterator_traits<BiIter>::value_type, ST, SA>& lhs, const sub_match<BiIter>& rhs);
+  inline bool operator>(const basic_string<typename iterator_traits<BiIter>::value_type, ST, SA>& lhs, const sub_match<BiIter>& rhs) { return __::re::compare(rhs, lhs) < 0; }
   template <class BiIter, class ST, class SA>
-  bool operator>=(const basic_string<typename iterator_traits<BiIter>::value_type, ST, SA>& lhs, const sub_match<BiIter>& rhs);
+  inline bool operator>=(const basic_string<typename iterator_traits<BiIter>::value_type, ST, SA>& lhs, const sub_match<BiIter>& rhs) { return __::re::compare(rhs, lhs) <= 0; }
   template <class BiIter, class ST, class SA>
-  bool operator<=(const basic_string<typename iterator_traits<BiIter>::value_type, ST, SA>& lhs, const sub_match<BiIter>& rhs);
+  inline bool operator<=(const basic_string<typename iterator_traits<BiIter>::value_type, ST, SA>& lhs, const sub_match<BiIter>& rhs) { return __::re::compare(rhs, lhs) >= 0; }
   template <class BiIter, class ST, class SA>
-  bool operator==(const sub_match<BiIter>& lhs, const basic_string<typename iterator_traits<BiIter>::value_type, ST, SA>& rhs);
+  inline bool operator==(const sub_match<BiIter>& lhs, const basic_string<typename iterator_traits<BiIter>::value_type, ST, SA>& rhs) { return __::re::compare(lhs, rhs) == 0; }
   template <class BiIter, class ST, class SA>
-  bool operator!=(const sub_match<BiIter>& lhs, const basic_string<typename iterator_traits<BiIter>::value_type, ST, SA>& rhs);
+  inline bool operator!=(const sub_match<BiIter>& lhs, const basic_string<typename iterator_traits<BiIter>::value_type, ST, SA>& rhs) { return __::re::compare(lhs, rhs) != 0; }
   template <class BiIter, class ST, class SA>
-  bool operator<(const sub_match<BiIter>& lhs, const basic_string<typename iterator_traits<BiIter>::value_type, ST, SA>& rhs);
+  inline bool operator<(const sub_match<BiIter>& lhs, const basic_string<typename iterator_traits<BiIter>::value_type, ST, SA>& rhs) { return __::re::compare(lhs, rhs) < 0; }
   template <class BiIter, class ST, class SA>
-  bool operator>(const sub_match<BiIter>& lhs, const basic_string<typename iterator_traits<BiIter>::value_type, ST, SA>& rhs);
+  inline bool operator>(const sub_match<BiIter>& lhs, const basic_string<typename iterator_traits<BiIter>::value_type, ST, SA>& rhs) { return __::re::compare(lhs, rhs) > 0; }
   template <class BiIter, class ST, class SA>
-  bool operator>=(const sub_match<BiIter>& lhs, const basic_string<typename iterator_traits<BiIter>::value_type, ST, SA>& rhs);
+  inline bool operator>=(const sub_match<BiIter>& lhs, const basic_string<typename iterator_traits<BiIter>::value_type, ST, SA>& rhs) { return __::re::compare(lhs, rhs) >= 0; }
   template <class BiIter, class ST, class SA>
-  bool operator<=(const sub_match<BiIter>& lhs, const basic_string<typename iterator_traits<BiIter>::value_type, ST, SA>& rhs);
+  inline bool operator<=(const sub_match<BiIter>& lhs, const basic_string<typename iterator_traits<BiIter>::value_type, ST, SA>& rhs) { return __::re::compare(lhs, rhs) <= 0; }
 
   template <class BiIter>
-  bool operator==(typename iterator_traits<BiIter>::value_type const* lhs, const sub_match<BiIter>& rhs);
+  inline bool operator==(typename iterator_traits<BiIter>::value_type const* lhs, const sub_match<BiIter>& rhs) { return rhs.compare(lhs) == 0; }
   template <class BiIter>
-  bool operator!=(typename iterator_traits<BiIter>::value_type const* lhs, const sub_match<BiIter>& rhs);
+  inline bool operator!=(typename iterator_traits<BiIter>::value_type const* lhs, const sub_match<BiIter>& rhs) { return rhs.compare(lhs) != 0; }
   template <class BiIter>
-  bool operator<(typename iterator_traits<BiIter>::value_type const* lhs, const sub_match<BiIter>& rhs);
+  inline bool operator<(typename iterator_traits<BiIter>::value_type const* lhs, const sub_match<BiIter>& rhs) { return rhs.compare(lhs) > 0; }
   template <class BiIter>
-  bool operator>(typename iterator_traits<BiIter>::value_type const* lhs, const sub_match<BiIter>& rhs);
+  inline bool operator>(typename iterator_traits<BiIter>::value_type const* lhs, const sub_match<BiIter>& rhs) { return rhs.compare(lhs) < 0; }
   template <class BiIter>
-  bool operator>=(typename iterator_traits<BiIter>::value_type const* lhs, const sub_match<BiIter>& rhs);
+  inline bool operator>=(typename iterator_traits<BiIter>::value_type const* lhs, const sub_match<BiIter>& rhs) { return rhs.compare(lhs) <= 0; }
   template <class BiIter>
-  bool operator<=(typename iterator_traits<BiIter>::value_type const* lhs, const sub_match<BiIter>& rhs);
+  inline bool operator<=(typename iterator_traits<BiIter>::value_type const* lhs, const sub_match<BiIter>& rhs) { return rhs.compare(lhs) >= 0; }
   template <class BiIter>
-  bool operator==(const sub_match<BiIter>& lhs, typename iterator_traits<BiIter>::value_type const* rhs);
+  inline bool operator==(const sub_match<BiIter>& lhs, typename iterator_traits<BiIter>::value_type const* rhs) { return lhs.compare(rhs) == 0; }
   template <class BiIter>
-  bool operator!=(const sub_match<BiIter>& lhs, typename iterator_traits<BiIter>::value_type const* rhs);
+  inline bool operator!=(const sub_match<BiIter>& lhs, typename iterator_traits<BiIter>::value_type const* rhs) { return lhs.compare(rhs) != 0; }
   template <class BiIter>
-  bool operator<(const sub_match<BiIter>& lhs, typename iterator_traits<BiIter>::value_type const* rhs);
+  inline bool operator<(const sub_match<BiIter>& lhs, typename iterator_traits<BiIter>::value_type const* rhs) { return lhs.compare(rhs) < 0; }
   template <class BiIter>
-  bool operator>(const sub_match<BiIter>& lhs, typename iterator_traits<BiIter>::value_type const* rhs);
+  inline bool operator>(const sub_match<BiIter>& lhs, typename iterator_traits<BiIter>::value_type const* rhs) { return lhs.compare(rhs) > 0; }
   template <class BiIter>
-  bool operator>=(const sub_match<BiIter>& lhs, typename iterator_traits<BiIter>::value_type const* rhs);
+  inline bool operator>=(const sub_match<BiIter>& lhs, typename iterator_traits<BiIter>::value_type const* rhs) { return lhs.compare(rhs) >= 0; }
   template <class BiIter>
-  bool operator<=(const sub_match<BiIter>& lhs, typename iterator_traits<BiIter>::value_type const* rhs);
+  inline bool operator<=(const sub_match<BiIter>& lhs, typename iterator_traits<BiIter>::value_type const* rhs) { return lhs.compare(rhs) <= 0; }
   template <class BiIter>
-  bool operator==(typename iterator_traits<BiIter>::value_type const& lhs, const sub_match<BiIter>& rhs);
+  inline bool operator==(typename iterator_traits<BiIter>::value_type const& lhs, const sub_match<BiIter>& rhs) { return __::re::compare(rhs, lhs) == 0; }
   template <class BiIter>
-  bool operator!=(typename iterator_traits<BiIter>::value_type const& lhs, const sub_match<BiIter>& rhs);
+  inline bool operator!=(typename iterator_traits<BiIter>::value_type const& lhs, const sub_match<BiIter>& rhs) { return __::re::compare(rhs, lhs) != 0; }
   template <class BiIter>
-  bool operator<(typename iterator_traits<BiIter>::value_type const& lhs, const sub_match<BiIter>& rhs);
+  inline bool operator<(typename iterator_traits<BiIter>::value_type const& lhs, const sub_match<BiIter>& rhs) { return __::re::compare(rhs, lhs) > 0; }
   template <class BiIter>
-  bool operator>(typename iterator_traits<BiIter>::value_type const& lhs, const sub_match<BiIter>& rhs);
+  inline bool operator>(typename iterator_traits<BiIter>::value_type const& lhs, const sub_match<BiIter>& rhs) { return __::re::compare(rhs, lhs) < 0; }
   template <class BiIter>
-  bool operator>=(typename iterator_traits<BiIter>::value_type const& lhs, const sub_match<BiIter>& rhs);
+  inline bool operator>=(typename iterator_traits<BiIter>::value_type const& lhs, const sub_match<BiIter>& rhs) { return __::re::compare(rhs, lhs) <= 0; }
   template <class BiIter>
-  bool operator<=(typename iterator_traits<BiIter>::value_type const& lhs, const sub_match<BiIter>& rhs);
+  inline bool operator<=(typename iterator_traits<BiIter>::value_type const& lhs, const sub_match<BiIter>& rhs) { return __::re::compare(rhs, lhs) >= 0; }
   template <class BiIter>
-  bool operator==(const sub_match<BiIter>& lhs, typename iterator_traits<BiIter>::value_type const& rhs);
+  inline bool operator==(const sub_match<BiIter>& lhs, typename iterator_traits<BiIter>::value_type const& rhs) { return __::re::compare(lhs, rhs) == 0; }
   template <class BiIter>
-  bool operator!=(const sub_match<BiIter>& lhs, typename iterator_traits<BiIter>::value_type const& rhs);
+  inline bool operator!=(const sub_match<BiIter>& lhs, typename iterator_traits<BiIter>::value_type const& rhs) { return __::re::compare(lhs, rhs) != 0; }
   template <class BiIter>
-  bool operator<(const sub_match<BiIter>& lhs, typename iterator_traits<BiIter>::value_type const& rhs);
+  inline bool operator<(const sub_match<BiIter>& lhs, typename iterator_traits<BiIter>::value_type const& rhs) { return __::re::compare(lhs, rhs) < 0; }
   template <class BiIter>
-  bool operator>(const sub_match<BiIter>& lhs, typename iterator_traits<BiIter>::value_type const& rhs);
+  inline bool operator>(const sub_match<BiIter>& lhs, typename iterator_traits<BiIter>::value_type const& rhs) { return __::re::compare(lhs, rhs) > 0; }
   template <class BiIter>
-  bool operator>=(const sub_match<BiIter>& lhs, typename iterator_traits<BiIter>::value_type const& rhs);
+  inline bool operator>=(const sub_match<BiIter>& lhs, typename iterator_traits<BiIter>::value_type const& rhs) { return __::re::compare(lhs, rhs) >= 0; }
   template <class BiIter>
-  bool operator<=(const sub_match<BiIter>& lhs, typename iterator_traits<BiIter>::value_type const& rhs);
+  inline bool operator<=(const sub_match<BiIter>& lhs, typename iterator_traits<BiIter>::value_type const& rhs) { return __::re::compare(lhs, rhs) <= 0; }
   template <class charT, class ST, class BiIter>
-  basic_ostream<charT, ST>& operator<<(basic_ostream<charT, ST>& os, const sub_match<BiIter>& m);
+  inline basic_ostream<charT, ST>& operator<<(basic_ostream<charT, ST>& os, const sub_match<BiIter>& m)
+  {
+    return os << m.str();
+  }
 
 
   // 28.10, class template match_results:
   template <class BidirectionalIterator, class Allocator = allocator<sub_match<BidirectionalIterator> > >
   class match_results
   {
+    friend struct __::re::access;
+    typedef vector<sub_match<BidirectionalIterator>, Allocator> container;
   public:
     typedef sub_match<BidirectionalIterator> value_type;
     typedef typename Allocator::const_reference const_reference;
     typedef const_reference reference;
-    typedef implementation defined const_iterator;
+    typedef typename container::const_iterator const_iterator;
     typedef const_iterator iterator;
     typedef typename iterator_traits<BidirectionalIterator>::difference_type difference_type;
     typedef typename Allocator::size_type size_type;
@@ -305,53 +499,181 @@ namespace std
     typedef basic_string<char_type> string_type;
 
     // 28.10.1, construct/copy/destroy:
-    explicit match_results(const Allocator& a = Allocator());
-    match_results(const match_results& m);
-    match_results& operator=(const match_results& m);
-    ~match_results();
-    
+    explicit match_results(const Allocator& a = Allocator())
+      :subs(a), ready_()
+    {}
+    match_results(const match_results& m)
+      :subs(m.subs), prefix_(m.prefix_), suffix_(m.suffix_), unmatched(m.unmatched), origin(m.origin), ready_(m.ready_)
+    {}
+    match_results& operator=(const match_results& m)
+    {
+      subs = m.subs;
+      prefix_ = m.prefix_;
+      suffix_ = m.suffix_;
+      unmatched = m.unmatched;
+      origin = m.origin;
+      ready_ = m.ready_;
+      return *this;
+    }
+    ~match_results()
+    {}
+
+    bool ready() const { return ready_; }
+
     // 28.10.2, size:
-    size_type size() const;
-    size_type max_size() const;
-    bool empty() const;
-    
+    size_type size() const { return subs.size(); }
+    size_type max_size() const { return subs.max_size(); }
+    bool empty() const { return subs.empty(); }
+
     // 28.10.3 element access:
-    difference_type length(size_type sub = 0) const;
-    difference_type position(size_type sub = 0) const;
+    difference_type length(size_type sub = 0) const { return (*this)[sub].length(); }
+    difference_type position(size_type sub = 0) const { return std::distance(origin, (*this)[sub].first); }
+
+    string_type str(size_type sub = 0) const { return (*this)[sub].str(); }
+    const_reference operator[](size_type n) const { return n < subs.size() ? subs[n] : unmatched; }
 
-    string_type str(size_type sub = 0) const;
-    const_reference operator[](size_type n) const;
+    const_reference prefix() const { return prefix_; }
+    const_reference suffix() const { return suffix_; }
 
-    const_reference prefix() const;
-    const_reference suffix() const;
+    const_iterator begin() const { return subs.begin(); }
+    const_iterator end() const { return subs.end(); }
+    const_iterator cbegin() const { return subs.begin(); }
+    const_iterator cend() const { return subs.end(); }
 
-    const_iterator begin() const;
-    const_iterator end() const;
-    const_iterator cbegin() const;
-    const_iterator cend() const;
-    
     // 28.10.4, format:
+    /** Copies \p fmt replacing $&, $n, $nn, $`, $' and $$ (or &, \\n with format_sed) by the matched text */
     template <class OutputIter>
-    OutputIter format(OutputIter out, const string_type& fmt, regex_constants::match_flag_type flags = regex_constants::format_default) const;
-    string_type format(const string_type& fmt, regex_constants::match_flag_type flags = regex_constants::format_default) const;
+    OutputIter format(OutputIter out, const string_type& fmt, regex_constants::match_flag_type flags = regex_constants::format_default) const
+    {
+      const char_type *p = fmt.data(), * const end = p + fmt.size();
+      if(flags & regex_constants::format_sed){
+        while(p != end){
+          if(*p == char_type('&')){
+            out = copy((*this)[0], out);
+            ++p;
+          }else if(*p == char_type('\\') && end - p > 1){
+            if(digit(p[1]))
+              out = copy((*this)[p[1] - char_type('0')], out);
+            else
+              *out++ = p[1];
+            p += 2;
+          }else
+            *out++ = *p++;
+        }
+        return out;
+      }
+      while(p != end){
+        if(*p == char_type('$') && end - p > 1){
+          const char_type c = p[1];
+          if(c == char_type('$') || c == char_type('&') || c == char_type('`') || c == char_type('\'')){
+            if(c == char_type('$'))
+              *out++ = c;
+            else
+              out = copy(c == char_type('&') ? (*this)[0] : c == char_type('`') ? prefix_ : suffix_, out);
+            p += 2;
+            continue;
+          }
+          if(digit(c)){
+            size_type n = c - char_type('0');
+            p += 2;
+            if(p != end && digit(*p) && n * 10 + (*p - char_type('0')) < size())
+              n = n * 10 + (*p++ - char_type('0'));
+            out = copy((*this)[n], out);
+            continue;
+          }
+        }
+        *out++ = *p++;
+      }
+      return out;
+    }
+    string_type format(const string_type& fmt, regex_constants::match_flag_type flags = regex_constants::format_default) const
+    {
+      string_type s;
+      format(back_inserter(s), fmt, flags);
+      return s;
+    }
 
     // 28.10.5, allocator:
-    allocator_type get_allocator() const;
+    allocator_type get_allocator() const { return subs.get_allocator(); }
 
     // 28.10.6, swap:
-    void swap(match_results& that);
+    void swap(match_results& that)
+    {
+      subs.swap(that.subs);
+      std::swap(prefix_, that.prefix_);
+      std::swap(suffix_, that.suffix_);
+      std::swap(unmatched, that.unmatched);
+      std::swap(origin, that.origin);
+      std::swap(ready_, that.ready_);
+    }
+
+  private:
+    container subs;
+    value_type prefix_, suffix_, unmatched;
+    BidirectionalIterator origin;       // position() counts from here
+    bool ready_;
+
+    static bool digit(char_type c) { return c >= char_type('0') && c <= char_type('9'); }
+
+    template <class OutputIter>
+    static OutputIter copy(const value_type& s, OutputIter out)
+    {
+      return s.matched ? std::copy(s.first, s.second, out) : out;
+    }
+
+    /** Fills the groups from the engine offsets relative to \p first */
+    void set(BidirectionalIterator first, BidirectionalIterator last, const vector<size_t>& slots, size_t marks)
+    {
+      subs.assign(marks + 1, value_type());
+      for(size_t i = 0; i <= marks; i++){
+        value_type& s = subs[i];
+        s.first = s.second = last;
+        if(2 * i + 1 < slots.size() && slots[2 * i] != __::re::unset && slots[2 * i + 1] != __::re::unset){
+          s.first = s.second = first;
+          std::advance(s.first, slots[2 * i]);
+          std::advance(s.second, slots[2 * i + 1]);
+          s.matched = true;
+        }
+      }
+      prefix_.first = first;
+      prefix_.second = subs[0].first;
+      prefix_.matched = prefix_.first != prefix_.second;
+      suffix_.first = subs[0].second;
+      suffix_.second = last;
+      suffix_.matched = suffix_.first != suffix_.second;
+      unmatched.first = unmatched.second = last;
+      unmatched.matched = false;
+      origin = first;
+      ready_ = true;
+    }
+
+    void fail(BidirectionalIterator last)
+    {
+      subs.clear();
+      prefix_.first = prefix_.second = suffix_.first = suffix_.second = unmatched.first = unmatched.second = last;
+      prefix_.matched = suffix_.matched = unmatched.matched = false;
+      ready_ = true;
+    }
   };
   typedef match_results<const char*> cmatch;
   typedef match_results<const wchar_t*> wcmatch;
   typedef match_results<string::const_iterator> smatch;
   typedef match_results<wstring::const_iterator> wsmatch;
-  
+
   // match_results comparisons
   template <class BidirectionalIterator, class Allocator>
-  bool operator== (const match_results<BidirectionalIterator, Allocator>& m1, const match_results<BidirectionalIterator, Allocator>& m2);
+  inline bool operator== (const match_results<BidirectionalIterator, Allocator>& m1, const match_results<BidirectionalIterator, Allocator>& m2)
+  {
+    if(m1.empty() || m2.empty())
+      return m1.empty() == m2.empty();
+    return m1.prefix() == m2.prefix() && m1.size() == m2.size() && std::equal(m1.begin(), m1.end(), m2.begin()) && m1.suffix() == m2.suffix();
+  }
   template <class BidirectionalIterator, class Allocator>
-  bool operator!= (const match_results<BidirectionalIterator, Allocator>& m1, const match_results<BidirectionalIterator, Allocator>& m2);
-  
+  inline bool operator!= (const match_results<BidirectionalIterator, Allocator>& m1, const match_results<BidirectionalIterator, Allocator>& m2)
+  {
+    return !(m1 == m2);
+  }
+
   // 28.10.6, match_results swap:
   template <class BidirectionalIterator, class Allocator>
   void swap(match_results<BidirectionalIterator, Allocator>& m1, match_results<BidirectionalIterator, Allocator>& m2)
@@ -359,91 +681,144 @@ namespace std
     m1.swap(m2);
   }
 
+  namespace __ { namespace re {
+    /** The algorithms' way into the compiled program and the match results */
+    struct access
+    {
+      template <class It, class charT, class traits>
+      static bool test(It first, It last, const basic_regex<charT, traits>& e, match_type flags, bool full)
+      {
+        return e.prog && execute(*e.prog, first, last, flags, full, static_cast<vector<size_t>*>(0));
+      }
+
+      template <class It, class Allocator, class charT, class traits>
+      static bool run(It first, It last, match_results<It, Allocator>& m, const basic_regex<charT, traits>& e, match_type flags, bool full)
+      {
+        vector<size_t> slots;
+        if(!e.prog || !execute(*e.prog, first, last, flags, full, &slots)){
+          m.fail(last);
+          return false;
+        }
+        m.set(first, last, slots, e.prog->marks);
+        return true;
+      }
+
+      /** Continues the iteration: the prefix begins after the previous match */
+      template <class It, class Allocator>
+      static void resume(match_results<It, Allocator>& m, It origin, It prev)
+      {
+        m.origin = origin;
+        m.prefix_.first = prev;
+        m.prefix_.matched = prev != m.prefix_.second;
+      }
+    };
+  }}
+
   // 28.11.2, function template regex_match:
   template <class BidirectionalIterator, class Allocator, class charT, class traits>
-    bool regex_match(BidirectionalIterator first, BidirectionalIterator last,
+  inline bool regex_match(BidirectionalIterator first, BidirectionalIterator last,
                     match_results<BidirectionalIterator, Allocator>& m,
                     const basic_regex<charT, traits>& e,
                     regex_constants::match_flag_type flags =
-                    regex_constants::match_default);
+                    regex_constants::match_default)
+  {
+    return __::re::access::run(first, last, m, e, flags, true);
+  }
   template <class BidirectionalIterator, class charT, class traits>
-  bool regex_match(BidirectionalIterator first, BidirectionalIterator last,
+  inline bool regex_match(BidirectionalIterator first, BidirectionalIterator last,
                   const basic_regex<charT, traits>& e,
                   regex_constants::match_flag_type flags =
-                  regex_constants::match_default);
+                  regex_constants::match_default)
+  {
+    return __::re::access::test(first, last, e, flags, true);
+  }
   template <class charT, class Allocator, class traits>
-  bool regex_match(const charT* str, match_results<const charT*, Allocator>& m,
+  inline bool regex_match(const charT* str, match_results<const charT*, Allocator>& m,
                   const basic_regex<charT, traits>& e,
                   regex_constants::match_flag_type flags =
-                  regex_constants::match_default);
+                  regex_constants::match_default)
+  {
+    return regex_match(str, str + traits::length(str), m, e, flags);
+  }
   template <class ST, class SA, class Allocator, class charT, class traits>
-  bool regex_match(const basic_string<charT, ST, SA>& s,
+  inline bool regex_match(const basic_string<charT, ST, SA>& s,
                   match_results< typename basic_string<charT, ST, SA>::const_iterator, Allocator>& m,
                   const basic_regex<charT, traits>& e,
                   regex_constants::match_flag_type flags =
-                  regex_constants::match_default);
+                  regex_constants::match_default)
+  {
+    return regex_match(s.begin(), s.end(), m, e, flags);
+  }
   template <class charT, class traits>
-  bool regex_match(const charT* str,
+  inline bool regex_match(const charT* str,
                   const basic_regex<charT, traits>& e,
                   regex_constants::match_flag_type flags =
-                  regex_constants::match_default);
+                  regex_constants::match_default)
+  {
+    return regex_match(str, str + traits::length(str), e, flags);
+  }
   template <class ST, class SA, class charT, class traits>
-  bool regex_match(const basic_string<charT, ST, SA>& s,
+  inline bool regex_match(const basic_string<charT, ST, SA>& s,
                   const basic_regex<charT, traits>& e,
                   regex_constants::match_flag_type flags =
-                  regex_constants::match_default);
+                  regex_constants::match_default)
+  {
+    return regex_match(s.begin(), s.end(), e, flags);
+  }
 
 
   // 28.11.3, function template regex_search:
   template <class BidirectionalIterator, class Allocator, class charT, class traits>
-  bool regex_search(BidirectionalIterator first, BidirectionalIterator last,
+  inline bool regex_search(BidirectionalIterator first, BidirectionalIterator last,
                     match_results<BidirectionalIterator, Allocator>& m,
                     const basic_regex<charT, traits>& e,
                     regex_constants::match_flag_type flags =
-                    regex_constants::match_default);
+                    regex_constants::match_default)
+  {
+    return __::re::access::run(first, last, m, e, flags, false);
+  }
   template <class BidirectionalIterator, class charT, class traits>
-  bool regex_search(BidirectionalIterator first, BidirectionalIterator last,
+  inline bool regex_search(BidirectionalIterator first, BidirectionalIterator last,
                     const basic_regex<charT, traits>& e,
                     regex_constants::match_flag_type flags =
-                    regex_constants::match_default);
+                    regex_constants::match_default)
+  {
+    return __::re::access::test(first, last, e, flags, false);
+  }
   template <class charT, class Allocator, class traits>
-  bool regex_search(const charT* str,
+  inline bool regex_search(const charT* str,
                     match_results<const charT*, Allocator>& m,
                     const basic_regex<charT, traits>& e,
                     regex_constants::match_flag_type flags =
-                    regex_constants::match_default);
+                    regex_constants::match_default)
+  {
+    return regex_search(str, str + traits::length(str), m, e, flags);
+  }
   template <class charT, class traits>
-  bool regex_search(const charT* str,
+  inline bool regex_search(const charT* str,
                     const basic_regex<charT, traits>& e,
                     regex_constants::match_flag_type flags =
-                    regex_constants::match_default);
+                    regex_constants::match_default)
+  {
+    return regex_search(str, str + traits::length(str), e, flags);
+  }
   template <class ST, class SA, class charT, class traits>
-  bool regex_search(const basic_string<charT, ST, SA>& s,
+  inline bool regex_search(const basic_string<charT, ST, SA>& s,
                     const basic_regex<charT, traits>& e,
                     regex_constants::match_flag_type flags =
-                    regex_constants::match_default);
+                    regex_constants::match_default)
+  {
+    return regex_search(s.begin(), s.end(), e, flags);
+  }
   template <class ST, class SA, class Allocator, class charT, class traits>
-  bool regex_search(const basic_string<charT, ST, SA>& s,
+  inline bool regex_search(const basic_string<charT, ST, SA>& s,
                     match_results<typename basic_string<charT, ST, SA>::const_iterator, Allocator>& m,
                     const basic_regex<charT, traits>& e,
                     regex_constants::match_flag_type flags =
-                    regex_constants::match_default);
-
-
-  // 28.11.4, function template regex_replace:
-  template <class OutputIterator, class BidirectionalIterator,class traits, class charT>
-    OutputIterator regex_replace(OutputIterator out,
-                                BidirectionalIterator first, BidirectionalIterator last,
-                                const basic_regex<charT, traits>& e,
-                                const basic_string<charT>& fmt,
-                                regex_constants::match_flag_type flags =
-                                regex_constants::match_default);
-  template <class traits, class charT>
-  basic_string<charT> regex_replace(const basic_string<charT>& s,
-                                const basic_regex<charT, traits>& e,
-                                const basic_string<charT>& fmt,
-                                regex_constants::match_flag_type flags =
-                                regex_constants::match_default);
+                    regex_constants::match_default)
+  {
+    return regex_search(s.begin(), s.end(), m, e, flags);
+  }
 
 
   // 28.12.1, class template regex_iterator:
@@ -458,18 +833,62 @@ namespace std
     typedef const value_type& reference;
     typedef std::forward_iterator_tag iterator_category;
 
-    regex_iterator();
+    regex_iterator()
+      :pregex(), flags()
+    {}
     regex_iterator(BidirectionalIterator a, BidirectionalIterator b, const regex_type& re,
-                  regex_constants::match_flag_type m = regex_constants::match_default);
-    regex_iterator(const regex_iterator&);
-
-    regex_iterator& operator=(const regex_iterator&);
-    bool operator==(const regex_iterator&) const;
-    bool operator!=(const regex_iterator&) const;
-    const value_type& operator*() const;
-    const value_type* operator->() const;
-    regex_iterator& operator++();
-    regex_iterator operator++(int);
+                  regex_constants::match_flag_type m = regex_constants::match_default)
+      :begin(a), end(b), pregex(&re), flags(m)
+    {
+      if(!regex_search(begin, end, match, *pregex, flags))
+        pregex = 0;
+    }
+    regex_iterator(const regex_iterator& i)
+      :begin(i.begin), end(i.end), pregex(i.pregex), flags(i.flags), match(i.match)
+    {}
+
+    regex_iterator& operator=(const regex_iterator& i)
+    {
+      begin = i.begin;
+      end = i.end;
+      pregex = i.pregex;
+      flags = i.flags;
+      match = i.match;
+      return *this;
+    }
+    bool operator==(const regex_iterator& i) const
+    {
+      if(!pregex || !i.pregex)
+        return pregex == i.pregex;
+      return begin == i.begin && end == i.end && pregex == i.pregex && flags == i.flags && match[0] == i.match[0];
+    }
+    bool operator!=(const regex_iterator& i) const { return !(*this == i); }
+    const value_type& operator*() const { return match; }
+    const value_type* operator->() const { return &match; }
+    regex_iterator& operator++()
+    {
+      const BidirectionalIterator prev = match[0].second;
+      BidirectionalIterator start = prev;
+      if(match[0].first == match[0].second){
+        // an empty match: try a non-empty one at the same place, then step over a character
+        if(start == end){
+          pregex = 0;
+          return *this;
+        }
+        if(next(start, prev, regex_constants::match_not_null | regex_constants::match_continuous))
+          return *this;
+        ++start;
+      }
+      if(!next(start, prev, 0))
+        pregex = 0;
+      return *this;
+    }
+    regex_iterator operator++(int)
+    {
+      regex_iterator tmp(*this);
+      ++*this;
+      return tmp;
+    }
   private:
     // these members are shown for exposition only:
     BidirectionalIterator begin;
@@ -477,12 +896,23 @@ namespace std
     const regex_type* pregex;
     regex_constants::match_flag_type flags;
     match_results<BidirectionalIterator> match;
+
+    bool next(BidirectionalIterator start, BidirectionalIterator prev, regex_constants::match_flag_type extra)
+    {
+      regex_constants::match_flag_type f = flags | extra;
+      if(start != begin)
+        f |= regex_constants::match_prev_avail;
+      if(!regex_search(start, end, match, *pregex, f))
+        return false;
+      __::re::access::resume(match, begin, prev);
+      return true;
+    }
   };
   typedef regex_iterator<const char*> cregex_iterator;
   typedef regex_iterator<const wchar_t*> wcregex_iterator;
   typedef regex_iterator<string::const_iterator> sregex_iterator;
   typedef regex_iterator<wstring::const_iterator> wsregex_iterator;
-  
+
   // 28.12.2, class template regex_token_iterator:
   template <class BidirectionalIterator, class charT = typename iterator_traits<BidirectionalIterator>::value_type, class traits = regex_traits<charT> >
   class regex_token_iterator
@@ -495,20 +925,79 @@ namespace std
     typedef const value_type& reference;
     typedef std::forward_iterator_tag iterator_category;
 
-    regex_token_iterator();
-    regex_token_iterator(BidirectionalIterator a, BidirectionalIterator b, const regex_type& re, int submatch = 0,regex_constants::match_flag_type m = regex_constants::match_default);
-    regex_token_iterator(BidirectionalIterator a, BidirectionalIterator b, const regex_type& re, const std::vector<int>& submatches, regex_constants::match_flag_type m = regex_constants::match_default);
-    template <std::size_t N>
-    regex_token_iterator(BidirectionalIterator a, BidirectionalIterator b, const regex_type& re, const int (&submatches)[N], regex_constants::match_flag_type m = regex_constants::match_default);
-    regex_token_iterator(const regex_token_iterator&);
-    regex_token_iterator& operator=(const regex_token_iterator&);
-
-    bool operator==(const regex_token_iterator&) const;
-    bool operator!=(const regex_token_iterator&) const;
-    const value_type& operator*() const;
-    const value_type* operator->() const;
-    regex_token_iterator& operator++();
-    regex_token_iterator operator++(int);
+    regex_token_iterator()
+      :result(), N()
+    {}
+    regex_token_iterator(BidirectionalIterator a, BidirectionalIterator b, const regex_type& re, int submatch = 0,regex_constants::match_flag_type m = regex_constants::match_default)
+      :position(a, b, re, m), result(), N(), subs(1, submatch)
+    {
+      init(a, b);
+    }
+    regex_token_iterator(BidirectionalIterator a, BidirectionalIterator b, const regex_type& re, const std::vector<int>& submatches, regex_constants::match_flag_type m = regex_constants::match_default)
+      :position(a, b, re, m), result(), N(), subs(submatches)
+    {
+      init(a, b);
+    }
+    template <std::size_t Size>
+    regex_token_iterator(BidirectionalIterator a, BidirectionalIterator b, const regex_type& re, const int (&submatches)[Size], regex_constants::match_flag_type m = regex_constants::match_default)
+      :position(a, b, re, m), result(), N(), subs(submatches, submatches + Size)
+    {
+      init(a, b);
+    }
+    regex_token_iterator(const regex_token_iterator& i)
+      :position(i.position), result(), suffix(i.suffix), N(i.N), subs(i.subs)
+    {
+      adopt(i);
+    }
+    regex_token_iterator& operator=(const regex_token_iterator& i)
+    {
+      position = i.position;
+      suffix = i.suffix;
+      N = i.N;
+      subs = i.subs;
+      adopt(i);
+      return *this;
+    }
+
+    bool operator==(const regex_token_iterator& i) const
+    {
+      if(!result || !i.result)
+        return result == i.result;
+      const bool at_suffix = result == &suffix;
+      if(at_suffix || i.result == &i.suffix)
+        return at_suffix == (i.result == &i.suffix) && suffix == i.suffix;
+      return position == i.position && N == i.N && subs == i.subs;
+    }
+    bool operator!=(const regex_token_iterator& i) const { return !(*this == i); }
+    const value_type& operator*() const { return *result; }
+    const value_type* operator->() const { return result; }
+    regex_token_iterator& operator++()
+    {
+      if(result == &suffix)
+        result = 0;
+      else if(N + 1 < subs.size()){
+        ++N;
+        result = &current();
+      }else{
+        const position_iterator prev = position;
+        N = 0;
+        ++position;
+        if(position != position_iterator())
+          result = &current();
+        else if(splits() && prev->suffix().matched){
+          suffix = prev->suffix();
+          result = &suffix;
+        }else
+          result = 0;
+      }
+      return *this;
+    }
+    regex_token_iterator operator++(int)
+    {
+      regex_token_iterator tmp(*this);
+      ++*this;
+      return tmp;
+    }
   private: // data members for exposition only:
     typedef regex_iterator<BidirectionalIterator, charT, traits> position_iterator;
     position_iterator position;
@@ -516,12 +1005,70 @@ namespace std
     value_type suffix;
     std::size_t N;
     std::vector<int> subs;
+
+    bool splits() const { return std::find(subs.begin(), subs.end(), -1) != subs.end(); }
+    const value_type& current() const { return subs[N] == -1 ? position->prefix() : (*position)[subs[N]]; }
+
+    void init(BidirectionalIterator a, BidirectionalIterator b)
+    {
+      if(position != position_iterator())
+        result = &current();
+      else if(splits() && a != b){
+        suffix.first = a;
+        suffix.second = b;
+        suffix.matched = true;
+        result = &suffix;
+      }
+    }
+
+    void adopt(const regex_token_iterator& i)
+    {
+      result = !i.result ? 0 : i.result == &i.suffix ? &suffix : &current();
+    }
   };
   typedef regex_token_iterator<const char*> cregex_token_iterator;
   typedef regex_token_iterator<const wchar_t*> wcregex_token_iterator;
   typedef regex_token_iterator<string::const_iterator> sregex_token_iterator;
   typedef regex_token_iterator<wstring::const_iterator> wsregex_token_iterator;
 
+
+  // 28.11.4, function template regex_replace:
+  template <class OutputIterator, class BidirectionalIterator,class traits, class charT>
+  OutputIterator regex_replace(OutputIterator out,
+                                BidirectionalIterator first, BidirectionalIterator last,
+                                const basic_regex<charT, traits>& e,
+                                const basic_string<charT>& fmt,
+                                regex_constants::match_flag_type flags =
+                                regex_constants::match_default)
+  {
+    typedef regex_iterator<BidirectionalIterator, charT, traits> iterator;
+    const bool copy = !(flags & regex_constants::format_no_copy);
+    iterator i(first, last, e, flags), end;
+    if(i == end)
+      return copy ? std::copy(first, last, out) : out;
+    BidirectionalIterator rest = last;
+    for(; i != end; ++i){
+      if(copy)
+        out = std::copy(i->prefix().first, i->prefix().second, out);
+      out = i->format(out, fmt, flags);
+      rest = (*i)[0].second;
+      if(flags & regex_constants::format_first_only)
+        break;
+    }
+    return copy ? std::copy(rest, last, out) : out;
+  }
+  template <class traits, class charT>
+  basic_string<charT> regex_replace(const basic_string<charT>& s,
+                                const basic_regex<charT, traits>& e,
+                                const basic_string<charT>& fmt,
+                                regex_constants::match_flag_type flags =
+                                regex_constants::match_default)
+  {
+    basic_string<charT> r;
+    regex_replace(back_inserter(r), s.begin(), s.end(), e, fmt, flags);
+    return r;
+  }
+
 } // std
 
 #endif // NTL__STLX_REGEX
@@ -67,7 +67,7 @@ namespace std {
     {}
     #ifdef NTL_CXX_RV
     set(set<Key,Compare,Allocator>&& x)
-      :tree_type(x)
+      :tree_type(std::move(x))
     {}
     #endif
 
@@ -101,8 +101,7 @@ namespace std {
     #ifdef NTL_CXX_RV
     set<Key,Compare,Allocator>& operator= (set<Key,Compare,Allocator>&& x)
     {
-      clear();
-      assign(x);
+      tree_type::operator=(std::move(x));
       return *this;
     }
 
@@ -151,10 +150,15 @@ namespace std {
       return std::make_pair(insert_impl(place.second, construct_node(x), greater), true);
     }
 
-    iterator insert(const_iterator /*position*/, const value_type& x)
+    iterator insert(const_iterator position, const value_type& x)
     {
-      // TODO: implement fast insert function based on position
-      return insert(x).first;
+      return tree_type::insert(position, x);
+    }
+
+    template <class InputIterator>
+    void insert(InputIterator first, InputIterator last)
+    {
+      tree_type::insert_range(first, last);
     }
 
 #ifdef NTL_CXX_RV
@@ -169,6 +173,15 @@ namespace std {
     }
 #endif
 
+    ///\name Set operations extension
+    /** Moves the elements of \c x which are not in this set, others are left in \c x. Runs in linear time. */
+    void merge(set<Key,Compare,Allocator>& x) { tree_type::merge(x); }
+    /** Inserts the copies of the elements of \c x which are not in this set. Runs in linear time. */
+    void unite(const set<Key,Compare,Allocator>& x) { tree_type::unite(x); }
+    /** Erases the elements which are not in \c x. Runs in linear time. */
+    void intersect(const set<Key,Compare,Allocator>& x) { tree_type::intersect(x); }
+    ///\}
+
     // observers:
     key_compare key_comp() const { return tree_type::value_comp(); }
     value_compare value_comp() const { return tree_type::value_comp(); }
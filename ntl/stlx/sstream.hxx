@@ -165,6 +165,13 @@ namespace std {
         ? traits::to_int_type(*this->gptr()) : traits::eof();
     }
 
+    virtual streamsize xsgetn(char_type* s, streamsize n)
+    {
+      // make the written characters readable, then copy them at once
+      syncg();
+      return basic_streambuf::xsgetn(s, n);
+    }
+
     virtual int_type pbackfail(int_type c = traits::eof())
     {
       // backup sequence
@@ -199,22 +206,21 @@ namespace std {
         if(mode_ & ios_base::app)
           pbump(static_cast<int>(epptr()-pptr()));
 
-        const ptrdiff_t gp = gptr() - eback(), pp = pptr() - pbase();
-
-        growto(max(initial_output_size, __ntl_grow_heap_block_size(str_.size())));
-        char_type* newbeg = str_.begin();
-        setp(newbeg, newbeg+str_.capacity());
-        pbump(static_cast<int>(pp)); // NOTE: there is an issue in "C++ Standard Library Issues List" about this
-
-        // 27.8.1.4/8
-        //if(mode_ & ios_base::in)
-        setg(newbeg, newbeg+gp, pptr());
+        grow(1);
         *pptr() = cc;
         pbump(1);
       }
       return c;
     }
 
+    virtual streamsize xsputn(const char_type* s, streamsize n)
+    {
+      // grow once for the whole span instead of an overflow() per a buffer size
+      if(n > epptr()-pptr() && (mode_ & ios_base::out) && !(mode_ & ios_base::app))
+        grow(n);
+      return basic_streambuf::xsputn(s, n);
+    }
+
     virtual pos_type seekoff(off_type off, ios_base::seekdir way, ios_base::openmode which = ios_base::in | ios_base::out)
     {
       pos_type re = pos_type(off_type(-1));
@@ -308,6 +314,21 @@ namespace std {
       }
     }
 
+    /// grows the buffer for at least \p n characters after pptr()
+    void grow(streamsize n)
+    {
+      const ptrdiff_t gp = gptr() - eback(), pp = pptr() - pbase();
+
+      growto(max(max(static_cast<streamsize>(initial_output_size), pp + n), static_cast<streamsize>(__ntl_grow_heap_block_size(str_.size()))));
+      char_type* newbeg = str_.begin();
+      setp(newbeg, newbeg+str_.capacity());
+      pbump(static_cast<int>(pp)); // NOTE: there is an issue in "C++ Standard Library Issues List" about this
+
+      // 27.8.1.4/8
+      //if(mode_ & ios_base::in)
+      setg(newbeg, newbeg+gp, pptr());
+    }
+
     void growto(streamsize newsize)
     {
       str_.resize(newsize, '\0');
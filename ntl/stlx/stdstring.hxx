@@ -36,6 +36,12 @@
 #ifndef NTL__STLX_RANGE
 #include "range.hxx"
 #endif
+#ifndef NTL__EXT_SIMD_CHARS
+# include "ext/simd_chars.hxx"
+#endif
+#ifndef NTL__EXT_FAST_HASH
+# include "ext/fast_hash.hxx"
+#endif
 
 #ifndef EOF // should be moved to "stdio.hxx" ?
 # define EOF -1
@@ -76,10 +82,10 @@ struct char_traits<char>
   static constexpr bool eq(const char_type& c1, const char_type& c2) { return c1 == c2; }
   static constexpr bool lt(const char_type& c1, const char_type& c2) { return c1 < c2; }
   static int compare(const char_type* s1, const char_type* s2, size_t n)
-    { return strncmp(s1, s2, n); }
-  static size_t length(const char_type* s) { return strlen(s); }
+    { return ext::simd::compare(s1, s2, n); }
+  static size_t length(const char_type* s) { return ext::simd::length(s); }
   static const char_type* find(const char_type* s, size_t n, const char_type& a)
-    { while ( n-- ) if ( a != *s ) ++s; else return s; return 0; }
+    { return ext::simd::find(s, n, a); }
   static char_type* move(char_type* dst, const char_type* src, size_t n)
     { return reinterpret_cast<char_type*>(memmove(dst, src, n)); }
   static char_type* copy(char_type* dst, const char_type* src, size_t n)
@@ -111,10 +117,10 @@ struct char_traits<char16_t>
   static constexpr bool lt(const char_type& c1, const char_type& c2) { return c1 < c2; }
 
   static int compare(const char_type* s1, const char_type* s2, size_t n)
-  { return wcsncmp(reinterpret_cast<const wchar_t*>(s1), reinterpret_cast<const wchar_t*>(s2), n); }
-  static size_t length(const char_type* s) { return wcslen(reinterpret_cast<const wchar_t*>(s)); }
+  { return ext::simd::compare(s1, s2, n); }
+  static size_t length(const char_type* s) { return ext::simd::length(s); }
   static const char_type* find(const char_type* s, size_t n, const char_type& a)
-  { while ( n-- ) if ( a != *s ) ++s; else return s; return 0; }
+  { return ext::simd::find(s, n, a); }
   static char_type* move(char_type* dst, const char_type* src, size_t n)
   { return reinterpret_cast<char_type*>(memmove(dst, src, n*sizeof(char_type))); }
   static char_type* copy(char_type* dst, const char_type* src, size_t n)
@@ -148,16 +154,10 @@ struct char_traits<char32_t>
   static constexpr bool lt(const char_type& c1, const char_type& c2) { return c1 < c2; }
 
   static int compare(const char_type* s1, const char_type* s2, size_t n)
-  { return memcmp(s1, s2, n*sizeof(char_type)); }
-  static size_t length(const char_type* s)
-  {
-    size_t n = 0;
-    while(*s++)
-      n++;
-    return n;
-  }
+  { return ext::simd::compare(s1, s2, n); }
+  static size_t length(const char_type* s) { return ext::simd::length(s); }
   static const char_type* find(const char_type* s, size_t n, const char_type& a)
-  { while ( n-- ) if ( a != *s ) ++s; else return s; return 0; }
+  { return ext::simd::find(s, n, a); }
   static char_type* move(char_type* dst, const char_type* src, size_t n)
   { return reinterpret_cast<char_type*>(memmove(dst, src, n*sizeof(char_type))); }
   static char_type* copy(char_type* dst, const char_type* src, size_t n)
@@ -192,10 +192,10 @@ struct char_traits<wchar_t>
   static constexpr bool eq(const char_type& c1, const char_type& c2) { return c1 == c2; }
   static constexpr bool lt(const char_type& c1, const char_type& c2) { return c1 < c2; }
   static int compare(const char_type* s1, const char_type* s2, size_t n)
-    { return wcsncmp(s1, s2, n); }
-  static size_t length(const char_type* s) { return wcslen(s); }
+    { return ext::simd::compare(s1, s2, n); }
+  static size_t length(const char_type* s) { return ext::simd::length(s); }
   static const char_type* find(const char_type* s, size_t n, const char_type& a)
-    { while ( n-- ) if ( a != *s ) ++s; else return s; return 0; }
+    { return ext::simd::find(s, n, a); }
   static char_type* move(char_type* dst, const char_type* src, size_t n)
     { return reinterpret_cast<char_type*>(memmove(dst, src, n * sizeof(char_type))); }
   static char_type* copy(char_type* dst, const char_type* src, size_t n)
@@ -215,6 +215,39 @@ struct char_traits<wchar_t>
 ///\}
 /**@} lib_char_traits */
 
+namespace __
+{
+  template<class traits, class charT>
+  inline const charT* traits_search(const charT* s, size_t n, const charT* x, size_t m, false_type)
+  {
+    for ( size_t xpos = 0; xpos + m <= n; ++xpos )
+    {
+      for(size_t i = 0; i != m; ++i){
+        if ( !traits::eq(*(s + xpos  + i), *(x + i)) )
+          goto next_xpos;
+      }
+      return s + xpos;
+    next_xpos:;
+    }
+    return nullptr;
+  }
+
+  template<class traits, class charT>
+  inline const charT* traits_search(const charT* s, size_t n, const charT* x, size_t m, true_type)
+  {
+    return ext::simd::search(s, n, x, m);
+  }
+
+  /// Returns the first occurrence of [x, x + m) in [s, s + n) or \c nullptr.
+  /// The standard traits compare the characters by value, so the vectorized search is used with them.
+  template<class traits, class charT>
+  inline const charT* traits_search(const charT* s, size_t n, const charT* x, size_t m)
+  {
+    typedef integral_constant<bool, is_same<traits, char_traits<charT> >::value && is_simd_char<charT>::value> vectorizable;
+    return traits_search<traits>(s, n, x, m, vectorizable());
+  }
+}
+
 /**
  *  @brief 21.3 Class template basic_string [basic.string]
  *
@@ -278,9 +311,14 @@ struct char_traits<wchar_t>
 
   private:
     static const charT zero_char = 0;
+
+    /** capacity of the inline buffer (including the terminating zero) used by the short strings instead of the allocated one */
+    static const size_type sso_capacity = 16 / sizeof(charT) < 2 ? 2 : 16 / sizeof(charT);
+
     size_type length_, capacity_;
     charT* buffer_;
     Allocator alloc;
+    charT sso_[sso_capacity];
   public:
     static const size_type npos = static_cast<size_type>(-1);
 
@@ -292,10 +330,10 @@ struct char_traits<wchar_t>
     /// - size() == 0;
     /// - capacity() an unspecified value.
     explicit basic_string()
-      :length_(), capacity_(), buffer_(), alloc()
+      :length_(), capacity_(sso_capacity), buffer_(sso_), alloc()
     {}
     explicit basic_string(const Allocator& a)
-      :length_(), capacity_(), buffer_(), alloc(a)
+      :length_(), capacity_(sso_capacity), buffer_(sso_), alloc(a)
     {}
 
 
@@ -308,7 +346,7 @@ struct char_traits<wchar_t>
     /// - capacity() is at least as large as size().
     __forceinline
     basic_string(const basic_string& str)
-      :length_(), capacity_(), buffer_(),
+      :length_(), capacity_(sso_capacity), buffer_(sso_),
       alloc(str.alloc)
     {
       append(str);
@@ -326,7 +364,7 @@ struct char_traits<wchar_t>
     /// - size() == rlen;
     /// - capacity() is at least as large as size().
     basic_string(const basic_string& str, size_type pos, size_type n = npos, const Allocator& a = Allocator()) __ntl_throws(out_of_range)
-      :alloc(a), length_(), capacity_(), buffer_()
+      :alloc(a), length_(), capacity_(sso_capacity), buffer_(sso_)
     {
       if(pos > str.size()){
         __throw_out_of_range("std::basic_string(): invalid `pos`");
@@ -346,7 +384,7 @@ struct char_traits<wchar_t>
     /// - size() == n;
     /// - capacity() is at least as large as size().
     basic_string(const charT* s, size_type n, const Allocator& a = Allocator())
-      :length_(), capacity_(), buffer_(), alloc(a)
+      :length_(), capacity_(sso_capacity), buffer_(sso_), alloc(a)
     {
       if(!assert_pos(n) || !assert_ptr(s)) return;
       append(s, n);
@@ -362,10 +400,10 @@ struct char_traits<wchar_t>
     /// - size() == traits::length(s);
     /// - capacity() is at least as large as size().
     basic_string(const charT* s)
-      :length_(), capacity_(), buffer_()
+      :length_(), capacity_(sso_capacity), buffer_(sso_)
     { if(!assert_ptr(s)) return; append(s); } // one line for simplifing tracing
     basic_string(const charT* s, const Allocator& a)
-      :length_(), capacity_(), buffer_(), alloc(a)
+      :length_(), capacity_(sso_capacity), buffer_(sso_), alloc(a)
     { if(!assert_ptr(s)) return; append(s); } // one line for simplifing tracing
 
     /// 12 Requires: n < npos
@@ -378,7 +416,7 @@ struct char_traits<wchar_t>
     /// - size() = n;
     /// - capacity() is at least as large as size().
     basic_string(size_type n, charT c)
-      :length_(), capacity_(), buffer_(),
+      :length_(), capacity_(sso_capacity), buffer_(sso_),
       alloc()
     {
       assert_pos(n);
@@ -386,7 +424,7 @@ struct char_traits<wchar_t>
         append(n, c);
     }
     basic_string(size_type n, charT c, const Allocator& a)
-      :length_(), capacity_(), buffer_(),
+      :length_(), capacity_(sso_capacity), buffer_(sso_),
       alloc(a)
     {
       assert_pos(n);
@@ -404,14 +442,14 @@ struct char_traits<wchar_t>
     /// - capacity() is at least as large as size().
     template<class InputIterator>
     basic_string(InputIterator begin, InputIterator end, const Allocator& a = Allocator(), typename enable_if<!is_integral<InputIterator>::value>::type* =0)
-      :alloc(a), length_(), capacity_(), buffer_()
+      :alloc(a), length_(), capacity_(sso_capacity), buffer_(sso_)
     {
       append(begin, end);
     }
 
     __forceinline
       basic_string(const basic_string& str, const Allocator& a)
-      :alloc(str.alloc), length_(), capacity_(), buffer_()
+      :alloc(str.alloc), length_(), capacity_(sso_capacity), buffer_(sso_)
     {
       if(!str.empty())
         append(str);
@@ -419,14 +457,14 @@ struct char_traits<wchar_t>
 
     __forceinline
       basic_string(initializer_list<charT> il)
-      :length_(), capacity_(), buffer_()
+      :length_(), capacity_(sso_capacity), buffer_(sso_)
     {
       append(il.begin(), il.end());
     }
 
     __forceinline
       basic_string(initializer_list<charT> il, const Allocator& a)
-      :alloc(a), length_(), capacity_(), buffer_()
+      :alloc(a), length_(), capacity_(sso_capacity), buffer_(sso_)
     {
       append(il.begin(), il.end());
     }
@@ -434,7 +472,7 @@ struct char_traits<wchar_t>
 #ifdef NTL_CXX_RV
     __forceinline
       basic_string(basic_string&& str)
-      :length_(), capacity_(), buffer_(),
+      :length_(), capacity_(sso_capacity), buffer_(sso_),
       alloc(str.alloc)
     {
       swap(str);
@@ -446,13 +484,13 @@ struct char_traits<wchar_t>
 #if 0
     template<class Range, typename IsRange = enable_if<__::ranged::is_ranged<Range, basic_string>::value>::type>
     explicit basic_string(Range&& R)
-      :length_(), capacity_(), buffer_()
+      :length_(), capacity_(sso_capacity), buffer_(sso_)
     {
       assign(forward<Range>(R));
     }
     template<class Range, typename IsRange = enable_if<__::ranged::is_ranged<Range, basic_string>::value>::type>
     explicit basic_string(Range&& R, const Allocator& a)
-      :length_(), capacity_(), buffer_(),
+      :length_(), capacity_(sso_capacity), buffer_(sso_),
       alloc(a)
     {
       assign(forward<Range>(R));
@@ -476,13 +514,13 @@ struct char_traits<wchar_t>
 #else
     template<class Iter>
     explicit basic_string(std::range<Iter>&& R)
-      :length_(), capacity_(), buffer_()
+      :length_(), capacity_(sso_capacity), buffer_(sso_)
     {
       assign(forward<std::range<Iter>>(R));
     }
     template<class Iter>
     explicit basic_string(std::range<Iter>&& R, const Allocator& a)
-      :length_(), capacity_(), buffer_(),
+      :length_(), capacity_(sso_capacity), buffer_(sso_),
       alloc(a)
     {
       assign(forward<std::range<Iter>>(R));
@@ -512,7 +550,7 @@ struct char_traits<wchar_t>
     __forceinline
     ~basic_string()
     {
-      if(buffer_){
+      if(!is__local()){
         allocator_traits::deallocate(alloc, buffer_, capacity_);
         #ifdef NTL_DEBUG
         length_ = 0;
@@ -607,10 +645,10 @@ struct char_traits<wchar_t>
         __throw_length_error("std::basic_string::resize(): n > max_size()");
         return;
       }
-      if(n > capacity_){
+      if(n > capacity_)
         grow_buffer(n);
-        memset( buffer_+length_, c, (n-length_)*sizeof(charT) );
-      }
+      if(n > length_)
+        traits_type::assign(buffer_+length_, n-length_, c);
       length_ = n;
     }
 
@@ -645,16 +683,16 @@ struct char_traits<wchar_t>
     ///   implementation-specific optimizations.
     void shrink_to_fit()
     {
-      if(length_){
+      if(is__local())
+        return;
+      if(length_ < sso_capacity){
+        move__local(length_);
+      }else if(length_ != capacity_){
         pointer buf = allocator_traits::allocate(alloc, length_);
         traits_type::copy(buf, buffer_, length_);
         allocator_traits::deallocate(alloc, buffer_, capacity_);
         buffer_ = buf;
         capacity_ = length_;
-      }else if(capacity_){
-        allocator_traits::deallocate(alloc, buffer_, capacity_);
-        buffer_ = nullptr;
-        capacity_ = 0;
       }
     }
 
@@ -1207,7 +1245,17 @@ struct char_traits<wchar_t>
     {
       if(this == &str) return;
       using std::swap;
-      swap(buffer_, str.buffer_);
+      charT* const buf = is__local() ? nullptr : buffer_;
+      charT* const strbuf = str.is__local() ? nullptr : str.buffer_;
+      if(!buf || !strbuf){
+        // the inline buffers are exchanged by value
+        charT tmp[sso_capacity];
+        traits_type::copy(tmp, sso_, sso_capacity);
+        traits_type::copy(sso_, str.sso_, sso_capacity);
+        traits_type::copy(str.sso_, tmp, sso_capacity);
+      }
+      buffer_ = strbuf ? strbuf : sso_;
+      str.buffer_ = buf ? buf : str.sso_;
       swap(length_, str.length_);
       swap(capacity_, str.capacity_);
     }
@@ -1217,8 +1265,6 @@ struct char_traits<wchar_t>
     const charT* c_str() const  __ntl_nothrow
     {
       // ensure string is null-terminated
-      if(!capacity_)
-        return &zero_char;
       if(length_ < capacity_) {
         buffer_[length_] = zero_char;
       } else{
@@ -1254,18 +1300,10 @@ struct char_traits<wchar_t>
     size_type find(const charT* s, size_type pos, size_type n) const
     {
       const size_type cursize = size();
-      if(pos > cursize || pos+n > cursize) return npos;
+      if(pos > cursize || n > cursize - pos) return npos;
       const charT* const beg = begin();
-      for ( size_type xpos = pos; xpos + n <= cursize; ++xpos )
-      {
-        for(size_type i = 0; i != n; ++i){
-          if ( !traits_type::eq(*(beg + xpos  + i), *(s + i)) )
-            goto next_xpos;
-        }
-        return xpos;
-      next_xpos:;
-      }
-      return npos;
+      const charT* const p = __::traits_search<traits_type>(beg + pos, cursize - pos, s, n);
+      return p ? static_cast<size_type>(p - beg) : npos;
     }
 
     /// 5 Returns: find(basic_string<charT,traits,Allocator>(s),pos).
@@ -1278,12 +1316,12 @@ struct char_traits<wchar_t>
     /// 7 Returns: find(basic_string<charT,traits,Allocator>(1,c),pos).
     size_type find(charT c, size_type pos = 0) const
     {
-      const charT* const beg = begin();
       const size_type cursize = size();
-      for ( size_type xpos = pos; xpos < cursize; ++xpos )
-        if ( traits_type::eq(*(beg + xpos), c) )
-          return xpos;
-      return npos;
+      if ( pos >= cursize )
+        return npos;
+      const charT* const beg = begin();
+      const charT* const p = traits_type::find(beg + pos, cursize - pos, c);
+      return p ? static_cast<size_type>(p - beg) : npos;
     }
 
     ///\name   basic_string::rfind [21.4.6.2 string::rfind]
@@ -1776,6 +1814,12 @@ next_xpos:;
 
     void grow_buffer(size_type new_size, size_type length, bool exactly)
     {
+      if(exactly && new_size <= sso_capacity){
+        // reserve() request which fits into the inline buffer
+        if(!is__local())
+          move__local(length);
+        return;
+      }
       const size_type n = exactly ? new_size : static_cast<size_type>(__ntl_grow_heap_block_size(new_size + 1));
       if(!(n < new_size)) // overflow
         new_size = n;
@@ -1783,19 +1827,35 @@ next_xpos:;
       if(!buf) return;
       if(length)
         traits::copy(buf, buffer_, length);
-      if(buffer_)
+      if(!is__local())
         allocator_traits::deallocate(alloc, buffer_, capacity_);
       capacity_ = new_size;
       buffer_ = buf;
     }
 
-    /// @note allocates n + 1 bytes, possibly optimizing c_str()
+    /// @note allocates n + 1 bytes, possibly optimizing c_str(); the short strings use the inline buffer
     void alloc__new(size_type n)
     {
+      assert(is__local());
+      if(n < sso_capacity)
+        return;
       capacity_ = __ntl_grow_heap_block_size(n + sizeof('\0'));
       buffer_ = allocator_traits::allocate(alloc, capacity_);
     }
 
+    bool is__local() const { return buffer_ == sso_; }
+
+    /// moves the first \c length characters of the allocated buffer into the inline one and frees it
+    void move__local(size_type length)
+    {
+      assert(!is__local() && length < sso_capacity);
+      charT* const buf = buffer_;
+      traits_type::copy(sso_, buf, length);
+      allocator_traits::deallocate(alloc, buf, capacity_);
+      buffer_ = sso_;
+      capacity_ = sso_capacity;
+    }
+
   };//class basic_string
 
 
@@ -2031,49 +2091,28 @@ wstring to_wstring(long double val);
 
 
 //////////////////////////////////////////////////////////////////////////
-inline string to_string(long long val)
-{
-  string s(ntl::numeric::max_number_size, '\0');
-  size_t len;
-  ntl::numeric::itoa(val, s.begin(), s.size(), 10, &len);
-  s.resize(len);
-  return s;
-}
-
-inline string to_string(unsigned long long val)
-{
-  string s(ntl::numeric::max_number_size, '\0');
-  size_t len;
-  ntl::numeric::itoa(val, s.begin(), s.size(), 10, &len);
-  s.resize(len);
-  return s;
-}
-
-inline wstring to_wstring(long long val)
+namespace __
 {
-  wstring s(ntl::numeric::max_number_size, '\0');
-  size_t len;
-  ntl::numeric::itow(val, s.begin(), s.size(), 10, &len);
-  s.resize(len);
-  return s;
+  template<class String, typename T>
+  inline String to_string(T val)
+  {
+    char buf[intconv::max_size];
+    return String(buf, intconv::format(buf, val));
+  }
 }
 
-inline wstring to_wstring(unsigned long long val)
-{
-  wstring s(ntl::numeric::max_number_size, '\0');
-  size_t len;
-  ntl::numeric::itow(val, s.begin(), s.size(), 10, &len);
-  s.resize(len);
-  return s;
-}
+inline string to_string(long long val) { return __::to_string<string>(val); }
+inline string to_string(unsigned long long val) { return __::to_string<string>(val); }
+inline wstring to_wstring(long long val) { return __::to_string<wstring>(val); }
+inline wstring to_wstring(unsigned long long val) { return __::to_string<wstring>(val); }
 
-// eliminate to_string(-1) ambiguity
-inline string to_string(int val) { return to_string(static_cast<long long>(val)); }
-inline string to_string(unsigned int val) { return to_string(static_cast<unsigned long long>(val)); }
-inline string to_string(unsigned long val) { return to_string(static_cast<unsigned long long>(val)); }
-inline wstring to_wstring(int val) { return to_wstring(static_cast<long long>(val)); }
-inline wstring to_wstring(unsigned int val) { return to_wstring(static_cast<unsigned long long>(val)); }
-inline wstring to_wstring(unsigned long val) { return to_wstring(static_cast<unsigned long long>(val)); }
+// eliminate to_string(-1) ambiguity, the 32-bit values are converted in 32 bits
+inline string to_string(int val) { return __::to_string<string>(val); }
+inline string to_string(unsigned int val) { return __::to_string<string>(val); }
+inline string to_string(unsigned long val) { return __::to_string<string>(val); }
+inline wstring to_wstring(int val) { return __::to_string<wstring>(val); }
+inline wstring to_wstring(unsigned int val) { return __::to_string<wstring>(val); }
+inline wstring to_wstring(unsigned long val) { return __::to_string<wstring>(val); }
 
 ///\}
 
@@ -2091,7 +2130,7 @@ namespace __
     /// string hash calculation
     inline size_t operator()(const basic_string<charT, traits, Allocator>& str) const __ntl_nothrow //
     {
-      return FNVHash()(str.data(), str.length()*sizeof(charT));
+      return ext::hashing::hash_bytes(str.data(), str.length()*sizeof(charT));
     }
   };
 }
@@ -33,6 +33,67 @@ namespace std
       }
       return static_cast<T>(value);
     }
+
+    template<typename T>
+    inline T stof(const char* str, size_t length, size_t* end)
+    {
+      size_t l;
+      T value;
+      ntl::numeric::convresult re = ntl::numeric::str2float(value, str, static_cast<ssize_t>(length), &l);
+      if(end) *end = l;
+      if(re <= ntl::numeric::conv_result::bad_format){
+#if STLX_USE_EXCEPTIONS
+        __throw_invalid_argument("stof: no conversion could be performed");
+#else
+        _assert_msg("stof: no conversion could be performed");
+#endif
+      }else if(re == ntl::numeric::conv_result::overflow){
+#if STLX_USE_EXCEPTIONS
+        __throw_out_of_range("stof: converted value is outside the range of representable values");
+#else
+        _assert_msg("stof: converted value is outside the range of representable values");
+#endif
+      }
+      return value;
+    }
+
+    /** The wide number narrowed up to its first non ASCII character */
+    inline size_t narrow_number(const wstring_ref& str, char* buf, size_t size)
+    {
+      const wchar_t* p = str.data();
+      const size_t len = min(str.length(), size);
+      size_t i = 0;
+      for(; i != len && static_cast<unsigned>(p[i]) < 0x80; i++)
+        buf[i] = static_cast<char>(p[i]);
+      return i;
+    }
+
+    /** Longer floating point numbers are narrowed to the heap buffer */
+    static const size_t max_float_size = 256;
+
+    /** The wide floating point number narrowed to the stack buffer or, when it is longer, to the allocated one */
+    class narrow_float
+    {
+      char local[max_float_size];
+      char* buf;
+      size_t len;
+
+      narrow_float(const narrow_float&);
+      narrow_float& operator=(const narrow_float&);
+    public:
+      explicit narrow_float(const wstring_ref& str)
+        :buf(str.length() > max_float_size ? new char[str.length()] : local)
+      {
+        len = narrow_number(str, buf, str.length());
+      }
+      ~narrow_float()
+      {
+        if(buf != local)
+          delete[] buf;
+      }
+      const char* data() const { return buf; }
+      size_t length() const { return len; }
+    };
   }
 
   inline int stoi(const string& str, size_t *end, int base)
@@ -135,6 +196,54 @@ namespace std
     return __::stoi<unsigned long long>(buf, len, end, base);
   }
 
+  inline float stof(const string& str, size_t *end)
+  {
+    return __::stof<float>(str.data(), str.length(), end);
+  }
+
+  inline double stod(const string& str, size_t *end)
+  {
+    return __::stof<double>(str.data(), str.length(), end);
+  }
+
+  inline long double stold(const string& str, size_t *end)
+  {
+    return __::stof<double>(str.data(), str.length(), end);
+  }
+
+  inline float stof(const string_ref& str, size_t *end)
+  {
+    return __::stof<float>(str.data(), str.length(), end);
+  }
+
+  inline double stod(const string_ref& str, size_t *end)
+  {
+    return __::stof<double>(str.data(), str.length(), end);
+  }
+
+  inline long double stold(const string_ref& str, size_t *end)
+  {
+    return __::stof<double>(str.data(), str.length(), end);
+  }
+
+  inline float stof(const wstring_ref& str, size_t *end)
+  {
+    const __::narrow_float number(str);
+    return __::stof<float>(number.data(), number.length(), end);
+  }
+
+  inline double stod(const wstring_ref& str, size_t *end)
+  {
+    const __::narrow_float number(str);
+    return __::stof<double>(number.data(), number.length(), end);
+  }
+
+  inline long double stold(const wstring_ref& str, size_t *end)
+  {
+    const __::narrow_float number(str);
+    return __::stof<double>(number.data(), number.length(), end);
+  }
+
   inline int stoi(const wstring& str, size_t *end, int base)
   {
     return stoi(wstring_ref(str), end, base);
@@ -161,4 +270,19 @@ namespace std
     return stoull(wstring_ref(str), end, base);
   }
 
+  inline float stof(const wstring& str, size_t *end)
+  {
+    return stof(wstring_ref(str), end);
+  }
+
+  inline double stod(const wstring& str, size_t *end)
+  {
+    return stod(wstring_ref(str), end);
+  }
+
+  inline long double stold(const wstring& str, size_t *end)
+  {
+    return stold(wstring_ref(str), end);
+  }
+
 } // namespace std
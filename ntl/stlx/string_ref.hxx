@@ -201,17 +201,11 @@ namespace std
     //////////////////////////////////////////////////////////////////////////
     size_type find(const basic_string_ref& s, size_type pos = 0) const
     {
-      const charT* const beg = begin(), *p = s.begin();
-      for(size_type xpos = pos, n = s.length(); xpos + n <= len; ++xpos)
-      {
-        for(size_type i = 0; i != n; ++i){
-          if ( !traits_type::eq(*(beg + xpos  + i), *(p + i)) )
-            goto next_xpos;
-        }
-        return xpos;
-      next_xpos:;
-      }
-      return npos;
+      if(pos > len || s.length() > len - pos)
+        return npos;
+      const charT* const beg = begin();
+      const charT* const e = __::traits_search<traits_type>(beg + pos, len - pos, s.begin(), s.length());
+      return e == nullptr ? npos : (e-beg);
     }
 
     size_type find(charT c, size_type pos = 0) const
@@ -307,10 +301,24 @@ namespace std
   }
 
   // Hashing
-  template<> struct hash<string_ref>;
-  template<> struct hash<u16string_ref>;
-  template<> struct hash<u32string_ref>;
-  template<> struct hash<wstring_ref>;
+  namespace __
+  {
+    /// basic_string_ref<> hash implementation, the same as of the basic_string<>
+    template<class charT, class traits>
+    struct string_hash<basic_string_ref<charT, traits> >:
+      unary_function<basic_string_ref<charT, traits>, size_t>
+    {
+      inline size_t operator()(const basic_string_ref<charT, traits>& str) const __ntl_nothrow
+      {
+        return ext::hashing::hash_bytes(str.data(), str.length()*sizeof(charT));
+      }
+    };
+  }
+
+  template<> struct hash<string_ref>: __::string_hash<string_ref>{};
+  template<> struct hash<u16string_ref>: __::string_hash<u16string_ref>{};
+  template<> struct hash<u32string_ref>: __::string_hash<u32string_ref>{};
+  template<> struct hash<wstring_ref>: __::string_hash<wstring_ref>{};
 
   //////////////////////////////////////////////////////////////////////////
   // string literals
@@ -10,6 +10,7 @@
 
 #include "stdexcept_fwd.hxx"
 #include "ext/hashtable.hxx"
+#include "ext/flat_hashtable.hxx"
 #include "range.hxx"
 
 namespace std {
@@ -27,7 +28,8 @@ namespace std {
             class T,
             class Hash = hash<Key>,
             class Pred = std::equal_to<Key>,
-            class Alloc = std::allocator<std::pair<const Key, T> >
+            class Alloc = std::allocator<std::pair<const Key, T> >,
+            class TablePolicy = ext::hashtable::chained_policy
             >
   class unordered_map;
 
@@ -46,12 +48,15 @@ namespace std {
    *  
    *  An unordered_map is an unordered associative container that supports unique keys
    *  (an unordered_map contains at most one of each key value) and that associates values of another type \c mapped_type with the keys.
+   *
+   *  @note \c TablePolicy is an extension which selects the backing hash table:
+   *  ext::hashtable::chained_policy (default) or ext::hashtable::flat_policy for the open addressing table.
    **/
-  template <class Key, class T, class Hash, class Pred, class Allocator>
+  template <class Key, class T, class Hash, class Pred, class Allocator, class TablePolicy>
   class unordered_map:
-    public std::ext::hashtable::chained_hashtable<Key,T,Hash,Pred,Allocator, true, true>
+    public TablePolicy::template table<Key,T,Hash,Pred,Allocator, true, true>::type
   {
-    typedef std::ext::hashtable::chained_hashtable<Key,T,Hash,Pred,Allocator, true, true> base;
+    typedef typename TablePolicy::template table<Key,T,Hash,Pred,Allocator, true, true>::type base;
   public:
 
     ///\name types
@@ -319,6 +324,8 @@ namespace std {
 
     /** Invalidates hash table */
     void rehash(size_type n);
+    /** Rebuilds the table to hold at least \c n elements without rehashing */
+    void reserve(size_type n);
     ///\}
 #endif
   };
@@ -573,12 +580,14 @@ namespace std {
 
     /** Invalidates hash table */
     void rehash(size_type n);
+    /** Rebuilds the table to hold at least \c n elements without rehashing */
+    void reserve(size_type n);
     ///\}
 #endif
   };
 
-  template <class Key, class T, class Hash, class Pred, class Alloc>
-  inline void swap(unordered_map<Key, T, Hash, Pred, Alloc>& x, unordered_map<Key, T, Hash, Pred, Alloc>& y) { x.swap(y); }
+  template <class Key, class T, class Hash, class Pred, class Alloc, class TablePolicy>
+  inline void swap(unordered_map<Key, T, Hash, Pred, Alloc, TablePolicy>& x, unordered_map<Key, T, Hash, Pred, Alloc, TablePolicy>& y) { x.swap(y); }
 
   template <class Key, class T, class Hash, class Pred, class Alloc>
   inline void swap(unordered_multimap<Key, T, Hash, Pred, Alloc>& x, unordered_multimap<Key, T, Hash, Pred, Alloc>& y) { x.swap(y); }
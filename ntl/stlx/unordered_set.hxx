@@ -10,6 +10,7 @@
 
 #include "stdexcept_fwd.hxx"
 #include "ext/hashtable.hxx"
+#include "ext/flat_hashtable.hxx"
 #include "range.hxx"
 
 namespace std {
@@ -26,7 +27,8 @@ namespace std {
   template <class Value,
             class Hash = hash<Value>,
             class Pred = std::equal_to<Value>,
-            class Alloc = std::allocator<Value> >
+            class Alloc = std::allocator<Value>,
+            class TablePolicy = ext::hashtable::chained_policy>
   class unordered_set;
 
   // 23.4.4, class template unordered_multiset:
@@ -42,12 +44,15 @@ namespace std {
    *
    *  An unordered_set is an unordered associative container that supports unique keys
    *  (an unordered_set contains at most one of each key value) and in which the elements' keys are the elements themselves.
+   *
+   *  @note \c TablePolicy is an extension which selects the backing hash table:
+   *  ext::hashtable::chained_policy (default) or ext::hashtable::flat_policy for the open addressing table.
    **/
-  template <class Value, class Hash, class Pred, class Allocator>
+  template <class Value, class Hash, class Pred, class Allocator, class TablePolicy>
   class unordered_set:
-    public std::ext::hashtable::chained_hashtable<Value,Value,Hash,Pred,Allocator, false, true>
+    public TablePolicy::template table<Value,Value,Hash,Pred,Allocator, false, true>::type
   {
-    typedef std::ext::hashtable::chained_hashtable<Value,Value,Hash,Pred,Allocator, false, true> base;
+    typedef typename TablePolicy::template table<Value,Value,Hash,Pred,Allocator, false, true>::type base;
   public:
 
     ///\name types
@@ -283,6 +288,8 @@ namespace std {
 
     /** Invalidates hash table */
     void rehash(size_type n);
+    /** Rebuilds the table to hold at least \c n elements without rehashing */
+    void reserve(size_type n);
     ///\}
 #endif
   };
@@ -537,12 +544,14 @@ namespace std {
 
     /** Invalidates hash table */
     void rehash(size_type n);
+    /** Rebuilds the table to hold at least \c n elements without rehashing */
+    void reserve(size_type n);
     ///\}
 #endif
   };
 
-  template <class Value, class Hash, class Pred, class Alloc>
-  inline void swap(unordered_set<Value, Hash, Pred, Alloc>& x, unordered_set<Value, Hash, Pred, Alloc>& y) { x.swap(y); }
+  template <class Value, class Hash, class Pred, class Alloc, class TablePolicy>
+  inline void swap(unordered_set<Value, Hash, Pred, Alloc, TablePolicy>& x, unordered_set<Value, Hash, Pred, Alloc, TablePolicy>& y) { x.swap(y); }
 
   template <class Value, class Hash, class Pred, class Alloc>
   inline void swap(unordered_multiset<Value, Hash, Pred, Alloc>& x, unordered_multiset<Value, Hash, Pred, Alloc>& y) { x.swap(y); }
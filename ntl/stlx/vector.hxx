@@ -12,6 +12,15 @@
 #include "memory.hxx"
 #include "stdexcept_fwd.hxx"
 #include "range.hxx"
+#include "cstring.hxx"
+
+/** The vector storage grows by STLX__VECTOR_GROWTH_NUM / STLX__VECTOR_GROWTH_DEN, twice by default */
+#ifndef STLX__VECTOR_GROWTH_NUM
+#define STLX__VECTOR_GROWTH_NUM 2
+#endif
+#ifndef STLX__VECTOR_GROWTH_DEN
+#define STLX__VECTOR_GROWTH_DEN 1
+#endif
 
 #ifdef _MSC_VER
 # pragma warning(push)
@@ -59,6 +68,7 @@ class vector
     #ifndef __BCPLUSPLUS__
     static_assert((is_same<value_type, typename allocator::value_type>::value), "allocator::value_type must be the same as X::value_type");
     #endif
+    static_assert(STLX__VECTOR_GROWTH_NUM > STLX__VECTOR_GROWTH_DEN, "the vector storage must grow");
   private:
 
     void construct(size_type n, const T& value)
@@ -422,33 +432,26 @@ class vector
       const size_type old_capacity = capacity_;
       iterator old_mem = 0;
       iterator new_end = end_ + n;
-      // a hint to compiler - may be it'll eliminate  while ( tail_size-- ) ...
-      difference_type tail_size = end_ - position;
+      const iterator tail = begin_ + (position - begin_);
       // realloc the first part if needed
       if ( capacity_ < end_- begin_ + n )
       {
-        old_mem = begin_;
-        capacity_ = n + capacity_factor();
-        const iterator new_mem = array_allocator.allocate(capacity_);
-        new_end = new_mem + difference_type(new_end - old_mem);
-        //new_end += difference_type(new_mem - old_mem);        // dangerous alignment
-        iterator dest = begin_ = new_mem;
-        // this is safe for begin_ == 0 && end_ == 0, but keep vector() intact
-        //#ifndef NTL_CXX_RV
-        for ( iterator src = old_mem; src != position; ++src, ++dest )
-          move(dest, src);
-        //#else
-        //for ( iterator src = old_mem; src != position; ++src, ++dest ){
-        //  *dest = std::move(*src);
-        //  array_allocator.destroy(src);
-        //}
-        //#endif
+        const size_type grown = n + capacity_factor();
+        if ( !expand(grown) )
+        {
+          old_mem = begin_;
+          const iterator new_mem = array_allocator.allocate(grown);
+          capacity_ = grown;
+          new_end = new_mem + difference_type(new_end - old_mem);
+          //new_end += difference_type(new_mem - old_mem);        // dangerous alignment
+          begin_ = new_mem;
+          // this is safe for begin_ == 0 && end_ == 0, but keep vector() intact
+          relocate(new_mem, old_mem, tail);
+        }
       }
       // move the tail. iterators are reverse - may be no realloc
-      iterator r_src = end();
-      iterator r_dest = end_ = new_end;
-      while ( tail_size-- )
-        move(--r_dest, --r_src);
+      const iterator r_dest = relocate_backward(new_end, tail, end_);
+      end_ = new_end;
       if ( old_mem ) array_allocator.deallocate(old_mem, old_capacity);
       return r_dest;
     }
@@ -695,18 +698,57 @@ class vector
       array_allocator.destroy(from);
     }
 
+    typedef ext::is_trivially_relocatable<T> relocatable;
+
+    /** Moves [first, last) to the raw memory at \p to, returns the end of the destination */
+    iterator relocate(iterator to, iterator first, iterator last) const
+    {
+      if ( relocatable::value )
+      {
+        const size_type n = static_cast<size_type>(last - first);
+        if ( n ) memcpy(static_cast<void*>(to), static_cast<const void*>(first), n * sizeof(T));
+        return to + n;
+      }
+      for ( ; first != last; ++first, ++to )
+        move(to, first);
+      return to;
+    }
+
+    /** Moves [first, last) to the raw memory ending at \p to, which may overlap it from above; returns the beginning of the destination */
+    iterator relocate_backward(iterator to, iterator first, iterator last) const
+    {
+      if ( relocatable::value )
+      {
+        const size_type n = static_cast<size_type>(last - first);
+        if ( n ) memmove(static_cast<void*>(to - n), static_cast<const void*>(first), n * sizeof(T));
+        return to - n;
+      }
+      while ( last != first )
+        move(--to, --last);
+      return to;
+    }
+
+    /** Grows the storage to \p n elements in place if the allocator can */
+    bool expand(size_type n)
+    {
+      if ( !begin_ || !ext::allocator_expansion<allocator>::expand(array_allocator, begin_, capacity_, n) )
+        return false;
+      capacity_ = n;
+      return true;
+    }
+
     void realloc(size_type n) __ntl_throws(bad_alloc)
     {
+      if ( expand(n) )
+        return;
       const iterator new_mem = array_allocator.allocate(n);
       const size_type old_capacity = capacity_;
       capacity_ = n;
-      iterator dest = new_mem;
       // this is safe for begin_ == 0 && end_ == 0, but keep vector() coherent
-      for ( iterator src = begin_; src != end_; ++src, ++dest )
-        move(dest, src);
+      const iterator new_end = relocate(new_mem, begin_, end_);
       if ( begin_ ) array_allocator.deallocate(begin_, old_capacity);
       begin_ = new_mem;
-      end_ = dest;
+      end_ = new_end;
     }
 
     //  + 8/2 serves two purposes:
@@ -714,7 +756,13 @@ class vector
     //    for smal capacity_ values reallocation will be more efficient
     //      2,  4,  8,  16,  32,  64, 128, 256, 512
     //      8, 24, 56, 120, 248, 504,
-    size_type capacity_factor() const { return (capacity_ + 4) * 2; }
+    size_type capacity_factor() const
+    {
+      const size_type c = capacity_ + 4, num = STLX__VECTOR_GROWTH_NUM, den = STLX__VECTOR_GROWTH_DEN;
+      // c * num / den, saturated at max_size()
+      if ( c / den >= max_size() / num ) return max_size();
+      return c / den * num + c % den * num / den;
+    }
 
 };//class vector
 
@@ -761,6 +809,16 @@ template <class T, class Allocator>
 inline void swap(vector<T, Allocator>& x, vector<T, Allocator>& y) __ntl_nothrow { x.swap(y); }
 
 ///@}
+
+namespace ext
+{
+  /** vector keeps no pointers to itself */
+  template <class T, class Allocator>
+  struct is_trivially_relocatable<vector<T, Allocator> >:
+    is_trivially_relocatable<typename Allocator::template rebind<T>::other>
+  {};
+}
+
 /**@} lib_sequence */
 /**@} lib_containers */
 
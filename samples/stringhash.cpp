@@ -0,0 +1,59 @@
+//  NTL samples library
+//  String hash benchmark: the throughput of FNV-1, CRC-32C and wyhash
+//  on the keys of the short, medium and long lengths.
+//
+//  compile:
+//      cl /nologo /O2 /EHsc /DUNICODE /GS- /I"%ntl64%" stringhash.cpp /link /subsystem:console
+//
+#include <consoleapp.hxx>
+#include <iostream>
+#include <string>
+#include <vector>
+#include <chrono>
+
+namespace
+{
+  std::vector<std::string> make_keys(size_t count, size_t length)
+  {
+    std::vector<std::string> v(count, std::string(length, 'a'));
+    unsigned seed = static_cast<unsigned>(length);
+    for(size_t i = 0; i < count; i++)
+      for(size_t c = 0; c < length; c++){
+        seed = seed * 1103515245 + 12345;
+        v[i][c] = static_cast<char>(' ' + (seed >> 16) % 95);
+      }
+    return v;
+  }
+
+  template<class Hash>
+  double gigabytes_per_second(const std::vector<std::string>& keys, Hash h, size_t& sink)
+  {
+    size_t bytes = 0;
+    const std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
+    for(int round = 0; round < 20; round++)
+      for(size_t i = 0; i < keys.size(); i++){
+        sink += h(keys[i].data(), keys[i].size());
+        bytes += keys[i].size();
+      }
+    const int64_t ns = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::high_resolution_clock::now() - start).count();
+    return ns ? static_cast<double>(bytes) / static_cast<double>(ns) : 0;
+  }
+
+  size_t fnv_hash(const void* p, size_t n) { return std::ext::hashing::fnv(p, n); }
+  size_t crc_hash(const void* p, size_t n) { return std::ext::hashing::crc32c(p, n); }
+  size_t wy_hash(const void* p, size_t n)  { return static_cast<size_t>(std::ext::hashing::wyhash(p, n)); }
+}
+
+int ntl::consoleapp::main()
+{
+  static const size_t lengths[] = { 16, 64, 256 };
+  size_t sink = 0;
+  for(size_t k = 0; k < sizeof(lengths) / sizeof(*lengths); k++){
+    const std::vector<std::string> keys = make_keys(100000, lengths[k]);
+    std::cout << "string hash on " << keys.size() << " keys of " << lengths[k] << " bytes:\n"
+      << "  fnv:    " << gigabytes_per_second(keys, fnv_hash, sink) << " GB/s\n"
+      << "  crc32c: " << gigabytes_per_second(keys, crc_hash, sink) << " GB/s\n"
+      << "  wyhash: " << gigabytes_per_second(keys, wy_hash, sink)  << " GB/s\n";
+  }
+  return sink == 0;
+}
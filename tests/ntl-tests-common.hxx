@@ -3,6 +3,7 @@
 #include <tut/tut.hpp>
 #include <nt/debug.hxx>
 #include <nt/dbgstream.hxx>
+#include <memory>
 namespace dbg = ntl::nt::dbg;
 
 
@@ -82,6 +83,59 @@ namespace
   tut::testgroup tg(name); \
 }
 
+//////////////////////////////////////////////////////////////////////////
+// common test fixtures
+namespace
+{
+  // deterministic pseudo random sequence
+  inline unsigned next_random(unsigned& seed)
+  {
+    seed = seed * 1103515245 + 12345;
+    return seed >> 8;
+  }
+
+  // xorshift32, the full 32 bits of each value are random
+  inline uint32_t next_xorshift(uint32_t& seed)
+  {
+    seed ^= seed << 13;
+    seed ^= seed >> 17;
+    seed ^= seed << 5;
+    return seed;
+  }
+
+  // counts the blocks of the counting_allocator: the live ones, their peak and all allocated
+  struct blocks
+  {
+    static size_t live, peak, allocated;
+  };
+  size_t blocks::live = 0, blocks::peak = 0, blocks::allocated = 0;
+
+  template<class T>
+  class counting_allocator: public std::allocator<T>
+  {
+  public:
+    typedef T*      pointer;
+    typedef size_t  size_type;
+    template<class U> struct rebind { typedef counting_allocator<U> other; };
+
+    counting_allocator() {}
+    template<class U> counting_allocator(const counting_allocator<U>&) {}
+
+    pointer allocate(size_type n, const void* = 0)
+    {
+      blocks::allocated++;
+      if(++blocks::live > blocks::peak)
+        blocks::peak = blocks::live;
+      return std::allocator<T>::allocate(n);
+    }
+    void deallocate(pointer p, size_type n)
+    {
+      blocks::live--;
+      std::allocator<T>::deallocate(p, n);
+    }
+  };
+}
+
 //////////////////////////////////////////////////////////////////////////
 // compiler-specific settings
 
@@ -0,0 +1,185 @@
+// 20.2.8 Primitive numeric output conversion [utility.to.chars]
+
+#include <ntl-tests-common.hxx>
+#include <charconv>
+#include <sstream>
+#include <limits>
+
+STLX_DEFAULT_TESTGROUP_NAME("std::to_chars");
+
+namespace
+{
+  char buf[512];
+
+  template<class T>
+  bool formats(T v, const char* expected)
+  {
+    const std::to_chars_result r = std::to_chars(buf, buf + sizeof(buf), v);
+    return r.ec == std::errc() && std::string(buf, r.ptr) == expected;
+  }
+
+  template<class T>
+  bool formats(T v, std::chars_format fmt, const char* expected)
+  {
+    const std::to_chars_result r = std::to_chars(buf, buf + sizeof(buf), v, fmt);
+    return r.ec == std::errc() && std::string(buf, r.ptr) == expected;
+  }
+
+  template<class T>
+  bool formats(T v, std::chars_format fmt, int precision, const char* expected)
+  {
+    const std::to_chars_result r = std::to_chars(buf, buf + sizeof(buf), v, fmt, precision);
+    return r.ec == std::errc() && std::string(buf, r.ptr) == expected;
+  }
+
+  template<class T>
+  bool formats_base(T v, int base, const char* expected)
+  {
+    const std::to_chars_result r = std::to_chars(buf, buf + sizeof(buf), v, base);
+    return r.ec == std::errc() && std::string(buf, r.ptr) == expected;
+  }
+
+  template<class T>
+  std::string put(T v, std::ios_base::fmtflags flags, std::streamsize precision = 6, std::streamsize width = 0)
+  {
+    std::ostringstream s;
+    s.flags(flags);
+    s.precision(precision);
+    s.width(width);
+    s << v;
+    return s.str();
+  }
+}
+
+// shortest round trip
+template<> template<> void tut::to::test<01>(void)
+{
+  VERIFY( formats(0.0, "0") );
+  VERIFY( formats(-0.0, "-0") );
+  VERIFY( formats(0.1, "0.1") );
+  VERIFY( formats(0.3, "0.3") );
+  VERIFY( formats(0.1 + 0.2, "0.30000000000000004") );
+  VERIFY( formats(1.5e-10, "1.5e-10") );
+  VERIFY( formats(123456.0, "123456") );
+  VERIFY( formats(1e22, "1e+22") );
+  VERIFY( formats(5e-324, "5e-324") );
+  VERIFY( formats(1.7976931348623157e308, "1.7976931348623157e+308") );
+  VERIFY( formats(0.1f, "0.1") );
+  VERIFY( formats(16777216.0f, "16777216") );
+
+  VERIFY( formats(100.0, std::chars_format::scientific, "1e+02") );
+  VERIFY( formats(1e23, std::chars_format::fixed, "99999999999999991611392") );
+  VERIFY( formats(0.0001, std::chars_format::general, "0.0001") );
+  VERIFY( formats(0.00001, std::chars_format::general, "1e-05") );
+  VERIFY( formats(3.0, std::chars_format::hex, "1.8p+1") );
+  VERIFY( formats(-0.0, std::chars_format::hex, "-0p+0") );
+}
+
+// precision
+template<> template<> void tut::to::test<02>(void)
+{
+  VERIFY( formats(3.14159, std::chars_format::fixed, 2, "3.14") );
+  VERIFY( formats(0.5, std::chars_format::fixed, 0, "0") );
+  VERIFY( formats(1.5, std::chars_format::fixed, 0, "2") );
+  VERIFY( formats(2.5, std::chars_format::fixed, 0, "2") );
+  VERIFY( formats(0.125, std::chars_format::fixed, 2, "0.12") );
+  VERIFY( formats(9.996, std::chars_format::fixed, 2, "10.00") );
+  VERIFY( formats(0.004, std::chars_format::fixed, 2, "0.00") );
+  VERIFY( formats(0.1, std::chars_format::fixed, 20, "0.10000000000000000555") );
+  VERIFY( formats(1e21, std::chars_format::fixed, 1, "1000000000000000000000.0") );
+
+  VERIFY( formats(1234.5678, std::chars_format::scientific, 3, "1.235e+03") );
+  VERIFY( formats(0.0, std::chars_format::scientific, 2, "0.00e+00") );
+  VERIFY( formats(9.99e99, std::chars_format::scientific, 1, "1.0e+100") );
+
+  VERIFY( formats(1234.5678, std::chars_format::general, 6, "1234.57") );
+  VERIFY( formats(1234567.0, std::chars_format::general, 6, "1.23457e+06") );
+  VERIFY( formats(0.0001, std::chars_format::general, 6, "0.0001") );
+  VERIFY( formats(100.0, std::chars_format::general, 6, "100") );
+  VERIFY( formats(0.1, std::chars_format::general, 17, "0.10000000000000001") );
+
+  VERIFY( formats(1.0, std::chars_format::hex, 3, "1.000p+0") );
+  VERIFY( formats(1.5, std::chars_format::hex, 0, "2p+0") );
+}
+
+// special values and the short buffer
+template<> template<> void tut::to::test<03>(void)
+{
+  const double inf = std::numeric_limits<double>::infinity();
+  VERIFY( formats(inf, "inf") );
+  VERIFY( formats(-inf, std::chars_format::fixed, 2, "-inf") );
+  VERIFY( formats(std::numeric_limits<double>::quiet_NaN(), "nan") );
+
+  char small[4];
+  std::to_chars_result r = std::to_chars(small, small + sizeof(small), 12345.0);
+  VERIFY( r.ec == std::errc::value_too_large && r.ptr == small + sizeof(small) );
+  r = std::to_chars(small, small + sizeof(small), 1234.0);
+  VERIFY( r.ec == std::errc() && r.ptr == small + 4 );
+}
+
+// num_put
+template<> template<> void tut::to::test<04>(void)
+{
+  typedef std::ios_base ios;
+  VERIFY( put(0.1 + 0.2, ios::dec) == "0.3" );
+  VERIFY( put(1234567.0, ios::dec) == "1.23457e+06" );
+  VERIFY( put(2.5, ios::fixed, 3) == "2.500" );
+  VERIFY( put(2.5, ios::scientific | ios::uppercase, 2) == "2.50E+00" );
+  VERIFY( put(2.0, ios::showpoint, 3) == "2.00" );
+  VERIFY( put(2.0, ios::showpos) == "+2" );
+  VERIFY( put(3.0, ios::fixed | ios::scientific) == "0x1.8p+1" );
+  VERIFY( put(-1.5, ios::fixed | ios::internal, 1, 8) == "-    1.5" );
+  VERIFY( put(-1.5, ios::fixed | ios::left, 1, 8) == "-1.5    " );
+  VERIFY( put(-1.5, ios::fixed, 1, 8) == "    -1.5" );
+  VERIFY( put(1e100, ios::fixed, 0).size() == 101 );
+}
+
+// integers
+template<> template<> void tut::to::test<05>(void)
+{
+  VERIFY( formats(0, "0") );
+  VERIFY( formats(-7, "-7") );
+  VERIFY( formats(1234567890u, "1234567890") );
+  VERIFY( formats(std::numeric_limits<int>::min(), "-2147483648") );
+  VERIFY( formats(std::numeric_limits<long long>::min(), "-9223372036854775808") );
+  VERIFY( formats(std::numeric_limits<unsigned long long>::max(), "18446744073709551615") );
+  VERIFY( formats(static_cast<signed char>(-128), "-128") );
+  VERIFY( formats(static_cast<unsigned short>(65535), "65535") );
+
+  VERIFY( formats_base(255, 16, "ff") );
+  VERIFY( formats_base(-255, 16, "-ff") );
+  VERIFY( formats_base(5u, 2, "101") );
+  VERIFY( formats_base(35, 36, "z") );
+  VERIFY( formats_base(std::numeric_limits<unsigned long long>::max(), 8, "1777777777777777777777") );
+  VERIFY( formats_base(std::numeric_limits<long long>::min(), 2, "-1000000000000000000000000000000000000000000000000000000000000000") );
+  VERIFY( formats_base(100, 7, "202") );
+
+  char small[3];
+  std::to_chars_result r = std::to_chars(small, small + sizeof(small), -100);
+  VERIFY( r.ec == std::errc::value_too_large && r.ptr == small + sizeof(small) );
+  r = std::to_chars(small, small + sizeof(small), -99);
+  VERIFY( r.ec == std::errc() && r.ptr == small + 3 );
+
+  VERIFY( std::to_string(-42) == "-42" );
+  VERIFY( std::to_string(std::numeric_limits<unsigned long long>::max()) == "18446744073709551615" );
+  VERIFY( std::to_wstring(1000000u) == L"1000000" );
+}
+
+// num_put of integers
+template<> template<> void tut::to::test<06>(void)
+{
+  typedef std::ios_base ios;
+  VERIFY( put(-123L, ios::dec) == "-123" );
+  VERIFY( put(123L, ios::showpos) == "+123" );
+  VERIFY( put(123UL, ios::showpos) == "123" );
+  VERIFY( put(255L, ios::hex | ios::showbase) == "0xff" );
+  VERIFY( put(255L, ios::hex | ios::showbase | ios::uppercase) == "0XFF" );
+  VERIFY( put(0L, ios::hex | ios::showbase) == "0" );
+  VERIFY( put(8L, ios::oct | ios::showbase) == "010" );
+  VERIFY( put(-1L, ios::hex) == "ffffffff" );
+  VERIFY( put(-1LL, ios::hex) == "ffffffffffffffff" );
+  VERIFY( put(-42L, ios::internal, 6, 6) == "-   42" );
+  VERIFY( put(42L, ios::left, 6, 6) == "42    " );
+  VERIFY( put(255L, ios::hex | ios::showbase | ios::internal, 6, 8) == "0x    ff" );
+  VERIFY( put(std::numeric_limits<long long>::min(), ios::dec) == "-9223372036854775808" );
+}
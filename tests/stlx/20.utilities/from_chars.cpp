@@ -0,0 +1,216 @@
+// 20.2.9 Primitive numeric input conversion [utility.from.chars]
+
+#include <ntl-tests-common.hxx>
+#include <charconv>
+#include <sstream>
+#include <string>
+#include <limits>
+#include <cstring>
+
+STLX_DEFAULT_TESTGROUP_NAME("std::from_chars");
+
+namespace
+{
+  template<class T>
+  bool parses(const char* s, T expected, size_t length, std::chars_format fmt = std::chars_format::general)
+  {
+    T v = T(-1);
+    const char* const last = s + std::char_traits<char>::length(s);
+    const std::from_chars_result r = std::from_chars(s, last, v, fmt);
+    return r.ec == std::errc() && r.ptr == s + length && memcmp(&v, &expected, sizeof(v)) == 0;
+  }
+
+  template<class T>
+  bool rejects(const char* s, std::errc ec, std::chars_format fmt = std::chars_format::general)
+  {
+    T v = T(42);
+    const char* const last = s + std::char_traits<char>::length(s);
+    const std::from_chars_result r = std::from_chars(s, last, v, fmt);
+    return r.ec == ec && v == T(42) && (ec != std::errc::invalid_argument || r.ptr == s);
+  }
+
+  template<class T>
+  bool parses_base(const char* s, T expected, size_t length, int base = 10)
+  {
+    T v = T(1);
+    const char* const last = s + std::char_traits<char>::length(s);
+    const std::from_chars_result r = std::from_chars(s, last, v, base);
+    return r.ec == std::errc() && r.ptr == s + length && v == expected;
+  }
+
+  template<class T>
+  bool rejects_base(const char* s, std::errc ec, size_t length = 0, int base = 10)
+  {
+    T v = T(42);
+    const char* const last = s + std::char_traits<char>::length(s);
+    const std::from_chars_result r = std::from_chars(s, last, v, base);
+    return r.ec == ec && v == T(42) && r.ptr == s + length;
+  }
+
+  bool bits_equal(double a, uint64_t bits)
+  {
+    return memcmp(&a, &bits, sizeof(a)) == 0;
+  }
+}
+
+// decimal
+template<> template<> void tut::to::test<01>(void)
+{
+  VERIFY( parses("0", 0.0, 1) );
+  VERIFY( parses("-0", -0.0, 2) );
+  VERIFY( parses("0.1", 0.1, 3) );
+  VERIFY( parses(".5", 0.5, 2) );
+  VERIFY( parses("5.", 5.0, 2) );
+  VERIFY( parses("1e23", 1e23, 4) );
+  VERIFY( parses("-2.5E-3x", -2.5e-3, 7) );
+  VERIFY( parses("1e", 1.0, 1) );
+  VERIFY( parses("1e+", 1.0, 1) );
+  VERIFY( parses("123456789012345678901234567890", 123456789012345678901234567890.0, 30) );
+  VERIFY( parses("0.000000000000000000000000000000000000001e39", 1.0, 44) );
+  VERIFY( parses("1.7976931348623157e308", 1.7976931348623157e308, 22) );
+  VERIFY( parses("4.9406564584124654e-324", 4.9406564584124654e-324, 23) );
+  VERIFY( parses("2.2250738585072011e-308", 2.2250738585072011e-308, 23) );
+  VERIFY( parses("0.1f", 0.1f, 3) );
+  VERIFY( parses("3.4028235e38", 3.4028235e38f, 12) );
+  VERIFY( parses("1.4e-45", 1.4e-45f, 7) );
+}
+
+// ties and the digits past the 19th
+template<> template<> void tut::to::test<02>(void)
+{
+  double v;
+  // 2^53 + 1 is halfway between two doubles, the even one is 2^53
+  std::from_chars("9007199254740993", "9007199254740993" + 16, v);
+  VERIFY( v == 9007199254740992.0 );
+  std::from_chars("9007199254740993.0000000000000000000000001", "9007199254740993.0000000000000000000000001" + 42, v);
+  VERIFY( v == 9007199254740994.0 );
+  // exactly halfway between the double nearest to 0.1 and its successor, written in full
+  const char half[] = "0.100000000000000012490009027033011079765856266021728515625";
+  std::from_chars(half, half + sizeof(half) - 1, v);
+  VERIFY( bits_equal(v, 0x3FB999999999999AULL) );
+  const char above[] = "0.1000000000000000124900090270330110797658562660217285156250000000000000000000000001";
+  std::from_chars(above, above + sizeof(above) - 1, v);
+  VERIFY( bits_equal(v, 0x3FB999999999999BULL) );
+  // half of the smallest subnormal rounds to zero, anything above it rounds up
+  VERIFY( rejects<double>("2.4703282292062327208828439643411068618252990130716238221279284125033775363510437593264991818081799618989828234772285886546332835517796989819938739800539093906315035659515570226392290858392449105184435e-324", std::errc::result_out_of_range) );
+  std::from_chars("2.4703282292062328e-324", "2.4703282292062328e-324" + 23, v);
+  VERIFY( bits_equal(v, 1) );
+}
+
+// formats, special values and errors
+template<> template<> void tut::to::test<03>(void)
+{
+  VERIFY( parses("1e5", 1.0, 1, std::chars_format::fixed) );
+  VERIFY( parses("1e5", 1e5, 3, std::chars_format::scientific) );
+  VERIFY( rejects<double>("15", std::errc::invalid_argument, std::chars_format::scientific) );
+  VERIFY( parses("1.8p1", 3.0, 5, std::chars_format::hex) );
+  VERIFY( parses("-a.8", -10.5, 4, std::chars_format::hex) );
+  VERIFY( parses("0x1p3", 0.0, 1, std::chars_format::hex) );
+  VERIFY( rejects<double>("1.fffffffffffff8p1023", std::errc::result_out_of_range, std::chars_format::hex) );
+
+  VERIFY( parses("inf", std::numeric_limits<double>::infinity(), 3) );
+  VERIFY( parses("-Infinity", -std::numeric_limits<double>::infinity(), 9) );
+  double v;
+  const char nan[] = "nan(123)";
+  const std::from_chars_result r = std::from_chars(nan, nan + 8, v);
+  VERIFY( r.ec == std::errc() && r.ptr == nan + 8 && v != v );
+
+  VERIFY( rejects<double>("", std::errc::invalid_argument) );
+  VERIFY( rejects<double>("+1", std::errc::invalid_argument) );
+  VERIFY( rejects<double>(" 1", std::errc::invalid_argument) );
+  VERIFY( rejects<double>(".", std::errc::invalid_argument) );
+  VERIFY( rejects<double>("1e309", std::errc::result_out_of_range) );
+  VERIFY( rejects<double>("1e-400", std::errc::result_out_of_range) );
+  VERIFY( rejects<float>("1e39", std::errc::result_out_of_range) );
+}
+
+// stod and num_get
+template<> template<> void tut::to::test<04>(void)
+{
+  size_t idx;
+  VERIFY( std::stod(std::string("  +1.5e3 tail"), &idx) == 1500.0 && idx == 8 );
+  VERIFY( std::stod(std::string("0x1.8p1")) == 3.0 );
+  VERIFY( std::stof(std::string("0.1")) == 0.1f );
+  VERIFY( std::stod(std::wstring(L"-0.25")) == -0.25 );
+  // the wide number longer than the narrowing buffer
+  const std::wstring longer = L"1" + std::wstring(400, L'0') + L"e-400 tail";
+  VERIFY( std::stod(longer, &idx) == 1.0 && idx == 406 );
+  VERIFY( std::stof(longer, &idx) == 1.0f && idx == 406 );
+
+  std::istringstream s("1.25 -3e2 0.1 1e500 x");
+  double d = 0;
+  float f = 0;
+  s >> d;
+  VERIFY( d == 1.25 );
+  s >> d;
+  VERIFY( d == -300.0 );
+  s >> f;
+  VERIFY( f == 0.1f );
+  s >> d;
+  VERIFY( s.fail() && d == std::numeric_limits<double>::max() );
+  s.clear();
+  s >> d;
+  VERIFY( s.fail() && d == 0 );
+}
+
+// integers
+template<> template<> void tut::to::test<05>(void)
+{
+  VERIFY( parses_base("0", 0, 1) );
+  VERIFY( parses_base("-0", 0, 2) );
+  VERIFY( parses_base("123abc", 123, 3) );
+  VERIFY( parses_base("-2147483648", std::numeric_limits<int>::min(), 11) );
+  VERIFY( parses_base("2147483647", std::numeric_limits<int>::max(), 10) );
+  VERIFY( parses_base("18446744073709551615", std::numeric_limits<unsigned long long>::max(), 20) );
+  VERIFY( parses_base("-9223372036854775808", std::numeric_limits<long long>::min(), 20) );
+  VERIFY( parses_base("0000000000000000000000000000000000000042", 42u, 40) );
+  VERIFY( parses_base("12345678901234567", 12345678901234567LL, 17) );
+  VERIFY( parses_base("FF", 255, 2, 16) );
+  VERIFY( parses_base("-7fffffff", -0x7fffffff, 9, 16) );
+  VERIFY( parses_base("1012", 5, 3, 2) );
+  VERIFY( parses_base("Zz", 35 * 36 + 35, 2, 36) );
+  VERIFY( parses_base("-128", static_cast<signed char>(-128), 4) );
+
+  VERIFY( rejects_base<int>("", std::errc::invalid_argument) );
+  VERIFY( rejects_base<int>("-", std::errc::invalid_argument) );
+  VERIFY( rejects_base<int>("+1", std::errc::invalid_argument) );
+  VERIFY( rejects_base<int>(" 1", std::errc::invalid_argument) );
+  VERIFY( rejects_base<unsigned>("-1", std::errc::invalid_argument) );
+  VERIFY( parses_base("0x10", 0, 1, 16) );
+  VERIFY( rejects_base<int>("2147483648", std::errc::result_out_of_range, 10) );
+  VERIFY( rejects_base<int>("-2147483649", std::errc::result_out_of_range, 11) );
+  VERIFY( rejects_base<unsigned char>("256", std::errc::result_out_of_range, 3) );
+  VERIFY( rejects_base<unsigned long long>("18446744073709551616x", std::errc::result_out_of_range, 20) );
+  VERIFY( rejects_base<long long>("99999999999999999999999999", std::errc::result_out_of_range, 26) );
+}
+
+// stoi and num_get of integers
+template<> template<> void tut::to::test<06>(void)
+{
+  size_t idx;
+  VERIFY( std::stoi(std::string("  -42 tail"), &idx) == -42 && idx == 5 );
+  VERIFY( std::stoi(std::string("0x1f"), 0, 0) == 31 );
+  VERIFY( std::stoi(std::string("017"), 0, 0) == 15 );
+  VERIFY( std::stoull(std::string("18446744073709551615")) == std::numeric_limits<unsigned long long>::max() );
+  VERIFY( std::stol(std::wstring(L"123")) == 123 );
+
+  std::istringstream s("123 -45 ff 99999999999 x");
+  long l = 0;
+  s >> l;
+  VERIFY( l == 123 );
+  s >> l;
+  VERIFY( l == -45 );
+  s >> std::hex >> l >> std::dec;
+  VERIFY( l == 255 );
+  int i = 0;
+  s >> i;
+  VERIFY( s.fail() && i == std::numeric_limits<int>::max() );
+  s.clear();
+  s >> i;
+  VERIFY( s.fail() && i == 0 );
+
+  std::istringstream p("0x1234");
+  void* v = 0;
+  p >> v;
+  VERIFY( v == reinterpret_cast<void*>(0x1234) );
+}
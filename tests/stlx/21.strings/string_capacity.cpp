@@ -265,8 +265,8 @@ template<> template<> void tut::to::test<03>()
   typedef string::size_type size_type;
 
   // Our current implementation provides exact shrink-to-size
-  // and shrink-to-fit (in the future, maybe this will change
-  // for short strings).
+  // and shrink-to-fit, except the short strings which are moved
+  // into the inline buffer.
   const size_type minsize = 2 << 0;
   const size_type maxsize = 2 << 20;
   for (size_type i = minsize; i <= maxsize; i *= 2)
@@ -278,7 +278,7 @@ template<> template<> void tut::to::test<03>()
     VERIFY( str.capacity() >= 2 * i );
 
     str.reserve();
-    VERIFY( str.capacity() == i );
+    VERIFY( str.capacity() == i || (i < 16 && str.capacity() == 16) );
   }
 }
 
@@ -287,9 +287,74 @@ template<> template<> void tut::to::test<04>()
   //tut::skip("see above");
   bool test __attribute__((unused)) = true;
 
-  std::string str01 = "twelve chars";
+  std::string str01 = "twenty-four characters!!";
   // str01 becomes shared
   std::string str02 = str01;
   str01.reserve(1);
-  VERIFY( str01.capacity() == 12 );
+  VERIFY( str01.capacity() == 24 );
+}
+
+template<> template<> void tut::to::test<05>()
+{
+  // short strings are kept inline
+  std::string s1 = "short", s2(100, 'x');
+  const std::string::size_type inline_capacity = s1.capacity();
+  VERIFY( inline_capacity >= 5 );
+
+  s1.swap(s2);
+  VERIFY( s1 == std::string(100, 'x') && s2 == "short" );
+  VERIFY( s2.capacity() == inline_capacity );
+  s1.swap(s2);
+  VERIFY( s1 == "short" && s2.size() == 100 );
+
+  std::string s3 = s1;
+  s3.append(s2);
+  VERIFY( s3.size() == 105 && s3.compare(0, 5, "short") == 0 );
+  s3.resize(3);
+  s3.shrink_to_fit();
+  VERIFY( s3 == "sho" && s3.capacity() == inline_capacity );
+  VERIFY( *(s3.c_str() + 3) == '\0' );
+}
+
+// the short strings never allocate, swap and move keep the contents between the inline and the allocated buffers
+template<> template<> void tut::to::test<06>()
+{
+  typedef std::basic_string<char, std::char_traits<char>, counting_allocator<char> > counted_string;
+  {
+    const counted_string xs(100, 'x');
+    const size_t allocated = blocks::allocated;
+    VERIFY( blocks::live == 1 );
+
+    counted_string empty, s1("short"), s2(15, 'y'), s3 = s1;
+    s3 = s2;
+    s3.assign("fifteen chars!!");
+    s1.append("er");
+    empty.reserve(10);
+    VERIFY( blocks::allocated == allocated && blocks::live == 1 );
+    VERIFY( s1 == "shorter" && s2 == "yyyyyyyyyyyyyyy" && s3 == "fifteen chars!!" && *empty.c_str() == '\0' );
+
+    counted_string heap = xs;
+    VERIFY( blocks::allocated == allocated + 1 && blocks::live == 2 );
+
+    s1.swap(heap);
+    VERIFY( s1 == xs && heap == "shorter" );
+    heap.swap(s1);
+    VERIFY( heap == xs && s1 == "shorter" );
+    s1.swap(s2);
+    VERIFY( s1 == "yyyyyyyyyyyyyyy" && s2 == "shorter" );
+    VERIFY( blocks::allocated == allocated + 1 && blocks::live == 2 );
+
+#ifdef NTL_CXX_RV
+    counted_string moved(std::move(heap));
+    VERIFY( moved == xs && heap.empty() );
+    counted_string inline_moved(std::move(s2));
+    VERIFY( inline_moved == "shorter" && s2.empty() );
+    s3 = std::move(moved);
+    VERIFY( s3 == xs && moved.empty() );
+    moved = std::move(inline_moved);
+    VERIFY( moved == "shorter" && inline_moved.empty() );
+    VERIFY( blocks::allocated == allocated + 1 && blocks::live == 2 );
+#endif
+  }
+  VERIFY( blocks::live == 0 );
 }
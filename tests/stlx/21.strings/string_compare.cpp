@@ -145,3 +145,33 @@ template<> template<> void tut::to::test<02>()
   const string str_b(lit_ref_b, 3);
   VERIFY( str_b.compare(0, 3, lit_02, 5) < 0 );
 }
+
+// char_traits::compare on the sequences longer than a vector block
+template<> template<> void tut::to::test<03>()
+{
+  using namespace std;
+  string a(100, 'x');
+  for(string::size_type i = 0; i < a.size(); i++){
+    string b(a);
+    b[i] = 'y';
+    VERIFY( a.compare(b) < 0 && b.compare(a) > 0 );
+    // chars are compared as unsigned
+    b[i] = '\xE0';
+    VERIFY( a.compare(b) < 0 );
+    // the difference after the embedded zero still counts
+    b = a;
+    b[i / 2] = '\0';
+    a[i / 2] = '\0';
+    b[i] = 'z';
+    VERIFY( a.compare(b) < 0 );
+    a[i / 2] = 'x';
+  }
+  VERIFY( a.compare(string(100, 'x')) == 0 );
+
+  const wstring w1(70, L'a');
+  wstring w2(w1);
+  w2[69] = L'b';
+  VERIFY( w1.compare(w2) < 0 && w2.compare(w1) > 0 );
+  w2[0] = L'\x8000';
+  VERIFY( w1.compare(w2) < 0 );
+}
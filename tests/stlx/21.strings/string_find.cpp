@@ -352,3 +352,64 @@ template<> template<> void tut::to::test<07>()
 
 }
 
+// 21.3.6.1 basic_string::find(charT) on the sequences longer than a vector block
+template<> template<> void tut::to::test<08>()
+{
+  bool test __attribute__((unused)) = true;
+  std::string s(200, 'a');
+  for(std::string::size_type i = 0; i < s.size(); i++){
+    s[i] = 'b';
+    VERIFY( s.find('b') == i );
+    VERIFY( s.find('b', i) == i );
+    VERIFY( s.find('b', i + 1) == std::string::npos );
+    VERIFY( s.find('\xB0') == std::string::npos );
+    s[i] = 'a';
+  }
+  VERIFY( s.find('a', 200) == std::string::npos );
+  VERIFY( s.find('a', 199) == 199 );
+
+  std::wstring w(100, L'a');
+  w[77] = L'\x1234';
+  VERIFY( w.find(L'\x1234') == 77 );
+  VERIFY( w.find(L'\x1235') == std::wstring::npos );
+  VERIFY( std::char_traits<wchar_t>::length(w.c_str()) == 100 );
+  VERIFY( std::char_traits<char>::length(s.c_str() + 3) == 197 );
+}
+
+// 21.3.6.1 basic_string::find with the long and the periodic needles
+template<> template<> void tut::to::test<09>()
+{
+  bool test __attribute__((unused)) = true;
+  std::string hay(5000, 'a');
+  std::string needle(100, 'a');
+  needle += 'b';
+  VERIFY( hay.find(needle) == std::string::npos );
+  hay[4999] = 'b';
+  VERIFY( hay.find(needle) == 4899 );
+  VERIFY( hay.find(needle, 4899) == 4899 );
+  VERIFY( hay.find(needle, 4900) == std::string::npos );
+
+  // short needles go through the first and last character filter
+  std::string text("the quick brown fox jumps over the lazy dog, the quick brown fox");
+  VERIFY( text.find("quick brown") == 4 );
+  VERIFY( text.find("quick brown", 5) == 49 );
+  VERIFY( text.find("lazy cat") == std::string::npos );
+  VERIFY( text.find("dog,") == 40 );
+  VERIFY( text.find(text) == 0 );
+  VERIFY( text.find(text + "!") == std::string::npos );
+
+  std::string periodic;
+  for(int i = 0; i < 100; i++)
+    periodic += "abab";
+  periodic += "abc";
+  std::string needle2;
+  for(int i = 0; i < 20; i++)
+    needle2 += "ab";
+  needle2 += "c";
+  VERIFY( periodic.find(needle2) == periodic.size() - needle2.size() );
+
+  std::wstring w(300, L'x');
+  w.replace(250, 3, L"abc");
+  VERIFY( w.find(L"xxabcx") == 248 );
+  VERIFY( w.find(std::wstring(40, L'x') + L"abc") == 210 );
+}
@@ -0,0 +1,121 @@
+// std::hash<basic_string>, std::hash<basic_string_ref> and std::ext::hashing
+
+#include <ntl-tests-common.hxx>
+#include <string>
+#include <string_ref>
+#include <vector>
+#include <algorithm>
+
+STLX_DEFAULT_TESTGROUP_NAME("std::hash<string>");
+
+namespace
+{
+  // long path strings which differ in a few characters only
+  std::vector<std::string> make_paths(size_t count)
+  {
+    static const char* const dirs[] = { "Windows\\System32\\", "Program Files\\Common Files\\Microsoft Shared\\", "Users\\Public\\Documents\\Projects\\" };
+    std::vector<std::string> v;
+    v.reserve(count);
+    for(size_t i = 0; i < count; i++){
+      std::string s = "C:\\";
+      s += dirs[i % 3];
+      s += "module_";
+      s += std::to_string(i / 3);
+      s += "\\resources\\strings\\localized\\file_";
+      s += std::to_string(i % 97);
+      s += ".dat";
+      v.push_back(s);
+    }
+    return v;
+  }
+
+  /// the number of the keys which fall into the occupied bucket of the table with \p buckets (power of two)
+  template<class Hash>
+  size_t bucket_collisions(const std::vector<std::string>& keys, size_t buckets, Hash h)
+  {
+    std::vector<size_t> v(keys.size());
+    for(size_t i = 0; i < keys.size(); i++)
+      v[i] = h(keys[i].data(), keys[i].size()) & (buckets - 1);
+    std::sort(v.begin(), v.end());
+    return keys.size() - (std::unique(v.begin(), v.end()) - v.begin());
+  }
+
+  size_t crc_hash(const void* p, size_t n) { return std::ext::hashing::crc32c(p, n); }
+  size_t wy_hash(const void* p, size_t n)  { return static_cast<size_t>(std::ext::hashing::wyhash(p, n)); }
+}
+
+// CRC-32C check values
+template<> template<> void tut::to::test<01>(void)
+{
+  using std::ext::hashing::crc32c;
+  VERIFY( crc32c("", 0) == 0 );
+  VERIFY( crc32c("123456789", 9) == 0xE3069283 );
+  VERIFY( crc32c("a", 1) == 0xC1D04330 );
+  const char zeros[32] = {};
+  VERIFY( crc32c(zeros, sizeof(zeros)) == 0x8A9136AA );   // RFC 3720, B.4
+
+  // the parts are chained, the hardware and the table give the same result
+  unsigned seed = 1;
+  char buf[300];
+  for(size_t i = 0; i < sizeof(buf); i++)
+    buf[i] = static_cast<char>(next_random(seed));
+  for(size_t n = 0; n <= sizeof(buf); n += 7){
+    const uint32_t whole = crc32c(buf, n);
+    VERIFY( crc32c(buf + n / 3, n - n / 3, crc32c(buf, n / 3)) == whole );
+    VERIFY( ~std::ext::hashing::__::crc32c_soft(~0u, reinterpret_cast<const uint8_t*>(buf), n) == whole );
+  }
+}
+
+// wyhash reads the tails of any length
+template<> template<> void tut::to::test<02>(void)
+{
+  using std::ext::hashing::wyhash;
+  unsigned seed = 2;
+  char buf[200];
+  for(size_t i = 0; i < sizeof(buf); i++)
+    buf[i] = static_cast<char>(next_random(seed));
+  std::vector<uint64_t> v;
+  for(size_t n = 0; n <= sizeof(buf); n++){
+    v.push_back(wyhash(buf, n));
+    VERIFY( wyhash(buf, n) == v.back() );
+    VERIFY( wyhash(buf, n, 1) != v.back() );
+    // every byte counts
+    if(n){
+      buf[n - 1] ^= 1;
+      VERIFY( wyhash(buf, n) != v.back() );
+      buf[n - 1] ^= 1;
+    }
+  }
+  std::sort(v.begin(), v.end());
+  VERIFY( std::unique(v.begin(), v.end()) == v.end() );
+}
+
+// the strings and the string references hash alike
+template<> template<> void tut::to::test<03>(void)
+{
+  const std::string s = "C:\\Windows\\System32\\drivers\\etc\\hosts";
+  const std::string_ref r = s;
+  VERIFY( std::hash<std::string>()(s) == std::hash<std::string_ref>()(r) );
+  VERIFY( std::hash<std::string>()(s) == std::ext::hashing::hash_bytes(s.data(), s.size()) );
+  VERIFY( std::hash<std::string>()(s) != std::hash<std::string>()(s.substr(1)) );
+  VERIFY( std::hash<std::string>()(std::string()) == std::hash<std::string_ref>()(std::string_ref()) );
+
+  const std::wstring w = L"C:\\Windows\\System32";
+  VERIFY( std::hash<std::wstring>()(w) == std::hash<std::wstring_ref>()(std::wstring_ref(w)) );
+  VERIFY( std::hash<std::wstring>()(w) != std::hash<std::wstring>()(L"C:\\Windows\\System64") );
+}
+
+// collision quality on the path keys, the throughput is measured by samples/stringhash.cpp
+template<> template<> void tut::to::test<04>(void)
+{
+  const std::vector<std::string> keys = make_paths(100000);
+  const size_t buckets = 1 << 17;
+  // the expected number for the random hash: n - m * (1 - (1 - 1/m)^n)
+  double empty = 1;
+  for(size_t i = 0; i < keys.size(); i++)
+    empty *= 1 - 1.0 / buckets;
+  const double expected = keys.size() - buckets * (1 - empty);
+
+  VERIFY( bucket_collisions(keys, buckets, crc_hash) < expected * 1.1 + 50 );
+  VERIFY( bucket_collisions(keys, buckets, wy_hash) < expected * 1.1 + 50 );
+}
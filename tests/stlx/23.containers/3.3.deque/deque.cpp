@@ -0,0 +1,166 @@
+// deque: the block map, the end insertions without relocation, the memory of a long FIFO use
+
+#include <ntl-tests-common.hxx>
+#include <deque>
+#include <vector>
+
+STLX_DEFAULT_TESTGROUP_NAME("std::deque");
+
+namespace
+{
+  // the element counts its live objects
+  struct tracked
+  {
+    static int live;
+    int value;
+    tracked(int value = 0) : value(value) { live++; }
+    tracked(const tracked& r) : value(r.value) { live++; }
+    tracked& operator=(const tracked& r) { value = r.value; return *this; }
+    ~tracked() { live--; }
+    friend bool operator==(const tracked& x, const tracked& y) { return x.value == y.value; }
+    friend bool operator<(const tracked& x, const tracked& y) { return x.value < y.value; }
+  };
+  int tracked::live = 0;
+
+  template<class D, class V>
+  bool same(const D& d, const V& v)
+  {
+    if(d.size() != v.size())
+      return false;
+    typename D::const_iterator i = d.begin();
+    for(size_t k = 0; k < v.size(); k++, ++i)
+      if(d[k].value != v[k] || i->value != v[k])
+        return false;
+    return i == d.end() && size_t(d.end() - d.begin()) == d.size();
+  }
+}
+
+// the operations at both ends and in the middle against a vector
+template<> template<> void tut::to::test<01>(void)
+{
+  {
+    std::deque<tracked> d;
+    std::vector<int> v;
+    for(int i = 0; i < 3000; i++){
+      if(i % 3){
+        d.push_back(tracked(i));
+        v.push_back(i);
+      }else{
+        d.push_front(tracked(i));
+        v.insert(v.begin(), i);
+      }
+    }
+    VERIFY( same(d, v) );
+
+    for(int i = 0; i < 200; i++){
+      const size_t at = (i * 7919) % (v.size() + 1);
+      d.insert(d.begin() + at, tracked(-i));
+      v.insert(v.begin() + at, -i);
+    }
+    VERIFY( same(d, v) );
+
+    d.insert(d.begin() + 10, 100, tracked(7));
+    v.insert(v.begin() + 10, 100, 7);
+    d.insert(d.end() - 10, 300, tracked(8));
+    v.insert(v.end() - 10, 300, 8);
+    const int range[] = { 1, 2, 3, 4, 5 };
+    const tracked trange[] = { 1, 2, 3, 4, 5 };
+    d.insert(d.begin() + 3, trange, trange + 5);
+    v.insert(v.begin() + 3, range, range + 5);
+    d.insert(d.end() - 3, trange, trange + 5);
+    v.insert(v.end() - 3, range, range + 5);
+    VERIFY( same(d, v) );
+
+    for(int i = 0; i < 300; i++){
+      const size_t at = (i * 104729) % v.size();
+      d.erase(d.begin() + at);
+      v.erase(v.begin() + at);
+    }
+    d.erase(d.begin() + 5, d.begin() + 700);
+    v.erase(v.begin() + 5, v.begin() + 700);
+    d.erase(d.end() - 900, d.end() - 20);
+    v.erase(v.end() - 900, v.end() - 20);
+    VERIFY( same(d, v) );
+
+    for(int i = 0; i < 500; i++){
+      d.pop_front();
+      v.erase(v.begin());
+      d.pop_back();
+      v.pop_back();
+    }
+    VERIFY( same(d, v) );
+    VERIFY( d.front().value == v.front() && d.back().value == v.back() );
+
+    std::deque<tracked> copy(d);
+    VERIFY( copy == d );
+    d.clear();
+    VERIFY( d.empty() && d.begin() == d.end() );
+    d.push_back(tracked(1));
+    VERIFY( d.size() == 1 && d.front().value == 1 );
+    d.swap(copy);
+    VERIFY( same(d, v) && copy.size() == 1 );
+
+    bool thrown = false;
+    try{
+      d.at(d.size());
+    }
+    catch(const std::out_of_range&){
+      thrown = true;
+    }
+    VERIFY( thrown );
+  }
+  VERIFY( tracked::live == 0 );
+}
+
+// the end insertions keep the references to the elements
+template<> template<> void tut::to::test<02>(void)
+{
+  std::deque<int> d;
+  d.push_back(0);
+  const int* const first = &d.front();
+  std::vector<const int*> refs;
+  for(int i = 1; i < 100000; i++){
+    if(i % 2)
+      d.push_back(i);
+    else
+      d.push_front(i);
+    if(i % 1000 == 0)
+      refs.push_back(&d.front());
+  }
+  bool stable = *first == 0;
+  for(size_t i = 0; i < refs.size(); i++)
+    stable = *refs[i] == int(i + 1) * 1000 && stable;
+  VERIFY( stable );
+
+  // the random access across the blocks
+  std::deque<int>::iterator b = d.begin(), e = d.end();
+  VERIFY( e - b == 100000 && (b + 50000) - b == 50000 && b + 100000 == e && e - 100000 == b );
+  VERIFY( *(b + 49998) == 2 && b[49999] == 0 && b[50000] == 1 && *(e - 1) == 99999 && *(e - 50000) == 1 );
+  std::deque<int>::const_reverse_iterator r = d.crbegin();
+  VERIFY( *r == 99999 && *(d.crend() - 1) == 99998 );
+}
+
+// a long FIFO run keeps the memory bounded by the size of the queue
+template<> template<> void tut::to::test<03>(void)
+{
+  typedef std::deque<int, counting_allocator<int> > queue;
+  {
+    queue q;
+    for(int i = 0; i < 1000; i++)
+      q.push_back(i);
+    const size_t warm = blocks::peak;
+    blocks::peak = blocks::live;
+    bool fifo = true;
+    for(int i = 1000; i < 1000000; i++){
+      q.push_back(i);
+      fifo = q.front() == i - 1000 && fifo;
+      q.pop_front();
+    }
+    VERIFY( fifo && q.size() == 1000 );
+    // the blocks and the map are reused, not grown
+    VERIFY( blocks::peak <= warm + 2 );
+    q.shrink_to_fit();
+    VERIFY( q.front() == 999000 && q.back() == 999999 );
+  }
+  VERIFY( blocks::live == 0 );
+}
@@ -0,0 +1,222 @@
+// vector reallocation: relocation by memcpy, in-place growth, growth policy
+
+#include <ntl-tests-common.hxx>
+#include <vector>
+#include <memory>
+
+STLX_DEFAULT_TESTGROUP_NAME("std::vector::realloc");
+
+namespace
+{
+  // a type which must be moved by its constructor
+  struct anchored
+  {
+    const anchored* self;
+    int value;
+    anchored(int value = 0) : self(this), value(value) {}
+    anchored(const anchored& r) : self(this), value(r.value) {}
+    anchored& operator=(const anchored& r) { value = r.value; return *this; }
+    bool intact() const { return self == this; }
+  };
+
+  // a type with a costly copy which opts in the relocation
+  struct counted
+  {
+    static unsigned copies;
+    int value;
+    counted(int value = 0) : value(value) {}
+    counted(const counted& r) : value(r.value) { copies++; }
+    counted& operator=(const counted& r) { value = r.value; return *this; }
+  };
+  unsigned counted::copies = 0;
+
+  // the same type without the opt-in, moved by its copy constructor
+  struct copied
+  {
+    static unsigned copies;
+    int value;
+    copied(int value = 0) : value(value) {}
+    copied(const copied& r) : value(r.value) { copies++; }
+    copied& operator=(const copied& r) { value = r.value; return *this; }
+  };
+  unsigned copied::copies = 0;
+
+  // a bump allocator which grows the last block in place
+  struct arena
+  {
+    static char storage[1 << 20];
+    static size_t used, last, expansions;
+  };
+  char arena::storage[1 << 20];
+  size_t arena::used = 0, arena::last = 0, arena::expansions = 0;
+
+  template<class T>
+  class arena_allocator: public std::allocator<T>
+  {
+  public:
+    typedef T*      pointer;
+    typedef size_t  size_type;
+    template<class U> struct rebind { typedef arena_allocator<U> other; };
+
+    arena_allocator() {}
+    template<class U> arena_allocator(const arena_allocator<U>&) {}
+
+    pointer allocate(size_type n, const void* = 0)
+    {
+      arena::last = (arena::used + 15) & ~size_t(15);
+      arena::used = arena::last + n * sizeof(T);
+      return reinterpret_cast<pointer>(arena::storage + arena::last);
+    }
+    void deallocate(pointer, size_type) {}
+
+    bool expand(pointer p, size_type, size_type m)
+    {
+      if(reinterpret_cast<char*>(p) != arena::storage + arena::last || arena::last + m * sizeof(T) > sizeof(arena::storage))
+        return false;
+      arena::used = arena::last + m * sizeof(T);
+      arena::expansions++;
+      return true;
+    }
+  };
+
+  struct record
+  {
+    uint64_t key, value;
+  };
+
+  // the same record with a user copy constructor, moved element by element
+  struct record_copied
+  {
+    uint64_t key, value;
+    record_copied() {}
+    record_copied(const record_copied& r) : key(r.key), value(r.value) {}
+  };
+}
+
+namespace std
+{
+  namespace ext
+  {
+    template<> struct is_trivially_relocatable<counted>: true_type {};
+  }
+}
+
+// the elements keep their values whichever way they are moved
+template<> template<> void tut::to::test<01>(void)
+{
+  using namespace std;
+  VERIFY( ext::is_trivially_relocatable<int>::value );
+  VERIFY( ext::is_trivially_relocatable<vector<int> >::value );
+  VERIFY( !ext::is_trivially_relocatable<anchored>::value );
+
+  vector<anchored> a;
+  for(int i = 0; i < 1000; i++)
+    a.push_back(anchored(i));
+  a.insert(a.begin() + 10, 5, anchored(-1));
+  a.insert(a.begin(), anchored(-2));
+  bool intact = true;
+  for(size_t i = 0; i < a.size(); i++){
+    const int expected = i == 0 ? -2 : i <= 10 ? int(i) - 1 : i <= 15 ? -1 : int(i) - 6;
+    intact = a[i].intact() && a[i].value == expected && intact;
+  }
+  VERIFY( intact && a.size() == 1006 );
+
+  counted::copies = 0;
+  vector<counted> c;
+  c.reserve(4);
+  for(int i = 0; i < 1000; i++)
+    c.push_back(counted(i));
+  // only the push_back copies, the reallocations copy nothing
+  VERIFY( counted::copies == 1000 );
+  c.insert(c.begin() + 500, 3, counted(-1));
+  c.insert(c.begin() + 1, counted(-2));
+  bool ordered = c.size() == 1004 && c[0].value == 0 && c[1].value == -2 && c[500].value == 499 && c[501].value == -1 && c[503].value == -1 && c[504].value == 500 && c[1003].value == 999;
+  VERIFY( ordered );
+
+  vector<vector<int> > nested;
+  for(int i = 0; i < 300; i++)
+    nested.push_back(vector<int>(i % 7, i));
+  bool kept = true;
+  for(int i = 0; i < 300; i++)
+    kept = nested[i].size() == size_t(i % 7) && (nested[i].empty() || nested[i].back() == i) && kept;
+  VERIFY( kept );
+}
+
+// an allocator with expand() grows the storage without moving it
+template<> template<> void tut::to::test<02>(void)
+{
+  using namespace std;
+  VERIFY( !ext::allocator_expansion<allocator<int> >::value );
+  VERIFY( ext::allocator_expansion<arena_allocator<int> >::value );
+
+  vector<int, arena_allocator<int> > v;
+  v.push_back(0);
+  const int* const first = v.data();
+  for(int i = 1; i < 10000; i++)
+    v.push_back(i);
+  VERIFY( v.data() == first && arena::expansions > 5 );
+  v.insert(v.begin() + 1, 20000, -1);
+  bool ok = v.data() == first && v.size() == 30000 && v[0] == 0 && v[1] == -1 && v[20000] == -1 && v[20001] == 1 && v.back() == 9999;
+  VERIFY( ok );
+
+  // another block after it, the vector has to move
+  vector<int, arena_allocator<int> > w(16, 1);
+  v.resize(v.capacity());
+  v.push_back(1);
+  VERIFY( v.data() != first && v.back() == 1 && v[20001] == 1 );
+}
+
+// the default policy doubles the capacity
+template<> template<> void tut::to::test<03>(void)
+{
+  std::vector<int> v;
+  size_t capacities[4] = {}, k = 0, last = 0;
+  for(int i = 0; i < 100 && k < 4; i++){
+    v.push_back(i);
+    if(v.capacity() != last)
+      capacities[k++] = last = v.capacity();
+  }
+  VERIFY( capacities[0] == 8 && capacities[1] == 24 && capacities[2] == 56 && capacities[3] == 120 );
+}
+
+// the relocatable elements are moved by memcpy: the reallocations run no copy constructor
+template<> template<> void tut::to::test<04>(void)
+{
+  using namespace std;
+  VERIFY( ext::is_trivially_relocatable<record>::value );
+  VERIFY( !ext::is_trivially_relocatable<record_copied>::value );
+  VERIFY( ext::is_trivially_relocatable<counted>::value );
+  VERIFY( !ext::is_trivially_relocatable<copied>::value );
+
+  vector<counted> c;
+  vector<copied> d;
+  for(int i = 0; i < 100; i++){
+    c.push_back(counted(i));
+    d.push_back(copied(i));
+  }
+  counted::copies = copied::copies = 0;
+
+  // reserve() and the growth of push_back()
+  c.reserve(c.capacity() + 1);
+  d.reserve(d.capacity() + 1);
+  VERIFY( counted::copies == 0 && copied::copies == 100 );
+  counted::copies = copied::copies = 0;
+  c.resize(c.capacity());
+  d.resize(d.capacity());
+  const size_t full = c.size();
+  counted::copies = copied::copies = 0;
+  c.push_back(counted(-1));
+  d.push_back(copied(-1));
+  VERIFY( counted::copies == 1 && copied::copies == full + 1 );
+
+  // insert() which reallocates moves both the head and the tail
+  c.resize(c.capacity());
+  d.resize(d.capacity());
+  const size_t size = c.size();
+  counted::copies = copied::copies = 0;
+  c.insert(c.begin() + 10, 2, counted(-2));
+  d.insert(d.begin() + 10, 2, copied(-2));
+  VERIFY( counted::copies == 2 && copied::copies == size + 2 );
+  VERIFY( c[9].value == 9 && c[10].value == -2 && c[12].value == 10 && c[full + 2].value == -1 && c.size() == size + 2 );
+  VERIFY( d[9].value == 9 && d[10].value == -2 && d[12].value == 10 && d[full + 2].value == -1 && d.size() == size + 2 );
+}
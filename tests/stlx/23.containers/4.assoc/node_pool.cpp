@@ -0,0 +1,192 @@
+// rb_tree nodes from the node_pool: the free list, the bulk release, the nodes of the swapped and moved trees
+
+#include <ntl-tests-common.hxx>
+#include <set>
+#include <map>
+#include <vector>
+#include <stlx/ext/node_pool.hxx>
+
+STLX_DEFAULT_TESTGROUP_NAME("std::ext::node_pool");
+
+namespace
+{
+  // the element counts its live objects
+  struct tracked
+  {
+    static int live;
+    int value;
+    tracked(int value = 0) : value(value) { live++; }
+    tracked(const tracked& r) : value(r.value) { live++; }
+    tracked& operator=(const tracked& r) { value = r.value; return *this; }
+    ~tracked() { live--; }
+    friend bool operator<(const tracked& x, const tracked& y) { return x.value < y.value; }
+  };
+  int tracked::live = 0;
+
+  struct node
+  {
+    void* link[3];
+    int value;
+  };
+
+  typedef std::ext::tree::rb_tree<int> pooled_tree;
+  typedef std::ext::tree::rb_tree<int, std::less<int>, std::allocator<int>, std::ext::tree::allocated_nodes> plain_tree;
+  typedef std::ext::tree::rb_tree<int, std::less<int>, counting_allocator<int> > counted_tree;
+  typedef std::ext::tree::rb_tree<tracked, std::less<tracked>, counting_allocator<tracked> > tracked_tree;
+}
+
+// the freed nodes are reused from the free list, the chunks grow geometrically
+template<> template<> void tut::to::test<01>(void)
+{
+  {
+    std::ext::node_pool<node, counting_allocator<node> > pool;
+    VERIFY( blocks::live == 0 );
+    node* const a = pool.allocate(1);
+    node* const b = pool.allocate(1);
+    node* const c = pool.allocate(1);
+    VERIFY( blocks::live == 1 && a != b && b != c );
+    VERIFY( reinterpret_cast<uintptr_t>(a) % pool.cache_line == 0 );
+
+    // the last freed node comes first
+    pool.deallocate(b, 1);
+    VERIFY( pool.allocate(1) == b );
+    pool.deallocate(a, 1);
+    pool.deallocate(c, 1);
+    VERIFY( pool.allocate(1) == c && pool.allocate(1) == a );
+    VERIFY( blocks::live == 1 );
+
+    // a hundred thousand nodes take a few chunks
+    std::vector<node*> nodes;
+    for(int i = 0; i < 100000; i++)
+      nodes.push_back(pool.allocate(1));
+    const size_t chunks = blocks::live;
+    VERIFY( chunks > 1 && chunks < 100 );
+    for(size_t i = 0; i < nodes.size(); i++)
+      pool.deallocate(nodes[i], 1);
+    for(int i = 0; i < 100000; i++)
+      pool.allocate(1);
+    VERIFY( blocks::live == chunks );
+
+    pool.release();
+    VERIFY( blocks::live == 0 );
+    pool.allocate(1);
+    VERIFY( blocks::live == 1 );
+  }
+  // the destructor returns the chunks
+  VERIFY( blocks::live == 0 );
+}
+
+// clear() and the destructor release the chunks at once
+template<> template<> void tut::to::test<02>(void)
+{
+  {
+    // the trivially destructible elements: the nodes are not walked, the chunks are freed
+    counted_tree t((std::less<int>()));
+    blocks::allocated = 0;
+    for(int i = 0; i < 10000; i++)
+      t.insert((i * 7919) % 10000);
+    const size_t chunks = blocks::live;
+    VERIFY( t.size() == 10000 && chunks == blocks::allocated && chunks < 20 );
+    t.clear();
+    VERIFY( t.empty() && t.begin() == t.end() && blocks::live == 0 );
+
+    // the cleared tree starts again from the first chunk
+    for(int i = 0; i < 100; i++)
+      t.insert(i);
+    VERIFY( t.size() == 100 && *t.begin() == 0 && *--t.end() == 99 && blocks::live < chunks );
+  }
+  VERIFY( blocks::live == 0 );
+
+  {
+    // the elements with destructors are destroyed before the release
+    tracked_tree t((std::less<tracked>()));
+    for(int i = 0; i < 5000; i++)
+      t.insert(tracked(i));
+    VERIFY( tracked::live == 5000 );
+    t.clear();
+    VERIFY( tracked::live == 0 && blocks::live == 0 );
+    for(int i = 0; i < 5000; i++)
+      t.insert(tracked(-i));
+    for(int i = 0; i < 5000; i += 2)
+      t.erase(tracked(-i));
+    VERIFY( tracked::live == 2500 && t.size() == 2500 );
+  }
+  VERIFY( tracked::live == 0 && blocks::live == 0 );
+}
+
+// the nodes stay in place when the pooled tree is swapped or moved
+template<> template<> void tut::to::test<03>(void)
+{
+  pooled_tree a((std::less<int>())), b((std::less<int>()));
+  for(int i = 0; i < 1000; i++)
+    a.insert(i);
+  b.insert(-1);
+  const int* const p = &*a.find(500);
+  const int* const q = &*b.find(-1);
+
+  a.swap(b);
+  VERIFY( &*b.find(500) == p && &*a.find(-1) == q && a.size() == 1 && b.size() == 1000 );
+
+  pooled_tree c(std::move(b));
+  VERIFY( &*c.find(500) == p && c.size() == 1000 && b.empty() );
+
+  // the moved-from tree has its own pool, clearing it keeps the nodes of the others
+  for(int i = 0; i < 100; i++)
+    b.insert(i);
+  b.clear();
+  a.clear();
+  for(int i = 1000; i < 2000; i++)
+    c.insert(i);
+  for(int i = 0; i < 1000; i += 2)
+    c.erase(i);
+  VERIFY( *c.find(501) == 501 && c.size() == 1500 && c.find(500) == c.end() );
+
+  pooled_tree d((std::less<int>()));
+  d = std::move(c);
+  VERIFY( d.size() == 1500 && *d.find(1999) == 1999 && c.empty() );
+
+  // through the containers
+  std::set<int> s;
+  for(int i = 0; i < 100; i++)
+    s.insert(i);
+  const int* const ps = &*s.find(50);
+  std::set<int> s2(std::move(s));
+  VERIFY( &*s2.find(50) == ps && s2.size() == 100 );
+  std::set<int> s3;
+  s3 = std::move(s2);
+  VERIFY( &*s3.find(50) == ps && s3.size() == 100 );
+
+  std::map<int, int> m;
+  for(int i = 0; i < 100; i++)
+    m[i] = i;
+  const int* const pm = &m.find(50)->second;
+  std::map<int, int> m2(std::move(m));
+  VERIFY( &m2.find(50)->second == pm && m2.size() == 100 );
+  m2.swap(m);
+  VERIFY( &m.find(50)->second == pm && m.size() == 100 && m2.empty() );
+}
+
+// the pooled and the separately allocated trees hold the same elements
+template<> template<> void tut::to::test<04>(void)
+{
+  std::vector<int> v;
+  for(int i = 0; i < 3000; i++)
+    v.push_back((i * 104729) % 3001);
+
+  pooled_tree pooled(v.begin(), v.end(), std::less<int>());
+  plain_tree plain(pooled.begin(), pooled.end(), std::less<int>());
+  pooled_tree back(plain.begin(), plain.end(), std::less<int>());
+  VERIFY( pooled.size() == 3000 && plain.size() == 3000 && back.size() == 3000 );
+  VERIFY( std::equal(pooled.begin(), pooled.end(), plain.begin()) && back == pooled );
+
+  for(int i = 0; i < 3001; i += 3){
+    pooled.erase(i);
+    plain.erase(i);
+  }
+  VERIFY( pooled.size() == plain.size() && std::equal(pooled.begin(), pooled.end(), plain.begin()) );
+
+  plain_tree copy(plain);
+  plain.clear();
+  back = pooled;
+  VERIFY( copy.size() == back.size() && std::equal(copy.begin(), copy.end(), back.begin()) && plain.empty() );
+}
@@ -0,0 +1,282 @@
+// rb_tree bulk operations: the sorted insert_range, merge, unite and intersect, with the red-black invariants checked after each
+
+#include <ntl-tests-common.hxx>
+#include <set>
+#include <map>
+#include <vector>
+#include <algorithm>
+
+STLX_DEFAULT_TESTGROUP_NAME("std::ext::tree::rb_tree set operations");
+
+namespace
+{
+  // the container with its tree checked: the order, the colors, the parent links, the black height and the bounds
+  template<class Container>
+  struct checked: Container
+  {
+    bool valid() const
+    {
+      if(this->root_ && (this->root_->color() != this->root_->black || this->root_->parent()))
+        return false;
+      int height = -1;
+      size_t count = 0;
+      if(!walk(this->root_, 0, height, count) || count != this->size())
+        return false;
+      if(!this->root_)
+        return !this->first_ && !this->last_;
+      if(this->first_ != extreme(this->root_, 0) || this->last_ != extreme(this->root_, 1))
+        return false;
+
+      // the in-order traversal is strictly ascending both ways
+      count = 0;
+      for(typename Container::const_iterator i = this->begin(), prev = i; i != this->end(); prev = i++, count++)
+        if(i != prev && !this->elem_less(*prev, *i))
+          return false;
+      typename Container::const_iterator last = this->end();
+      --last;
+      return count == this->size() && &*last == &this->last_->elem;
+    }
+
+  private:
+    template<class Node>
+    bool walk(const Node* p, int depth, int& height, size_t& count) const
+    {
+      if(!p){
+        if(height < 0)
+          height = depth;
+        return height == depth;
+      }
+      ++count;
+      for(int c = 0; c < 2; c++){
+        const Node* const child = p->child[c];
+        if(!child)
+          continue;
+        if(child->parent() != p)
+          return false;
+        if(p->color() == p->red && child->color() == child->red)
+          return false;
+        if(c == 0 ? !this->elem_less(child->elem, p->elem) : !this->elem_less(p->elem, child->elem))
+          return false;
+      }
+      const int below = depth + (p->color() == p->black ? 1 : 0);
+      return walk(p->child[0], below, height, count) && walk(p->child[1], below, height, count);
+    }
+
+    template<class Node>
+    static const Node* extreme(const Node* p, int c)
+    {
+      while(p->child[c])
+        p = p->child[c];
+      return p;
+    }
+  };
+
+  typedef checked<std::set<int> > set;
+  typedef checked<std::map<int, int> > map;
+
+  template<class Container>
+  bool equal(const Container& c, const std::vector<int>& keys)
+  {
+    if(c.size() != keys.size())
+      return false;
+    size_t n = 0;
+    for(typename Container::const_iterator i = c.begin(); i != c.end(); ++i, ++n)
+      if(*i != keys[n])
+        return false;
+    return true;
+  }
+
+  bool equal(const map& m, const std::vector<int>& keys)
+  {
+    if(m.size() != keys.size())
+      return false;
+    size_t n = 0;
+    for(map::const_iterator i = m.begin(); i != m.end(); ++i, ++n)
+      if(i->first != keys[n])
+        return false;
+    return true;
+  }
+
+  // the sorted unique keys of the input
+  std::vector<int> unique_keys(std::vector<int> v)
+  {
+    std::sort(v.begin(), v.end());
+    v.erase(std::unique(v.begin(), v.end()), v.end());
+    return v;
+  }
+
+  // the sorted unique keys of both
+  std::vector<int> joined(std::vector<int> a, const std::vector<int>& b)
+  {
+    a.insert(a.end(), b.begin(), b.end());
+    return unique_keys(a);
+  }
+
+  std::vector<int> sequence(int first, int count, int step)
+  {
+    std::vector<int> v;
+    for(int i = 0; i < count; i++)
+      v.push_back(first + i * step);
+    return v;
+  }
+}
+
+// insert_range into an empty tree: sorted input is linked at once, anything else falls back to one by one
+template<> template<> void tut::to::test<01>(void)
+{
+  const int sizes[] = { 0, 1, 2, 3, 7, 8, 15, 16, 100, 1000 };
+  uint32_t seed = 2463534242u;
+  for(size_t k = 0; k < _countof(sizes); k++){
+    const int n = sizes[k];
+
+    std::vector<int> sorted = sequence(0, n, 3);
+    set s;
+    s.insert(sorted.begin(), sorted.end());
+    VERIFY( s.valid() && equal(s, sorted) );
+
+    std::vector<int> reversed(sorted.rbegin(), sorted.rend());
+    set r;
+    r.insert(reversed.begin(), reversed.end());
+    VERIFY( r.valid() && equal(r, sorted) );
+
+    std::vector<int> unsorted;
+    for(int i = 0; i < n; i++)
+      unsorted.push_back(next_xorshift(seed) % (n + 1));
+    set u;
+    u.insert(unsorted.begin(), unsorted.end());
+    VERIFY( u.valid() && equal(u, unique_keys(unsorted)) );
+
+    // sorted with a duplicate and a sorted run followed by an unsorted tail break the fast path midway
+    std::vector<int> duplicates = sorted;
+    if(n > 1)
+      duplicates.insert(duplicates.begin() + n / 2, sorted[n / 2]);
+    set d;
+    d.insert(duplicates.begin(), duplicates.end());
+    VERIFY( d.valid() && equal(d, sorted) );
+
+    std::vector<int> tail = sorted;
+    tail.insert(tail.end(), unsorted.begin(), unsorted.end());
+    set t;
+    t.insert(tail.begin(), tail.end());
+    VERIFY( t.valid() && equal(t, unique_keys(tail)) );
+
+    // into a non-empty tree
+    s.insert(unsorted.begin(), unsorted.end());
+    VERIFY( s.valid() && equal(s, joined(sorted, unsorted)) );
+  }
+}
+
+// merge moves the missing keys, the equivalent ones stay in the source
+template<> template<> void tut::to::test<02>(void)
+{
+  const std::vector<int> evens = sequence(0, 100, 2), thirds = sequence(0, 67, 3);
+  set a, b;
+  a.insert(evens.begin(), evens.end());
+  b.insert(thirds.begin(), thirds.end());
+  a.merge(b);
+  const std::vector<int> both = joined(evens, thirds);
+  VERIFY( a.valid() && equal(a, both) );
+  VERIFY( b.valid() && equal(b, sequence(0, 34, 6)) );
+
+  // the map keeps its own value of the equivalent keys
+  map m, x;
+  for(int i = 0; i < 50; i++)
+    m[i * 2] = 1;
+  for(int i = 0; i < 50; i++)
+    x[i * 3] = 2;
+  m.merge(x);
+  VERIFY( m.valid() && x.valid() );
+  bool values = true, left = true;
+  for(map::const_iterator i = m.begin(); i != m.end(); ++i)
+    values = i->second == (i->first % 2 == 0 && i->first < 100 ? 1 : 2) && values;
+  for(map::const_iterator i = x.begin(); i != x.end(); ++i)
+    left = i->first % 6 == 0 && i->second == 2 && left;
+  VERIFY( values && left );
+  VERIFY( m.size() == 50 + 50 - 17 && x.size() == 17 );
+
+  // the empty sides, the disjoint sides and itself
+  set e;
+  a.merge(e);
+  VERIFY( a.valid() && equal(a, both) && e.empty() );
+  e.merge(a);
+  VERIFY( e.valid() && equal(e, both) && a.valid() && a.empty() );
+  e.merge(e);
+  VERIFY( e.valid() && equal(e, both) );
+
+  const std::vector<int> low = sequence(0, 20, 1), high = sequence(100, 20, 1);
+  set l, h;
+  l.insert(low.begin(), low.end());
+  h.insert(high.begin(), high.end());
+  l.merge(h);
+  VERIFY( l.valid() && h.valid() && h.empty() && equal(l, joined(low, high)) );
+}
+
+// unite and intersect against the empty, the disjoint, the overlapping sides and itself
+template<> template<> void tut::to::test<03>(void)
+{
+  const std::vector<int> none, low = sequence(0, 50, 1), high = sequence(1000, 50, 1), odds = sequence(1, 100, 2), fifths = sequence(0, 40, 5);
+  const std::vector<int> empty_side[] = { none, low };
+
+  for(size_t k = 0; k < 2; k++){
+    set a, e;
+    a.insert(empty_side[k].begin(), empty_side[k].end());
+    a.unite(e);
+    VERIFY( a.valid() && equal(a, empty_side[k]) );
+    e.unite(a);
+    VERIFY( e.valid() && equal(e, empty_side[k]) );
+
+    set b, f;
+    b.insert(empty_side[k].begin(), empty_side[k].end());
+    b.intersect(f);
+    VERIFY( b.valid() && b.empty() );
+    f.intersect(a);
+    VERIFY( f.valid() && f.empty() );
+  }
+
+  set l, h;
+  l.insert(low.begin(), low.end());
+  h.insert(high.begin(), high.end());
+  set i = l;
+  l.unite(h);
+  VERIFY( l.valid() && equal(l, joined(low, high)) && equal(h, high) );
+  h.unite(i);
+  VERIFY( h.valid() && equal(h, joined(low, high)) );
+  i.intersect(h);
+  VERIFY( i.valid() && equal(i, low) );
+  set d;
+  d.insert(high.begin(), high.end());
+  i.intersect(d);
+  VERIFY( i.valid() && i.empty() );
+  d.intersect(d);
+  d.unite(d);
+  VERIFY( d.valid() && equal(d, high) );
+
+  // the overlapping sides, interleaved
+  set o, v;
+  o.insert(odds.begin(), odds.end());
+  v.insert(fifths.begin(), fifths.end());
+  set u = o;
+  u.unite(v);
+  VERIFY( u.valid() && equal(u, joined(odds, fifths)) );
+  o.intersect(v);
+  VERIFY( o.valid() && equal(o, sequence(5, 20, 10)) );
+  v.intersect(u);
+  VERIFY( v.valid() && equal(v, fifths) );
+
+  // the maps unite and intersect by the keys, keeping their own values
+  map m, x;
+  for(int k = 0; k < 30; k++)
+    m[k * 2] = 1;
+  for(int k = 0; k < 30; k++)
+    x[k * 3] = 2;
+  map n = m;
+  m.unite(x);
+  n.intersect(x);
+  VERIFY( m.valid() && n.valid() && m.size() == 30 + 30 - 10 && n.size() == 10 );
+  bool values = true;
+  for(map::const_iterator k = m.begin(); k != m.end(); ++k)
+    values = k->second == (k->first % 2 == 0 && k->first < 60 ? 1 : 2) && values;
+  for(map::const_iterator k = n.begin(); k != n.end(); ++k)
+    values = k->first % 6 == 0 && k->second == 1 && values;
+  VERIFY( values );
+}
@@ -0,0 +1,359 @@
+// unordered_map and unordered_set over the open addressing table (ext::hashtable::flat_policy)
+
+#include <ntl-tests-common.hxx>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include <new>
+
+STLX_DEFAULT_TESTGROUP_NAME("std::ext::hashtable::flat_hashtable");
+
+namespace
+{
+  typedef std::ext::hashtable::flat_policy flat;
+
+  typedef std::unordered_map<int, int, std::hash<int>, std::equal_to<int>, std::allocator<std::pair<const int, int> >, flat> flat_map;
+  typedef std::unordered_set<int, std::hash<int>, std::equal_to<int>, std::allocator<int>, flat> flat_set;
+
+  // all keys share one probe sequence, so the erased slots of the full groups become tombstones
+  struct collide
+  {
+    size_t operator()(int) const { return 0; }
+  };
+  typedef std::unordered_set<int, collide, std::equal_to<int>, std::allocator<int>, flat> collide_set;
+
+  // fails the next allocation of the elements (the control bytes are allocated as usual) once armed
+  struct failure
+  {
+    static bool armed;
+  };
+  bool failure::armed = false;
+
+  template<class T>
+  class failing_allocator: public std::allocator<T>
+  {
+  public:
+    typedef T*      pointer;
+    typedef size_t  size_type;
+    template<class U> struct rebind { typedef failing_allocator<U> other; };
+
+    failing_allocator() {}
+    template<class U> failing_allocator(const failing_allocator<U>&) {}
+
+    pointer allocate(size_type n, const void* = 0)
+    {
+      if(failure::armed && sizeof(T) != 1){
+        failure::armed = false;
+        throw std::bad_alloc();
+      }
+      return std::allocator<T>::allocate(n);
+    }
+  };
+  typedef std::unordered_set<int, std::hash<int>, std::equal_to<int>, failing_allocator<int>, flat> failing_set;
+
+  // the key which throws from its copy once armed
+  struct fragile
+  {
+    static int copies_left;
+    int value;
+    fragile(int value) : value(value) {}
+    fragile(const fragile& r) : value(r.value)
+    {
+      if(copies_left >= 0 && copies_left-- == 0)
+        throw 1;
+    }
+    friend bool operator==(const fragile& x, const fragile& y) { return x.value == y.value; }
+  };
+  int fragile::copies_left = -1;
+
+  struct fragile_hash
+  {
+    size_t operator()(const fragile& x) const { return std::hash<int>()(x.value); }
+  };
+  typedef std::unordered_set<fragile, fragile_hash, std::equal_to<fragile>, std::allocator<fragile>, flat> fragile_set;
+
+  template<class Set>
+  bool holds(const Set& s, int n)
+  {
+    for(int k = 0; k < n; k++)
+      if(s.count(k) != 1)
+        return false;
+    return s.size() == size_t(n);
+  }
+
+  bool is_power_of_2(size_t n)
+  {
+    return n && (n & (n - 1)) == 0;
+  }
+
+  // every element of [0, n) which passes the filter is visited once, nothing else is
+  template<class Set>
+  bool visits_once(const Set& s, int n, int erased_each)
+  {
+    std::vector<int> seen(n);
+    size_t visited = 0;
+    for(typename Set::const_iterator i = s.cbegin(); i != s.cend(); ++i, ++visited){
+      if(*i < 0 || *i >= n || seen[*i]++)
+        return false;
+    }
+    for(int k = 0; k < n; k++)
+      if(seen[k] != (erased_each && k % erased_each == 0 ? 0 : 1))
+        return false;
+    return visited == s.size();
+  }
+}
+
+// insert, find and erase
+template<> template<> void tut::to::test<01>(void)
+{
+  flat_map m;
+  VERIFY( m.empty() && m.begin() == m.end() && m.find(1) == m.end() );
+
+  for(int i = 0; i < 10000; i++)
+    VERIFY( m.insert(std::make_pair(i, -i)).second );
+  VERIFY( m.size() == 10000 );
+  VERIFY( !m.insert(std::make_pair(5, 0)).second && m.find(5)->second == -5 );
+
+  bool found = true;
+  for(int i = 0; i < 10000; i++)
+    found = m.find(i) != m.end() && m.find(i)->second == -i && m.count(i) == 1 && found;
+  VERIFY( found );
+  VERIFY( m.find(10000) == m.end() && m.find(-1) == m.end() && m.count(10000) == 0 );
+
+  m[20000] = 7;
+  VERIFY( m.size() == 10001 && m.at(20000) == 7 );
+
+  for(int i = 0; i < 10000; i += 2)
+    VERIFY( m.erase(i) == 1 );
+  VERIFY( m.erase(0) == 0 && m.size() == 5001 );
+  m.erase(m.find(20000));
+  VERIFY( m.size() == 5000 );
+
+  bool erased = true;
+  for(int i = 0; i < 10000; i++)
+    erased = (m.find(i) == m.end()) == (i % 2 == 0) && erased;
+  VERIFY( erased );
+
+  // the missing keys after many erases: the probing stops at the free slots
+  for(int i = 1; i < 10000; i += 2)
+    m.erase(i);
+  VERIFY( m.empty() && m.begin() == m.end() );
+  bool missing = true;
+  for(int i = 0; i < 30000; i++)
+    missing = m.find(i) == m.end() && missing;
+  VERIFY( missing );
+
+  flat_set s;
+  for(int i = 0; i < 1000; i++)
+    s.insert(i * 3);
+  VERIFY( s.size() == 1000 && s.count(2997) == 1 && s.count(2998) == 0 );
+  VERIFY( s.erase(3) == 1 && s.find(3) == s.end() && s.size() == 999 );
+  s.clear();
+  VERIFY( s.empty() && s.begin() == s.end() && s.find(0) == s.end() );
+}
+
+// the slot of an erased element in a full group is reused
+template<> template<> void tut::to::test<02>(void)
+{
+  collide_set s;
+  s.rehash(64);
+  const size_t buckets = s.bucket_count();
+  VERIFY( buckets == 64 );
+
+  // the first two groups fill up, the rest spill into the next ones
+  for(int i = 0; i < 40; i++)
+    s.insert(i);
+  VERIFY( s.size() == 40 && s.bucket_count() == buckets );
+
+  // the erased slot stays a tombstone: the keys behind it are still found
+  const size_t slot = s.bucket(3);
+  VERIFY( s.erase(3) == 1 );
+  bool found = true;
+  for(int i = 0; i < 40; i++)
+    found = (s.count(i) == 1) == (i != 3) && found;
+  VERIFY( found );
+
+  // and the next key takes its place
+  s.insert(100);
+  VERIFY( s.bucket(100) == slot && s.size() == 40 && s.bucket_count() == buckets );
+
+  // the insert/erase churn at a constant size reuses the tombstones instead of growing
+  flat_set churn;
+  churn.rehash(1024);
+  for(int i = 0; i < 400; i++)
+    churn.insert(i);
+  for(int i = 400; i < 100000; i++){
+    churn.erase(i - 400);
+    churn.insert(i);
+  }
+  VERIFY( churn.size() == 400 && churn.bucket_count() == 1024 );
+  bool live = true;
+  for(int i = 0; i < 100000; i++)
+    live = (churn.count(i) == 1) == (i >= 100000 - 400) && live;
+  VERIFY( live );
+}
+
+// rehash and reserve across the sizes
+template<> template<> void tut::to::test<03>(void)
+{
+  const int sizes[] = { 0, 1, 13, 14, 15, 16, 17, 100, 1000, 5000 };
+  for(size_t k = 0; k < sizeof(sizes) / sizeof(*sizes); k++){
+    const int n = sizes[k];
+
+    // reserve(n) holds n elements without rehashing
+    flat_set s;
+    s.reserve(n);
+    const size_t buckets = s.bucket_count();
+    VERIFY( is_power_of_2(buckets) && buckets >= 16 );
+    for(int i = 0; i < n; i++)
+      s.insert(i);
+    VERIFY( s.bucket_count() == buckets && s.size() == size_t(n) );
+    VERIFY( s.load_factor() <= s.max_load_factor() );
+
+    // rehash(n) gives n buckets at least, but keeps the elements within the load factor
+    flat_map m;
+    for(int i = 0; i < n; i++)
+      m.insert(std::make_pair(i, i));
+    m.rehash(n * 4);
+    VERIFY( m.bucket_count() >= size_t(n * 4) && is_power_of_2(m.bucket_count()) );
+    m.rehash(0);
+    VERIFY( m.size() == size_t(n) && m.load_factor() <= m.max_load_factor() );
+    bool found = true;
+    for(int i = 0; i < n; i++)
+      found = m.find(i) != m.end() && m.find(i)->second == i && found;
+    VERIFY( found );
+  }
+
+  // the default table is a single control group
+  flat_map m;
+  VERIFY( m.bucket_count() == flat_map::initial_count );
+  for(int i = 0; i < 14; i++)
+    m[i] = i;
+  VERIFY( m.bucket_count() == flat_map::initial_count );
+  m[14] = 14;
+  VERIFY( m.bucket_count() > flat_map::initial_count );
+
+  // a lower maximum load factor grows the table
+  flat_set s;
+  for(int i = 0; i < 1000; i++)
+    s.insert(i);
+  const size_t buckets = s.bucket_count();
+  s.max_load_factor(0.25f);
+  VERIFY( s.bucket_count() > buckets && s.load_factor() <= 0.25f && s.size() == 1000 && s.count(999) == 1 );
+}
+
+// the iteration visits every element once
+template<> template<> void tut::to::test<04>(void)
+{
+  flat_set s;
+  VERIFY( visits_once(s, 0, 0) );
+  for(int i = 0; i < 5000; i++)
+    s.insert(i);
+  VERIFY( visits_once(s, 5000, 0) );
+  for(int i = 0; i < 5000; i += 3)
+    s.erase(i);
+  VERIFY( visits_once(s, 5000, 3) );
+
+  // erasing through the iterators reaches every element too
+  size_t erased = 0;
+  for(flat_set::iterator i = s.begin(); i != s.end(); ++erased)
+    i = s.erase(i);
+  VERIFY( erased == 5000 - 1667 && s.empty() && s.begin() == s.end() );
+
+  // the map iterators give the mutable values
+  flat_map m;
+  for(int i = 0; i < 3000; i++)
+    m.insert(std::make_pair(i, 0));
+  for(flat_map::iterator i = m.begin(); i != m.end(); ++i)
+    i->second += i->first + 1;
+  bool once = true;
+  for(flat_map::const_iterator i = m.cbegin(); i != m.cend(); ++i)
+    once = i->second == i->first + 1 && once;
+  VERIFY( once );
+}
+
+// copy, move and swap
+template<> template<> void tut::to::test<05>(void)
+{
+  flat_map a;
+  for(int i = 0; i < 1000; i++)
+    a.insert(std::make_pair(i, i * 2));
+  a.erase(500);
+
+  flat_map b(a);
+  VERIFY( b.size() == 999 && b.find(500) == b.end() && b.find(999)->second == 1998 );
+  b[999] = 0;
+  VERIFY( a.find(999)->second == 1998 );
+
+  flat_map c;
+  c.insert(std::make_pair(-1, -1));
+  c = a;
+  VERIFY( c.size() == 999 && c.count(-1) == 0 && c.find(1)->second == 2 );
+
+  flat_map d(std::move(c));
+  VERIFY( d.size() == 999 && d.find(998)->second == 1996 && c.empty() );
+  c.insert(std::make_pair(1, 1));
+  VERIFY( c.size() == 1 && c.find(1)->second == 1 );
+
+  flat_map e;
+  e = std::move(d);
+  VERIFY( e.size() == 999 && e.find(0)->second == 0 );
+
+  flat_map small;
+  small.insert(std::make_pair(42, 42));
+  e.swap(small);
+  VERIFY( e.size() == 1 && e.find(42)->second == 42 && small.size() == 999 && small.find(998)->second == 1996 );
+  std::swap(e, small);
+  VERIFY( e.size() == 999 && small.size() == 1 && small.count(42) == 1 );
+
+  flat_set s1, s2;
+  for(int i = 0; i < 100; i++)
+    s1.insert(i);
+  s2 = s1;
+  s1.clear();
+  VERIFY( s1.empty() && s2.size() == 100 && s2.count(99) == 1 );
+  flat_set s3(std::move(s2));
+  VERIFY( s3.size() == 100 && s2.empty() );
+  s1.swap(s3);
+  VERIFY( s1.size() == 100 && s3.empty() && visits_once(s1, 100, 0) );
+}
+
+// the failed growth leaves the table as it was
+template<> template<> void tut::to::test<06>(void)
+{
+  failing_set s;
+  for(int i = 0; i < 100; i++)
+    s.insert(i);
+  const size_t buckets = s.bucket_count();
+  bool thrown = false;
+  failure::armed = true;
+  try{
+    s.reserve(1000);
+  }
+  catch(std::bad_alloc&){
+    thrown = true;
+  }
+  failure::armed = false;
+  VERIFY( thrown && s.bucket_count() == buckets && holds(s, 100) );
+  s.reserve(1000);
+  VERIFY( s.bucket_count() > buckets && holds(s, 100) );
+
+  // the rehash copies the keys which may throw, so the failed copy loses nothing
+  fragile_set f;
+  for(int i = 0; i < 100; i++)
+    f.insert(fragile(i));
+  const size_t fragile_buckets = f.bucket_count();
+  thrown = false;
+  fragile::copies_left = 50;
+  try{
+    f.reserve(1000);
+  }
+  catch(int){
+    thrown = true;
+  }
+  fragile::copies_left = -1;
+  bool all = f.size() == 100;
+  for(int i = 0; i < 100; i++)
+    all = f.count(fragile(i)) == 1 && all;
+  VERIFY( thrown && f.bucket_count() == fragile_buckets && all );
+}
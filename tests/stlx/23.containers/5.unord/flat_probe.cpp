@@ -0,0 +1,149 @@
+// flat_hashtable control groups: the SSE2 group match, the probing across the groups, ntl::bsf/bsr
+
+#include <ntl-tests-common.hxx>
+#include <unordered_set>
+#include <stdlib.hxx>
+
+STLX_DEFAULT_TESTGROUP_NAME("std::ext::hashtable::ctrl_group");
+
+namespace
+{
+  namespace __ = std::ext::hashtable::__;
+
+  // every key has the same hash, so the probe sequence is the same for all of them
+  struct fixed_hash
+  {
+    size_t h;
+    explicit fixed_hash(size_t h = 0) : h(h) {}
+    size_t operator()(int) const { return h; }
+  };
+  typedef std::unordered_set<int, fixed_hash, std::equal_to<int>, std::allocator<int>, std::ext::hashtable::flat_policy> fixed_set;
+
+  // a random control byte: a hash fragment or one of the free marks
+  __::ctrl_t random_ctrl(uint32_t& seed)
+  {
+    const uint32_t r = next_xorshift(seed);
+    switch(r % 4){
+    case 0:  return __::ctrl_empty;
+    case 1:  return __::ctrl_deleted;
+    default: return static_cast<__::ctrl_t>((r >> 8) % 8); // a few fragments to have the repeated matches
+    }
+  }
+}
+
+// the group masks against the portable byte loop
+template<> template<> void tut::to::test<01>(void)
+{
+  __::ctrl_t ctrl[64 + __::ctrl_group::width];
+  uint32_t seed = 2463534242u;
+  bool same = true, sentinel = true;
+  for(int round = 0; round < 2000; round++){
+    for(size_t i = 0; i < sizeof(ctrl); i++)
+      ctrl[i] = random_ctrl(seed);
+    ctrl[next_xorshift(seed) % sizeof(ctrl)] = __::ctrl_sentinel;
+
+    // the unaligned positions too
+    for(size_t pos = 0; pos <= 64; pos++){
+      const __::ctrl_group g(ctrl + pos);
+      const __::ctrl_group_portable p(ctrl + pos);
+      for(__::ctrl_t h2 = 0; h2 < 8; h2++)
+        same = g.match(h2) == p.match(h2) && same;
+      same = g.match_empty() == p.match_empty() && g.match_empty_or_deleted() == p.match_empty_or_deleted() && same;
+      // the sentinel is neither free nor a fragment
+      for(uint32_t m = g.match_empty_or_deleted(); m; m &= m - 1)
+        sentinel = ctrl[pos + __::lowest_bit(m)] != __::ctrl_sentinel && sentinel;
+    }
+  }
+  VERIFY( same );
+  VERIFY( sentinel );
+
+  // the edge cases: all empty, all full, a single match at either end
+  __::ctrl_t group[__::ctrl_group::width];
+  for(size_t i = 0; i < __::ctrl_group::width; i++)
+    group[i] = __::ctrl_empty;
+  VERIFY( __::ctrl_group(group).match_empty() == 0xFFFF && __::ctrl_group(group).match(0) == 0 );
+  for(size_t i = 0; i < __::ctrl_group::width; i++)
+    group[i] = 0x7F;
+  VERIFY( __::ctrl_group(group).match(0x7F) == 0xFFFF && __::ctrl_group(group).match_empty_or_deleted() == 0 );
+  group[0] = __::ctrl_deleted;
+  group[15] = __::ctrl_empty;
+  VERIFY( __::ctrl_group(group).match_empty_or_deleted() == 0x8001 && __::ctrl_group(group).match_empty() == 0x8000 );
+}
+
+// the probe sequence spans the group boundaries and wraps at the end of the table
+template<> template<> void tut::to::test<02>(void)
+{
+  // find the hash which starts the probing at the last group of 64 slots
+  size_t h = 0;
+  for(;; h++){
+    fixed_set probe(64, fixed_hash(h));
+    probe.insert(0);
+    if(probe.bucket(0) >= probe.bucket_count() - __::ctrl_group::width)
+      break;
+  }
+
+  fixed_set s(64, fixed_hash(h));
+  VERIFY( s.bucket_count() == 64 );
+  for(int i = 0; i < 40; i++)
+    s.insert(i);
+  VERIFY( s.size() == 40 && s.bucket_count() == 64 );
+
+  // the last group is full, the rest went to the first groups after the wrap
+  size_t last = 0, wrapped = 0;
+  for(int i = 0; i < 40; i++){
+    const size_t slot = s.bucket(i);
+    if(slot >= 64 - __::ctrl_group::width)
+      last++;
+    else if(slot < __::ctrl_group::width)
+      wrapped++;
+  }
+  VERIFY( last == __::ctrl_group::width && wrapped == __::ctrl_group::width );
+
+  bool found = true;
+  for(int i = 0; i < 40; i++)
+    found = s.count(i) == 1 && found;
+  VERIFY( found );
+  VERIFY( s.count(40) == 0 && s.count(-1) == 0 );
+
+  // a hole in the full last group does not stop the probing
+  VERIFY( s.erase(5) == 1 );
+  found = true;
+  for(int i = 0; i < 40; i++)
+    found = (s.count(i) == 1) == (i != 5) && found;
+  VERIFY( found );
+  VERIFY( s.count(5) == 0 );
+}
+
+// ntl::bsf and ntl::bsr against the bit loop
+template<> template<> void tut::to::test<03>(void)
+{
+  bool single = true;
+  for(unsigned i = 0; i < 32; i++){
+    const uint32_t m = uint32_t(1) << i;
+    single = ntl::bsf(m) == i && ntl::bsr(m) == i && single;
+  }
+  VERIFY( single );
+
+  uint32_t seed = 88172645u;
+  bool scan = true;
+  for(int round = 0; round < 10000; round++){
+    const uint32_t m = next_xorshift(seed) >> (round % 32) | 1u << (round % 32);
+    unsigned lo = 0, hi = 31;
+    while(!(m & (1u << lo)))
+      lo++;
+    while(!(m & (1u << hi)))
+      hi--;
+    scan = ntl::bsf(m) == lo && ntl::bsr(m) == hi && scan;
+  }
+  VERIFY( scan );
+  VERIFY( ntl::bsf(0xFFFFFFFFu) == 0 && ntl::bsr(0xFFFFFFFFu) == 31 );
+
+#ifdef _M_X64
+  bool wide = true;
+  for(unsigned i = 0; i < 64; i++){
+    const uint64_t m = uint64_t(1) << i;
+    wide = ntl::bsf(m) == i && ntl::bsr(m) == i && ntl::bsf(m | (uint64_t(1) << 63)) == i && ntl::bsr(m | 1) == i && wide;
+  }
+  VERIFY( wide );
+#endif
+}
@@ -0,0 +1,179 @@
+// std::ext::btree_map, btree_set, btree_multimap
+
+#include <ntl-tests-common.hxx>
+#include <stlx/ext/btree.hxx>
+
+STLX_DEFAULT_TESTGROUP_NAME("std::ext::btree");
+
+namespace
+{
+  // the keys of the set are not modified through its iterators
+  template<class Iterator>
+  void constant_iterator(Iterator)
+  {
+    static_assert((std::is_const<typename std::remove_reference<typename std::iterator_traits<Iterator>::reference>::type>::value), "the set iterator must be constant");
+  }
+}
+
+// ordering & lookup
+template<> template<> void tut::to::test<01>(void)
+{
+  std::ext::btree_map<int, int> m;
+  VERIFY( m.empty() );
+  VERIFY( m.begin() == m.end() );
+  VERIFY( m.find(1) == m.end() );
+
+  // enough elements to split the leaves and the internal nodes
+  for(int i = 0; i < 10000; i++){
+    const int k = (i * 7919) % 10000;
+    VERIFY( m.insert(std::make_pair(k, -k)).second );
+  }
+  VERIFY( m.size() == 10000 );
+  VERIFY( !m.insert(std::make_pair(5, 0)).second );
+  VERIFY( m.size() == 10000 );
+
+  int expected = 0;
+  for(std::ext::btree_map<int, int>::const_iterator i = m.cbegin(); i != m.cend(); ++i, ++expected)
+    VERIFY( i->first == expected && i->second == -expected );
+  VERIFY( expected == 10000 );
+
+  expected = 9999;
+  for(std::ext::btree_map<int, int>::reverse_iterator i = m.rbegin(); i != m.rend(); ++i, --expected)
+    VERIFY( i->first == expected );
+  VERIFY( expected == -1 );
+
+  VERIFY( m.find(4242)->second == -4242 );
+  VERIFY( m.find(10000) == m.end() );
+  VERIFY( m.lower_bound(-1)->first == 0 );
+  VERIFY( m.upper_bound(4242)->first == 4243 );
+  VERIFY( m.upper_bound(9999) == m.end() );
+  VERIFY( m.count(17) == 1 && m.count(-17) == 0 );
+}
+
+// element access
+template<> template<> void tut::to::test<02>(void)
+{
+  std::ext::btree_map<int, int> m;
+  for(int i = 0; i < 1000; i++)
+    m[i % 100] += 1;
+  VERIFY( m.size() == 100 );
+  VERIFY( m[0] == 10 && m[99] == 10 );
+  VERIFY( m.at(50) == 10 );
+
+  bool thrown = false;
+  __ntl_try {
+    m.at(100);
+  }
+  __ntl_catch(const std::out_of_range&) {
+    thrown = true;
+  }
+  VERIFY( thrown );
+}
+
+// erasure & rebalancing
+template<> template<> void tut::to::test<03>(void)
+{
+  std::ext::btree_set<int> s;
+  for(int i = 0; i < 5000; i++)
+    s.insert(s.cend(), i);
+  VERIFY( s.size() == 5000 );
+
+  // erase the even keys: leaves underflow and borrow or merge
+  for(int i = 0; i < 5000; i += 2)
+    VERIFY( s.erase(i) == 1 );
+  VERIFY( s.size() == 2500 );
+  VERIFY( s.erase(0) == 0 );
+
+  int expected = 1;
+  for(std::ext::btree_set<int>::const_iterator i = s.cbegin(); i != s.cend(); ++i, expected += 2)
+    VERIFY( *i == expected );
+
+  // erase returns the following element
+  typedef std::ext::btree_set<int> set;
+  static_assert((std::is_same<set::iterator, set::const_iterator>::value), "set::iterator is the const_iterator");
+  static_assert((std::is_same<std::ext::btree_multiset<int>::iterator, std::ext::btree_multiset<int>::const_iterator>::value), "multiset::iterator is the const_iterator");
+  constant_iterator(s.begin());
+  constant_iterator(s.rbegin());
+  constant_iterator(s.find(1001));
+  constant_iterator(s.insert(0).first);
+  VERIFY( s.erase(0) == 1 );
+
+  set::iterator i = s.find(1001);
+  i = s.erase(i);
+  VERIFY( *i == 1003 );
+
+  i = s.erase(s.find(1101), s.find(4001));
+  VERIFY( *i == 4001 );
+  VERIFY( s.size() == 2500 - 1 - 1450 );
+
+  while(!s.empty())
+    s.erase(s.begin());
+  VERIFY( s.begin() == s.end() );
+}
+
+// equivalent keys keep the insertion order
+template<> template<> void tut::to::test<04>(void)
+{
+  typedef std::ext::btree_multimap<int, int> multimap;
+  multimap m;
+  for(int i = 0; i < 3000; i++)
+    m.insert(std::make_pair(i % 3, i));
+  VERIFY( m.size() == 3000 );
+  VERIFY( m.count(1) == 1000 );
+
+  std::pair<multimap::iterator, multimap::iterator> r = m.equal_range(1);
+  int expected = 1;
+  for(; r.first != r.second; ++r.first, expected += 3)
+    VERIFY( r.first->first == 1 && r.first->second == expected );
+  VERIFY( expected == 3001 );
+
+  VERIFY( m.erase(1) == 1000 );
+  VERIFY( m.size() == 2000 );
+  VERIFY( m.find(1) == m.end() );
+  VERIFY( m.lower_bound(1)->first == 2 );
+
+  std::ext::btree_multiset<int> ms;
+  ms.insert(5); ms.insert(5); ms.insert(3);
+  VERIFY( ms.size() == 3 && ms.count(5) == 2 && *ms.begin() == 3 );
+}
+
+// iterators must be reacquired after the modification
+template<> template<> void tut::to::test<05>(void)
+{
+  std::ext::btree_map<int, int> m;
+  for(int i = 0; i < 100; i++)
+    m.insert(std::make_pair(i * 2, i));
+
+  // the iterator returned by insert stays valid
+  std::ext::btree_map<int, int>::iterator i = m.insert(std::make_pair(51, 0)).first;
+  VERIFY( i->first == 51 );
+  ++i;
+  VERIFY( i->first == 52 );
+
+  // values may move between the nodes, so look them up again
+  for(int k = 1; k < 200; k += 2)
+    m.insert(std::make_pair(k, 0));
+  i = m.find(52);
+  VERIFY( i != m.end() && i->second == 26 );
+  --i;
+  VERIFY( i->first == 51 );
+}
+
+// copy & comparison
+template<> template<> void tut::to::test<06>(void)
+{
+  std::ext::btree_set<int> a, b;
+  for(int i = 0; i < 1000; i++)
+    a.insert(i);
+  std::ext::btree_set<int> c(a);
+  VERIFY( c == a );
+  VERIFY( b < a );
+  b = a;
+  VERIFY( b == a );
+  b.erase(999);
+  VERIFY( b != a && b < a );
+  swap(a, b);
+  VERIFY( a.size() == 999 && b.size() == 1000 );
+  a.clear();
+  VERIFY( a.empty() && a.begin() == a.end() );
+}
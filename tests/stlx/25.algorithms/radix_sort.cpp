@@ -0,0 +1,149 @@
+// std::ext::radix_sort
+
+#include <ntl-tests-common.hxx>
+#include <algorithm>
+#include <vector>
+#include <stlx/ext/radix_sort.hxx>
+
+STLX_DEFAULT_TESTGROUP_NAME("std::ext::radix_sort");
+
+namespace
+{
+  struct record
+  {
+    long long key;
+    int seq;
+  };
+
+  struct record_key
+  {
+    long long operator()(const record& r) const { return r.key; }
+  };
+
+  // the negative enumerators order before the positive ones
+  enum level { fatal = -3, error, warning, info, debug, verbose, trace };
+
+  struct record_name
+  {
+    const std::string& operator()(const std::pair<std::string, int>& r) const { return r.first; }
+  };
+
+  template<class Iterator>
+  bool ordered(Iterator first, Iterator last)
+  {
+    if(first != last)
+      for(Iterator next = first; ++next != last; ++first)
+        if(*next < *first)
+          return false;
+    return true;
+  }
+}
+
+// integral keys
+template<> template<> void tut::to::test<01>(void)
+{
+  unsigned seed = 1;
+  std::vector<unsigned> u(5000);
+  for(size_t i = 0; i < u.size(); i++)
+    u[i] = next_random(seed) * 2654435761u;
+  std::ext::radix_sort(u.begin(), u.end());
+  VERIFY( ordered(u.begin(), u.end()) );
+
+  std::vector<int> s(5000);
+  for(size_t i = 0; i < s.size(); i++)
+    s[i] = static_cast<int>(next_random(seed)) - 0x400000;
+  s[0] = INT_MIN; s[1] = INT_MAX;
+  std::ext::radix_sort(s.begin(), s.end());
+  VERIFY( ordered(s.begin(), s.end()) );
+  VERIFY( s.front() == INT_MIN && s.back() == INT_MAX );
+
+  // short ranges are sorted by comparison
+  short small[] = { 3, -1, 2, -7, 0 };
+  std::ext::radix_sort(small, small + sizeof(small) / sizeof(*small));
+  VERIFY( ordered(small, small + sizeof(small) / sizeof(*small)) );
+}
+
+// the equal keys keep their order, the scratch buffer is given
+template<> template<> void tut::to::test<02>(void)
+{
+  unsigned seed = 7;
+  std::vector<record> v(3000), scratch(3000);
+  for(size_t i = 0; i < v.size(); i++){
+    v[i].key = static_cast<long long>(next_random(seed) % 50) - 25;
+    v[i].seq = static_cast<int>(i);
+  }
+  std::ext::radix_sort(v.begin(), v.end(), record_key(), scratch.data());
+  for(size_t i = 1; i < v.size(); i++){
+    VERIFY( v[i - 1].key <= v[i].key );
+    if(v[i - 1].key == v[i].key)
+      VERIFY( v[i - 1].seq < v[i].seq );
+  }
+}
+
+// floating point keys
+template<> template<> void tut::to::test<03>(void)
+{
+  unsigned seed = 3;
+  std::vector<double> d(2000);
+  for(size_t i = 0; i < d.size(); i++)
+    d[i] = (static_cast<double>(next_random(seed)) - 0x800000) / 1024.0;
+  d[0] = -1e300; d[1] = 1e300; d[2] = -0.0; d[3] = 0.0;
+  std::ext::radix_sort(d.begin(), d.end());
+  VERIFY( ordered(d.begin(), d.end()) );
+  VERIFY( d.front() == -1e300 && d.back() == 1e300 );
+
+  std::vector<float> f(2000);
+  for(size_t i = 0; i < f.size(); i++)
+    f[i] = static_cast<float>(d[(i * 7) % d.size()]);
+  std::ext::radix_sort(f.begin(), f.end());
+  VERIFY( ordered(f.begin(), f.end()) );
+}
+
+// string keys
+template<> template<> void tut::to::test<04>(void)
+{
+  unsigned seed = 5;
+  typedef std::pair<std::string, int> named;
+  std::vector<named> v(2000);
+  for(size_t i = 0; i < v.size(); i++){
+    const size_t len = next_random(seed) % 12;
+    for(size_t c = 0; c < len; c++)
+      v[i].first += static_cast<char>('a' + next_random(seed) % 3);
+    v[i].second = static_cast<int>(i);
+  }
+  v[0].first = "\xE0";  // the characters are compared as unsigned
+  std::ext::radix_sort(v.begin(), v.end(), record_name());
+  for(size_t i = 1; i < v.size(); i++){
+    VERIFY( v[i - 1].first <= v[i].first );
+    if(v[i - 1].first == v[i].first)
+      VERIFY( v[i - 1].second < v[i].second );
+  }
+  VERIFY( v.back().first == "\xE0" );
+
+  std::vector<std::string_ref> r;
+  std::vector<const char*> p;
+  for(size_t i = 0; i < v.size(); i += 2){
+    r.push_back(v[i].first);
+    p.push_back(v[i].first.c_str());
+  }
+  std::reverse(r.begin(), r.end());
+  std::reverse(p.begin(), p.end());
+  std::ext::radix_sort(r.begin(), r.end());
+  std::ext::radix_sort(p.begin(), p.end());
+  for(size_t i = 1; i < r.size(); i++){
+    VERIFY( r[i - 1] <= r[i] );
+    VERIFY( std::string_ref(p[i - 1]) <= std::string_ref(p[i]) );
+  }
+}
+
+// enumeration keys with the negative values sort by their underlying type
+template<> template<> void tut::to::test<05>(void)
+{
+  unsigned seed = 11;
+  std::vector<level> v(1000);
+  for(size_t i = 0; i < v.size(); i++)
+    v[i] = static_cast<level>(static_cast<int>(next_random(seed) % 7) - 3);
+  std::ext::radix_sort(v.begin(), v.end());
+  VERIFY( ordered(v.begin(), v.end()) );
+  VERIFY( v.front() == fatal && v.back() == trace );
+}
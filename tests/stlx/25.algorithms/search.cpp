@@ -0,0 +1,58 @@
+// 25.2.13 Search [alg.search]
+
+#include <ntl-tests-common.hxx>
+#include <algorithm>
+#include <vector>
+#include <cstring>
+
+STLX_DEFAULT_TESTGROUP_NAME("std::search");
+
+namespace
+{
+  bool same_ci(char a, char b) { return (a | 0x20) == (b | 0x20); }
+}
+
+// generic iterators
+template<> template<> void tut::to::test<01>(void)
+{
+  std::vector<int> v;
+  for(int i = 0; i < 100; i++)
+    v.push_back(i % 10);
+  const int pattern[] = { 7, 8, 9, 0 };
+  VERIFY( std::search(v.begin(), v.end(), pattern, pattern + 4) - v.begin() == 7 );
+  VERIFY( std::search(v.begin(), v.end(), pattern, pattern) == v.begin() );
+  const int missing[] = { 9, 9 };
+  VERIFY( std::search(v.begin(), v.end(), missing, missing + 2) == v.end() );
+}
+
+// predicate
+template<> template<> void tut::to::test<02>(void)
+{
+  const char text[] = "Hello World";
+  const char word[] = "WORLD";
+  VERIFY( std::search(text, text + 11, word, word + 5, same_ci) == text + 6 );
+  VERIFY( std::search(text, text + 11, word, word + 5) == text + 11 );
+}
+
+// contiguous character ranges
+template<> template<> void tut::to::test<03>(void)
+{
+  static char buf[1 << 16];
+  std::memset(buf, 'a', sizeof(buf));
+  char marker[300];
+  std::memset(marker, 'a', sizeof(marker));
+  marker[299] = 'z';
+  char* const last = buf + sizeof(buf);
+
+  VERIFY( std::search(buf, last, marker, marker + 300) == last );
+  last[-1] = 'z';
+  VERIFY( std::search(buf, last, marker, marker + 300) == last - 300 );
+
+  const char* const cbuf = buf;
+  VERIFY( std::search(cbuf, cbuf + sizeof(buf), marker + 280, marker + 300) == last - 20 );
+  VERIFY( std::search(cbuf, cbuf + 10, marker, marker + 300) == cbuf + 10 );
+
+  const unsigned char u[] = { 1, 200, 3, 200, 4 };
+  const unsigned char un[] = { 200, 4 };
+  VERIFY( std::search(u, u + 5, un, un + 2) == u + 3 );
+}
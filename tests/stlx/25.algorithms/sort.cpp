@@ -0,0 +1,141 @@
+// 25.3.1 Sorting [alg.sort]
+
+#include <ntl-tests-common.hxx>
+#include <algorithm>
+#include <vector>
+#include <stlx/ext/parallel_sort.hxx>
+
+STLX_DEFAULT_TESTGROUP_NAME("std::sort");
+
+namespace
+{
+  struct record
+  {
+    int key, seq;
+  };
+
+  struct by_key
+  {
+    bool operator()(const record& a, const record& b) const { return a.key < b.key; }
+  };
+
+  template<class Iterator, class Compare>
+  bool ordered(Iterator first, Iterator last, Compare comp)
+  {
+    if(first != last)
+      for(Iterator next = first; ++next != last; ++first)
+        if(comp(*next, *first))
+          return false;
+    return true;
+  }
+
+  template<class Iterator>
+  bool ordered(Iterator first, Iterator last)
+  {
+    return ordered(first, last, std::less<int>());
+  }
+}
+
+// random, sorted, reversed and repeating input
+template<> template<> void tut::to::test<01>(void)
+{
+  unsigned seed = 1;
+  for(int pattern = 0; pattern < 5; pattern++){
+    std::vector<int> v(10000);
+    for(int i = 0; i < 10000; i++){
+      switch(pattern){
+      case 0: v[i] = static_cast<int>(next_random(seed)); break;
+      case 1: v[i] = i; break;
+      case 2: v[i] = 10000 - i; break;
+      case 3: v[i] = i % 3; break;
+      case 4: v[i] = i < 5000 ? i : 10000 - i; break;
+      }
+    }
+    long long sum = 0;
+    for(int i = 0; i < 10000; i++)
+      sum += v[i];
+
+    std::sort(v.begin(), v.end());
+    VERIFY( ordered(v.begin(), v.end()) );
+    for(int i = 0; i < 10000; i++)
+      sum -= v[i];
+    VERIFY( sum == 0 );
+
+    std::sort(v.begin(), v.end(), std::greater<int>());
+    VERIFY( ordered(v.begin(), v.end(), std::greater<int>()) );
+  }
+
+  int a[] = { 3, 1, 2 };
+  std::sort(a, a + 3);
+  VERIFY( a[0] == 1 && a[1] == 2 && a[2] == 3 );
+  std::sort(a, a);
+}
+
+// equivalent elements keep their order
+template<> template<> void tut::to::test<02>(void)
+{
+  unsigned seed = 2;
+  std::vector<record> v(5000);
+  for(int i = 0; i < 5000; i++){
+    v[i].key = next_random(seed) % 100;
+    v[i].seq = i;
+  }
+  std::stable_sort(v.begin(), v.end(), by_key());
+  for(int i = 1; i < 5000; i++)
+    VERIFY( v[i-1].key < v[i].key || (v[i-1].key == v[i].key && v[i-1].seq < v[i].seq) );
+
+  // strictly descending input is reversed
+  for(int i = 0; i < 5000; i++){
+    v[i].key = 5000 - i;
+    v[i].seq = i;
+  }
+  std::stable_sort(v.begin(), v.end(), by_key());
+  VERIFY( v[0].key == 1 && v[4999].key == 5000 );
+}
+
+// partial_sort & nth_element
+template<> template<> void tut::to::test<03>(void)
+{
+  unsigned seed = 3;
+  std::vector<int> v(3000);
+  for(int i = 0; i < 3000; i++)
+    v[i] = next_random(seed) % 1000;
+  std::vector<int> sorted(v);
+  std::sort(sorted.begin(), sorted.end());
+
+  const int sizes[] = { 0, 1, 10, 100, 2999, 3000 };
+  for(int k = 0; k < 6; k++){
+    std::vector<int> p(v);
+    std::partial_sort(p.begin(), p.begin() + sizes[k], p.end());
+    VERIFY( std::equal(p.begin(), p.begin() + sizes[k], sorted.begin()) );
+  }
+
+  const int positions[] = { 0, 1, 1500, 2998, 2999 };
+  for(int k = 0; k < 5; k++){
+    std::vector<int> p(v);
+    const int n = positions[k];
+    std::nth_element(p.begin(), p.begin() + n, p.end());
+    VERIFY( p[n] == sorted[n] );
+    for(int i = 0; i < n; i++)
+      VERIFY( !(p[n] < p[i]) );
+    for(int i = n + 1; i < 3000; i++)
+      VERIFY( !(p[i] < p[n]) );
+  }
+}
+
+// parallel sort
+template<> template<> void tut::to::test<04>(void)
+{
+  unsigned seed = 4;
+  std::vector<int> v(200000);
+  for(size_t i = 0; i < v.size(); i++)
+    v[i] = static_cast<int>(next_random(seed));
+  std::vector<int> expected(v);
+  std::sort(expected.begin(), expected.end());
+
+  std::sort(std::ext::par, v.begin(), v.end());
+  VERIFY( v == expected );
+
+  std::sort(std::ext::parallel_t(3), v.begin(), v.end(), std::greater<int>());
+  VERIFY( ordered(v.begin(), v.end(), std::greater<int>()) );
+}
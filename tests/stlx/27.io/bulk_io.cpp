@@ -0,0 +1,117 @@
+// the bulk xsputn/xsgetn of basic_stringbuf and basic_filebuf
+
+#include <ntl-tests-common.hxx>
+#include <sstream>
+#include <fstream>
+#include <string>
+#include <cstring>
+
+STLX_DEFAULT_TESTGROUP_NAME("std::streambuf#bulk");
+
+namespace
+{
+  const char filename[] = "bulk_io.bin";
+
+  std::string blob(size_t n, unsigned seed)
+  {
+    std::string s(n, '\0');
+    for(size_t i = 0; i < n; i++)
+      s[i] = char(next_random(seed) >> 8);
+    return s;
+  }
+
+  // the bytes of the buffer from \p from which still hold the fill
+  bool untouched(const char* buffer, size_t from, size_t size, char fill)
+  {
+    for(size_t i = from; i < size; i++)
+      if(buffer[i] != fill)
+        return false;
+    return true;
+  }
+}
+
+// the large spans written and read back through a stringstream
+template<> template<> void tut::to::test<01>(void)
+{
+  const std::string small = blob(10, 1), large = blob(3 << 20, 2), medium = blob(5000, 3);
+
+  std::stringstream ss;
+  ss.write(small.data(), small.size());
+  ss.write(large.data(), large.size());
+  ss.write(medium.data(), medium.size());
+  ss << 'x';
+  VERIFY( ss.good() );
+  VERIFY( ss.str() == small + large + medium + "x" );
+
+  std::string back(small.size() + large.size(), '\0');
+  ss.read(&back[0], back.size());
+  VERIFY( ss.gcount() == std::streamsize(back.size()) && back == small + large );
+  std::string rest(medium.size() + 10, '\0');
+  ss.read(&rest[0], rest.size());
+  VERIFY( ss.gcount() == std::streamsize(medium.size() + 1) && ss.eof() );
+  VERIFY( rest.compare(0, medium.size(), medium) == 0 && rest[medium.size()] == 'x' );
+
+  // the output-only stream
+  std::ostringstream os;
+  for(int i = 0; i < 4; i++)
+    os.write(large.data(), large.size());
+  VERIFY( os.str().size() == 4 * large.size() && os.str().compare(3 * large.size(), large.size(), large) == 0 );
+}
+
+// the large writes bypass the file buffer, the pending data comes first
+template<> template<> void tut::to::test<02>(void)
+{
+  const std::string head = blob(100, 4), large = blob(5 << 20, 5), tail = blob(7, 6);
+  {
+    std::ofstream out(filename, std::ios_base::out | std::ios_base::trunc | std::ios_base::binary);
+    out.write(head.data(), head.size());
+    out.write(large.data(), large.size());
+    out.write(tail.data(), tail.size());
+    out.write(large.data(), large.size());
+    VERIFY( out.good() );
+  }
+  std::ifstream in(filename, std::ios_base::in | std::ios_base::binary);
+  std::string all(head.size() + tail.size() + 2 * large.size() + 1, '\0');
+  in.read(&all[0], all.size());
+  VERIFY( in.gcount() == std::streamsize(all.size() - 1) );
+  all.resize(all.size() - 1);
+  VERIFY( all == head + large + tail + large );
+}
+
+// the large write after the buffered small ones: the pending bytes go first, the large data never enters the buffer
+template<> template<> void tut::to::test<03>(void)
+{
+  const size_t size = 4096;
+  const std::string small = blob(300, 7), large = blob(1 << 20, 8), exact = blob(size, 9), tail = blob(7, 10);
+  char buffer[size];
+  std::memset(buffer, '#', size);
+  {
+    std::filebuf fb;
+    VERIFY( fb.open(filename, std::ios_base::out | std::ios_base::trunc | std::ios_base::binary) == &fb );
+    VERIFY( fb.pubsetbuf(buffer, size) == &fb );
+
+    // the small pieces stay in the buffer
+    VERIFY( fb.sputn(small.data(), 100) == 100 && fb.sputn(small.data() + 100, 200) == 200 );
+    VERIFY( std::memcmp(buffer, small.data(), small.size()) == 0 && untouched(buffer, small.size(), size, '#') );
+
+    // the large one is written past the buffer, which is left as it was
+    VERIFY( fb.sputn(large.data(), large.size()) == std::streamsize(large.size()) );
+    VERIFY( std::memcmp(buffer, small.data(), small.size()) == 0 && untouched(buffer, small.size(), size, '#') );
+
+    // the next small piece is buffered again, the buffer sized one which does not fit behind it bypasses
+    VERIFY( fb.sputn(tail.data(), tail.size()) == std::streamsize(tail.size()) );
+    VERIFY( std::memcmp(buffer, tail.data(), tail.size()) == 0 );
+    VERIFY( fb.sputn(exact.data(), exact.size()) == std::streamsize(exact.size()) );
+    VERIFY( std::memcmp(buffer, tail.data(), tail.size()) == 0 && std::memcmp(buffer + tail.size(), small.data() + tail.size(), small.size() - tail.size()) == 0 );
+    VERIFY( untouched(buffer, small.size(), size, '#') );
+    VERIFY( fb.sputn(tail.data(), tail.size()) == std::streamsize(tail.size()) );
+    VERIFY( fb.close() == &fb );
+  }
+  std::ifstream in(filename, std::ios_base::in | std::ios_base::binary);
+  const std::string expected = small + large + tail + exact + tail;
+  std::string all(expected.size() + 1, '\0');
+  in.read(&all[0], all.size());
+  VERIFY( in.gcount() == std::streamsize(expected.size()) );
+  all.resize(expected.size());
+  VERIFY( all == expected );
+}
@@ -0,0 +1,113 @@
+// basic_filebuf: the read-only mapped mode (ios_base::mapped)
+
+#include <ntl-tests-common.hxx>
+#include <fstream>
+#include <string>
+#include <iterator>
+
+STLX_DEFAULT_TESTGROUP_NAME("std::filebuf#mapped");
+
+namespace
+{
+  const char filename[] = "filebuf_mapped.txt";
+
+  const std::ios_base::openmode mapped = std::ios_base::in | std::ios_base::binary | std::ios_base::mapped;
+
+  // lines of the different length, the last one without the end of line
+  std::string sample(size_t lines)
+  {
+    std::string s;
+    for(size_t i = 0; i < lines; i++){
+      s.append(i % 61, char('a' + i % 26));
+      if(i + 1 < lines)
+        s += '\n';
+    }
+    return s;
+  }
+
+  bool write_file(const std::string& s)
+  {
+    std::ofstream out(filename, std::ios_base::out | std::ios_base::trunc | std::ios_base::binary);
+    out.write(s.data(), s.size());
+    out.close();
+    return !out.fail();
+  }
+
+  size_t count_lines(std::ios_base::openmode mode, size_t& bytes)
+  {
+    std::ifstream in(filename, mode);
+    std::string line;
+    size_t lines = 0;
+    bytes = 0;
+    while(std::getline(in, line)){
+      lines++;
+      bytes += line.size();
+    }
+    return lines;
+  }
+}
+
+// the mapped file reads as the buffered one
+template<> template<> void tut::to::test<01>(void)
+{
+  const std::string s = sample(5000);
+  VERIFY( write_file(s) );
+
+  std::ifstream in(filename, mapped);
+  VERIFY( in.is_open() );
+  // the whole file is available at once, not a buffer refill
+  VERIFY( in.get() == s[0] );
+  VERIFY( in.rdbuf()->in_avail() == std::streamsize(s.size() - 1) );
+  in.unget();
+
+  const std::string whole((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+  VERIFY( whole == s );
+  VERIFY( in.rdbuf()->sgetc() == std::char_traits<char>::eof() );
+
+  // positioning inside the view
+  in.clear();
+  in.seekg(100);
+  VERIFY( in.tellg() == std::streampos(100) );
+  char part[50];
+  in.read(part, sizeof(part));
+  VERIFY( in.gcount() == 50 && s.compare(100, 50, part, 50) == 0 );
+  in.seekg(-10, std::ios_base::end);
+  std::string tail;
+  std::getline(in, tail);
+  VERIFY( tail == s.substr(s.size() - 10) && in.eof() );
+  in.clear();
+  in.seekg(1, std::ios_base::end);
+  VERIFY( in.fail() );
+  in.close();
+
+  size_t bytes1, bytes2;
+  const size_t lines1 = count_lines(mapped, bytes1), lines2 = count_lines(std::ios_base::in | std::ios_base::binary, bytes2);
+  VERIFY( lines1 == 5000 && lines1 == lines2 && bytes1 == bytes2 );
+}
+
+// the files which can't be mapped are read through the buffer
+template<> template<> void tut::to::test<02>(void)
+{
+  // an empty file has no section
+  VERIFY( write_file(std::string()) );
+  std::ifstream empty(filename, mapped);
+  VERIFY( empty.is_open() );
+  VERIFY( empty.get() == std::char_traits<char>::eof() && empty.eof() );
+  empty.close();
+
+  // the text mode with conversion is buffered too
+  const std::string s = sample(100);
+  VERIFY( write_file(s) );
+  std::wifstream wide(filename, std::ios_base::in | std::ios_base::mapped, ntl::Encoding::Ansi);
+  VERIFY( wide.is_open() );
+  std::wstring line;
+  std::getline(wide, line);
+  VERIFY( line.empty() );
+  std::getline(wide, line);
+  VERIFY( line == L"b" );
+
+  // and the output ignores the flag
+  std::fstream io(filename, std::ios_base::in | std::ios_base::out | std::ios_base::mapped);
+  VERIFY( io.is_open() );
+  io.close();
+}
@@ -0,0 +1,317 @@
+// std::regex: the grammars, the captures, the error codes and the linear time matching
+
+#include <ntl-tests-common.hxx>
+#include <regex>
+#include <string>
+#include <vector>
+
+STLX_DEFAULT_TESTGROUP_NAME("std::regex");
+
+namespace
+{
+  std::regex_constants::error_type error_of(const char* pattern, std::regex::flag_type f = std::regex::ECMAScript)
+  {
+    try{
+      std::regex re(pattern, f);
+    }
+    catch(const std::regex_error& e){
+      return e.code();
+    }
+    return static_cast<std::regex_constants::error_type>(-1);
+  }
+
+  // a service log with a rare failure line
+  std::string make_log(size_t size)
+  {
+    static const char* const levels[] = { "INFO", "DEBUG", "WARN", "ERROR" };
+    std::string log;
+    unsigned seed = 5;
+    while(log.size() < size){
+      const unsigned r = next_random(seed);
+      log += "2013-07-01 12:00:00 ";
+      log += levels[r & 3];
+      log += " worker-" + std::to_string(r % 97) + ": request " + std::to_string(r % 100000);
+      log += (r >> 8) % 50 == 0 ? " failed: connection refused\n" : " completed in 12ms\n";
+    }
+    return log;
+  }
+}
+
+// the ECMAScript matching semantics
+template<> template<> void tut::to::test<01>(void)
+{
+  using namespace std;
+  cmatch m;
+  VERIFY( regex_match("abc", regex("abc")) );
+  VERIFY( !regex_match("abcd", regex("abc")) );
+  VERIFY( regex_search("xxabcx", m, regex("abc")) && m.position() == 2 && m.length() == 3 );
+
+  // leftmost-first: the first alternative and the greedy or lazy quantifiers decide
+  VERIFY( regex_search("ab", m, regex("a|ab")) && m.str() == "a" );
+  VERIFY( regex_match("ab", m, regex("a|ab")) && m.str() == "ab" );
+  VERIFY( regex_search("abcd", m, regex("c|abcd")) && m.str() == "abcd" );
+  VERIFY( regex_search("aaa", m, regex("a+?")) && m.str() == "a" );
+  VERIFY( regex_search("<a><b>", m, regex("<.*>")) && m.str() == "<a><b>" );
+  VERIFY( regex_search("<a><b>", m, regex("<.*?>")) && m.str() == "<a>" );
+  VERIFY( regex_search("xaaay", m, regex("a{2}")) && m.position() == 1 && m.length() == 2 );
+  VERIFY( regex_search("xaaay", m, regex("a{1,2}?y")) && m.position() == 2 );
+
+  // the assertions and the match flags
+  VERIFY( regex_search("foo bar", m, regex("\\bbar")) && m.position() == 4 );
+  VERIFY( !regex_search("foobar", regex("\\bbar")) );
+  VERIFY( regex_search("foobar", regex("\\Bbar")) );
+  VERIFY( !regex_search("a\nb", regex("^b")) );
+  VERIFY( regex_search("abc", regex("c$")) && !regex_search("abc", regex("c$"), regex_constants::match_not_eol) );
+  VERIFY( !regex_search("abc", regex("^a"), regex_constants::match_not_bol) );
+  VERIFY( !regex_search("xabc", regex("abc"), regex_constants::match_continuous) );
+  VERIFY( regex_match("", regex("a*")) && !regex_match("", regex("a*"), regex_constants::match_not_null) );
+  VERIFY( !regex_search("", regex()) );
+
+  // the classes and the case folding
+  VERIFY( regex_match("Hello World", regex("[[:alpha:]]+ [[:upper:]][[:lower:]]+")) );
+  VERIFY( regex_match("a_1", regex("\\w+")) && !regex_match("a-1", regex("\\w+")) );
+  VERIFY( regex_match("a-z", regex("[a\\-z]+")) && regex_match(" \t", regex("[\\s]+")) );
+  VERIFY( regex_match("x", regex("\\x78")) && regex_match("x", regex("\\u0078")) );
+  VERIFY( regex_match("AbC", regex("[a-c]+", regex::icase)) && !regex_match("AbC", regex("[a-c]+")) );
+  VERIFY( regex_search("ABC", m, regex("b", regex::icase)) && m.position() == 1 );
+  VERIFY( !regex_match("\n", regex(".")) );
+
+  // an empty iteration ends the loop, a backreference to an unset group matches empty
+  VERIFY( regex_search(" b", m, regex("(b?)*.[^a]")) && !m[1].matched );
+  VERIFY( regex_search("c", m, regex("(b)*[^a]\\1")) && m.str() == "c" );
+
+  // so does an empty iteration past the minimum, the bounded ones too; every iteration clears the captures of its atom
+  VERIFY( regex_search("aa", m, regex("(?:a*?)+")) && m.position() == 0 && m.length() == 2 );
+  VERIFY( regex_search("AB", m, regex("(?:.*?)+")) && m.position() == 0 && m.length() == 2 );
+  VERIFY( regex_search("ccBb", m, regex("(c{0,1}){1,3}")) && m.length() == 2 && m.position(1) == 1 && m.length(1) == 1 );
+  VERIFY( regex_search("b ca", m, regex("((?:([ab])| .){1,2}){0,1}", regex::icase)) && m.length() == 3 && m[1].matched && !m[2].matched );
+
+  // the same in the Pike VM, the spans too long to backtrack
+  const string as(400000, 'a'), asb = as + "b";
+  smatch sm;
+  VERIFY( regex_search(as, sm, regex("(a*?)+")) && sm.length() == 400000 && sm.position(1) == 399999 && sm.length(1) == 1 );
+  VERIFY( regex_match(asb, sm, regex("(?:(a)|b)+")) && !sm[1].matched );
+}
+
+// the POSIX grammars: leftmost-longest
+template<> template<> void tut::to::test<02>(void)
+{
+  using namespace std;
+  cmatch m;
+  VERIFY( regex_search("xabcd", m, regex("a|ab|abc", regex::extended)) && m.str() == "abc" );
+  VERIFY( regex_search("abcd", m, regex("abcd|c", regex::extended)) && m.str() == "abcd" );
+  VERIFY( regex_search("xaaa", m, regex("a\\{1,2\\}", regex::basic)) && m.str() == "aa" );
+  VERIFY( regex_search("x(ab)", m, regex("(ab)", regex::basic)) && m.str() == "(ab)" );
+  VERIFY( regex_search("abab", m, regex("\\(ab\\)\\1", regex::basic)) && m.str(1) == "ab" );
+  VERIFY( regex_search("x\nb", m, regex("a\nb", regex::grep)) && m.str() == "b" );
+  VERIFY( regex_search("ab", m, regex("a|ab", regex::egrep)) && m.str() == "ab" );
+}
+
+// the captures and match_results
+template<> template<> void tut::to::test<03>(void)
+{
+  using namespace std;
+  const string s = "name: John Smith, age: 42";
+  smatch m;
+  VERIFY( regex_search(s, m, regex("(\\w+) (\\w+), age: (\\d+)")) );
+  VERIFY( m.size() == 4 && m.ready() );
+  VERIFY( m[1] == "John" && m[2] == "Smith" && m.str(3) == "42" );
+  VERIFY( m.position(1) == 6 && m.length(2) == 5 );
+  VERIFY( m.prefix() == "name: " && m.suffix().length() == 0 );
+  VERIFY( !m[4].matched && m[4].length() == 0 );
+  VERIFY( m.format("$2, $1 ($3)") == "Smith, John (42)" );
+  VERIFY( m.format("\\2 &", regex_constants::format_sed) == "Smith John Smith, age: 42" );
+
+  // the last iteration is captured, the unmatched alternative is not
+  const string abcabd = "abcabd", b = "b", xyz = "xyz", ba = "b a";
+  VERIFY( regex_match(abcabd, m, regex("(?:(ab)(c|d))+")) && m.str(1) == "ab" && m.str(2) == "d" );
+  VERIFY( regex_match(b, m, regex("(a)|(b)")) && !m[1].matched && m[2].matched );
+  VERIFY( regex_search(xyz, m, regex("y", regex::nosubs)) && m.size() == 1 );
+
+  // a failed search leaves the results ready and empty
+  VERIFY( !regex_search(xyz, m, regex("d")) && m.ready() && m.empty() );
+
+  // the sub_match comparisons
+  VERIFY( regex_search(ba, m, regex("(\\w) (\\w)")) );
+  VERIFY( m[1] > m[2] && m[2] < m[1] && m[2] == 'a' && "b" == m[1] && m[1] != string("a") );
+}
+
+// the backreferences and the compilation errors
+template<> template<> void tut::to::test<04>(void)
+{
+  using namespace std;
+  smatch m;
+  const string said = "say hello hello world";
+  VERIFY( regex_search(said, m, regex("\\b(\\w+) \\1\\b")) && m.str(1) == "hello" );
+  VERIFY( regex_match(string("abcABC"), regex("(abc)\\1", regex::icase)) );
+  VERIFY( !regex_match(string("abcabd"), regex("(abc)\\1")) );
+
+  VERIFY( error_of("a(") == regex_constants::error_paren );
+  VERIFY( error_of("a)") == regex_constants::error_paren );
+  VERIFY( error_of("[a") == regex_constants::error_brack );
+  VERIFY( error_of("a{2") == regex_constants::error_brace );
+  VERIFY( error_of("a{3,2}") == regex_constants::error_badbrace );
+  VERIFY( error_of("*a") == regex_constants::error_badrepeat );
+  VERIFY( error_of("[z-a]") == regex_constants::error_range );
+  VERIFY( error_of("[[:foo:]]") == regex_constants::error_ctype );
+  VERIFY( error_of("(a)\\2") == regex_constants::error_backref );
+  VERIFY( error_of("a\\") == regex_constants::error_escape );
+  VERIFY( error_of("(?=a)") == regex_constants::error_complexity );
+  VERIFY( error_of("(a{1000}){1000}") == regex_constants::error_space );
+  VERIFY( error_of(string(1000, '(').c_str()) == regex_constants::error_stack );
+
+  // the invalid pattern keeps the old one
+  regex re("abc");
+  try{
+    re.assign("(");
+  }
+  catch(const regex_error&){}
+  VERIFY( regex_match("abc", re) && re.mark_count() == 0 );
+}
+
+// the hostile patterns match in linear time
+template<> template<> void tut::to::test<05>(void)
+{
+  using namespace std;
+  const string a(100000, 'a');
+  smatch m;
+  VERIFY( !regex_search(a, regex("(a*)*b")) );
+  VERIFY( !regex_search(a, regex("(a|aa)+$"), regex_constants::match_not_eol) );
+  VERIFY( !regex_match(a + "c", regex("(a|aa)*")) );
+  VERIFY( regex_match(a, m, regex("(a|aa)*")) && m.length(1) == 1 );
+  const string ab = a + "b";
+  VERIFY( regex_search(ab, m, regex("(x+x+)+y|(a+)b")) && m.length(2) == 100000 );
+
+  // the DFA of this one has 2^13 states, more than the cache holds
+  string s;
+  unsigned seed = 3;
+  for(int i = 0; i < 200000; i++)
+    s += "ab"[next_random(seed) & 1];
+  s += "aababababababc";
+  VERIFY( regex_search(s, m, regex("(a|b)*a(a|b){12}c")) && m.suffix().length() == 0 && m.position() == 0 );
+
+  // the backreferences run out of the budget instead, unless the prefilter finds the literal missing
+  VERIFY( !regex_search(a, regex("(a*)*\\1b")) );
+  bool complex = false;
+  try{
+    regex_search(a, regex("(a*)*\\1[bc]"));
+  }
+  catch(const regex_error& e){
+    complex = e.code() == regex_constants::error_complexity;
+  }
+  VERIFY( complex );
+}
+
+// the iterators, the replacement and the wide strings
+template<> template<> void tut::to::test<06>(void)
+{
+  using namespace std;
+  const string text = "one two  three";
+  const regex spaces(" +"), words("\\w+"), empty("x*");
+  const vector<string> parts(sregex_token_iterator(text.begin(), text.end(), spaces, -1), sregex_token_iterator());
+  VERIFY( parts.size() == 3 && parts[0] == "one" && parts[2] == "three" );
+
+  int count = 0;
+  for(sregex_iterator i(text.begin(), text.end(), words), end; i != end; ++i)
+    count++;
+  VERIFY( count == 3 );
+
+  // the empty matches step over a character each
+  count = 0;
+  for(sregex_iterator i(text.begin(), text.end(), empty), end; i != end; ++i)
+    count++;
+  VERIFY( count == static_cast<int>(text.size()) + 1 );
+
+  const int subs[] = { 1, 2 };
+  const regex pairs("(\\w)=(\\w)");
+  const string kv = "a=1, b=2";
+  const vector<string> tokens(sregex_token_iterator(kv.begin(), kv.end(), pairs, subs), sregex_token_iterator());
+  VERIFY( tokens.size() == 4 && tokens[2] == "b" && tokens[3] == "2" );
+
+  VERIFY( regex_replace(string("a1b22c"), regex("\\d+"), string("[$&]")) == "a[1]b[22]c" );
+  VERIFY( regex_replace(string("john smith"), regex("(\\w+) (\\w+)"), string("$2, $1")) == "smith, john" );
+  VERIFY( regex_replace(string("aaa"), regex("a"), string("b"), regex_constants::format_first_only) == "baa" );
+  VERIFY( regex_replace(string("xay"), regex("a"), string("<&>"), regex_constants::format_sed) == "x<a>y" );
+  VERIFY( regex_replace(string("ab"), regex("x*"), string("-")) == "-a-b-" );
+  VERIFY( regex_replace(string("a1b2"), regex("\\d"), string(""), regex_constants::format_no_copy) == "" );
+
+  wsmatch wm;
+  const wstring w = L"key=value";
+  VERIFY( regex_match(w, wm, wregex(L"(\\w+)=(\\w+)")) && wm[2] == L"value" );
+  VERIFY( regex_search(w, wregex(L"VALUE", wregex::icase)) );
+}
+
+// the log filter finds the same lines with the literal prefilter and by the automaton alone
+template<> template<> void tut::to::test<07>(void)
+{
+  using namespace std;
+  const string log = make_log(64 * 1024);
+  // the failed lines of the each level, counted by hand
+  size_t failed = 0, failed_errors = 0;
+  for(string::size_type p = 0, e; p < log.size(); p = e + 1){
+    e = log.find('\n', p);
+    const string line = log.substr(p, e - p);
+    if(line.find("failed: connection refused") != string::npos){
+      failed++;
+      if(line.find(" ERROR ") != string::npos)
+        failed_errors++;
+    }
+  }
+  const regex failure("ERROR worker-[0-9]+: request [0-9]+ failed: (timeout|connection refused)"),
+              scanned("\\w+ worker-[0-9]+: request [0-9]+ failed: (timeout|connection refused)");
+  size_t found[2];
+  for(int k = 0; k < 2; k++){
+    found[k] = 0;
+    for(sregex_iterator i(log.begin(), log.end(), k ? scanned : failure), end; i != end; ++i){
+      VERIFY( i->str(1) == "connection refused" );
+      found[k]++;
+    }
+  }
+  VERIFY( failed_errors != 0 && found[0] == failed_errors && found[1] == failed );
+}
+
+// the prefilter skips only the text no match starts in
+template<> template<> void tut::to::test<8>(void)
+{
+  using namespace std;
+  static const char* const patterns[] = {
+    "abc", "ab+c", "a(b)\\1", "(abc|abd)e", "(x|y)ab", "[0-9]{2}:ab", "[xy]{1,3}-ab", "\\bab\\b", "(^|c)ab",
+    "c{3}", "ab|cd", "[ab]c", "\\w+ ab", "(a|b)*cab", "ABc"
+  };
+  unsigned seed = 8;
+  for(size_t k = 0; k < sizeof(patterns) / sizeof(patterns[0]); k++){
+    for(int f = 0; f < 3; f++){
+      const regex re(patterns[k], f == 0 ? regex::ECMAScript : f == 1 ? regex::ECMAScript | regex::icase : regex::extended);
+      for(int round = 0; round < 20; round++){
+        string text;
+        for(int i = 0; i < 60; i++)
+          text += "abcdxy0 :-"[next_random(seed) % 10];
+        // the leftmost match is the first one anchored at its start
+        const string::const_iterator first = text.begin(), last = text.end();
+        smatch expected;
+        bool any = false;
+        for(string::const_iterator p = first; !any; ++p){
+          any = regex_search(p, last, expected, re, regex_constants::match_continuous | (p == first ? regex_constants::match_default : regex_constants::match_prev_avail));
+          if(p == last)
+            break;
+        }
+        smatch m;
+        VERIFY( regex_search(text, m, re) == any );
+        if(any)
+          VERIFY( m.position() == expected[0].first - first && m.length() == expected.length() && m.str(m.size() - 1) == expected.str(expected.size() - 1) );
+      }
+    }
+  }
+
+  // the missing literal rejects the text, the wide characters past the table are candidates
+  VERIFY( !regex_search(string(1000, 'a') + "xyz", regex("\\w+: error")) );
+  VERIFY( regex_search(wstring(L"\x0141\x0142 b"), wregex(L"[\x0140-\x0142]+ b")) );
+  wsmatch wm;
+  const wstring w = L"id=\x0142\x0142, id=42";
+  VERIFY( regex_search(w, wm, wregex(L"id=\\d+")) && wm.position() == 7 );
+
+  // dense candidates which never match switch to the unanchored scan
+  const string a(100000, 'a');
+  VERIFY( !regex_search(a, regex("a[ab]*c")) );
+  VERIFY( !regex_search(a, regex("[ab]{1,40}-a")) );
+}
@@ -0,0 +1,190 @@
+// std::ext::mpmc_queue, std::ext::spsc_ring and std::ext::blocking_queue
+
+#include <ntl-tests-common.hxx>
+#include <stlx/ext/concurrent_queue.hxx>
+#include <thread>
+#include <vector>
+
+STLX_DEFAULT_TESTGROUP_NAME("std::ext::concurrent_queue");
+
+namespace
+{
+  // counts the live instances
+  struct tracked
+  {
+    static int alive;
+    unsigned value;
+    tracked(unsigned value = 0) : value(value) { alive++; }
+    tracked(const tracked& r) : value(r.value) { alive++; }
+    ~tracked() { alive--; }
+  };
+  int tracked::alive = 0;
+
+  const unsigned producer_shift = 24;
+
+  // each producer sends its own increasing sequence, tagged with its index
+  template<class Queue>
+  struct exchange
+  {
+    Queue& q;
+    unsigned count;
+    std::atomic<unsigned> next_producer;
+    std::atomic<uint64_t> sum;
+    std::atomic<unsigned> received, disorders;
+
+    exchange(Queue& q, unsigned count)
+      :q(q), count(count), next_producer(0), sum(0), received(0), disorders(0)
+    {}
+  };
+
+  template<class Queue>
+  void produce(exchange<Queue>* x)
+  {
+    const unsigned tag = x->next_producer++ << producer_shift;
+    for(unsigned i = 0; i < x->count; i++)
+      while(!x->q.try_push(tag | i))
+        std::this_thread::yield();
+  }
+
+  template<class Queue>
+  void consume(exchange<Queue>* x, unsigned producers, unsigned total)
+  {
+    // a consumer sees the elements of one producer in their order
+    std::vector<unsigned> last(producers, ~0u);
+    uint64_t sum = 0;
+    unsigned v;
+    while(x->received.load() < total){
+      if(!x->q.try_pop(v)){
+        std::this_thread::yield();
+        continue;
+      }
+      x->received++;
+      unsigned& prev = last[v >> producer_shift];
+      const unsigned i = v & ((1u << producer_shift) - 1);
+      if(prev != ~0u && i <= prev)
+        x->disorders++;
+      prev = i;
+      sum += i;
+    }
+    x->sum += sum;
+  }
+
+  template<class Queue>
+  bool transfer(Queue& q, unsigned producers, unsigned consumers, unsigned count)
+  {
+    exchange<Queue> x(q, count);
+    std::thread* threads[16];
+    const unsigned total = producers * count;
+    for(unsigned i = 0; i < consumers; i++)
+      threads[i] = new std::thread(consume<Queue>, &x, producers, total);
+    for(unsigned i = 0; i < producers; i++)
+      threads[consumers + i] = new std::thread(produce<Queue>, &x);
+    for(unsigned i = 0; i < producers + consumers; i++){
+      threads[i]->join();
+      delete threads[i];
+    }
+    return x.received == total && x.disorders == 0 && x.sum == uint64_t(producers) * count * (count - 1) / 2 && q.empty();
+  }
+
+  struct blocking_producer
+  {
+    std::ext::blocking_queue<std::ext::mpmc_queue<unsigned> >* q;
+    unsigned count;
+    void operator()() const
+    {
+      for(unsigned i = 1; i <= count; i++)
+        q->push(i);
+    }
+  };
+
+  struct blocking_consumer
+  {
+    std::ext::blocking_queue<std::ext::mpmc_queue<unsigned> >* q;
+    std::atomic<uint64_t>* sum;
+    void operator()() const
+    {
+      unsigned v;
+      uint64_t s = 0;
+      while(q->pop(v))
+        s += v;
+      *sum += s;
+    }
+  };
+}
+
+// the single thread semantics
+template<> template<> void tut::to::test<01>(void)
+{
+  using namespace std::ext;
+  {
+    mpmc_queue<tracked> q(5);
+    VERIFY( q.capacity() == 8 && q.empty() );
+    for(unsigned lap = 0; lap < 3; lap++){
+      for(unsigned i = 0; i < 8; i++)
+        VERIFY( q.try_push(tracked(i)) );
+      VERIFY( !q.try_push(tracked(8)) && q.size() == 8 );
+      tracked v;
+      for(unsigned i = 0; i < 8; i++)
+        VERIFY( q.try_pop(v) && v.value == i );
+      VERIFY( !q.try_pop(v) && q.empty() );
+    }
+    q.try_push(tracked(1));
+    q.try_push(tracked(2));
+    VERIFY( tracked::alive == 2 );
+  }
+  VERIFY( tracked::alive == 0 );
+  {
+    spsc_ring<tracked> r(3);
+    VERIFY( r.capacity() == 4 );
+    tracked v;
+    for(unsigned i = 0; i < 10; i++){
+      VERIFY( r.try_push(tracked(i)) && r.try_push(tracked(i + 100)) );
+      VERIFY( r.try_pop(v) && v.value == i );
+      VERIFY( r.try_pop(v) && v.value == i + 100 );
+    }
+    for(unsigned i = 0; i < 4; i++)
+      VERIFY( r.try_push(tracked(i)) );
+    VERIFY( !r.try_push(tracked(4)) && r.size() == 4 );
+    VERIFY( tracked::alive == 5 );
+  }
+  VERIFY( tracked::alive == 0 );
+}
+
+// the elements are neither lost nor duplicated, each producer's order is kept
+template<> template<> void tut::to::test<02>(void)
+{
+  using namespace std::ext;
+  mpmc_queue<unsigned> small(4), large(1024);
+  VERIFY( transfer(small, 4, 4, 20000) );
+  VERIFY( transfer(large, 3, 5, 50000) );
+  VERIFY( transfer(large, 1, 1, 50000) );
+  spsc_ring<unsigned> ring(16);
+  VERIFY( transfer(ring, 1, 1, 200000) );
+}
+
+// the blocking wrapper parks the full and the empty side, close() drains the queue
+template<> template<> void tut::to::test<03>(void)
+{
+  using namespace std::ext;
+  blocking_queue<mpmc_queue<unsigned> > q(8);
+  std::atomic<uint64_t> sum(0);
+  const blocking_producer p = { &q, 10000 };
+  const blocking_consumer c = { &q, &sum };
+  std::thread p1(p), p2(p), p3(p), c1(c), c2(c);
+  p1.join();
+  p2.join();
+  p3.join();
+  q.close();
+  c1.join();
+  c2.join();
+  VERIFY( sum == 3 * uint64_t(10000) * 10001 / 2 );
+  VERIFY( q.empty() && !q.push(1) );
+  unsigned v;
+  VERIFY( !q.pop(v) );
+
+  blocking_queue<spsc_ring<unsigned> > r(2);
+  VERIFY( r.push(1) && r.push(2) && !r.try_push(3) );
+  VERIFY( r.pop(v) && v == 1 && r.try_push(3) );
+  r.close();
+  VERIFY( r.pop(v) && v == 2 && r.pop(v) && v == 3 && !r.pop(v) );
+}
@@ -0,0 +1,155 @@
+// std::ext::thread_pool and std::async
+
+#include <ntl-tests-common.hxx>
+#include <stlx/ext/thread_pool.hxx>
+#include <future>
+#include <thread>
+#include <stdexcept>
+
+STLX_DEFAULT_TESTGROUP_NAME("std::ext::thread_pool");
+
+namespace
+{
+  int square(int x) { return x * x; }
+
+  struct squared
+  {
+    int x;
+    int operator()() const { return square(x); }
+  };
+
+  struct counter
+  {
+    std::atomic<unsigned>* n;
+    void operator()() const { (*n)++; }
+  };
+
+  int fails()
+  {
+    throw std::runtime_error("task failed");
+  }
+
+  // each task submits its children to the same pool, the workers steal them from each other
+  struct spawn
+  {
+    std::ext::thread_pool* pool;
+    std::atomic<unsigned>* n;
+    unsigned depth;
+    void operator()() const
+    {
+      (*n)++;
+      if(depth){
+        const spawn child = { pool, n, depth - 1 };
+        for(unsigned i = 0; i < 4; i++)
+          pool->submit(child);
+      }
+    }
+  };
+
+  // a task of one pool submits to another one, which takes it through its inbox
+  struct relay
+  {
+    std::ext::thread_pool* to;
+    std::atomic<unsigned>* n;
+    void operator()() const
+    {
+      const counter c = { n };
+      to->submit(c);
+    }
+  };
+
+  std::thread::id caller() { return std::this_thread::get_id(); }
+}
+
+// submit() delivers the results and the exceptions
+template<> template<> void tut::to::test<01>(void)
+{
+  using namespace std::ext;
+  thread_pool pool(3);
+  VERIFY( pool.size() == 3 );
+
+  std::future<int> results[64];
+  for(int i = 0; i < 64; i++){
+    const squared f = { i };
+    results[i] = pool.submit(f);
+  }
+  bool all = true;
+  for(int i = 0; i < 64; i++)
+    all = results[i].get() == i * i && all;
+  VERIFY( all );
+
+  std::atomic<unsigned> n(0);
+  const counter c = { &n };
+  std::future<void> done = pool.submit(c);
+  done.get();
+  VERIFY( n == 1 );
+
+  std::future<int> failed = pool.submit(fails);
+  bool thrown = false;
+  __ntl_try{
+    failed.get();
+  }
+  __ntl_catch(const std::runtime_error&){
+    thrown = true;
+  }
+  VERIFY( thrown );
+}
+
+// the nested tasks are spread over the workers, the destructor runs everything queued
+template<> template<> void tut::to::test<02>(void)
+{
+  using namespace std::ext;
+  std::atomic<unsigned> n(0);
+  {
+    thread_pool pool(4);
+    const spawn root = { &pool, &n, 6 };
+    pool.submit(root);
+  }
+  // 1 + 4 + ... + 4^6
+  VERIFY( n == 5461 );
+
+  n = 0;
+  {
+    thread_pool pool(2);
+    const counter c = { &n };
+    for(unsigned i = 0; i < 10000; i++)
+      pool.submit(c);
+  }
+  VERIFY( n == 10000 );
+
+  n = 0;
+  {
+    thread_pool to(3);
+    {
+      thread_pool from(2);
+      const relay f = { &to, &n };
+      for(unsigned i = 0; i < 1000; i++)
+        from.submit(f);
+    }
+  }
+  VERIFY( n == 1000 );
+}
+
+// std::async runs on the other thread, launch::deferred alone runs at the call
+template<> template<> void tut::to::test<03>(void)
+{
+  using namespace std;
+  const squared f = { 7 };
+  future<int> r = async(launch::async, f);
+  VERIFY( r.get() == 49 );
+
+  future<thread::id> other = async(launch::async, caller);
+  VERIFY( other.get() != this_thread::get_id() );
+  future<thread::id> here = async(launch::deferred, caller);
+  VERIFY( here.get() == this_thread::get_id() );
+
+  std::future<int> many[32];
+  for(int i = 0; i < 32; i++){
+    const squared g = { i };
+    many[i] = async(launch::async, g);
+  }
+  bool all = true;
+  for(int i = 0; i < 32; i++)
+    all = many[i].get() == i * i && all;
+  VERIFY( all );
+}
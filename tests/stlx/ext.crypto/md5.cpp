@@ -0,0 +1,179 @@
+// MD5 against the RFC 1321 test suite, and the SIMD lanes of hash_many against the single stream
+
+#include <ntl-tests-common.hxx>
+#include <crypto/md5.hxx>
+#include <vector>
+#include <algorithm>
+
+STLX_DEFAULT_TESTGROUP_NAME("ntl::crypto::md5");
+
+using namespace ntl::crypto;
+
+namespace
+{
+  // A.5 Test suite
+  struct example
+  {
+    const char* message;
+    const char* digest;
+  };
+
+  const example suite[] = {
+    { "", "d41d8cd98f00b204e9800998ecf8427e" },
+    { "a", "0cc175b9c0f1b6a831c399e269772661" },
+    { "abc", "900150983cd24fb0d6963f7d28e17f72" },
+    { "message digest", "f96b697d7cb7938d525a2f31aaf161d0" },
+    { "abcdefghijklmnopqrstuvwxyz", "c3fcd3d76192e4007dfb496cca67e13b" },
+    { "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789", "d174ab98d277d9f5a5611c2c9f419d9f" },
+    { "12345678901234567890123456789012345678901234567890123456789012345678901234567890", "57edf4a22be3c955ac49da2e2107b67a" },
+  };
+
+  bool equal(const md5::digest& d, const char* hex)
+  {
+    static const char digits[] = "0123456789abcdef";
+    for(size_t i = 0; i < d.size(); i++, hex += 2)
+      if(!hex[0] || digits[d[i] >> 4] != hex[0] || digits[d[i] & 15] != hex[1])
+        return false;
+    return *hex == 0;
+  }
+
+  // the message fed in the pieces of the odd sizes growing by two, starting from \p first
+  md5::digest streamed(const void* message, size_t bytes, size_t first)
+  {
+    const char* p = reinterpret_cast<const char*>(message);
+    md5 m;
+    for(size_t i = 0, piece = first; i < bytes; i += piece, piece += 2)
+      m(p + i, std::min(piece, bytes - i));
+    return m.final();
+  }
+
+  md5::digest single(const void* message, size_t bytes)
+  {
+    md5 m;
+    return m(message, bytes).final();
+  }
+
+  typedef void hash_lanes(const void* const messages[], const size_t sizes[], md5::digest out[], size_t count);
+
+#ifdef NTL_CPU_SSE2
+  void sse2_lanes(const void* const messages[], const size_t sizes[], md5::digest out[], size_t count)
+  {
+    __::md5_hash_lanes<4>(__::md5_compress4x, messages, sizes, out, count);
+  }
+#endif
+#ifdef NTL_CPU_AVX2
+  void avx2_lanes(const void* const messages[], const size_t sizes[], md5::digest out[], size_t count)
+  {
+    __::md5_hash_lanes<8>(__::md5_compress8x, messages, sizes, out, count);
+  }
+#endif
+
+  // hashes \p count messages of the different lengths at once and compares each lane with the single stream
+  bool lanes_match(hash_lanes* hash, const std::vector<uint8_t>& data, size_t count)
+  {
+    std::vector<const void*> messages(count + 1);
+    std::vector<size_t> sizes(count + 1);
+    std::vector<md5::digest> many(count + 1);
+    for(size_t n = 0; n < count; n++){
+      // the empty, the one block, the two blocks padded and the long messages, so the lanes finish apart
+      sizes[n] = n % 7 == 3 ? 1000 + n * 13 : (n * 37) % 150;
+      messages[n] = &data[n * 5];
+    }
+    hash(&messages[0], &sizes[0], &many[0], count);
+    bool same = true;
+    for(size_t n = 0; n < count; n++)
+      same = many[n] == single(messages[n], sizes[n]) && same;
+    return same;
+  }
+
+  // a message with the two padding blocks and \p lanes empty ones behind it,
+  // so the long message is still in its padding when the lanes drain
+  bool padding_drained(hash_lanes* hash, const std::vector<uint8_t>& data, size_t lanes)
+  {
+    const size_t count = lanes + 1;
+    const size_t longs[] = { 56, 60, 63, 120 };
+    bool same = true;
+    for(size_t k = 0; k < _countof(longs); k++){
+      std::vector<const void*> messages(count, &data[0]);
+      std::vector<size_t> sizes(count, 0);
+      std::vector<md5::digest> many(count);
+      sizes[0] = longs[k];
+      hash(&messages[0], &sizes[0], &many[0], count);
+      for(size_t n = 0; n < count; n++)
+        same = many[n] == single(messages[n], sizes[n]) && same;
+    }
+    return same;
+  }
+}
+
+// the test suite in one call, streamed and by md5sum
+template<> template<> void tut::to::test<01>(void)
+{
+  for(size_t i = 0; i < _countof(suite); i++){
+    const example& e = suite[i];
+    const size_t bytes = std::strlen(e.message);
+    VERIFY( equal(single(e.message, bytes), e.digest) );
+    VERIFY( equal(streamed(e.message, bytes, 1), e.digest) );
+    VERIFY( equal(streamed(e.message, bytes, 5), e.digest) );
+    VERIFY( equal(md5sum(e.message), e.digest) );
+  }
+
+  // the 64 bytes block boundaries crossed at the odd offsets, the object reused after reset()
+  std::vector<uint8_t> data(1000);
+  uint32_t seed = 2463534242u;
+  for(size_t i = 0; i < data.size(); i++)
+    data[i] = static_cast<uint8_t>(next_xorshift(seed));
+  md5 m;
+  m(&data[0], 17);
+  m.reset();
+  m(&data[0], 63)(&data[63], 65)(&data[128], 872);
+  const md5::digest d = single(&data[0], data.size());
+  VERIFY( m.final() == d );
+  VERIFY( streamed(&data[0], data.size(), 1) == d && streamed(&data[0], data.size(), 63) == d );
+}
+
+// hash_many and the lanes of each width, with the counts which are not the multiples of the lanes
+template<> template<> void tut::to::test<02>(void)
+{
+  std::vector<uint8_t> data(4000);
+  uint32_t seed = 88172645u;
+  for(size_t i = 0; i < data.size(); i++)
+    data[i] = static_cast<uint8_t>(next_xorshift(seed));
+
+  const size_t counts[] = { 0, 1, 3, 4, 5, 7, 8, 9, 13, 19, 33 };
+  for(size_t k = 0; k < _countof(counts); k++){
+    VERIFY( lanes_match(md5::hash_many, data, counts[k]) );
+#ifdef NTL_CPU_SSE2
+    VERIFY( lanes_match(sse2_lanes, data, counts[k]) );
+#endif
+#ifdef NTL_CPU_AVX2
+    if(ntl::cpu::has(ntl::cpu::avx2))
+      VERIFY( lanes_match(avx2_lanes, data, counts[k]) );
+#endif
+  }
+
+  // the lanes drained while one of them is part-way through its padding
+  VERIFY( padding_drained(md5::hash_many, data, 4) && padding_drained(md5::hash_many, data, 8) );
+#ifdef NTL_CPU_SSE2
+  VERIFY( padding_drained(sse2_lanes, data, 4) );
+#endif
+#ifdef NTL_CPU_AVX2
+  if(ntl::cpu::has(ntl::cpu::avx2))
+    VERIFY( padding_drained(avx2_lanes, data, 8) );
+#endif
+
+  // the test suite through the lanes
+  const size_t count = _countof(suite);
+  const void* messages[count];
+  size_t sizes[count];
+  md5::digest many[count];
+  for(size_t n = 0; n < count; n++){
+    messages[n] = suite[n].message;
+    sizes[n] = std::strlen(suite[n].message);
+  }
+  md5::hash_many(messages, sizes, many, count);
+  bool same = true;
+  for(size_t n = 0; n < count; n++)
+    same = equal(many[n], suite[n].digest) && same;
+  VERIFY( same );
+}
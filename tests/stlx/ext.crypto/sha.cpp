@@ -0,0 +1,198 @@
+// SHA-1, SHA-256 and SHA-512 against the FIPS 180 examples, streamed at odd offsets, and their kernels against the portable code
+
+#include <ntl-tests-common.hxx>
+#include <crypto/sha.hxx>
+#include <vector>
+#include <algorithm>
+
+STLX_DEFAULT_TESTGROUP_NAME("ntl::crypto::sha");
+
+using namespace ntl::crypto;
+
+namespace
+{
+  // the message and its digests as the hex strings
+  struct example
+  {
+    const char* message;
+    size_t      bytes;
+    const char* sha1, *sha256, *sha512;
+  };
+
+  const char msg448[] = "abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq";
+  const char msg896[] = "abcdefghbcdefghicdefghijdefghijkefghijklfghijklmghijklmnhijklmno"
+                        "ijklmnopjklmnopqklmnopqrlmnopqrsmnopqrstnopqrstu";
+
+  const example examples[] = {
+    { "abc", 3,
+      "a9993e364706816aba3e25717850c26c9cd0d89d",
+      "ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad",
+      "ddaf35a193617abacc417349ae20413112e6fa4e89a97ea20a9eeee64b55d39a2192992a274fc1a836ba3c23a3feebbd454d4423643ce80e2a9ac94fa54ca49f" },
+    { "", 0,
+      "da39a3ee5e6b4b0d3255bfef95601890afd80709",
+      "e3b0c44298fc1c149afbf4c8996fb92427ae41e4649b934ca495991b7852b855",
+      "cf83e1357eefb8bdf1542850d66d8007d620e4050b5715dc83f4a921d36ce9ce47d0d13c5d85f2b0ff8318d2877eec2f63b931bd47417a81a538327af927da3e" },
+    { msg448, 448 / 8,
+      "84983e441c3bd26ebaae4aa1f95129e5e54670f1",
+      "248d6a61d20638b8e5c026930c3e6039a33ce45964ff2167f6ecedd419db06c1",
+      "204a8fc6dda82f0a0ced7beb8e08a41657c16ef468b228a8279be331a703c33596fd15c13b1b07f9aa1d3bea57789ca031ad85c7a71dd70354ec631238ca3445" },
+    { msg896, 896 / 8,
+      "a49b2446a02c645bf419f995b67091253a04a259",
+      "cf5b16a778af8380036ce59e7b0492370b249b11e8f07a51afac45037afee9d1",
+      "8e959b75dae313da8cf4f72814fc143f8f7779c6eb9f7fa17299aeadb6889018501d289e4900f7e4331b99dec4b5433ac7d329eeb6dd26545e96e55b874be909" },
+  };
+
+  // one million of 'a'
+  const example million = { 0, 1000000,
+    "34aa973cd4c4daa4f61eeb2bdbad27316534016f",
+    "cdc76e5c9914fb9281a1c7e284d73e67f1809a48a497200e046d39ccc7112cd0",
+    "e718483d0ce769644e2e42c7bc15b4638e1f98b13b2044285632a803afa973ebde0ff244877ea60a4cb0432ce577c31beb009c5c2c49aa2e4eadb217ad8cc09b" };
+
+  bool equal(const void* digest, size_t bytes, const char* hex)
+  {
+    static const char digits[] = "0123456789abcdef";
+    const uint8_t* p = reinterpret_cast<const uint8_t*>(digest);
+    for(size_t i = 0; i < bytes; i++, hex += 2)
+      if(!hex[0] || digits[p[i] >> 4] != hex[0] || digits[p[i] & 15] != hex[1])
+        return false;
+    return *hex == 0;
+  }
+
+  template<class Hash>
+  bool hashed(const char* message, size_t bytes, const char* hex)
+  {
+    Hash hash;
+    const typename Hash::digest& d = hash(message, bytes);
+    return equal(&d, sizeof(d), hex);
+  }
+
+  // fed in the pieces of the odd sizes growing by two, starting from \p first
+  template<class Hash>
+  bool streamed(const char* message, size_t bytes, const char* hex, size_t first)
+  {
+    Hash hash;
+    for(size_t i = 0, piece = first; i < bytes; i += piece, piece += 2)
+      hash.update(message + i, std::min(piece, bytes - i));
+    const typename Hash::digest& d = hash.finalize();
+    return equal(&d, sizeof(d), hex);
+  }
+
+  template<class Hash>
+  bool all_ways(const char* message, size_t bytes, const char* hex)
+  {
+    // 1, 3, 5..., 63, 65... and 127, 129... bytes: the splits move across the 64 and 128 byte blocks
+    return hashed<Hash>(message, bytes, hex)
+      && streamed<Hash>(message, bytes, hex, 1)
+      && streamed<Hash>(message, bytes, hex, 63)
+      && streamed<Hash>(message, bytes, hex, 127);
+  }
+}
+
+// the examples in one call and streamed
+template<> template<> void tut::to::test<01>(void)
+{
+  for(size_t i = 0; i < _countof(examples); i++){
+    const example& e = examples[i];
+    VERIFY( all_ways<sha1>(e.message, e.bytes, e.sha1) );
+    VERIFY( all_ways<sha256>(e.message, e.bytes, e.sha256) );
+    VERIFY( all_ways<sha512>(e.message, e.bytes, e.sha512) );
+  }
+
+  // the hash object is reusable after reset()
+  sha256 hash;
+  hash.update("abc", 3);
+  hash.finalize();
+  hash.reset();
+  hash.update(msg448, 448 / 8);
+  const sha256::digest& d = hash.finalize();
+  VERIFY( equal(&d, sizeof(d), examples[2].sha256) );
+}
+
+// the long message
+template<> template<> void tut::to::test<02>(void)
+{
+  const std::vector<char> a(million.bytes, 'a');
+  VERIFY( all_ways<sha1>(&a[0], a.size(), million.sha1) );
+  VERIFY( all_ways<sha256>(&a[0], a.size(), million.sha256) );
+  VERIFY( all_ways<sha512>(&a[0], a.size(), million.sha512) );
+}
+
+// the SHA extensions and the AVX2 lanes compress as the portable code, the dispatched paths hash the same
+template<> template<> void tut::to::test<03>(void)
+{
+  std::vector<uint8_t> data(64 * 120);
+  uint32_t seed = 2463534242u;
+  for(size_t i = 0; i < data.size(); i++)
+    data[i] = static_cast<uint8_t>(next_xorshift(seed));
+
+  const size_t counts[] = { 1, 2, 3, 17, 100 };
+  bool kernels = true;
+  for(size_t k = 0; k < _countof(counts); k++){
+    const size_t n = counts[k];
+    (void)n;
+#ifdef NTL_CPU_SHA
+    if(__::has_sha_extensions()){
+      uint32_t portable1[5], ni1[5];
+      for(unsigned i = 0; i < 5; i++)
+        portable1[i] = ni1[i] = next_xorshift(seed);
+      sha1::compress_blocks(portable1, &data[3], n);
+      __::sha1_compress_ni(ni1, &data[3], n);
+      kernels = std::equal(portable1, portable1 + 5, ni1) && kernels;
+
+      uint32_t portable256[8], ni256[8];
+      for(unsigned i = 0; i < 8; i++)
+        portable256[i] = ni256[i] = next_xorshift(seed);
+      sha256::compress_blocks(portable256, &data[5], n);
+      __::sha256_compress_ni(ni256, &data[5], n);
+      kernels = std::equal(portable256, portable256 + 8, ni256) && kernels;
+    }
+#endif
+#ifdef NTL_CPU_AVX2
+    if(ntl::cpu::has(ntl::cpu::avx2)){
+      // the lanes hold the big endian states of the different messages
+      uint32_t portable[8][8], lanes[8][8];
+      const uint8_t* messages[8];
+      for(unsigned j = 0; j < 8; j++){
+        messages[j] = &data[j * 67];
+        for(unsigned i = 0; i < 8; i++){
+          portable[j][i] = next_xorshift(seed);
+          lanes[j][i] = ntl::big_endian(portable[j][i]);
+        }
+        sha256::compress_blocks(portable[j], messages[j], n);
+      }
+      __::sha256_compress_x8(lanes, messages, n);
+      for(unsigned j = 0; j < 8; j++)
+        for(unsigned i = 0; i < 8; i++)
+          kernels = lanes[j][i] == ntl::big_endian(portable[j][i]) && kernels;
+    }
+#endif
+  }
+  VERIFY( kernels );
+
+  // the dispatched compression from the initial state
+  sha256 dispatched;
+  dispatched.compress(&data[0], 100);
+  uint32_t state[8] = { 0x6A09E667, 0xBB67AE85, 0x3C6EF372, 0xA54FF53A, 0x510E527F, 0x9B05688C, 0x1F83D9AB, 0x5BE0CD19 };
+  sha256::compress_blocks(state, &data[0], 100);
+  for(unsigned i = 0; i < 8; i++)
+    state[i] = ntl::big_endian(state[i]);
+  const sha256::digest& d = dispatched;
+  VERIFY( std::memcmp(&d, state, sizeof(state)) == 0 );
+
+  // hash_many with the count which is not a multiple of the lanes and the different lengths
+  const size_t count = 19;
+  const void* messages[count];
+  size_t sizes[count];
+  sha256::digest many[count];
+  for(size_t i = 0; i < count; i++){
+    messages[i] = &data[i];
+    sizes[i] = i * 97 + (i & 1) * 1000 + (i == 9 ? 0 : 1);
+  }
+  sha256::hash_many(messages, sizes, many, count);
+  bool same = true;
+  for(size_t i = 0; i < count; i++){
+    sha256 one;
+    same = many[i] == one(messages[i], sizes[i]) && same;
+  }
+  VERIFY( same );
+}
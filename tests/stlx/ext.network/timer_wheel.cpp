@@ -0,0 +1,134 @@
+// the timing wheel of the io_service timers, driven by a fake clock
+
+#include <ntl-tests-common.hxx>
+#include <stlx/ext/tr2/network/timer_wheel.hxx>
+#include <vector>
+#include <map>
+#include <algorithm>
+
+STLX_DEFAULT_TESTGROUP_NAME("std::tr2::sys::__::timer_wheel");
+
+namespace
+{
+  typedef std::tr2::sys::__::timer_wheel<unsigned, int64_t> wheel;
+
+  // collects the expired timers: the key and its armed time
+  struct collect
+  {
+    std::vector<std::pair<unsigned, int64_t> >* fired;
+    void operator()(unsigned key, int64_t time) const
+    {
+      fired->push_back(std::make_pair(key, time));
+    }
+  };
+
+  // re-arms each expired timer one period later
+  struct periodic
+  {
+    wheel* w;
+    int64_t period;
+    unsigned* count;
+    void operator()(unsigned key, int64_t time) const
+    {
+      (*count)++;
+      w->arm(key, time + period, time + period);
+    }
+  };
+}
+
+// the timers expire at the first tick at or after their time, never earlier
+template<> template<> void tut::to::test<01>(void)
+{
+  std::vector<std::pair<unsigned, int64_t> > fired;
+  const collect c = { &fired };
+
+  wheel w(10);
+  VERIFY( w.empty() && w.next_expiry() == wheel::never );
+  w.arm(1, 15, 15);
+  w.arm(2, 20, 20);
+  w.arm(3, 21, 21);
+  VERIFY( w.size() == 3 && w.next_expiry() == 20 );
+
+  VERIFY( w.advance(19, c) == 0 );
+  VERIFY( w.advance(20, c) == 2 && fired.size() == 2 );
+  VERIFY( w.advance(29, c) == 0 );
+  VERIFY( w.advance(30, c) == 1 && fired.back().first == 3 && w.empty() );
+
+  // re-arming replaces the time, cancel returns the payload
+  w.arm(4, 100, 100);
+  w.arm(5, 200, 200);
+  w.arm(4, 300, 300);
+  int64_t payload = 0;
+  VERIFY( w.cancel(5, &payload) && payload == 200 && !w.cancel(5) );
+  VERIFY( w.armed(4) && w.size() == 1 );
+  fired.clear();
+  VERIFY( w.advance(299, c) == 0 && w.advance(300, c) == 1 && fired[0].first == 4 );
+
+  // the periodic timer is re-armed from the callback
+  unsigned count = 0;
+  const periodic p = { &w, 50, &count };
+  w.arm(6, 1050, 1050);
+  VERIFY( w.advance(1000, p) == 0 );
+  for(int64_t now = 1010; now <= 2000; now += 10)
+    w.advance(now, p);
+  VERIFY( count == 1000 / 50 && w.armed(6) && w.next_expiry() == 2050 );
+  w.clear();
+  VERIFY( w.empty() );
+}
+
+// random arming, cancelling and clock jumps against a sorted reference
+template<> template<> void tut::to::test<02>(void)
+{
+  const int64_t resolution = 7;
+  wheel w(resolution, 1000);
+  std::map<unsigned, int64_t> armed;
+  std::vector<std::pair<unsigned, int64_t> > fired;
+  const collect c = { &fired };
+
+  uint32_t seed = 2463534242u;
+  int64_t now = 1000;
+  bool ok = true, early = false, bound = true;
+  for(int round = 0; round < 20000 && ok; round++){
+    const uint32_t r = next_xorshift(seed);
+    const unsigned key = next_xorshift(seed) % 500;
+    if(r % 8 < 5){
+      // near, far and very far timeouts
+      const uint32_t kind = next_xorshift(seed) % 10;
+      const int64_t after = kind < 6 ? 1 + next_xorshift(seed) % 500 : kind < 9 ? 1 + next_xorshift(seed) % 100000 : 1 + int64_t(next_xorshift(seed)) * 4096;
+      w.arm(key, now + after, now + after);
+      armed[key] = now + after;
+    }else if(r % 8 < 7){
+      int64_t payload;
+      const bool was = armed.erase(key) != 0;
+      ok = w.cancel(key, &payload) == was && ok;
+    }else{
+      // a lower bound of the nearest timer
+      int64_t nearest = wheel::never;
+      for(std::map<unsigned, int64_t>::const_iterator i = armed.begin(); i != armed.end(); ++i)
+        nearest = std::min(nearest, i->second);
+      bound = (armed.empty() ? w.next_expiry() == wheel::never : w.next_expiry() <= (nearest + resolution - 1) / resolution * resolution) && bound;
+
+      const uint32_t kind = next_xorshift(seed) % 10;
+      now += kind < 7 ? next_xorshift(seed) % 300 : kind < 9 ? next_xorshift(seed) % 50000 : int64_t(next_xorshift(seed)) * 64;
+      fired.clear();
+      w.advance(now, c);
+      const int64_t last_tick = now / resolution;
+      size_t expected = 0;
+      for(std::map<unsigned, int64_t>::iterator i = armed.begin(); i != armed.end(); ){
+        if((i->second + resolution - 1) / resolution <= last_tick){
+          expected++;
+          armed.erase(i++);
+        }else{
+          ++i;
+        }
+      }
+      ok = fired.size() == expected && ok;
+      for(size_t i = 0; i < fired.size(); i++)
+        early = fired[i].second > now || early;
+    }
+    ok = w.size() == armed.size() && ok;
+  }
+  VERIFY( ok );
+  VERIFY( !early );
+  VERIFY( bound );
+}